@@ -13,58 +13,34 @@
  *   You should have received a copy of the GNU General Public License
  *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
-#include "checks/braces/EnumBracesCheck.hpp"
-#include "checks/braces/FunctionBodyBracesCheck.hpp"
-#include "checks/braces/StructUnionBracesCheck.hpp"
-#include "checks/comments/CommentManager.hpp"
-#include "checks/comments/FunctionCommentCheck.hpp"
-#include "checks/comments/GlobalVarCommentCheck.hpp"
-#include "checks/indentation/EnumBodyIndentCheck.hpp"
-#include "checks/indentation/FuncDeclParamContIndentCheck.hpp"
-#include "checks/indentation/FunctionBodyIndentCheck.hpp"
-#include "checks/indentation/GlobalVarIndentCheck.hpp"
-#include "checks/indentation/StructUnionBodyIndentCheck.hpp"
-#include "checks/indentation/TypedefIndentCheck.hpp"
-#include "checks/naming/DefineNameCheck.hpp"
-#include "checks/naming/EnumConstNameCheck.hpp"
-#include "checks/naming/EnumNameCheck.hpp"
-#include "checks/naming/FuncNameCheck.hpp"
-#include "checks/naming/StructUnionFieldNameCheck.hpp"
-#include "checks/naming/StructUnionNameCheck.hpp"
-#include "checks/naming/TypedefNameCheck.hpp"
-#include "checks/naming/VarNameCheck.hpp"
-#include "checks/overall/FuncDefinitionInHeaderCheck.hpp"
-#include "checks/overall/FuncLengthCheck.hpp"
-#include "checks/overall/KeywordRedefCheck.hpp"
-#include "checks/warning/GoToCheck.hpp"
-#include "checks/whitespace/BinaryOperatorWhitespaceCheck.hpp"
-#include "checks/whitespace/EnumWhitespaceCheck.hpp"
-#include "checks/whitespace/FileContentManager.hpp"
-#include "checks/whitespace/FunctionBodyWhitespaceCheck.hpp"
-#include "checks/whitespace/FunctionCallWhitespaceCheck.hpp"
-#include "checks/whitespace/GlobalVariableSemicolonWhitespaceCheck.hpp"
-#include "checks/whitespace/StatementSemicolonWhitespaceCheck.hpp"
-#include "checks/whitespace/StructUnionMemberAccessWhitespaceCheck.hpp"
-#include "checks/whitespace/StructUnionWhitespaceCheck.hpp"
-#include "checks/whitespace/TernaryOperatorWhitespaceCheck.hpp"
-#include "checks/whitespace/UnaryOperatorWhitespaceCheck.hpp"
-#include "checks/whitespace/VarDeclWhitespaceCheck.hpp"
+#include "input/Corpus.hpp"
 #include "input/FileInput.hpp"
+#include "input/LineFilter.hpp"
 #include "output/OutputColors.hpp"
+#include "output/StructuredOutput.hpp"
 #include "output/UserOutput.hpp"
+#include "runner/CheckResults.hpp"
+#include "runner/Checker.hpp"
+#include "runner/Preamble.hpp"
+#include "runner/ResultCache.hpp"
+#include "runner/Session.hpp"
+#include "server/Server.hpp"
+#include "stats/Counters.hpp"
+#include "stats/MemoryUsage.hpp"
+#include "stats/Profiler.hpp"
+#include "stats/TimeTrace.hpp"
 #include "violations/ViolationManager.hpp"
 
-#include "clang/ASTMatchers/ASTMatchFinder.h"
-#include "clang/ASTMatchers/ASTMatchers.h"
-#include "clang/Frontend/CompilerInstance.h"
-#include "clang/Frontend/FrontendActions.h"
 #include "clang/Tooling/CommonOptionsParser.h"
-#include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
 
 using namespace clang;
 using namespace clang::tooling;
-using namespace clang::ast_matchers;
 using namespace llvm;
 using namespace nett;
 
@@ -80,206 +56,194 @@ violations detected within them.
 )"),
         cl::init(false), cl::cat(NettOptionCategory));
 
-static cl::opt<bool> ShowLicense("license",
-        cl::desc(R"(Show the license for the software.
+static cl::opt<output::OutputFormat> Format("format",
+        cl::desc(R"(The format to print the violations in. The jsonl and sarif
+formats print each file's violations as soon as no other
+file can change them, instead of once every file has been
+checked. In corpus mode these are printed to stdout rather
+than to a report in each submission.
+)"),
+        cl::values(clEnumValN(output::FORMAT_TEXT, "text",
+                           "Terminal output (default)"),
+                clEnumValN(output::FORMAT_JSONL, "jsonl",
+                        "A JSON object per file, one per line"),
+                clEnumValN(output::FORMAT_SARIF, "sarif", "A SARIF 2.1.0 log")),
+        cl::init(output::FORMAT_TEXT), cl::cat(NettOptionCategory));
+
+static cl::opt<unsigned> Jobs("jobs",
+        cl::desc(R"(The number of files to check in parallel. The violations
+found are the same as when checking the files one at a
+time. A value of 0 uses every available hardware thread.
+Defaults to 1.
+)"),
+        cl::init(1), cl::cat(NettOptionCategory));
+
+static cl::alias JobsShort("j", cl::desc("Alias for --jobs"),
+        cl::aliasopt(Jobs), cl::cat(NettOptionCategory));
+
+static cl::opt<bool> UsePreamble("preamble",
+        cl::desc(R"(Precompile the system headers included at the top of the
+input files once and share them between the files which
+include them. Use --preamble=false to parse every file's
+headers in full. Defaults to true.
+)"),
+        cl::init(true), cl::cat(NettOptionCategory));
+
+static cl::opt<bool> ShowPreambleStats("preamble-stats",
+        cl::desc(R"(Print how many files could use the shared preamble (hits)
+and how many had to be parsed in full (misses).
+)"),
+        cl::init(false), cl::cat(NettOptionCategory));
+
+static cl::opt<bool> ShowCounters("counters",
+        cl::desc(R"(Print how often the checks did certain costly work (e.g.
+lookups of a node's parents), how many heap allocations were made and
+the peak resident memory once checking is done.
 )"),
         cl::init(false), cl::cat(NettOptionCategory));
 
-// SUPPRESSIONS ---------------------------------------------------------------
+static cl::opt<bool> ShowStats("stats",
+        cl::desc(R"(Print the memory used checking each file (the AST, the
+source buffers, the sanitized content and the violations) once checking is
+done.
+)"),
+        cl::init(false), cl::cat(NettOptionCategory));
 
-// The WarningDiagConsumer allows us to suppress warning and error messages
-// which are raised when a file is being parsed by clang. We do nothing when
-// handling a diagnostic since we are simply style checking code which we
-// assume already compiles.
-class WarningDiagConsumer : public DiagnosticConsumer {
+static cl::opt<unsigned> MaxMemory("max-memory",
+        cl::desc(R"(Stop checking a file once its AST and source buffers use
+more than this many MiB, reporting a RESOURCE violation and carrying on with
+the other files (default: no limit).
+)"),
+        cl::value_desc("MiB"), cl::init(0), cl::cat(NettOptionCategory));
 
-    public:
-    virtual void HandleDiagnostic(
-            DiagnosticsEngine::Level Level, const Diagnostic& Info) override {
-        // simply do nothing
-    }
-};
+static cl::opt<bool> ProfileChecks("profile-checks",
+        cl::desc(R"(Print the time spent in each check, and on each file, once
+checking is done.
+)"),
+        cl::init(false), cl::cat(NettOptionCategory));
 
-// MATCHERS -------------------------------------------------------------------
+static cl::opt<std::string> ProfileOutput("profile-output",
+        cl::desc(R"(Write the time spent in each check on each file to the
+given file as JSON. This turns on profiling even without --profile-checks.
+)"),
+        cl::value_desc("filename"), cl::cat(NettOptionCategory));
 
-namespace {
+static cl::opt<std::string> TimeTrace("time-trace",
+        cl::desc(R"(Write a timeline of each file's phases (reading, parsing,
+matching, each check and the output) to the given file, in the Chrome trace
+event format. Each worker thread has its own track.
+)"),
+        cl::value_desc("filename"), cl::cat(NettOptionCategory));
 
-AST_MATCHER(VarDecl, isLocalVariable) {
-    return Node.isLocalVarDecl();
-}
+static cl::opt<unsigned> TimeTraceGranularity("time-trace-granularity",
+        cl::desc(R"(Leave spans shorter than this many microseconds out of the
+time trace (default: 500).
+)"),
+        cl::init(500), cl::cat(NettOptionCategory));
 
-// Variable declaration matcher
-auto VarDeclMatcher = varDecl().bind("varDecl");
-// Function declaration matcher
-auto FuncDeclMatcher = functionDecl().bind("funcDecl");
-// Struct/Union declaration matcher
-auto StructUnionDeclMatcher = recordDecl().bind("recordDecl");
-// Struct/Union field matcher
-auto StructUnionFieldMatcher = fieldDecl().bind("fieldDecl");
-// Enum declaration matcher
-auto EnumDeclMatcher = enumDecl().bind("enumDecl");
-// Enum constant matcher
-auto EnumConstMatcher = enumConstantDecl().bind("enumConstDecl");
-// Typedef matcher
-auto TypedefMatcher = typedefDecl().bind("typedefDecl");
-// goto statement matcher
-auto GoToMatcher = gotoStmt().bind("gotoStmt");
-// Global variable matcher
-auto GlobalVarMatcher = varDecl(hasGlobalStorage(), unless(isLocalVariable()),
-        unless(matchesName("::g[A-Z]")))
-                                .bind("globalVar");
-// Top level struct/union matcher
-auto TopLevelRecordMatcher = recordDecl(
-        unless(hasAncestor(recordDecl())), unless(hasAncestor(functionDecl())))
-                                     .bind("topLevelRecordDecl");
-// Top level enum matcher
-auto TopLevelEnumMatcher = enumDecl(
-        unless(hasAncestor(recordDecl())), unless(hasAncestor(functionDecl())))
-                                   .bind("topLevelEnumDecl");
-// Top level typedef matcher
-auto TopLevelTypedefMatcher = typedefDecl(
-        unless(hasAncestor(recordDecl())), unless(hasAncestor(functionDecl())))
-                                      .bind("topLevelTypedefDecl");
-// Binary operator matcher
-auto BinOpMatcher = binaryOperator().bind("binOp");
-
-// Member expression (X->a / X.a) matcher
-auto MemberExprMatcher = memberExpr().bind("memberExpr");
-
-// Unary operator matcher
-auto UnaryOpMatcher = unaryOperator().bind("unaryOp");
-
-// Statement matcher
-auto StmtMatcher = stmt().bind("stmt");
-
-// Function call matcher
-auto FuncCallMatcher = callExpr().bind("funcCall");
-
-// Ternary expression matcher
-auto TernaryMatcher = conditionalOperator().bind("ternaryExpr");
-
-}  // namespace
-
-// TRAVERSAL SETUP ------------------------------------------------------------
-
-// The ASTConsumer allows us to dictate which AST nodes we match and how we
-// want to handle those matches.
-class NettASTConsumer : public ASTConsumer {
-
-    public:
-    NettASTConsumer(clang::Preprocessor& PP) {
-        // Here we add all of the checks that should be run
-        // when the AST is traversed by using Matcher.addMatcher
-
-        // NAMING checks
-        Matcher.addMatcher(
-                VarDeclMatcher, new checks::naming::VarNameChecker());
-        Matcher.addMatcher(
-                FuncDeclMatcher, new checks::naming::FuncNameChecker());
-        Matcher.addMatcher(StructUnionDeclMatcher,
-                new checks::naming::RecordNameChecker());
-        Matcher.addMatcher(StructUnionFieldMatcher,
-                new checks::naming::RecordFieldNameChecker());
-        Matcher.addMatcher(
-                EnumDeclMatcher, new checks::naming::EnumNameChecker());
-        Matcher.addMatcher(
-                EnumConstMatcher, new checks::naming::EnumConstNameChecker());
-        Matcher.addMatcher(
-                TypedefMatcher, new checks::naming::TypedefNameChecker());
-
-        // COMMENTS checks
-        Matcher.addMatcher(GlobalVarMatcher,
-                new checks::comments::GlobalVarCommentChecker());
-        Matcher.addMatcher(FuncDeclMatcher,
-                new checks::comments::FunctionCommentChecker());
-
-        // BRACES checks
-        Matcher.addMatcher(FuncDeclMatcher,
-                new checks::braces::FunctionBodyBracesChecker());
-        Matcher.addMatcher(
-                EnumDeclMatcher, new checks::braces::EnumBracesChecker());
-        Matcher.addMatcher(StructUnionDeclMatcher,
-                new checks::braces::StructUnionBracesChecker());
-
-        // WHITESPACE checks
-        Matcher.addMatcher(BinOpMatcher,
-                new checks::whitespace::BinaryOperatorWhitespaceChecker());
-        Matcher.addMatcher(MemberExprMatcher,
-                new checks::whitespace::
-                        StructUnionMemberAccessWhitespaceChecker());
-        Matcher.addMatcher(UnaryOpMatcher,
-                new checks::whitespace::UnaryOperatorWhitespaceChecker());
-        Matcher.addMatcher(StmtMatcher,
-                new checks::whitespace::StatementSemicolonWhitespaceChecker());
-        Matcher.addMatcher(GlobalVarMatcher,
-                new checks::whitespace::
-                        GlobalVariableSemicolonWhitespaceChecker());
-        Matcher.addMatcher(FuncDeclMatcher,
-                new checks::whitespace::FunctionBodyWhitespaceChecker(PP));
-        Matcher.addMatcher(EnumDeclMatcher,
-                new checks::whitespace::EnumWhitespaceChecker(PP));
-        Matcher.addMatcher(StructUnionDeclMatcher,
-                new checks::whitespace::StructUnionWhitespaceChecker(PP));
-        Matcher.addMatcher(FuncCallMatcher,
-                new checks::whitespace::FunctionCallWhitespaceChecker(PP));
-        Matcher.addMatcher(VarDeclMatcher,
-                new checks::whitespace::VarDeclWhitespaceChecker(PP));
-        Matcher.addMatcher(TernaryMatcher,
-                new checks::whitespace::TernaryOperatorWhitespaceChecker());
-
-        // INDENTATION checks
-        Matcher.addMatcher(FuncDeclMatcher,
-                new checks::indentation::FuncDeclParamContIndentChecker());
-        Matcher.addMatcher(FuncDeclMatcher,
-                new checks::indentation::FunctionBodyIndentChecker(PP));
-        Matcher.addMatcher(GlobalVarMatcher,
-                new checks::indentation::GlobalVarIndentChecker());
-        Matcher.addMatcher(TopLevelRecordMatcher,
-                new checks::indentation::StructUnionBodyIndentChecker(PP));
-        Matcher.addMatcher(TopLevelEnumMatcher,
-                new checks::indentation::EnumBodyIndentChecker(PP));
-        Matcher.addMatcher(TopLevelTypedefMatcher,
-                new checks::indentation::TypedefIndentChecker());
-
-        // OVERALL checks
-        Matcher.addMatcher(FuncDeclMatcher,
-                new checks::overall::FuncDefinitionInHeaderChecker());
-        Matcher.addMatcher(
-                FuncDeclMatcher, new checks::overall::FuncLengthChecker());
-
-        // WARNING checks
-        Matcher.addMatcher(GoToMatcher, new checks::warning::GoToChecker());
-    }
-
-    void HandleTranslationUnit(ASTContext& Context) override {
-        Matcher.matchAST(Context);
-    }
-
-    private:
-    MatchFinder Matcher;
-};
-
-// The FrontEndAction is the main entry point for the clang tooling library
-// and allows us to add callbacks for checks via PPCallback and
-// ASTConsumer classes.
-class NettFrontEndAction : public ASTFrontendAction {
-
-    public:
-    virtual std::unique_ptr<ASTConsumer> CreateASTConsumer(
-            CompilerInstance& CI, StringRef file) override {
-
-        // Here we add any checks which require the preprocessor.
-        CI.getPreprocessor().addPPCallbacks(std::unique_ptr<PPCallbacks>(
-                new checks::naming::DefineNameChecker(CI.getSourceManager())));
-
-        CI.getPreprocessor().addPPCallbacks(std::unique_ptr<PPCallbacks>(
-                new checks::overall::KeywordRedefChecker(
-                        CI.getSourceManager(), CI.getLangOpts())));
-
-        return std::unique_ptr<ASTConsumer>(
-                new NettASTConsumer(CI.getPreprocessor()));
-    }
-};
+static cl::opt<bool> SkipHeaderBodies("skip-header-bodies",
+        cl::desc(R"(Don't parse the bodies of functions defined outside the file
+being checked (e.g. static inline functions in headers).
+A header's function bodies are still checked when the
+header itself is given as an input.
+)"),
+        cl::init(false), cl::cat(NettOptionCategory));
+
+static cl::list<std::string> LineRanges("lines",
+        cl::desc(R"(Only check the given lines of a file, given as
+'file:first-last' (e.g. --lines=main.c:10-40,52). Can be
+given more than once. Only the declarations near the lines
+are checked, and only the violations on them are reported.
+If no input files are given, the files named are checked.
+)"),
+        cl::value_desc("file:lines"), cl::ZeroOrMore,
+        cl::cat(NettOptionCategory));
+
+static cl::opt<bool> UseDiff("diff",
+        cl::desc(R"(Read a unified diff (e.g. from 'git diff') on stdin and only
+check the lines it adds or changes, in the same way as
+--lines. If no input files are given, the .c and .h files
+changed by the diff are checked.
+)"),
+        cl::init(false), cl::cat(NettOptionCategory));
+
+static cl::opt<bool> UseCache("cache",
+        cl::desc(R"(Keep the results of checking each file on disk, and reuse
+them while the file, the local headers it includes, the
+nett executable and the options are unchanged. Changes to
+the system headers aren't noticed.
+)"),
+        cl::init(false), cl::cat(NettOptionCategory));
+
+static cl::opt<std::string> CacheDirectory("cache-dir",
+        cl::desc(R"(The directory to keep the cached results in. Defaults to
+$XDG_CACHE_HOME/nett (or ~/.cache/nett).
+)"),
+        cl::value_desc("directory"), cl::init(""), cl::cat(NettOptionCategory));
+
+static cl::opt<std::string> CorpusManifest("corpus",
+        cl::desc(R"(Check each of the submission directories listed (one per
+line) in the given manifest file. The .c and .h files in
+each submission are checked independently of the other
+submissions, and the violations are written to a 'nett.out'
+file within the submission (or to .styled files when
+generating files).
+)"),
+        cl::value_desc("manifest"), cl::init(""), cl::cat(NettOptionCategory));
+
+static cl::opt<std::string> ServeSocket("serve",
+        cl::desc(R"(Stay resident and check the files sent by 'nett --connect'
+over a Unix socket at the given path. The options given
+here (e.g. --jobs) apply to every request. The time taken
+to serve each request is reported on stderr.
+)"),
+        cl::value_desc("socket"), cl::init(""), cl::cat(NettOptionCategory));
+
+static cl::opt<std::string> ConnectSocket("connect",
+        cl::desc(R"(Send the input files to the 'nett --serve' process
+listening at the given socket path and print its output.
+)"),
+        cl::value_desc("socket"), cl::init(""), cl::cat(NettOptionCategory));
+
+static cl::opt<std::string> AssumeFilename("assume-filename",
+        cl::desc(R"(Read a file's content from stdin and send it to the server
+(with --connect) under the given file name, along with any
+input files. The file doesn't need to exist on disk, e.g.
+when checking an editor's unsaved buffer.
+)"),
+        cl::value_desc("filename"), cl::init(""), cl::cat(NettOptionCategory));
+
+static cl::opt<bool> ShowLicense("license",
+        cl::desc(R"(Show the license for the software.
+)"),
+        cl::init(false), cl::cat(NettOptionCategory));
+
+// The names of the reports written to each submission in corpus mode, for
+// the terminal output and for each of the structured formats
+#define CORPUS_REPORT_NAME "nett.out"
+#define CORPUS_JSONL_REPORT_NAME "nett.jsonl"
+#define CORPUS_SARIF_REPORT_NAME "nett.sarif"
+
+// The precompiled system headers shared by the files checked. This lives for
+// the whole run so that a server or corpus can keep reusing it.
+static PreambleManager Preambles;
+
+// The results kept from earlier runs, if the cache is in use
+static std::unique_ptr<ResultCache> Cache;
+
+// Returns the options the files are checked with, as given on the command
+// line.
+CheckOptions GetCheckOptions(void) {
+
+    CheckOptions Options;
+    Options.Jobs = Jobs;
+    Options.GenerateFiles = GenerateFiles;
+    Options.SkipHeaderBodies = SkipHeaderBodies;
+    Options.MaxMemory = static_cast<uint64_t>(MaxMemory) << 20;
+    Options.Preambles = UsePreamble ? &Preambles : nullptr;
+    Options.Cache = Cache.get();
+    return Options;
+}
 
 // Appends a set of default flags to the command line arguments passed
 // to the program. These flags are necessary to allow correct functionality
@@ -287,9 +251,6 @@ class NettFrontEndAction : public ASTFrontendAction {
 std::vector<std::string> AppendDefaultFlagsToArgv(int Argc, const char** Argv) {
 
     std::vector<std::string> NewArgv;
-    std::vector<std::string> DefaultFlags{"--extra-arg=-fparse-all-comments",
-            "--extra-arg=-std=gnu99", "--extra-arg=-trigraphs", 
-            "--extra-arg=-O0", "--"};
 
     // We take the command line arguments as is
     for (int i = 0; i < Argc; i++) {
@@ -297,13 +258,312 @@ std::vector<std::string> AppendDefaultFlagsToArgv(int Argc, const char** Argv) {
     }
 
     // Then we add our flags
-    for (auto Flag : DefaultFlags) {
-        NewArgv.push_back(Flag);
+    for (const auto& Flag : GetDefaultCompileFlags()) {
+        NewArgv.push_back("--extra-arg=" + Flag);
     }
+    NewArgv.push_back("--");
 
     return NewArgv;
 }
 
+
+// Prints how often the preamble could be used, the counters of the work
+// done by the checks, the memory used by each file and the time spent in
+// each check, and writes the time trace, if those were asked for.
+void ReportStats(void) {
+
+    if (ShowPreambleStats) {
+        llvm::errs() << "Preamble: " << Preambles.GetHitCount()
+                     << " hit(s), " << Preambles.GetMissCount()
+                     << " miss(es)\n";
+    }
+    if (ShowCounters) {
+        stats::PrintCounters(llvm::errs());
+    }
+    if (ShowStats) {
+        stats::GlobalMemoryUsage.Print(llvm::errs());
+    }
+    if (ProfileChecks) {
+        stats::GlobalCheckProfiler.Print(llvm::errs());
+    }
+    if (stats::IsTimeTraceEnabled() && !stats::WriteTimeTrace(TimeTrace)) {
+        llvm::errs() << "Error: Unable to write time trace "
+                     << colors::Colorize(TimeTrace, colors::COLOR_BOLD_WHITE)
+                     << "\n";
+    }
+    if (!ProfileOutput.empty()) {
+        std::error_code EC;
+        llvm::raw_fd_ostream OS(ProfileOutput, EC, llvm::sys::fs::OF_Text);
+
+        if (EC) {
+            llvm::errs() << "Error: Unable to write profile "
+                         << colors::Colorize(
+                                    ProfileOutput, colors::COLOR_BOLD_WHITE)
+                         << "\n";
+        } else {
+            OS << llvm::formatv(
+                    "{0:2}", stats::GlobalCheckProfiler.ToJSON())
+               << "\n";
+        }
+    }
+}
+
+// Opens the report with the given name within the given submission, printing
+// an error if it can't be written. Returns nullptr in that case.
+std::unique_ptr<llvm::raw_fd_ostream> OpenCorpusReport(
+        llvm::StringRef Submission, llvm::StringRef ReportName) {
+
+    llvm::SmallString<128> ReportPath(Submission);
+    llvm::sys::path::append(ReportPath, ReportName);
+
+    std::error_code EC;
+    std::unique_ptr<llvm::raw_fd_ostream> Report(
+            new llvm::raw_fd_ostream(ReportPath, EC, llvm::sys::fs::OF_Text));
+
+    if (EC) {
+        llvm::errs() << "Error: Unable to write report "
+                     << colors::Colorize(ReportPath.str().str(),
+                                colors::COLOR_BOLD_WHITE)
+                     << "\n";
+        return nullptr;
+    }
+
+    return Report;
+}
+
+// Checks each of the submissions listed in the given corpus manifest. The
+// submissions are independent of each other, so all of the state kept
+// between files is freed once a submission's results have been written.
+int RunCorpus(const CompilationDatabase& Compilations,
+        std::string ManifestPath) {
+
+    std::vector<std::string> Submissions;
+
+    if (!input::ReadCorpusManifest(ManifestPath, Submissions)) {
+        llvm::errs() << "Error: Unable to access corpus manifest "
+                     << colors::Colorize(ManifestPath, colors::COLOR_BOLD_WHITE)
+                     << "\n";
+        return EXIT_FAILURE;
+    }
+
+    for (const auto& Submission : Submissions) {
+        auto FileList = input::GetSubmissionFiles(Submission);
+        CheckSession Session;
+        SessionScope Scope(Session);
+
+        if (FileList.empty()) {
+            llvm::errs() << "Warning: No input files found in submission "
+                         << colors::Colorize(
+                                    Submission, colors::COLOR_BOLD_WHITE)
+                         << "\n";
+            continue;
+        }
+
+        // Streamed results go to the submission's own report, so that each
+        // one is a complete document on its own
+        std::unique_ptr<llvm::raw_fd_ostream> StructuredReport;
+        std::unique_ptr<output::ResultStream> Stream;
+        if (Format != output::FORMAT_TEXT) {
+            StructuredReport = OpenCorpusReport(Submission,
+                    Format == output::FORMAT_JSONL ? CORPUS_JSONL_REPORT_NAME
+                                                   : CORPUS_SARIF_REPORT_NAME);
+            if (!StructuredReport) {
+                continue;
+            }
+            Stream.reset(new output::ResultStream(Format, *StructuredReport));
+        }
+
+        auto FilePaths = CheckFiles(Compilations, FileList, GetCheckOptions(),
+                llvm::StringMap<std::string>(), Stream.get());
+
+        if (Stream) {
+            Stream->Finish();
+        }
+        if (GenerateFiles) {
+            stats::ProfileScope Profile("output/Files");
+            output::OutputViolationsToFiles(FilePaths);
+        } else if (!Stream) {
+            auto Report = OpenCorpusReport(Submission, CORPUS_REPORT_NAME);
+            if (Report) {
+                stats::ProfileScope Profile("output/Terminal");
+                output::OutputViolationsToTerminal(FilePaths, *Report);
+            }
+        }
+
+        DiscardCheckResults();
+    }
+    ReportStats();
+
+    return EXIT_SUCCESS;
+}
+
+// Checks the files in a single server request, returning the output that
+// would have been printed to the terminal.
+server::CheckResponse HandleCheckRequest(
+        const CompilationDatabase& Compilations,
+        const server::CheckRequest& Request) {
+
+    std::string Output;
+    llvm::raw_string_ostream OS(Output);
+    std::vector<std::string> FileList;
+    llvm::StringMap<std::string> Buffers;
+
+    if (Request.Files.empty()) {
+        OS << "Error: No input files specified\n";
+        return {false, OS.str()};
+    }
+
+    for (const auto& File : Request.Files) {
+        if (File.Content) {
+            Buffers[File.FilePath] = *File.Content;
+        } else if (!input::FileCanBeAccessed(File.FilePath)) {
+            OS << "Error: Unable to access file "
+               << colors::Colorize(File.FilePath, colors::COLOR_BOLD_WHITE)
+               << "\n";
+            return {false, OS.str()};
+        }
+        FileList.push_back(File.FilePath);
+    }
+
+    CheckSession Session;
+    SessionScope Scope(Session);
+    auto FilePaths =
+            CheckFiles(Compilations, FileList, GetCheckOptions(), Buffers);
+    {
+        stats::ProfileScope Profile("output/Terminal");
+        output::OutputViolationsToTerminal(FilePaths, OS);
+    }
+
+    // Nothing from this request may leak into the next one
+    DiscardCheckResults();
+
+    return {true, OS.str()};
+}
+
+// Serves check requests on the given socket until interrupted. The parsed
+// options, compilation database and default flags stay resident between
+// requests; everything produced by the checks is freed after each one.
+// Each request still gets its own tool and FileManager, since the buffers
+// sent with one request would otherwise be cached into the next; the
+// preamble is what saves reparsing the system headers.
+// The stats asked for cover all of the requests and are reported once the
+// server stops.
+int RunServer(const CompilationDatabase& Compilations,
+        std::string SocketPath) {
+
+    auto Handler = [&Compilations](const server::CheckRequest& Request) {
+        return HandleCheckRequest(Compilations, Request);
+    };
+
+    if (!server::RunServer(SocketPath, Handler)) {
+        llvm::errs() << "Error: Unable to listen on socket "
+                     << colors::Colorize(SocketPath, colors::COLOR_BOLD_WHITE)
+                     << "\n";
+        return EXIT_FAILURE;
+    }
+    ReportStats();
+
+    return EXIT_SUCCESS;
+}
+
+// Sends the given files (and the content of stdin, with --assume-filename)
+// to the server listening on the given socket and prints the violations it
+// found.
+int RunClient(const std::vector<std::string>& FileList,
+        std::string SocketPath) {
+
+    // The server may have been started from somewhere else, so we send it
+    // full paths to the files.
+    server::CheckRequest Request;
+    for (const auto& FilePath : FileList) {
+        server::RequestFile File;
+        File.FilePath = GetFullPath(FilePath);
+        Request.Files.push_back(File);
+    }
+
+    if (!AssumeFilename.empty()) {
+        auto Content = llvm::MemoryBuffer::getSTDIN();
+        if (!Content) {
+            llvm::errs() << "Error: Unable to read a file from stdin\n";
+            return EXIT_FAILURE;
+        }
+
+        server::RequestFile File;
+        File.FilePath = GetFullPath(AssumeFilename);
+        File.Content = (*Content)->getBuffer().str();
+        Request.Files.push_back(File);
+    }
+
+    server::CheckResponse Response;
+    if (!server::SendRequest(SocketPath, Request, Response)) {
+        llvm::errs() << "Error: Unable to reach server at "
+                     << colors::Colorize(SocketPath, colors::COLOR_BOLD_WHITE)
+                     << "\n";
+        return EXIT_FAILURE;
+    }
+
+    // Errors are printed the same way as when checking the files directly
+    if (!Response.Succeeded) {
+        llvm::errs() << Response.Output;
+        return EXIT_FAILURE;
+    }
+    llvm::outs() << Response.Output;
+
+    return EXIT_SUCCESS;
+}
+
+// Fills the GlobalLineFilter from the --lines and --diff options, adding
+// any files named there to FileList if no input files were given. Returns
+// false if the ranges can't be read.
+bool ReadLineFilter(std::vector<std::string>& FileList) {
+
+    std::vector<std::string> NamedFiles;
+
+    for (const auto& Spec : LineRanges) {
+        std::string FilePath;
+        std::vector<input::LineRange> Ranges;
+        if (!input::ParseLineRanges(Spec, FilePath, Ranges)) {
+            llvm::errs() << "Error: Unable to read line range "
+                         << colors::Colorize(Spec, colors::COLOR_BOLD_WHITE)
+                         << "\n";
+            return false;
+        }
+
+        NamedFiles.push_back(FilePath);
+        for (auto Range : Ranges) {
+            input::GlobalLineFilter->AddRange(GetFullPath(FilePath), Range);
+        }
+    }
+
+    if (UseDiff) {
+        auto Diff = llvm::MemoryBuffer::getSTDIN();
+        if (!Diff) {
+            llvm::errs() << "Error: Unable to read a diff from stdin\n";
+            return false;
+        }
+
+        auto Changes = input::ParseUnifiedDiff((*Diff)->getBuffer());
+        for (const auto& File : Changes) {
+            auto FilePath = File.getKey().str();
+            auto Extension = llvm::sys::path::extension(FilePath);
+            if (Extension == ".c" || Extension == ".h") {
+                NamedFiles.push_back(FilePath);
+            }
+            for (auto Range : File.getValue()) {
+                input::GlobalLineFilter->AddRange(GetFullPath(FilePath), Range);
+            }
+        }
+    }
+
+    if (FileList.empty()) {
+        std::sort(NamedFiles.begin(), NamedFiles.end());
+        NamedFiles.erase(std::unique(NamedFiles.begin(), NamedFiles.end()),
+                NamedFiles.end());
+        FileList = NamedFiles;
+    }
+    return true;
+}
+
 // Prints the licensing information for the program.
 void PrintLicense(void) {
     llvm::outs() << "nett  Copyright (C) 2020  Matthys Grobbelaar\n\n";
@@ -340,11 +600,119 @@ int main(int Argc, const char** Argv) {
         return EXIT_SUCCESS;
     }
 
+    if (ShowStats) {
+        stats::GlobalMemoryUsage.Enable();
+    }
+
+    // Nothing is counted (not even allocations) unless it will be printed
+    if (ShowCounters) {
+        stats::EnableCounters();
+    }
+
+    // The checks look up whether they are being timed as they are made
+    if (ProfileChecks || !ProfileOutput.empty()) {
+        stats::GlobalCheckProfiler.Enable();
+    }
+
+    // A server's trace would never be written, and a client checks nothing
+    if (!TimeTrace.empty()) {
+        if (!ServeSocket.empty() || !ConnectSocket.empty()) {
+            llvm::errs() << "Error: --time-trace cannot be used with --serve "
+                            "or --connect\n";
+            return EXIT_FAILURE;
+        }
+        stats::EnableTimeTrace(
+                TimeTraceGranularity, llvm::sys::path::filename(Argv[0]));
+    }
+
+    // Only the options which change the violations found are part of the
+    // cache's keys
+    if (UseCache) {
+        std::string Directory = CacheDirectory;
+        if (Directory.empty()) {
+            Directory = ResultCache::GetDefaultDirectory();
+        }
+        if (Directory.empty()) {
+            llvm::errs() << "Error: Unable to find a cache directory, use "
+                            "--cache-dir to give one\n";
+            return EXIT_FAILURE;
+        }
+
+        std::string Options = "generate-files=";
+        Options += GenerateFiles ? "1" : "0";
+        Options += ";skip-header-bodies=";
+        Options += SkipHeaderBodies ? "1" : "0";
+        Options += ";max-memory=" + std::to_string(MaxMemory);
+        // Results from another build of nett can't be trusted
+        auto BuildID = ResultCache::GetBuildID(
+                Argv[0], (void*)(intptr_t)&PrintLicense);
+        if (BuildID.empty()) {
+            llvm::errs() << "Warning: Unable to identify the nett executable, "
+                            "so results won't be cached\n";
+        } else {
+            Cache.reset(new ResultCache(Directory, BuildID, Options));
+        }
+    }
+
+    // The line filter belongs to a single set of input files, and the
+    // cached results are of whole files
+    bool FilterLines = !LineRanges.empty() || UseDiff;
+    if (FilterLines && (!ServeSocket.empty() || !CorpusManifest.empty() ||
+                               !ConnectSocket.empty() || Cache)) {
+        llvm::errs() << "Error: --lines and --diff cannot be used with "
+                        "--serve, --connect, --corpus or --cache\n";
+        return EXIT_FAILURE;
+    }
+
+    // Only a server is sent content rather than reading files from disk
+    if (!AssumeFilename.empty() && ConnectSocket.empty()) {
+        llvm::errs() << "Error: --assume-filename can only be used with "
+                        "--connect\n";
+        return EXIT_FAILURE;
+    }
+
+    // The server sends its output back to the client, so it can't
+    // write .styled files.
+    if (!ServeSocket.empty()) {
+        if (GenerateFiles) {
+            llvm::errs() << "Error: --generate-files cannot be used with "
+                            "--serve\n";
+            return EXIT_FAILURE;
+        }
+        if (Format != output::FORMAT_TEXT) {
+            llvm::errs() << "Error: --format cannot be used with --serve\n";
+            return EXIT_FAILURE;
+        }
+        return RunServer(OptionsParser->getCompilations(), ServeSocket);
+    }
+
+    // The .styled files take the place of the printed output
+    if (GenerateFiles && Format != output::FORMAT_TEXT) {
+        llvm::errs() << "Error: --format cannot be used with "
+                        "--generate-files\n";
+        return EXIT_FAILURE;
+    }
+
+    if (GenerateFiles) {
+        GlobalViolationManager.SetOutputToFile();
+    }
+
+    // A corpus brings its own input files
+    if (!CorpusManifest.empty()) {
+        return RunCorpus(OptionsParser->getCompilations(), CorpusManifest);
+    }
+
     // Check if we received some input files.
     // Also check if files are accessible
     auto FileList = OptionsParser->getSourcePathList();
+    CheckSession Session;
+    SessionScope Scope(Session);
 
-    if (FileList.empty()) {
+    if (FilterLines && !ReadLineFilter(FileList)) {
+        return EXIT_FAILURE;
+    }
+
+    if (FileList.empty() && AssumeFilename.empty()) {
         llvm::errs() << "Error: No input files specified\n";
         return EXIT_FAILURE;
     }
@@ -358,56 +726,38 @@ int main(int Argc, const char** Argv) {
         }
     }
 
-    // We have some files, so we can set up a new clang tool to do the checks.
-    ClangTool Tool(OptionsParser->getCompilations(), FileList);
-    Tool.setDiagnosticConsumer(new WarningDiagConsumer);
-    if (GenerateFiles) {
-        GlobalViolationManager.SetOutputToFile();
+    if (!ConnectSocket.empty()) {
+        if (Format != output::FORMAT_TEXT) {
+            llvm::errs() << "Error: --format cannot be used with "
+                            "--connect\n";
+            return EXIT_FAILURE;
+        }
+        return RunClient(FileList, ConnectSocket);
     }
 
-    // Once the tool has been set up, we need to convert all tabs into spaces
-    // within the file contents. In order to avoid needing to create a new file
-    // on disk, this can be done by providing a virtual content mapping of the
-    // file to the tool. We also need to keep track of the file content
-    // since the virtual map uses StringRefs which require the strings to have
-    // a long lifetime and not doing this causes memory corruption and annoying
-    // bugs.
-    std::vector<std::string> FileContentHolder;
-    int FileIndex = 0;
+    // Streamed violations are printed while the files are being checked
+    if (Format != output::FORMAT_TEXT) {
+        output::ResultStream Stream(Format, llvm::outs());
+        CheckFiles(OptionsParser->getCompilations(), FileList,
+                GetCheckOptions(), llvm::StringMap<std::string>(), &Stream);
+        Stream.Finish();
+        ReportStats();
 
-    for (const auto& FilePath : OptionsParser->getSourcePathList()) {
-        llvm::SmallString<128> AbsPath(FilePath);
-        Tool.getFiles().makeAbsolutePath(AbsPath);
-        std::string Content = input::GetSanitizedFileContent(AbsPath.c_str());
-        FileContentHolder.push_back(Content);
-        Tool.mapVirtualFile(
-                FilePath, llvm::StringRef(FileContentHolder.at(FileIndex)));
-        FileIndex++;
+        return EXIT_SUCCESS;
     }
 
-    // Now that the tool is all set up, we can run the checks.
-    Tool.run(newFrontendActionFactory<NettFrontEndAction>().get());
-
-    // Some of the checks (e.g. function comments) can only be done once
-    // everything has been processed. We do those checks here.
-    GlobalFunctionCommentManager.GenerateCommentViolations();
-    GlobalFileContentManager.GenerateWhitespaceViolations();
-
     // Once the checks are done, we output the violations.
-    // We need to get the full paths to each of the files due to the way
-    // the violations are stored.
-    std::vector<std::string> FilePaths;
-    for (auto FilePath : FileList) {
-        llvm::SmallString<128> AbsPath(FilePath);
-        Tool.getFiles().makeAbsolutePath(AbsPath);
-        FilePaths.push_back(AbsPath.c_str());
-    }
+    auto FilePaths = CheckFiles(
+            OptionsParser->getCompilations(), FileList, GetCheckOptions());
 
     if (GenerateFiles) {
+        stats::ProfileScope Profile("output/Files");
         output::OutputViolationsToFiles(FilePaths);
     } else {
+        stats::ProfileScope Profile("output/Terminal");
         output::OutputViolationsToTerminal(FilePaths);
     }
+    ReportStats();
 
     return EXIT_SUCCESS;
 }
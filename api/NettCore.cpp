@@ -0,0 +1,83 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#include "NettCore.hpp"
+
+#include "../output/UserOutput.hpp"
+#include "../runner/CheckResults.hpp"
+#include "../runner/Checker.hpp"
+#include "../runner/Preamble.hpp"
+#include "../runner/Session.hpp"
+#include "../violations/ViolationManager.hpp"
+
+#include "clang/Tooling/CompilationDatabase.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace nett {
+
+CheckBufferResults CheckBuffers(const std::vector<SourceBuffer>& Files,
+        const CheckBufferOptions& Options) {
+
+    CheckBufferResults Results;
+    if (Files.empty()) {
+        return Results;
+    }
+
+    auto Flags = GetDefaultCompileFlags();
+    Flags.insert(Flags.end(), Options.CompileFlags.begin(),
+            Options.CompileFlags.end());
+    clang::tooling::FixedCompilationDatabase Compilations(".", Flags);
+
+    std::vector<std::string> FileList;
+    llvm::StringMap<std::string> Buffers;
+    for (const auto& File : Files) {
+        FileList.push_back(File.FilePath);
+        Buffers[File.FilePath] = File.Content;
+    }
+
+    PreambleManager Preambles;
+    CheckOptions Checking;
+    Checking.Jobs = Options.Jobs;
+    Checking.SkipHeaderBodies = Options.SkipHeaderBodies;
+    Checking.MaxMemory = static_cast<uint64_t>(Options.MaxMemory) << 20;
+    if (Options.UsePreamble) {
+        Checking.Preambles = &Preambles;
+    }
+
+    // Anything the caller's thread was already holding is put aside, and
+    // given back once our own results are gone.
+    auto OuterResults = TakeCheckResults();
+    {
+        CheckSession Session;
+        SessionScope Scope(Session);
+
+        auto FilePaths = CheckFiles(Compilations, FileList, Checking, Buffers);
+        for (const auto& FilePath : FilePaths) {
+            FileViolations File;
+            File.FilePath = FilePath;
+            const auto& Index =
+                    GlobalViolationManager.GetFileViolations(FilePath);
+            for (const auto* Viol : Index.GetViolations()) {
+                File.Violations.push_back({Viol->GetLineNumber(),
+                        Viol->GetColumnNumber(),
+                        GetViolationTypeName(Viol->Type()).str(),
+                        Viol->GetMessage()});
+            }
+            Results.Files.push_back(std::move(File));
+        }
+
+        llvm::raw_string_ostream OS(Results.Output);
+        output::OutputViolationsToTerminal(FilePaths, OS);
+        OS.flush();
+
+        // The violations refer to the session's strings, so they have to
+        // go before it does
+        DiscardCheckResults();
+    }
+    MergeCheckResults(OuterResults);
+
+    return Results;
+}
+
+}  // namespace nett
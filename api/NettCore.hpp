@@ -0,0 +1,81 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#ifndef LLVM_CLANG_TOOLS_EXTRA_NETT_API_NETTCORE_HPP
+#define LLVM_CLANG_TOOLS_EXTRA_NETT_API_NETTCORE_HPP
+
+#include <string>
+#include <vector>
+
+// The in-process interface to the checks, for tools (e.g. editors and
+// graders) which link the nettcore library instead of running nett. Each
+// call keeps its state to itself, so several threads can check files at
+// once, and nothing is left behind once a call returns.
+//
+// A few pieces of state are not part of a call and are shared with the rest
+// of the process:
+//  - stats::GlobalCheckProfiler and stats::GlobalMemoryUsage are process-wide
+//    and off by default. If the host turns them on, every call records into
+//    them (under the mutex each holds) until the process exits.
+//  - stats::CountersEnabled is process-wide, and must only be set before any
+//    call is made.
+//  - checks::utils::GlobalTokenCache is thread_local rather than part of
+//    the call. It is cleared at the end of each file, so it holds nothing
+//    between calls.
+namespace nett {
+
+// A file to check, along with the content to check it with. The content
+// takes the place of the file on disk, which doesn't have to exist.
+struct SourceBuffer {
+    std::string FilePath;
+    std::string Content;
+};
+
+// The options of a call to CheckBuffers
+struct CheckBufferOptions {
+    // Extra flags the files are compiled with (e.g. "-I include")
+    std::vector<std::string> CompileFlags;
+    // The number of worker threads, or 0 for every hardware thread
+    unsigned Jobs = 1;
+    // Whether the system headers included by the files are parsed once
+    // and shared between them
+    bool UsePreamble = false;
+    // Whether the function bodies of included headers are skipped
+    bool SkipHeaderBodies = false;
+    // The MiB a file may use before it stops being checked, or 0
+    unsigned MaxMemory = 0;
+};
+
+// A single style violation
+struct ReportedViolation {
+    unsigned Line;
+    // The column, or 0 if the violation is of the whole line
+    unsigned Column;
+    // The category of the violation (e.g. "NAMING")
+    std::string Category;
+    std::string Message;
+};
+
+// The violations found in a single file, sorted by line
+struct FileViolations {
+    // The full path of the file
+    std::string FilePath;
+    std::vector<ReportedViolation> Violations;
+};
+
+// The results of a call to CheckBuffers
+struct CheckBufferResults {
+    // The files, in the order they were given
+    std::vector<FileViolations> Files;
+    // The violations as nett would print them to the terminal
+    std::string Output;
+};
+
+// Checks the given files as if they were given to nett together, and
+// returns the violations found in each of them.
+CheckBufferResults CheckBuffers(const std::vector<SourceBuffer>& Files,
+        const CheckBufferOptions& Options = CheckBufferOptions());
+
+}  // namespace nett
+
+#endif
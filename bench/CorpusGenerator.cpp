@@ -0,0 +1,365 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#include "CorpusGenerator.hpp"
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <random>
+
+namespace nett {
+namespace bench {
+
+// The number of values written on each line of a table's initialiser
+#define VALUES_PER_LINE 8
+
+// One in this many statements breaks the style guide on purpose
+#define VIOLATION_RARITY 20
+
+// Builds the lines of a source file, keeping track of the indentation.
+class SourceWriter {
+    public:
+    void Line(const std::string& Text) {
+        Content.append(Depth * 4, ' ');
+        Content += Text;
+        Content += '\n';
+    }
+
+    void Blank(void) {
+        Content += '\n';
+    }
+
+    void Open(const std::string& Text) {
+        Line(Text);
+        Depth++;
+    }
+
+    void Close(const std::string& Text = "}") {
+        Depth--;
+        Line(Text);
+    }
+
+    unsigned GetDepth(void) const {
+        return Depth;
+    }
+
+    std::string Content;
+
+    private:
+    unsigned Depth = 0;
+};
+
+// Generates one module (a header and a source file) of the corpus. Every
+// random choice is made with the module's own generator, so a module is
+// the same however many other modules are generated.
+class ModuleGenerator {
+    public:
+    ModuleGenerator(const CorpusOptions& Options, unsigned Module)
+        : Options(Options), Module(Module), Id(std::to_string(Module)),
+          Random(Options.Seed + Module * 7919) {
+    }
+
+    GeneratedFile GenerateHeader(void);
+    GeneratedFile GenerateSource(void);
+
+    private:
+    // Returns true with the given percentage chance.
+    bool Chance(unsigned Percent) {
+        return Random() % 100 < Percent;
+    }
+
+    std::string FunctionName(unsigned Function) {
+        return "process" + Id + "Step" + std::to_string(Function);
+    }
+
+    std::string Prototype(unsigned Function) {
+        return "int " + FunctionName(Function) + "(int count, char* text, " +
+               "Record" + Id + "* record)";
+    }
+
+    void GenerateTables(SourceWriter& Writer);
+    void GenerateFunction(SourceWriter& Writer, unsigned Function);
+    void GenerateStatement(SourceWriter& Writer);
+
+    const CorpusOptions& Options;
+    unsigned Module;
+    std::string Id;
+    std::mt19937 Random;
+    unsigned NextName = 0;
+};
+
+GeneratedFile ModuleGenerator::GenerateHeader(void) {
+
+    SourceWriter Writer;
+    auto Guard = "MODULE" + Id + "_H";
+
+    Writer.Line("/* module" + Id + ".h");
+    Writer.Line(" * Generated by nett-bench.");
+    Writer.Line(" */");
+    Writer.Line("#ifndef " + Guard);
+    Writer.Line("#define " + Guard);
+    Writer.Blank();
+    Writer.Line("#include <stddef.h>");
+    Writer.Blank();
+    Writer.Line("// A record kept by module " + Id);
+    Writer.Open("typedef struct Record" + Id + " {");
+    Writer.Line("int value;");
+    Writer.Line("char* name;");
+    Writer.Line("struct Record" + Id + "* next;");
+    Writer.Close("} Record" + Id + ";");
+
+    for (unsigned i = 0; i < Options.FunctionsPerFile; i++) {
+        Writer.Blank();
+        if (Chance(Options.CommentDensity)) {
+            Writer.Line("// Steps the records of module " + Id +
+                        " forward by the given count.");
+        }
+        Writer.Line(Prototype(i) + ";");
+    }
+
+    Writer.Blank();
+    Writer.Line("#endif");
+    return {"module" + Id + ".h", std::move(Writer.Content)};
+}
+
+void ModuleGenerator::GenerateTables(SourceWriter& Writer) {
+
+    unsigned Size = Options.InitialiserSize ? Options.InitialiserSize : 1;
+
+    Writer.Line("// Values used by module " + Id);
+    Writer.Open("static const int table" + Id + "[TABLE_SIZE_" + Id + "] = {");
+    for (unsigned i = 0; i < Size; i += VALUES_PER_LINE) {
+        std::string Values;
+        for (unsigned j = i; j < Size && j < i + VALUES_PER_LINE; j++) {
+            Values += std::to_string(Random() % 1000);
+            Values += (j + 1 < Size) ? ", " : "";
+        }
+        Writer.Line(Values.substr(0, Values.find_last_not_of(' ') + 1));
+    }
+    Writer.Close("};");
+    Writer.Blank();
+
+    Writer.Line("// Records every module " + Id + " step starts from");
+    Writer.Open("static Record" + Id + " records" + Id + "[] = {");
+    for (unsigned i = 0; i < Size / VALUES_PER_LINE + 1; i++) {
+        Writer.Line("{" + std::to_string(i) + ", \"record" +
+                    std::to_string(i) + "\", NULL},");
+    }
+    Writer.Close("};");
+}
+
+void ModuleGenerator::GenerateStatement(SourceWriter& Writer) {
+
+    auto Name = std::to_string(NextName++);
+
+    if (Random() % VIOLATION_RARITY == 0) {
+        switch (Random() % 3) {
+        case 0:
+            Writer.Line("total+=count;");
+            break;
+        case 1:
+            Writer.Line("int Bad_Name" + Name + " = total;");
+            Writer.Line("total -= Bad_Name" + Name + ";");
+            break;
+        default:
+            Writer.Line("  total = total * 2;");
+            break;
+        }
+        return;
+    }
+
+    if (Chance(Options.PointerDensity)) {
+        switch (Random() % 5) {
+        case 0:
+            Writer.Line("cursor = text + (total % TABLE_SIZE_" + Id + ");");
+            break;
+        case 1:
+            Writer.Line("current->value += *cursor;");
+            break;
+        case 2:
+            Writer.Line("char* copy" + Name + " = malloc(count + 1);");
+            Writer.Line("strncpy(copy" + Name + ", text, count);");
+            Writer.Line("free(copy" + Name + ");");
+            break;
+        case 3:
+            Writer.Line("current = current->next ? current->next : record;");
+            break;
+        default:
+            Writer.Line("total += (int)strlen(cursor);");
+            break;
+        }
+        return;
+    }
+
+    if (Chance(Options.MacroDensity)) {
+        switch (Random() % 2) {
+        case 0:
+            Writer.Line("total += SCALE_" + Id + "(total);");
+            break;
+        default:
+            Writer.Line("total = CLAMP_" + Id + "(total, 0, LIMIT_" + Id +
+                        ");");
+            break;
+        }
+        return;
+    }
+
+    switch (Random() % 4) {
+    case 0:
+        Writer.Line("total += count * " + std::to_string(Random() % 9 + 1) +
+                    " - 1;");
+        break;
+    case 1:
+        Writer.Line("total = table" + Id + "[total % TABLE_SIZE_" + Id +
+                    "];");
+        break;
+    case 2:
+        Writer.Line("int value" + Name + " = records" + Id +
+                    "[0].value + total;");
+        Writer.Line("total ^= value" + Name + ";");
+        break;
+    default:
+        Writer.Line("printf(\"%d\\n\", total);");
+        break;
+    }
+}
+
+void ModuleGenerator::GenerateFunction(SourceWriter& Writer, unsigned Function) {
+
+    if (Chance(Options.CommentDensity)) {
+        Writer.Line("// Steps the records of module " + Id +
+                    " forward, returning the running total.");
+    }
+    Writer.Open(Prototype(Function) + " {");
+    Writer.Line("int total = 0;");
+    Writer.Line("char* cursor = text;");
+    Writer.Line("Record" + Id + "* current = record;");
+
+    // Blocks are opened and closed at random, never going deeper than the
+    // nesting depth, and every block is closed by the end of the function
+    unsigned BaseDepth = Writer.GetDepth();
+    for (unsigned i = 0; i < Options.FunctionLength; i++) {
+        auto Depth = Writer.GetDepth() - BaseDepth;
+        auto Loop = "i" + std::to_string(Depth);
+
+        if (Depth < Options.NestingDepth && Random() % 5 == 0) {
+            switch (Random() % 3) {
+            case 0:
+                Writer.Open("for (int " + Loop + " = 0; " + Loop +
+                            " < count; " + Loop + "++) {");
+                break;
+            case 1:
+                Writer.Open("if (total > " + std::to_string(Random() % 100) +
+                            ") {");
+                break;
+            default:
+                Writer.Open("while (current != NULL && total < LIMIT_" + Id +
+                            ") {");
+                break;
+            }
+            continue;
+        }
+        if (Depth > 0 && Random() % 6 == 0) {
+            Writer.Close();
+            continue;
+        }
+        if (Chance(Options.CommentDensity / 4)) {
+            Writer.Line("// Fold the next value into the running total");
+        }
+        GenerateStatement(Writer);
+    }
+    while (Writer.GetDepth() > BaseDepth) {
+        Writer.Close();
+    }
+
+    Writer.Line("return total;");
+    Writer.Close();
+}
+
+GeneratedFile ModuleGenerator::GenerateSource(void) {
+
+    SourceWriter Writer;
+    unsigned TableSize = Options.InitialiserSize ? Options.InitialiserSize : 1;
+
+    Writer.Line("/* module" + Id + ".c");
+    Writer.Line(" * Generated by nett-bench.");
+    Writer.Line(" */");
+    Writer.Line("#include <stdio.h>");
+    Writer.Line("#include <stdlib.h>");
+    Writer.Line("#include <string.h>");
+    Writer.Line("#include \"module" + Id + ".h\"");
+    Writer.Blank();
+    Writer.Line("#define LIMIT_" + Id + " " + std::to_string(64 + Module));
+    Writer.Line("#define TABLE_SIZE_" + Id + " " + std::to_string(TableSize));
+    Writer.Line("#define SCALE_" + Id + "(x) ((x) * " +
+                std::to_string(Module % 7 + 2) + " + 1)");
+    Writer.Line("#define CLAMP_" + Id +
+                "(x, low, high) ((x) < (low) ? (low) : "
+                "((x) > (high) ? (high) : (x)))");
+    Writer.Blank();
+
+    GenerateTables(Writer);
+
+    for (unsigned i = 0; i < Options.FunctionsPerFile; i++) {
+        Writer.Blank();
+        GenerateFunction(Writer, i);
+    }
+
+    if (Module == 0) {
+        Writer.Blank();
+        Writer.Line("// Runs each step of the first module.");
+        Writer.Open("int main(int argc, char** argv) {");
+        Writer.Line("int total = 0;");
+        for (unsigned i = 0; i < Options.FunctionsPerFile; i++) {
+            Writer.Line("total += " + FunctionName(i) +
+                        "(argc, argv[0], &records0[0]);");
+        }
+        Writer.Line("return total > 0 ? 0 : 1;");
+        Writer.Close();
+    }
+
+    return {"module" + Id + ".c", std::move(Writer.Content)};
+}
+
+std::vector<GeneratedFile> GenerateCorpus(const CorpusOptions& Options) {
+
+    std::vector<GeneratedFile> Files;
+    for (unsigned i = 0; i < Options.Files; i++) {
+        ModuleGenerator Generator(Options, i);
+        Files.push_back(Generator.GenerateHeader());
+        Files.push_back(Generator.GenerateSource());
+    }
+    return Files;
+}
+
+std::vector<std::string> WriteCorpus(
+        llvm::StringRef Directory, const std::vector<GeneratedFile>& Files) {
+
+    std::vector<std::string> SourceFiles;
+    if (llvm::sys::fs::create_directories(Directory)) {
+        return {};
+    }
+
+    for (const auto& File : Files) {
+        llvm::SmallString<128> Path(Directory);
+        llvm::sys::path::append(Path, File.Name);
+
+        std::error_code EC;
+        llvm::raw_fd_ostream OS(Path, EC, llvm::sys::fs::OF_Text);
+        if (EC) {
+            return {};
+        }
+        OS << File.Content;
+
+        if (llvm::sys::path::extension(Path) == ".c") {
+            SourceFiles.push_back(Path.str().str());
+        }
+    }
+    return SourceFiles;
+}
+
+}  // namespace bench
+}  // namespace nett
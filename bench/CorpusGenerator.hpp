@@ -0,0 +1,52 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#ifndef LLVM_CLANG_TOOLS_EXTRA_NETT_BENCH_CORPUSGENERATOR_HPP
+#define LLVM_CLANG_TOOLS_EXTRA_NETT_BENCH_CORPUSGENERATOR_HPP
+
+#include "llvm/ADT/StringRef.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace nett {
+namespace bench {
+
+// The shape of a generated corpus. Densities are percentages of the
+// statements (or functions, for comments) generated.
+struct CorpusOptions {
+    unsigned Files = 20;
+    unsigned FunctionsPerFile = 8;
+    unsigned FunctionLength = 30;
+    unsigned NestingDepth = 3;
+    unsigned PointerDensity = 20;
+    unsigned MacroDensity = 10;
+    unsigned CommentDensity = 50;
+    unsigned InitialiserSize = 16;
+    uint32_t Seed = 2310;
+};
+
+// A generated source file.
+struct GeneratedFile {
+    std::string Name;
+    std::string Content;
+};
+
+// Generates C sources in the style of a CSSE2310 assignment: a header and
+// a source file per module, with typedef'd structs, #defines, initialised
+// tables and functions made of loops, conditionals and pointer juggling.
+// Some of the code breaks the style guide on purpose, so that the checks
+// have violations to report. The same options always give the same files.
+std::vector<GeneratedFile> GenerateCorpus(const CorpusOptions& Options);
+
+// Writes the given files into the given directory, which is created if
+// needed. Returns the paths of the .c files written, or an empty list if
+// any file couldn't be written.
+std::vector<std::string> WriteCorpus(
+        llvm::StringRef Directory, const std::vector<GeneratedFile>& Files);
+
+}  // namespace bench
+}  // namespace nett
+
+#endif
@@ -0,0 +1,372 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+// Runs nett end to end over generated corpora, each scaling one dimension
+// of the code (file count, function length, nesting depth, pointer, macro
+// and comment density, initialiser size), and compares the wall time and
+// peak memory of each run against a stored baseline.
+#include "CorpusGenerator.hpp"
+
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Program.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace nett;
+using namespace llvm;
+
+static cl::opt<std::string> NettPath("nett",
+        cl::desc("Path of the nett executable (defaults to the nett next to "
+                 "this benchmark)"));
+
+static cl::opt<unsigned> Repetitions("repetitions",
+        cl::desc("Number of times nett is run on each corpus"), cl::init(3));
+
+static cl::list<std::string> Scenarios("scenario",
+        cl::desc("Scenario to run (can be repeated, defaults to all)"),
+        cl::CommaSeparated);
+
+static cl::opt<unsigned> Scale("scale",
+        cl::desc("Multiplier applied to the scaled dimension of each "
+                 "scenario"), cl::init(4));
+
+static cl::opt<std::string> BaselinePath("baseline",
+        cl::desc("Baseline to compare the results against"));
+
+static cl::opt<std::string> SaveBaselinePath("save-baseline",
+        cl::desc("File to save the results to, as a new baseline"));
+
+static cl::opt<double> Tolerance("tolerance",
+        cl::desc("Allowed slowdown (or memory growth) over the baseline, as "
+                 "a fraction"), cl::init(0.10));
+
+static cl::opt<std::string> CorpusDirectory("corpus-dir",
+        cl::desc("Directory the corpora are generated in and kept (defaults "
+                 "to a temporary directory which is removed)"));
+
+static cl::list<std::string> NettArgs("nett-arg",
+        cl::desc("Extra argument passed to nett (can be repeated)"));
+
+static cl::opt<unsigned> Files("files",
+        cl::desc("Number of modules in the base corpus"), cl::init(20));
+
+static cl::opt<unsigned> FunctionLength("function-length",
+        cl::desc("Statements per function in the base corpus"), cl::init(30));
+
+static cl::opt<unsigned> NestingDepth("nesting-depth",
+        cl::desc("Deepest block nesting in the base corpus"), cl::init(3));
+
+static cl::opt<unsigned> PointerDensity("pointer-density",
+        cl::desc("Percentage of pointer statements in the base corpus"),
+        cl::init(20));
+
+static cl::opt<unsigned> MacroDensity("macro-density",
+        cl::desc("Percentage of macro uses in the base corpus"), cl::init(10));
+
+static cl::opt<unsigned> CommentDensity("comment-density",
+        cl::desc("Percentage of commented functions in the base corpus"),
+        cl::init(50));
+
+static cl::opt<unsigned> InitialiserSize("initialiser-size",
+        cl::desc("Entries in each initialised table of the base corpus"),
+        cl::init(16));
+
+static cl::opt<unsigned> Seed("seed",
+        cl::desc("Seed of the corpus generator"), cl::init(2310));
+
+// A corpus to run nett over: the base corpus with one dimension scaled.
+struct Scenario {
+    const char* Name;
+    std::function<void(bench::CorpusOptions&)> Apply;
+};
+
+// The measurements of a scenario.
+struct Result {
+    unsigned Files = 0;
+    double Wall = 0;
+    uint64_t PeakMemoryKB = 0;
+    uint64_t Violations = 0;
+};
+
+static std::vector<Scenario> GetScenarios(void) {
+
+    return {
+        {"default", [](bench::CorpusOptions&) {}},
+        {"many-files", [](bench::CorpusOptions& O) { O.Files *= Scale; }},
+        {"long-functions",
+                [](bench::CorpusOptions& O) { O.FunctionLength *= Scale; }},
+        {"deep-nesting",
+                [](bench::CorpusOptions& O) { O.NestingDepth *= Scale; }},
+        {"pointer-heavy",
+                [](bench::CorpusOptions& O) { O.PointerDensity = 80; }},
+        {"macro-heavy", [](bench::CorpusOptions& O) { O.MacroDensity = 60; }},
+        {"comment-heavy",
+                [](bench::CorpusOptions& O) { O.CommentDensity = 100; }},
+        {"large-initialisers",
+                [](bench::CorpusOptions& O) { O.InitialiserSize *= Scale * 64; }},
+    };
+}
+
+// Returns the nett executable to benchmark.
+static std::string FindNett(const char* Argv0) {
+
+    if (!NettPath.empty()) {
+        return NettPath;
+    }
+
+    static int StaticSymbol;
+    SmallString<128> Path(sys::path::parent_path(
+            sys::fs::getMainExecutable(Argv0, &StaticSymbol)));
+    sys::path::append(Path, "nett");
+    return Path.str().str();
+}
+
+// Counts the violations in nett's JSON Lines output.
+static uint64_t CountViolations(StringRef Output) {
+
+    uint64_t Count = 0;
+    SmallVector<StringRef, 64> Lines;
+    Output.split(Lines, '\n', -1, false);
+
+    for (auto Line : Lines) {
+        auto Entry = json::parse(Line);
+        if (!Entry) {
+            consumeError(Entry.takeError());
+            continue;
+        }
+        auto* Object = Entry->getAsObject();
+        auto* Violations = Object ? Object->getArray("violations") : nullptr;
+        if (Violations) {
+            Count += Violations->size();
+        }
+    }
+    return Count;
+}
+
+// Runs nett over the given files the requested number of times, keeping
+// the fastest run. Returns false if nett couldn't be run.
+static bool RunNett(StringRef Nett, const std::vector<std::string>& Sources,
+        Result& Measured) {
+
+    SmallString<128> OutputPath;
+    if (sys::fs::createTemporaryFile("nett-bench", "jsonl", OutputPath)) {
+        errs() << "Error: Unable to create a temporary file\n";
+        return false;
+    }
+
+    std::vector<StringRef> Args{Nett, "--format=jsonl"};
+    for (const auto& Arg : NettArgs) {
+        Args.push_back(Arg);
+    }
+    for (const auto& Source : Sources) {
+        Args.push_back(Source);
+    }
+    Optional<StringRef> Redirects[] = {None, StringRef(OutputPath),
+            StringRef("")};
+
+    for (unsigned i = 0; i < Repetitions; i++) {
+        std::string ErrMsg;
+        Optional<sys::ProcessStatistics> Stats;
+
+        auto Start = std::chrono::steady_clock::now();
+        int Status = sys::ExecuteAndWait(Nett, Args, None, Redirects, 0, 0,
+                &ErrMsg, nullptr, &Stats);
+        std::chrono::duration<double> Elapsed =
+                std::chrono::steady_clock::now() - Start;
+
+        if (Status < 0) {
+            errs() << "Error: Unable to run " << Nett << ": " << ErrMsg << "\n";
+            sys::fs::remove(OutputPath);
+            return false;
+        }
+        if (i == 0 || Elapsed.count() < Measured.Wall) {
+            Measured.Wall = Elapsed.count();
+        }
+        if (Stats && Stats->PeakMemory > Measured.PeakMemoryKB) {
+            Measured.PeakMemoryKB = Stats->PeakMemory;
+        }
+    }
+
+    auto Output = MemoryBuffer::getFile(OutputPath);
+    if (Output) {
+        Measured.Violations = CountViolations((*Output)->getBuffer());
+    }
+    sys::fs::remove(OutputPath);
+    Measured.Files = Sources.size();
+    return true;
+}
+
+static json::Object ToJSON(const Result& Measured) {
+
+    return json::Object{
+            {"files", Measured.Files},
+            {"wall_seconds", Measured.Wall},
+            {"per_file_ms", Measured.Wall * 1000 / Measured.Files},
+            {"peak_rss_kb", static_cast<int64_t>(Measured.PeakMemoryKB)},
+            {"violations", static_cast<int64_t>(Measured.Violations)},
+            {"violations_per_second", Measured.Violations / Measured.Wall}};
+}
+
+// Compares the result of a scenario against its baseline entry, printing
+// any regressions. Returns false if the scenario regressed.
+static bool CompareToBaseline(StringRef Name, const Result& Measured,
+        const json::Object& Baseline) {
+
+    bool Passed = true;
+    auto Wall = Baseline.getNumber("wall_seconds");
+    auto PeakMemory = Baseline.getInteger("peak_rss_kb");
+    auto Violations = Baseline.getInteger("violations");
+
+    if (Wall && Measured.Wall > *Wall * (1 + Tolerance)) {
+        outs() << format("  %s: wall time regressed, %.3f s -> %.3f s\n",
+                Name.str().c_str(), *Wall, Measured.Wall);
+        Passed = false;
+    }
+    if (PeakMemory && *PeakMemory > 0 &&
+            Measured.PeakMemoryKB > *PeakMemory * (1 + Tolerance)) {
+        outs() << format("  %s: peak memory regressed, %lld KiB -> %llu KiB\n",
+                Name.str().c_str(), static_cast<long long>(*PeakMemory),
+                static_cast<unsigned long long>(Measured.PeakMemoryKB));
+        Passed = false;
+    }
+    if (Violations && static_cast<uint64_t>(*Violations) != Measured.Violations) {
+        outs() << format("  %s: violation count changed, %lld -> %llu\n",
+                Name.str().c_str(), static_cast<long long>(*Violations),
+                static_cast<unsigned long long>(Measured.Violations));
+    }
+    return Passed;
+}
+
+int main(int Argc, const char** Argv) {
+
+    cl::ParseCommandLineOptions(Argc, Argv, "nett end-to-end benchmark\n");
+
+    bench::CorpusOptions Base;
+    Base.Files = Files;
+    Base.FunctionLength = FunctionLength;
+    Base.NestingDepth = NestingDepth;
+    Base.PointerDensity = PointerDensity;
+    Base.MacroDensity = MacroDensity;
+    Base.CommentDensity = CommentDensity;
+    Base.InitialiserSize = InitialiserSize;
+    Base.Seed = Seed;
+
+    auto Nett = FindNett(Argv[0]);
+    if (!sys::fs::can_execute(Nett)) {
+        errs() << "Error: Unable to find nett at " << Nett
+               << " (use --nett to give its path)\n";
+        return 1;
+    }
+
+    Optional<json::Object> Baseline;
+    if (!BaselinePath.empty()) {
+        auto Buffer = MemoryBuffer::getFile(BaselinePath);
+        if (!Buffer) {
+            errs() << "Error: Unable to read " << BaselinePath << "\n";
+            return 1;
+        }
+        auto Parsed = json::parse((*Buffer)->getBuffer());
+        if (!Parsed || !Parsed->getAsObject()) {
+            if (!Parsed) {
+                consumeError(Parsed.takeError());
+            }
+            errs() << "Error: " << BaselinePath << " is not a valid baseline\n";
+            return 1;
+        }
+        Baseline = std::move(*Parsed->getAsObject());
+    }
+
+    SmallString<128> Directory(CorpusDirectory);
+    bool KeepCorpus = !Directory.empty();
+    if (!KeepCorpus &&
+            sys::fs::createUniqueDirectory("nett-bench", Directory)) {
+        errs() << "Error: Unable to create a temporary directory\n";
+        return 1;
+    }
+
+    json::Object Results;
+    bool Passed = true;
+    bool Failed = false;
+
+    outs() << "scenario              files  wall (s)   ms/file   peak KiB "
+              "violations     viol/s\n";
+
+    for (const auto& Entry : GetScenarios()) {
+        if (!Scenarios.empty() &&
+                std::find(Scenarios.begin(), Scenarios.end(), Entry.Name) ==
+                        Scenarios.end()) {
+            continue;
+        }
+
+        auto Options = Base;
+        Entry.Apply(Options);
+
+        SmallString<128> ScenarioDirectory(Directory);
+        sys::path::append(ScenarioDirectory, Entry.Name);
+        auto Sources = bench::WriteCorpus(
+                ScenarioDirectory, bench::GenerateCorpus(Options));
+        if (Sources.empty()) {
+            errs() << "Error: Unable to write the corpus to "
+                   << ScenarioDirectory << "\n";
+            Failed = true;
+            break;
+        }
+
+        Result Measured;
+        if (!RunNett(Nett, Sources, Measured)) {
+            Failed = true;
+            break;
+        }
+
+        outs() << format("%-20s %6u %9.3f %9.2f %10llu %10llu %10.0f\n",
+                Entry.Name, Measured.Files, Measured.Wall,
+                Measured.Wall * 1000 / Measured.Files,
+                static_cast<unsigned long long>(Measured.PeakMemoryKB),
+                static_cast<unsigned long long>(Measured.Violations),
+                Measured.Violations / Measured.Wall);
+
+        if (Baseline) {
+            auto* Previous = Baseline->getObject(Entry.Name);
+            if (Previous) {
+                Passed &= CompareToBaseline(Entry.Name, Measured, *Previous);
+            }
+        }
+        Results[Entry.Name] = ToJSON(Measured);
+    }
+
+    if (!KeepCorpus) {
+        sys::fs::remove_directories(Directory);
+    }
+    if (Failed) {
+        return 1;
+    }
+
+    if (!SaveBaselinePath.empty()) {
+        std::error_code EC;
+        raw_fd_ostream OS(SaveBaselinePath, EC, sys::fs::OF_Text);
+        if (EC) {
+            errs() << "Error: Unable to write " << SaveBaselinePath << "\n";
+            return 1;
+        }
+        OS << formatv("{0:2}", json::Value(std::move(Results))) << "\n";
+    }
+
+    if (Baseline) {
+        outs() << (Passed ? "No regressions over the baseline\n"
+                          : "Regressions found over the baseline\n");
+    }
+    return Passed ? 0 : 1;
+}
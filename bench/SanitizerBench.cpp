@@ -0,0 +1,150 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+// Compares the single pass sanitizer against the original implementation
+// (tab expansion through a stringstream, in-place carriage return removal
+// and a getline split for line lengths) on generated source files.
+#include "../input/Sanitizer.hpp"
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <chrono>
+#include <random>
+#include <sstream>
+#include <string>
+
+using namespace nett;
+using namespace llvm;
+
+static cl::opt<unsigned> SizeMB("size",
+        cl::desc("Size of the generated source in megabytes"), cl::init(8));
+
+static cl::opt<unsigned> Repetitions("repetitions",
+        cl::desc("Number of times each sanitizer is run"), cl::init(5));
+
+#define TAB_SIZE 8
+#define MAX_LINE_LENGTH 79
+
+// Generates C-like source of roughly the given size, with tab and space
+// indentation, long lines and CRLF line endings mixed in.
+static std::string GenerateSource(size_t Size) {
+
+    std::mt19937 Random(42);
+    std::string Source;
+    Source.reserve(Size + 128);
+
+    while (Source.size() < Size) {
+        unsigned Depth = Random() % 4;
+        for (unsigned i = 0; i < Depth; i++) {
+            Source += (Random() % 2) ? "\t" : "    ";
+        }
+        Source += "int variable = function(argument, other) + 42;";
+        if (Random() % 8 == 0) {
+            Source += " /* a comment which makes this line too long */";
+        }
+        if (Random() % 16 == 0) {
+            Source += "\t// trailing tab";
+        }
+        Source += (Random() % 4 == 0) ? "\r\n" : "\n";
+    }
+    return Source;
+}
+
+// The sanitizer as it was before the single pass version.
+static std::string LegacySanitize(std::string Content, unsigned& LongLines) {
+
+    std::stringstream Result;
+    int CurrentColumn = 0;
+
+    for (auto C : Content) {
+        if (C == '\n') {
+            Result << C;
+            CurrentColumn = 0;
+            continue;
+        }
+        if (C == '\t') {
+            int SpacesRequired = TAB_SIZE - (CurrentColumn % TAB_SIZE);
+            for (int i = 0; i < SpacesRequired; i++) {
+                Result << ' ';
+                CurrentColumn++;
+            }
+            continue;
+        }
+        Result << C;
+        CurrentColumn++;
+    }
+    Content = Result.str();
+
+    auto Pos = Content.find("\r");
+    while (Pos != std::string::npos) {
+        Content.replace(Pos, 1, "");
+        Pos = Content.find("\r", Pos);
+    }
+
+    std::istringstream ContentStream(Content);
+    std::string Line;
+    while (std::getline(ContentStream, Line)) {
+        if (Line.length() > MAX_LINE_LENGTH) {
+            LongLines++;
+        }
+    }
+    return Content;
+}
+
+// Runs the given function the requested number of times, returning the
+// fastest run in seconds.
+template <typename Function>
+static double TimeBest(Function&& Run) {
+
+    double Best = 0;
+    for (unsigned i = 0; i < Repetitions; i++) {
+        auto Start = std::chrono::steady_clock::now();
+        Run();
+        std::chrono::duration<double> Elapsed =
+                std::chrono::steady_clock::now() - Start;
+        if (i == 0 || Elapsed.count() < Best) {
+            Best = Elapsed.count();
+        }
+    }
+    return Best;
+}
+
+int main(int Argc, const char** Argv) {
+
+    cl::ParseCommandLineOptions(Argc, Argv, "nett sanitizer benchmark\n");
+
+    auto Source = GenerateSource(static_cast<size_t>(SizeMB) << 20);
+    double Megabytes = Source.size() / (1024.0 * 1024.0);
+
+    std::string LegacyOutput;
+    unsigned LegacyLongLines = 0;
+    auto LegacyTime = TimeBest([&]() {
+        LegacyLongLines = 0;
+        LegacyOutput = LegacySanitize(Source, LegacyLongLines);
+    });
+
+    std::string Output;
+    unsigned LongLines = 0;
+    auto Time = TimeBest([&]() {
+        input::LineIndex Lines;
+        LongLines = 0;
+        Output = input::SanitizeContent(Source, TAB_SIZE, MAX_LINE_LENGTH,
+                Lines, [&LongLines](unsigned, unsigned) { LongLines++; });
+    });
+
+    if (Output != LegacyOutput || LongLines != LegacyLongLines) {
+        errs() << "Error: The sanitizers disagree on the generated source\n";
+        return 1;
+    }
+
+    outs() << format("Input:       %.1f MB\n", Megabytes);
+    outs() << format("Legacy:      %.3f s (%.1f MB/s)\n", LegacyTime,
+            Megabytes / LegacyTime);
+    outs() << format("Single pass: %.3f s (%.1f MB/s)\n", Time,
+            Megabytes / Time);
+    outs() << format("Speedup:     %.1fx\n", LegacyTime / Time);
+
+    return 0;
+}
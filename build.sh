@@ -59,9 +59,9 @@ if [ $? -ne 0 ]; then
     exit 1
 fi
 
-# Build the checker
+# Build the checker, and the test driver of its library
 echo "[+] Building executable"
-ninja nett
+ninja nett nett-api-test
 
 if [ $? -ne 0 ]; then
     echo "[-] Something went wrong when building the executable. Exiting build"
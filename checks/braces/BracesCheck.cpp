@@ -4,14 +4,12 @@
 #include "BracesCheck.hpp"
 
 #include "../../violations/ViolationManager.hpp"
+#include "../utils/TokenCache.hpp"
 
 #include "clang/AST/ParentMap.h"
 #include "clang/AST/RecursiveASTVisitor.h"
-#include "clang/Lex/Lexer.h"
 #include "clang/Lex/Preprocessor.h"
 
-#include <sstream>
-
 using namespace clang::ast_matchers;
 
 namespace nett {
@@ -23,19 +21,19 @@ void CheckBraceIsAtEndOfLine(
 
     auto& SM = Context->getSourceManager();
     auto LangOpts = Context->getLangOpts();
-    auto NextToken = clang::Lexer::findNextToken(BraceLoc, SM, LangOpts);
+    auto NextToken = utils::GlobalTokenCache.GetCursor(BraceLoc, SM, LangOpts);
+    NextToken.NextCode();
 
-    if (SM.getExpansionLineNumber(NextToken->getLocation()) ==
-            SM.getExpansionLineNumber(BraceLoc)) {
+    if (NextToken.GetLine() == SM.getExpansionLineNumber(BraceLoc)) {
 
         auto File = SM.getFilename(BraceLoc);
         auto LineNo = SM.getExpansionLineNumber(BraceLoc);
 
-        std::stringstream ErrMsg;
-        ErrMsg << "Opening brace is not the last character on a line.";
+        const char* ErrMsg = "Opening brace is not the last character on a "
+                             "line.";
 
         GlobalViolationManager.AddViolation(
-                new BracesViolation(File.str(), LineNo, ErrMsg.str()));
+                BracesViolation(File.str(), LineNo, ErrMsg));
     }
 }
 
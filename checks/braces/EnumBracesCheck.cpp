@@ -12,8 +12,6 @@
 #include "clang/Lex/Lexer.h"
 #include "clang/Lex/Preprocessor.h"
 
-#include <sstream>
-
 using namespace clang::ast_matchers;
 
 namespace nett {
@@ -45,11 +43,10 @@ void EnumBracesChecker::run(const MatchFinder::MatchResult& Result) {
 
             auto LineNo = SM.getExpansionLineNumber(OpenBraceLoc);
 
-            std::stringstream ErrMsg;
-            ErrMsg << "Opening braces should look like: enum X {";
+            const char* ErrMsg = "Opening braces should look like: enum X {";
 
             GlobalViolationManager.AddViolation(
-                    new BracesViolation(File.str(), LineNo, ErrMsg.str()));
+                    BracesViolation(File.str(), LineNo, ErrMsg));
         }
 
         // Check that the brace is the last thing on the line
@@ -8,13 +8,9 @@
 #include "../whitespace/WhitespaceCheck.hpp"
 #include "BracesCheck.hpp"
 
-#include "clang/AST/ParentMap.h"
-#include "clang/AST/RecursiveASTVisitor.h"
 #include "clang/Lex/Lexer.h"
 #include "clang/Lex/Preprocessor.h"
 
-#include <sstream>
-
 using namespace clang::ast_matchers;
 
 namespace nett {
@@ -25,225 +21,232 @@ static bool HasBraces(clang::Stmt* Stmt);
 static void CheckForMissingBraces(
         clang::Stmt* Stmt, clang::ASTContext* Context);
 
-class FunctionASTVisitor
-    : public clang::RecursiveASTVisitor<FunctionASTVisitor> {
-    using Base = clang::RecursiveASTVisitor<FunctionASTVisitor>;
+bool FunctionBodyBracesModule::BeginFunction(const clang::FunctionDecl* Node,
+        traversal::TraversalContext& Traversal) {
+    return Traversal.Context->getSourceManager().isWrittenInMainFile(
+            Node->getLocation());
+}
 
-    public:
-    explicit FunctionASTVisitor(clang::ASTContext* Context) : Context(Context) {
-    }
+void FunctionBodyBracesModule::VisitIfStmt(
+        clang::IfStmt* Stmt, traversal::TraversalContext& Traversal) {
 
-    bool VisitIfStmt(clang::IfStmt* Stmt) {
+    auto* Context = Traversal.Context;
 
-        auto& SM = Context->getSourceManager();
-        auto LangOpts = Context->getLangOpts();
-        auto File = SM.getFilename(Stmt->getBeginLoc());
+    auto& SM = Context->getSourceManager();
+    auto LangOpts = Context->getLangOpts();
+    auto File = SM.getFilename(Stmt->getBeginLoc());
 
-        CheckForMissingBraces(Stmt->getThen(), Context);
-        if (HasBraces(Stmt->getThen())) {
-            auto* Body = llvm::dyn_cast<clang::CompoundStmt>(Stmt->getThen());
-            auto OpenBraceLoc = Body->getLBracLoc();
-            auto ConditionEndLoc = whitespace::GetPreviousNonWhitespaceLoc(
-                    OpenBraceLoc.getLocWithOffset(-1), SM);
-
-            if (SM.getExpansionLineNumber(ConditionEndLoc) !=
-                    SM.getExpansionLineNumber(OpenBraceLoc)) {
-                std::stringstream ErrMsg;
-                ErrMsg << "Opening braces should look like: if (cond) {";
-
-                auto LineNo = SM.getExpansionLineNumber(OpenBraceLoc);
-                GlobalViolationManager.AddViolation(
-                        new BracesViolation(File.str(), LineNo, ErrMsg.str()));
-            }
+    CheckForMissingBraces(Stmt->getThen(), Context);
+    if (HasBraces(Stmt->getThen())) {
+        auto* Body = llvm::dyn_cast<clang::CompoundStmt>(Stmt->getThen());
+        auto OpenBraceLoc = Body->getLBracLoc();
+        auto ConditionEndLoc = whitespace::GetPreviousNonWhitespaceLoc(
+                OpenBraceLoc.getLocWithOffset(-1), SM);
+
+        if (SM.getExpansionLineNumber(ConditionEndLoc) !=
+                SM.getExpansionLineNumber(OpenBraceLoc)) {
+            const char* ErrMsg = "Opening braces should look like: if (cond) {";
+
+            auto LineNo = SM.getExpansionLineNumber(OpenBraceLoc);
+            GlobalViolationManager.AddViolation(
+                    BracesViolation(File.str(), LineNo, ErrMsg));
         }
+    }
 
-        if (Stmt->hasElseStorage()) {
-            auto ElseLoc = Stmt->getElseLoc();
-            if (HasBraces(Stmt->getThen())) {
-                // We need to check the right curly brace before the else
-                auto* ThenBody =
-                        llvm::dyn_cast<clang::CompoundStmt>(Stmt->getThen());
-                auto RBraceLoc = ThenBody->getRBracLoc();
-
-                if (SM.getExpansionLineNumber(RBraceLoc) !=
-                        SM.getExpansionLineNumber(ElseLoc)) {
-                    std::stringstream ErrMsg;
-                    ErrMsg << "Closing braces should look like: } else";
-
-                    auto LineNo = SM.getExpansionLineNumber(RBraceLoc);
-                    GlobalViolationManager.AddViolation(new BracesViolation(
-                            File.str(), LineNo, ErrMsg.str()));
-                }
+    if (Stmt->hasElseStorage()) {
+        auto ElseLoc = Stmt->getElseLoc();
+        if (HasBraces(Stmt->getThen())) {
+            // We need to check the right curly brace before the else
+            auto* ThenBody =
+                    llvm::dyn_cast<clang::CompoundStmt>(Stmt->getThen());
+            auto RBraceLoc = ThenBody->getRBracLoc();
+
+            if (SM.getExpansionLineNumber(RBraceLoc) !=
+                    SM.getExpansionLineNumber(ElseLoc)) {
+                const char* ErrMsg = "Closing braces should look like: } else";
+
+                auto LineNo = SM.getExpansionLineNumber(RBraceLoc);
+                GlobalViolationManager.AddViolation(BracesViolation(
+                        File.str(), LineNo, ErrMsg));
             }
-            if (!llvm::isa<clang::IfStmt>(Stmt->getElse())) {
-                // We only want the 'else' clause, not 'else if'
-                CheckForMissingBraces(Stmt->getElse(), Context);
-
-                if (HasBraces(Stmt->getElse())) {
-                    // We need to check the left curly brace after the else
-                    auto* ElseBody = llvm::dyn_cast<clang::CompoundStmt>(
-                            Stmt->getElse());
-                    auto LBraceLoc = ElseBody->getLBracLoc();
-
-                    if (SM.getExpansionLineNumber(ElseLoc) !=
-                            SM.getExpansionLineNumber(LBraceLoc)) {
-                        std::stringstream ErrMsg;
-                        ErrMsg << "Opening braces should look like: else {";
-
-                        auto LineNo = SM.getExpansionLineNumber(LBraceLoc);
-                        GlobalViolationManager.AddViolation(new BracesViolation(
-                                File.str(), LineNo, ErrMsg.str()));
-                    }
+        }
+        if (!llvm::isa<clang::IfStmt>(Stmt->getElse())) {
+            // We only want the 'else' clause, not 'else if'
+            CheckForMissingBraces(Stmt->getElse(), Context);
+
+            if (HasBraces(Stmt->getElse())) {
+                // We need to check the left curly brace after the else
+                auto* ElseBody = llvm::dyn_cast<clang::CompoundStmt>(
+                        Stmt->getElse());
+                auto LBraceLoc = ElseBody->getLBracLoc();
+
+                if (SM.getExpansionLineNumber(ElseLoc) !=
+                        SM.getExpansionLineNumber(LBraceLoc)) {
+                    const char* ErrMsg = "Opening braces should look like: "
+                                         "else {";
+
+                    auto LineNo = SM.getExpansionLineNumber(LBraceLoc);
+                    GlobalViolationManager.AddViolation(BracesViolation(
+                            File.str(), LineNo, ErrMsg));
                 }
             }
         }
-
-        return true;
     }
+}
 
-    bool VisitForStmt(clang::ForStmt* Stmt) {
-        CheckForMissingBraces(Stmt->getBody(), Context);
-        if (HasBraces(Stmt->getBody())) {
-            auto& SM = Context->getSourceManager();
-            auto LangOpts = Context->getLangOpts();
-            auto File = SM.getFilename(Stmt->getBeginLoc());
-            auto* Body = llvm::dyn_cast<clang::CompoundStmt>(Stmt->getBody());
-            auto OpenBraceLoc = Body->getLBracLoc();
+void FunctionBodyBracesModule::VisitForStmt(
+        clang::ForStmt* Stmt, traversal::TraversalContext& Traversal) {
 
-            auto ConditionEndLoc = whitespace::GetPreviousNonWhitespaceLoc(
-                    OpenBraceLoc.getLocWithOffset(-1), SM);
+    auto* Context = Traversal.Context;
 
-            if (SM.getExpansionLineNumber(ConditionEndLoc) !=
-                    SM.getExpansionLineNumber(OpenBraceLoc)) {
-                std::stringstream ErrMsg;
-                ErrMsg << "Opening braces should look like: for (...;...;...) "
-                          "{";
+    CheckForMissingBraces(Stmt->getBody(), Context);
+    if (HasBraces(Stmt->getBody())) {
+        auto& SM = Context->getSourceManager();
+        auto LangOpts = Context->getLangOpts();
+        auto File = SM.getFilename(Stmt->getBeginLoc());
+        auto* Body = llvm::dyn_cast<clang::CompoundStmt>(Stmt->getBody());
+        auto OpenBraceLoc = Body->getLBracLoc();
 
-                auto LineNo = SM.getExpansionLineNumber(OpenBraceLoc);
-                GlobalViolationManager.AddViolation(
-                        new BracesViolation(File.str(), LineNo, ErrMsg.str()));
-            }
+        auto ConditionEndLoc = whitespace::GetPreviousNonWhitespaceLoc(
+                OpenBraceLoc.getLocWithOffset(-1), SM);
+
+        if (SM.getExpansionLineNumber(ConditionEndLoc) !=
+                SM.getExpansionLineNumber(OpenBraceLoc)) {
+            const char* ErrMsg = "Opening braces should look like: for "
+                                 "(...;...;...) {";
+
+            auto LineNo = SM.getExpansionLineNumber(OpenBraceLoc);
+            GlobalViolationManager.AddViolation(
+                    BracesViolation(File.str(), LineNo, ErrMsg));
         }
-        return true;
     }
+}
 
-    bool VisitDoStmt(clang::DoStmt* Stmt) {
-        CheckForMissingBraces(Stmt->getBody(), Context);
-        if (HasBraces(Stmt->getBody())) {
-            auto& SM = Context->getSourceManager();
-            auto LangOpts = Context->getLangOpts();
-            auto File = SM.getFilename(Stmt->getBeginLoc());
-            auto* Body = llvm::dyn_cast<clang::CompoundStmt>(Stmt->getBody());
-
-            // Check the position of the open curly brace after the do
-            auto DoLoc = Stmt->getDoLoc();
-            auto OpenBraceLoc = Body->getLBracLoc();
-            if (SM.getExpansionLineNumber(DoLoc) !=
-                    SM.getExpansionLineNumber(OpenBraceLoc)) {
-                std::stringstream ErrMsg;
-                ErrMsg << "Opening braces should look like: do {";
-
-                auto LineNo = SM.getExpansionLineNumber(OpenBraceLoc);
-                GlobalViolationManager.AddViolation(
-                        new BracesViolation(File.str(), LineNo, ErrMsg.str()));
-            }
+void FunctionBodyBracesModule::VisitDoStmt(
+        clang::DoStmt* Stmt, traversal::TraversalContext& Traversal) {
 
-            // Check the position of the closing curly brace before the while
-            auto WhileLoc = Stmt->getWhileLoc();
-            auto CloseBraceLoc = Body->getRBracLoc();
-            if (SM.getExpansionLineNumber(CloseBraceLoc) !=
-                    SM.getExpansionLineNumber(WhileLoc)) {
-                std::stringstream ErrMsg;
-                ErrMsg << "Closing braces should look like: } while (cond)";
-
-                auto LineNo = SM.getExpansionLineNumber(CloseBraceLoc);
-                GlobalViolationManager.AddViolation(
-                        new BracesViolation(File.str(), LineNo, ErrMsg.str()));
-            }
+    auto* Context = Traversal.Context;
+
+    CheckForMissingBraces(Stmt->getBody(), Context);
+    if (HasBraces(Stmt->getBody())) {
+        auto& SM = Context->getSourceManager();
+        auto LangOpts = Context->getLangOpts();
+        auto File = SM.getFilename(Stmt->getBeginLoc());
+        auto* Body = llvm::dyn_cast<clang::CompoundStmt>(Stmt->getBody());
+
+        // Check the position of the open curly brace after the do
+        auto DoLoc = Stmt->getDoLoc();
+        auto OpenBraceLoc = Body->getLBracLoc();
+        if (SM.getExpansionLineNumber(DoLoc) !=
+                SM.getExpansionLineNumber(OpenBraceLoc)) {
+            const char* ErrMsg = "Opening braces should look like: do {";
+
+            auto LineNo = SM.getExpansionLineNumber(OpenBraceLoc);
+            GlobalViolationManager.AddViolation(
+                    BracesViolation(File.str(), LineNo, ErrMsg));
         }
-        return true;
-    }
 
-    bool VisitWhileStmt(clang::WhileStmt* Stmt) {
-        CheckForMissingBraces(Stmt->getBody(), Context);
-        if (HasBraces(Stmt->getBody())) {
-            auto& SM = Context->getSourceManager();
-            auto LangOpts = Context->getLangOpts();
-            auto File = SM.getFilename(Stmt->getBeginLoc());
-            auto* Body = llvm::dyn_cast<clang::CompoundStmt>(Stmt->getBody());
-            auto OpenBraceLoc = Body->getLBracLoc();
-            auto ConditionEndLoc = whitespace::GetPreviousNonWhitespaceLoc(
-                    OpenBraceLoc.getLocWithOffset(-1), SM);
-
-            if (SM.getExpansionLineNumber(ConditionEndLoc) !=
-                    SM.getExpansionLineNumber(OpenBraceLoc)) {
-                std::stringstream ErrMsg;
-                ErrMsg << "Opening braces should look like: while (cond) {";
-
-                auto LineNo = SM.getExpansionLineNumber(OpenBraceLoc);
-                GlobalViolationManager.AddViolation(
-                        new BracesViolation(File.str(), LineNo, ErrMsg.str()));
-            }
+        // Check the position of the closing curly brace before the while
+        auto WhileLoc = Stmt->getWhileLoc();
+        auto CloseBraceLoc = Body->getRBracLoc();
+        if (SM.getExpansionLineNumber(CloseBraceLoc) !=
+                SM.getExpansionLineNumber(WhileLoc)) {
+            const char* ErrMsg = "Closing braces should look like: } while "
+                                 "(cond)";
+
+            auto LineNo = SM.getExpansionLineNumber(CloseBraceLoc);
+            GlobalViolationManager.AddViolation(
+                    BracesViolation(File.str(), LineNo, ErrMsg));
         }
-        return true;
     }
+}
 
-    bool VisitSwitchStmt(clang::SwitchStmt* Stmt) {
-        CheckForMissingBraces(Stmt->getBody(), Context);
-        if (HasBraces(Stmt->getBody())) {
-            auto& SM = Context->getSourceManager();
-            auto LangOpts = Context->getLangOpts();
-            auto File = SM.getFilename(Stmt->getBeginLoc());
-            auto* Body = llvm::dyn_cast<clang::CompoundStmt>(Stmt->getBody());
-            auto OpenBraceLoc = Body->getLBracLoc();
-            auto ConditionEndLoc = whitespace::GetPreviousNonWhitespaceLoc(
-                    OpenBraceLoc.getLocWithOffset(-1), SM);
-
-            if (SM.getExpansionLineNumber(ConditionEndLoc) !=
-                    SM.getExpansionLineNumber(OpenBraceLoc)) {
-                std::stringstream ErrMsg;
-                ErrMsg << "Opening braces should look like: switch (cond) {";
-
-                auto LineNo = SM.getExpansionLineNumber(OpenBraceLoc);
-                GlobalViolationManager.AddViolation(
-                        new BracesViolation(File.str(), LineNo, ErrMsg.str()));
-            }
+void FunctionBodyBracesModule::VisitWhileStmt(
+        clang::WhileStmt* Stmt, traversal::TraversalContext& Traversal) {
+
+    auto* Context = Traversal.Context;
+
+    CheckForMissingBraces(Stmt->getBody(), Context);
+    if (HasBraces(Stmt->getBody())) {
+        auto& SM = Context->getSourceManager();
+        auto LangOpts = Context->getLangOpts();
+        auto File = SM.getFilename(Stmt->getBeginLoc());
+        auto* Body = llvm::dyn_cast<clang::CompoundStmt>(Stmt->getBody());
+        auto OpenBraceLoc = Body->getLBracLoc();
+        auto ConditionEndLoc = whitespace::GetPreviousNonWhitespaceLoc(
+                OpenBraceLoc.getLocWithOffset(-1), SM);
+
+        if (SM.getExpansionLineNumber(ConditionEndLoc) !=
+                SM.getExpansionLineNumber(OpenBraceLoc)) {
+            const char* ErrMsg = "Opening braces should look like: while "
+                                 "(cond) {";
+
+            auto LineNo = SM.getExpansionLineNumber(OpenBraceLoc);
+            GlobalViolationManager.AddViolation(
+                    BracesViolation(File.str(), LineNo, ErrMsg));
         }
-        return true;
     }
+}
 
-    bool VisitCaseStmt(clang::CaseStmt* Stmt) {
+void FunctionBodyBracesModule::VisitSwitchStmt(
+        clang::SwitchStmt* Stmt, traversal::TraversalContext& Traversal) {
 
-        if (HasBraces(Stmt->getSubStmt())) {
-            auto* Body =
-                    llvm::dyn_cast<clang::CompoundStmt>(Stmt->getSubStmt());
-            auto OpenBraceLoc = Body->getLBracLoc();
-            auto CaseEndLoc = Stmt->getCaseLoc();
-            auto& SM = Context->getSourceManager();
+    auto* Context = Traversal.Context;
 
-            if (SM.getExpansionLineNumber(CaseEndLoc) !=
-                    SM.getExpansionLineNumber(OpenBraceLoc)) {
+    CheckForMissingBraces(Stmt->getBody(), Context);
+    if (HasBraces(Stmt->getBody())) {
+        auto& SM = Context->getSourceManager();
+        auto LangOpts = Context->getLangOpts();
+        auto File = SM.getFilename(Stmt->getBeginLoc());
+        auto* Body = llvm::dyn_cast<clang::CompoundStmt>(Stmt->getBody());
+        auto OpenBraceLoc = Body->getLBracLoc();
+        auto ConditionEndLoc = whitespace::GetPreviousNonWhitespaceLoc(
+                OpenBraceLoc.getLocWithOffset(-1), SM);
 
-                std::stringstream ErrMsg;
-                ErrMsg << "Opening braces should look like: case X: {";
+        if (SM.getExpansionLineNumber(ConditionEndLoc) !=
+                SM.getExpansionLineNumber(OpenBraceLoc)) {
+            const char* ErrMsg = "Opening braces should look like: switch "
+                                 "(cond) {";
 
-                auto File = SM.getFilename(Stmt->getBeginLoc());
-                auto LineNo = SM.getExpansionLineNumber(OpenBraceLoc);
-                GlobalViolationManager.AddViolation(
-                        new BracesViolation(File.str(), LineNo, ErrMsg.str()));
-            }
+            auto LineNo = SM.getExpansionLineNumber(OpenBraceLoc);
+            GlobalViolationManager.AddViolation(
+                    BracesViolation(File.str(), LineNo, ErrMsg));
         }
-
-        return true;
     }
+}
+
+void FunctionBodyBracesModule::VisitCaseStmt(
+        clang::CaseStmt* Stmt, traversal::TraversalContext& Traversal) {
+
+    auto* Context = Traversal.Context;
+
+    if (HasBraces(Stmt->getSubStmt())) {
+        auto* Body =
+                llvm::dyn_cast<clang::CompoundStmt>(Stmt->getSubStmt());
+        auto OpenBraceLoc = Body->getLBracLoc();
+        auto CaseEndLoc = Stmt->getCaseLoc();
+        auto& SM = Context->getSourceManager();
+
+        if (SM.getExpansionLineNumber(CaseEndLoc) !=
+                SM.getExpansionLineNumber(OpenBraceLoc)) {
 
-    bool VisitCompoundStmt(clang::CompoundStmt* Stmt) {
-        CheckBraceIsAtEndOfLine(Stmt->getLBracLoc(), Context);
-        return true;
+            const char* ErrMsg = "Opening braces should look like: case X: {";
+
+            auto File = SM.getFilename(Stmt->getBeginLoc());
+            auto LineNo = SM.getExpansionLineNumber(OpenBraceLoc);
+            GlobalViolationManager.AddViolation(
+                    BracesViolation(File.str(), LineNo, ErrMsg));
+        }
     }
+}
 
-    clang::ASTContext* Context;
-};
+void FunctionBodyBracesModule::VisitCompoundStmt(
+        clang::CompoundStmt* Stmt, traversal::TraversalContext& Traversal) {
+
+    auto* Context = Traversal.Context;
+
+    CheckBraceIsAtEndOfLine(Stmt->getLBracLoc(), Context);
+}
 
 void FunctionBodyBracesChecker::run(const MatchFinder::MatchResult& Result) {
 
@@ -270,27 +273,23 @@ void FunctionBodyBracesChecker::run(const MatchFinder::MatchResult& Result) {
         auto BodyLBraceLine = SM.getExpansionLineNumber(BodyLBraceLoc);
 
         if (BodyLBraceLine - ParamEndLine > 1) {
-            std::stringstream ErrMsg;
-            ErrMsg << "The opening brace of a function should be at most one "
-                      "line away from its parameters.";
+            const char* ErrMsg = "The opening brace of a function should be at "
+                                 "most one line away from its parameters.";
 
             auto LineNo = SM.getExpansionLineNumber(BodyLBraceLoc);
             GlobalViolationManager.AddViolation(
-                    new BracesViolation(File.str(), LineNo, ErrMsg.str()));
+                    BracesViolation(File.str(), LineNo, ErrMsg));
         }
         if (BodyLBraceLine != ParamEndLine &&
                 SM.getSpellingColumnNumber(BodyLBraceLoc) != 1) {
-            std::stringstream ErrMsg;
-            ErrMsg << "The opening brace of a function should be left-aligned "
-                      "if not on the same line as its parameters.";
+            const char* ErrMsg = "The opening brace of a function should be "
+                                 "left-aligned if not on the same line as its "
+                                 "parameters.";
 
             auto LineNo = SM.getExpansionLineNumber(BodyLBraceLoc);
             GlobalViolationManager.AddViolation(
-                    new BracesViolation(File.str(), LineNo, ErrMsg.str()));
+                    BracesViolation(File.str(), LineNo, ErrMsg));
         }
-
-        FunctionASTVisitor Visitor(Result.Context);
-        Visitor.TraverseDecl(const_cast<clang::FunctionDecl*>(Node));
     }
 }
 
@@ -310,11 +309,11 @@ static void CheckForMissingBraces(
         auto File = SM.getFilename(Stmt->getBeginLoc());
         auto LineNo = SM.getExpansionLineNumber(Stmt->getBeginLoc());
 
-        std::stringstream ErrMsg;
-        ErrMsg << "Braces are required, even for single line blocks.";
+        const char* ErrMsg = "Braces are required, even for single line "
+                             "blocks.";
 
         GlobalViolationManager.AddViolation(
-                new BracesViolation(File.str(), LineNo, ErrMsg.str()));
+                BracesViolation(File.str(), LineNo, ErrMsg));
     }
 }
 
@@ -4,6 +4,8 @@
 #ifndef LLVM_CLANG_TOOLS_EXTRA_NETT_CHECKS_BRACES_FUNCTIONBODYBRACESCHECK_HPP
 #define LLVM_CLANG_TOOLS_EXTRA_NETT_CHECKS_BRACES_FUNCTIONBODYBRACESCHECK_HPP
 
+#include "../traversal/FunctionTraversal.hpp"
+
 #include "clang/ASTMatchers/ASTMatchFinder.h"
 
 namespace nett {
@@ -17,6 +19,28 @@ class FunctionBodyBracesChecker
             const clang::ast_matchers::MatchFinder::MatchResult& Result) override;
 };
 
+// Checks the braces of the statements within a function's body as part of
+// a FunctionTraversal.
+class FunctionBodyBracesModule : public traversal::FunctionTraversalModule {
+    public:
+    bool BeginFunction(const clang::FunctionDecl* Node,
+            traversal::TraversalContext& Traversal);
+    void VisitIfStmt(
+            clang::IfStmt* Stmt, traversal::TraversalContext& Traversal);
+    void VisitForStmt(
+            clang::ForStmt* Stmt, traversal::TraversalContext& Traversal);
+    void VisitDoStmt(
+            clang::DoStmt* Stmt, traversal::TraversalContext& Traversal);
+    void VisitWhileStmt(
+            clang::WhileStmt* Stmt, traversal::TraversalContext& Traversal);
+    void VisitSwitchStmt(
+            clang::SwitchStmt* Stmt, traversal::TraversalContext& Traversal);
+    void VisitCaseStmt(
+            clang::CaseStmt* Stmt, traversal::TraversalContext& Traversal);
+    void VisitCompoundStmt(
+            clang::CompoundStmt* Stmt, traversal::TraversalContext& Traversal);
+};
+
 }  // namespace braces
 }  // namespace checks
 }  // namespace nett
@@ -12,8 +12,6 @@
 #include "clang/Lex/Lexer.h"
 #include "clang/Lex/Preprocessor.h"
 
-#include <sstream>
-
 using namespace clang::ast_matchers;
 
 namespace nett {
@@ -45,15 +43,13 @@ void StructUnionBracesChecker::run(const MatchFinder::MatchResult& Result) {
 
             auto LineNo = SM.getExpansionLineNumber(OpenBraceLoc);
 
-            std::stringstream ErrMsg;
+            const char* ErrMsg = "Opening braces should look like: union X {";
             if (Node->isStruct()) {
-                ErrMsg << "Opening braces should look like: struct X {";
-            } else {
-                ErrMsg << "Opening braces should look like: union X {";
+                ErrMsg = "Opening braces should look like: struct X {";
             }
 
             GlobalViolationManager.AddViolation(
-                    new BracesViolation(File.str(), LineNo, ErrMsg.str()));
+                    BracesViolation(File.str(), LineNo, ErrMsg));
         }
 
         // Check that the brace is the last think on the line
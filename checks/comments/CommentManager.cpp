@@ -3,12 +3,12 @@
  */
 #include "CommentManager.hpp"
 
+#include "../../violations/StringPool.hpp"
 #include "../../violations/ViolationManager.hpp"
 
-#include <map>
-#include <sstream>
 #include <string>
 #include <unordered_set>
+#include <utility>
 
 namespace nett {
 
@@ -19,112 +19,170 @@ namespace nett {
 // to generate a violation if there is one. Due to the
 // calllback-based nature of the clang framework, we use
 // this global manager instead of passing it through the
-// callbacks.
-FunctionCommentManager GlobalFunctionCommentManager;
-
-// Represents a function declaration/definition in the code
-class DeclarationMarker {
-    public:
-    // Creates a new marker with the given name
-    DeclarationMarker(std::string DeclName) {
-        this->DeclName = DeclName;
-        HasComment = false;
-        DefinitionFound = false;
-    }
+// callbacks. Each thread that checks files gets its own manager.
+thread_local FunctionCommentManager GlobalFunctionCommentManager;
 
-    // Sets the location of the definition of the declaration
-    // This is to allow correct error reporting.
-    void SetDefinitionLocation(std::string FileName, uint LineNo) {
-        DefinitionFound = true;
-        DefinitionLineNo = LineNo;
-        this->FileName = FileName;
-    }
+void DeclarationMarker::SetDefinitionLocation(
+        llvm::StringRef FileName, uint LineNo) {
 
-    // Returns true if the declaration has a definition, else returns false.
-    bool HasDefinition(void) {
-        return DefinitionFound;
-    }
+    DefinitionFound = true;
+    DefinitionLineNo = LineNo;
+    FileID = GlobalStringPool->Intern(FileName);
+}
 
-    // Marks the given declaration has having a comment present.
-    void MarkAsCommented(void) {
-        HasComment = true;
-    }
+llvm::StringRef DeclarationMarker::GetFileName(void) const {
+    return GlobalStringPool->Get(FileID);
+}
 
-    // Returns true if the function has a comment somewhere in the
-    // source code. Else returns false.
-    bool IsCommented(void) {
-        return HasComment;
-    }
+CommentManager::CommentManager(CommentManager&& Other) {
+    *this = std::move(Other);
+}
 
-    // Returns the name of the declaration
-    std::string GetDeclName(void) {
-        return DeclName;
-    }
+CommentManager& CommentManager::operator=(CommentManager&& Other) {
+    // Swapping hands our current markers (and their allocator) to the
+    // other manager, which frees them once it is destroyed.
+    std::swap(DeclInformation, Other.DeclInformation);
+    return *this;
+}
 
-    // Returns the filepath of the function's source file.
-    // Note that SetDefinitionLocation() has to be called first.
-    std::string GetFileName(void) {
-        return FileName;
-    }
+void CommentManager::MarkDeclNameAsSeen(llvm::StringRef FuncName) {
 
-    // Returns the line number of the definition location.
-    // Note that SetDefinitionLocation() has to be called first.
-    uint GetLineNumber(void) {
-        return DefinitionLineNo;
-    }
+    CommentManager::DeclInformation[FuncName] = DeclarationMarker();
+}
 
-    private:
-    std::string DeclName;
-    uint DefinitionLineNo;
-    std::string FileName;
-    bool HasComment;
-    bool DefinitionFound;
-};
+bool CommentManager::DeclNameHasBeenSeen(llvm::StringRef FuncName) const {
 
-void CommentManager::MarkDeclNameAsSeen(std::string FuncName) {
+    return CommentManager::DeclInformation.count(FuncName) != 0;
+}
+
+void CommentManager::SetDefinitionLocation(
+        llvm::StringRef FuncName, llvm::StringRef FileName, uint LineNo) {
 
-    CommentManager::SeenDeclNames.insert(FuncName);
-    CommentManager::DeclInformation[FuncName] = new DeclarationMarker(FuncName);
+    // Looking the name up creates its marker if it hasn't been seen
+    CommentManager::DeclInformation[FuncName].SetDefinitionLocation(
+            FileName, LineNo);
 }
 
-bool CommentManager::DeclNameHasBeenSeen(std::string FuncName) {
+void CommentManager::MarkDeclNameAsCommented(llvm::StringRef DeclName) {
 
-    return CommentManager::SeenDeclNames.count(FuncName) != 0;
+    CommentManager::DeclInformation[DeclName].MarkAsCommented();
 }
 
-void CommentManager::SetDefinitionLocation(
-        std::string FuncName, std::string FileName, uint LineNo) {
+void CommentManager::MergeFrom(CommentManager& Other) {
+
+    for (const auto& Marker : Other.DeclInformation) {
+        auto DeclName = Marker.getKey();
 
-    if (!CommentManager::DeclNameHasBeenSeen(FuncName)) {
-        CommentManager::MarkDeclNameAsSeen(FuncName);
+        auto Inserted = CommentManager::DeclInformation.insert(
+                std::make_pair(DeclName, Marker.getValue()));
+        if (Inserted.second) {
+            continue;
+        }
+
+        const auto& OtherMarker = Marker.getValue();
+        auto& OurMarker = Inserted.first->getValue();
+        if (OtherMarker.HasDefinition()) {
+            OurMarker.SetDefinitionLocation(
+                    OtherMarker.GetFileName(), OtherMarker.GetLineNumber());
+        }
+        if (OtherMarker.IsCommented()) {
+            OurMarker.MarkAsCommented();
+        }
     }
-    CommentManager::DeclInformation[FuncName]->SetDefinitionLocation(
-            FileName, LineNo);
+
+    Other.Clear();
+}
+
+void CommentManager::Clear(void) {
+
+    // Clearing the map alone would keep hold of its allocator's memory
+    CommentManager::DeclInformation =
+            llvm::StringMap<DeclarationMarker, llvm::BumpPtrAllocator>();
+}
+
+llvm::json::Value CommentManager::ToJSON(void) const {
+
+    // Each declaration is stored as [name, commented, file, line], where
+    // the file is null if no definition was found.
+    llvm::json::Array Declarations;
+    for (const auto& Marker : CommentManager::DeclInformation) {
+        const auto& Decl = Marker.getValue();
+        llvm::json::Value File = nullptr;
+        if (Decl.HasDefinition()) {
+            File = Decl.GetFileName();
+        }
+        Declarations.push_back(llvm::json::Array{Marker.getKey(),
+                Decl.IsCommented(), std::move(File), Decl.GetLineNumber()});
+    }
+    return std::move(Declarations);
 }
 
-void CommentManager::MarkDeclNameAsCommented(std::string DeclName) {
+bool CommentManager::FromJSON(const llvm::json::Value& Value) {
+
+    const auto* Declarations = Value.getAsArray();
+    if (!Declarations) {
+        return false;
+    }
+
+    for (const auto& Item : *Declarations) {
+        const auto* Fields = Item.getAsArray();
+        if (!Fields || Fields->size() != 4) {
+            return false;
+        }
+        auto DeclName = (*Fields)[0].getAsString();
+        auto Commented = (*Fields)[1].getAsBoolean();
+        auto File = (*Fields)[2].getAsString();
+        auto LineNo = (*Fields)[3].getAsInteger();
+        if (!DeclName || !Commented || !LineNo) {
+            return false;
+        }
 
-    CommentManager::DeclInformation[DeclName]->MarkAsCommented();
+        CommentManager::MarkDeclNameAsSeen(*DeclName);
+        if (File) {
+            CommentManager::SetDefinitionLocation(*DeclName, *File, *LineNo);
+        }
+        if (*Commented) {
+            CommentManager::MarkDeclNameAsCommented(*DeclName);
+        }
+    }
+    return true;
 }
 
 void FunctionCommentManager::GenerateCommentViolations(void) {
 
-    for (auto Marker : DeclInformation) {
-        if (Marker.first.compare("main") == 0) {
+    for (const auto& Marker : DeclInformation) {
+        if (Marker.getKey() == "main") {
             // The main function does not need to be commented
             continue;
         }
 
-        if (!Marker.second->IsCommented() && Marker.second->HasDefinition()) {
-            std::stringstream ErrMsg;
-            ErrMsg << "Functions should be preceded by explanatory comments.";
+        const auto& Decl = Marker.getValue();
+        if (!Decl.IsCommented() && Decl.HasDefinition()) {
+            const char* ErrMsg = "Functions should be preceded by explanatory "
+                                 "comments.";
 
-            auto FileName = Marker.second->GetFileName();
-            auto LineNo = Marker.second->GetLineNumber();
+            auto FileName = Decl.GetFileName();
+            auto LineNo = Decl.GetLineNumber();
             GlobalViolationManager.AddViolation(
-                    new CommentsViolation(FileName, LineNo, ErrMsg.str()));
+                    CommentsViolation(FileName, LineNo, ErrMsg));
+        }
+    }
+}
+
+std::unordered_set<std::string>
+FunctionCommentManager::GetFilesAwaitingComments(void) {
+
+    std::unordered_set<std::string> Files;
+    for (const auto& Marker : DeclInformation) {
+        if (Marker.getKey() == "main") {
+            continue;
+        }
+        const auto& Decl = Marker.getValue();
+        if (!Decl.IsCommented() && Decl.HasDefinition()) {
+            Files.insert(Decl.GetFileName().str());
         }
     }
+    return Files;
 }
 
-}  // namespace nett
\ No newline at end of file
+}  // namespace nett
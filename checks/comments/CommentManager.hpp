@@ -7,30 +7,104 @@
 #ifndef __NETT_FUNCTION_COMMENT_MANAGER_HPP__
 #define __NETT_FUNCTION_COMMENT_MANAGER_HPP__
 
-#include <map>
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/JSON.h"
+
+#include <cstdint>
 #include <string>
 #include <unordered_set>
 
 namespace nett {
 
-class DeclarationMarker;
+// Represents a function declaration/definition in the code. The name of
+// the declaration is the key it is stored under.
+class DeclarationMarker {
+    public:
+    DeclarationMarker() = default;
+
+    // Sets the location of the definition of the declaration
+    // This is to allow correct error reporting.
+    void SetDefinitionLocation(llvm::StringRef FileName, uint LineNo);
+
+    // Returns true if the declaration has a definition, else returns false.
+    bool HasDefinition(void) const {
+        return DefinitionFound;
+    }
+
+    // Marks the given declaration has having a comment present.
+    void MarkAsCommented(void) {
+        HasComment = true;
+    }
+
+    // Returns true if the function has a comment somewhere in the
+    // source code. Else returns false.
+    bool IsCommented(void) const {
+        return HasComment;
+    }
+
+    // Returns the filepath of the function's source file.
+    // Note that SetDefinitionLocation() has to be called first.
+    llvm::StringRef GetFileName(void) const;
+
+    // Returns the line number of the definition location.
+    // Note that SetDefinitionLocation() has to be called first.
+    uint GetLineNumber(void) const {
+        return DefinitionLineNo;
+    }
+
+    private:
+    // The file is kept in the string pool, the same as the violations'
+    uint32_t FileID = 0;
+    uint DefinitionLineNo = 0;
+    bool HasComment = false;
+    bool DefinitionFound = false;
+};
 
 // We use the CommentManager to keep track of function declarations
 // and their associated comments.
 class CommentManager {
     public:
+    CommentManager() = default;
+    virtual ~CommentManager() = default;
+
+    // The manager's markers live in its own allocator, so it can be moved
+    // between threads but never copied.
+    CommentManager(CommentManager&& Other);
+    CommentManager& operator=(CommentManager&& Other);
+    CommentManager(const CommentManager&) = delete;
+    CommentManager& operator=(const CommentManager&) = delete;
+
     // Marks the given declaration name as having been seen.
-    void MarkDeclNameAsSeen(std::string DeclName);
+    void MarkDeclNameAsSeen(llvm::StringRef DeclName);
 
     // Returns true if the declaration name has been seen, else returns false.
-    bool DeclNameHasBeenSeen(std::string DeclName);
+    bool DeclNameHasBeenSeen(llvm::StringRef DeclName) const;
 
     // Sets the location of the definition of the given declaration name.
     void SetDefinitionLocation(
-            std::string DeclName, std::string FileName, uint LineNo);
+            llvm::StringRef DeclName, llvm::StringRef FileName, uint LineNo);
 
     // Marks the given declaration as having some form of comment present.
-    void MarkDeclNameAsCommented(std::string DeclName);
+    void MarkDeclNameAsCommented(llvm::StringRef DeclName);
+
+    // Moves the declarations seen by another manager into this one.
+    // The other manager should hold the declarations of files checked
+    // after those in this manager, so its definition locations take
+    // precedence.
+    void MergeFrom(CommentManager& Other);
+
+    // Frees all of the declarations seen by the manager.
+    void Clear(void);
+
+    // Returns the declarations seen by the manager as JSON, for the
+    // result cache.
+    llvm::json::Value ToJSON(void) const;
+
+    // Adds the declarations stored by ToJSON to the manager. Returns false
+    // if the value isn't in that form.
+    bool FromJSON(const llvm::json::Value& Value);
 
     // Resolves all of the seen declarations, generating comment violations
     // for those which don't have a comment present. We make this a virtual
@@ -39,16 +113,22 @@ class CommentManager {
     virtual void GenerateCommentViolations(void) = 0;
 
     protected:
-    std::unordered_set<std::string> SeenDeclNames;
-    std::map<std::string, DeclarationMarker*> DeclInformation;
+    // Each name and its marker are allocated together from the map's
+    // allocator, which is only freed as a whole when the manager is
+    // cleared.
+    llvm::StringMap<DeclarationMarker, llvm::BumpPtrAllocator> DeclInformation;
 };
 
 class FunctionCommentManager : public CommentManager {
     public:
     void GenerateCommentViolations(void) override;
+
+    // Returns the files holding function definitions which haven't been
+    // commented (yet). A file checked later on may still comment them.
+    std::unordered_set<std::string> GetFilesAwaitingComments(void);
 };
 
-extern FunctionCommentManager GlobalFunctionCommentManager;
+extern thread_local FunctionCommentManager GlobalFunctionCommentManager;
 
 }  // namespace nett
 
@@ -46,16 +46,15 @@ void FunctionCommentChecker::run(const MatchFinder::MatchResult& Result) {
         // Once we know the status of the comment, we update the comment
         // manager. This will automatically add violations for us later once all
         // the checks are completed.
-        if (!GlobalFunctionCommentManager.DeclNameHasBeenSeen(FuncName.str())) {
-            GlobalFunctionCommentManager.MarkDeclNameAsSeen(FuncName.str());
+        if (!GlobalFunctionCommentManager.DeclNameHasBeenSeen(FuncName)) {
+            GlobalFunctionCommentManager.MarkDeclNameAsSeen(FuncName);
         }
         if (Node->isThisDeclarationADefinition()) {
             GlobalFunctionCommentManager.SetDefinitionLocation(
-                    FuncName.str(), File.str(), FuncLineNo);
+                    FuncName, File, FuncLineNo);
         }
         if (HasComment) {
-            GlobalFunctionCommentManager.MarkDeclNameAsCommented(
-                    FuncName.str());
+            GlobalFunctionCommentManager.MarkDeclNameAsCommented(FuncName);
         }
 
         // Finally, we log the declaration/definition
@@ -7,8 +7,6 @@
 #include "../utils/Tokens.hpp"
 #include "../whitespace/FileContentManager.hpp"
 
-#include <sstream>
-
 using namespace clang::ast_matchers;
 
 namespace nett {
@@ -43,10 +41,9 @@ void GlobalVarCommentChecker::run(const MatchFinder::MatchResult& Result) {
         }
 
         if (HasNoComment) {
-            std::stringstream ErrMsg;
-            ErrMsg << "Global variables should be commented.";
+            const char* ErrMsg = "Global variables should be commented.";
             GlobalViolationManager.AddViolation(
-                    new CommentsViolation(File.str(), VarLineNo, ErrMsg.str()));
+                    CommentsViolation(File.str(), VarLineNo, ErrMsg));
         }
 
         nett::EntryInfo Info = ConstructFileEntry(
@@ -4,9 +4,7 @@
 #include "DefineIndentCheck.hpp"
 
 #include "../../violations/ViolationManager.hpp"
-#include "../utils/Tokens.hpp"
-
-#include <sstream>
+#include "../utils/SourceIndex.hpp"
 
 namespace nett {
 namespace checks {
@@ -20,34 +18,23 @@ void DefineIndentChecker::MacroDefined(
         return;
     }
 
-    auto LeadingIndentSize =
-            clang::Lexer::getIndentationForLine(Loc, SM).size();
+    auto LeadingIndentSize = utils::GetLineIndentation(Loc, SM);
     auto File = SM.getFilename(Loc);
     auto LocLineNo = SM.getExpansionLineNumber(Loc);
-
-    auto DefineLoc = Loc;
-    while (SM.getSpellingColumnNumber(DefineLoc) != 1) {
-        DefineLoc = DefineLoc.getLocWithOffset(-1);
-    }
+    auto DefineLoc = utils::GetLineStartLocation(Loc, SM);
 
     if (LeadingIndentSize != 0) {
         const auto* DirectiveSourceStart = SM.getCharacterData(
                 DefineLoc.getLocWithOffset(LeadingIndentSize));
-        std::stringstream TokenString;
 
         int Size = 0;
         while (DirectiveSourceStart[Size] != ' ') {
-            TokenString << DirectiveSourceStart[Size];
             Size++;
         }
+        llvm::StringRef TokenString(DirectiveSourceStart, Size);
 
-        std::stringstream ErrMsg;
-        ErrMsg << "'" << TokenString.str() << "' "
-               << "Expected indent of 0 spaces, found " << LeadingIndentSize
-               << ".";
-
-        GlobalViolationManager.AddViolation(
-                new IndentationViolation(File.str(), LocLineNo, ErrMsg.str()));
+        GlobalViolationManager.AddViolation(Violation::Indent(File.str(),
+                LocLineNo, TokenString, 0, LeadingIndentSize));
     }
 }
 
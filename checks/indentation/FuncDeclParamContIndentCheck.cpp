@@ -4,12 +4,11 @@
 #include "FuncDeclParamContIndentCheck.hpp"
 
 #include "../../violations/ViolationManager.hpp"
+#include "../utils/TokenCache.hpp"
 #include "../utils/Tokens.hpp"
 #include "IndentCheck.hpp"
 #include "IndentWidths.hpp"
 
-#include "clang/Lex/Lexer.h"
-
 #include <sstream>
 #include <unordered_set>
 
@@ -35,22 +34,27 @@ void FuncDeclParamContIndentChecker::run(
         // The start of the source range is the '(' token after the function
         // name The end of the source range is the ')' token after the final
         // parameter
-        auto ParamStartLoc = utils::FindCharLocation(
-                Node->getLocation(), '(', SM, Result.Context);
+        auto FoundParamStart = utils::FindCharLocation(Node->getLocation(),
+                '(', SM, Result.Context, Node->getEndLoc());
+        if (!FoundParamStart) {
+            return;
+        }
+        auto ParamStartLoc = *FoundParamStart;
 
         auto ParamEndLoc = ParamStartLoc;
-        if (Node->getNumParams() == 0) {
-            // We should get the closing ')' if there are no parameters
-            ParamEndLoc = clang::Lexer::findNextToken(ParamEndLoc, SM, LangOpts)
-                                  ->getLocation();
-        } else {
+        if (Node->getNumParams() != 0) {
             const auto* FinalParam =
                     Node->getParamDecl(Node->getNumParams() - 1);
-            ParamEndLoc = clang::Lexer::findNextToken(
-                    FinalParam->getEndLoc(), SM, LangOpts)
-                                  ->getLocation();
+            ParamEndLoc = FinalParam->getEndLoc();
         }
 
+        // The token after the '(' (if there are no parameters) or after the
+        // final parameter is the closing ')'
+        auto ParamEndToken =
+                utils::GlobalTokenCache.GetCursor(ParamEndLoc, SM, LangOpts);
+        ParamEndToken.NextCode();
+        ParamEndLoc = ParamEndToken.GetLocation();
+
         CheckSourceRangeContinuationIndent(
                 ParamStartLoc, ParamEndLoc, Result.Context, 0, 0);
     }
@@ -12,8 +12,6 @@
 #include "StructUnionBodyIndentCheck.hpp"
 #include "TypedefIndentCheck.hpp"
 
-#include "clang/AST/ParentMap.h"
-#include "clang/AST/RecursiveASTVisitor.h"
 #include "clang/Lex/Lexer.h"
 #include "clang/Lex/Preprocessor.h"
 
@@ -26,640 +24,641 @@ namespace checks {
 namespace indentation {
 
 static void CheckStandardStatementIndentation(clang::Stmt* Stmt,
-        clang::ASTContext* Context, unsigned int NestingLevel,
-        bool IsInSwitchStatement, unsigned int SwitchNestingLevel);
+        const clang::DynTypedNode& Parent, clang::ASTContext* Context,
+        unsigned int NestingLevel, bool IsInSwitchStatement,
+        unsigned int SwitchNestingLevel);
 
 static bool StatementIsALoopConstruct(clang::Stmt* Stmt);
 static bool StatementIsAConditional(clang::Stmt* Stmt);
 
-class FunctionASTVisitor
-    : public clang::RecursiveASTVisitor<FunctionASTVisitor> {
-    using Base = clang::RecursiveASTVisitor<FunctionASTVisitor>;
+bool FunctionBodyIndentModule::BeginFunction(const clang::FunctionDecl* Node,
+        traversal::TraversalContext& Traversal) {
+    return Traversal.Context->getSourceManager().isWrittenInMainFile(
+            Node->getLocation());
+}
 
-    public:
-    explicit FunctionASTVisitor(
-            clang::ASTContext* Context, clang::Preprocessor& PP)
-        : Context(Context), PP(PP) {
-    }
+void FunctionBodyIndentModule::EnterIfStmt(
+        clang::IfStmt* Node, traversal::TraversalContext& Traversal) {
 
-    bool VisitIfStmt(clang::IfStmt* Stmt) {
+    auto* Context = Traversal.Context;
+    auto CurrentNestingLevel = Traversal.CurrentNestingLevel;
 
-        // If the 'then' or 'else' components of the if statement are not
-        // compound statements, we need to check the nested statement
-        // indentation as well
-        if (!llvm::isa<clang::CompoundStmt>(Stmt->getThen()) &&
-                !StatementIsALoopConstruct(Stmt->getThen()) &&
-                !StatementIsAConditional(Stmt->getThen())) {
+    auto SwitchNestingLevel = Traversal.SwitchNestingLevel;
 
-            // To account for macros, we need to use getFileLoc() to get
-            // the actual location within the file source instead of the
-            // macro location.
-            auto TrueLocation = Context->getSourceManager().getFileLoc(
-                    Stmt->getThen()->getBeginLoc());
+    // We only want to check the indentation of the
+    // 'if' token if it is not part of an else branch
+    const auto* ParentIfStmt = Traversal.GetParent().get<clang::IfStmt>();
+    auto IsElseBranch = false;
 
-            CheckStatementIndentation(TrueLocation, Context,
+    if (ParentIfStmt) {
+        if (ParentIfStmt->getThen()->getBeginLoc() == Node->getBeginLoc()) {
+            // We are the if branch of our parent
+            CheckStatementIndentation(Node->getBeginLoc(), Context,
                     CurrentNestingLevel + SwitchNestingLevel);
-
-            if (PP.isAtStartOfMacroExpansion(Stmt->getThen()->getBeginLoc())) {
-                CheckSourceRangeContinuationIndent(TrueLocation,
-                        checks::utils::GetMacroEndLocation(
-                                Stmt->getThen(), Context, PP),
-                        Context, CurrentNestingLevel, SwitchNestingLevel);
-            } else {
-                CheckSourceRangeContinuationIndent(
-                        Stmt->getThen()->getBeginLoc(),
-                        Stmt->getThen()->getEndLoc(), Context,
-                        CurrentNestingLevel, SwitchNestingLevel);
-            }
+        } else if (ParentIfStmt->hasElseStorage()) {
+            IsElseBranch = true;
         }
-        if (Stmt->hasElseStorage()) {
-            if (!llvm::isa<clang::CompoundStmt>(Stmt->getElse()) &&
-                    !StatementIsALoopConstruct(Stmt->getElse()) &&
-                    !StatementIsAConditional(Stmt->getElse())) {
-
-                auto TrueLocation = Context->getSourceManager().getFileLoc(
-                        Stmt->getElse()->getBeginLoc());
-                CheckStatementIndentation(TrueLocation, Context,
-                        CurrentNestingLevel + SwitchNestingLevel);
+    } else {
+        // We are the top of an if/else-if chain
+        CheckStatementIndentation(Node->getBeginLoc(), Context,
+                CurrentNestingLevel + SwitchNestingLevel);
+    }
 
-                if (PP.isAtStartOfMacroExpansion(
-                            Stmt->getElse()->getBeginLoc())) {
-                    CheckSourceRangeContinuationIndent(TrueLocation,
-                            checks::utils::GetMacroEndLocation(
-                                    Stmt->getElse(), Context, PP),
-                            Context, CurrentNestingLevel, SwitchNestingLevel);
-                } else {
-                    CheckSourceRangeContinuationIndent(
-                            Stmt->getElse()->getBeginLoc(),
-                            Stmt->getElse()->getEndLoc(), Context,
-                            CurrentNestingLevel, SwitchNestingLevel);
-                }
-            }
+    // We only check the 'else' token's indentation if the 'then'
+    // statement's body is not a compound statement and the statement has an
+    // else component
+    if (!llvm::isa<clang::CompoundStmt>(Node->getThen()) &&
+            Node->hasElseStorage()) {
+        if (IsElseBranch) {
+            CheckStatementIndentation(Node->getElseLoc(), Context,
+                    CurrentNestingLevel + SwitchNestingLevel - 1);
+        } else {
+            CheckStatementIndentation(Node->getElseLoc(), Context,
+                    CurrentNestingLevel + SwitchNestingLevel);
         }
-
-        return true;
     }
 
-    bool VisitWhileStmt(clang::WhileStmt* Stmt) {
-
-        if (!llvm::isa<clang::CompoundStmt>(Stmt->getBody()) &&
-                !StatementIsALoopConstruct(Stmt->getBody()) &&
-                !StatementIsAConditional(Stmt->getBody())) {
-            auto TrueLocation = Context->getSourceManager().getFileLoc(
-                    Stmt->getBody()->getBeginLoc());
-            CheckStatementIndentation(TrueLocation, Context,
+    // If the 'then' or 'else' components of the if statement are compound
+    // statements, we need to check the indentation of the right curly brace
+    // '}'
+    if (llvm::isa<clang::CompoundStmt>(Node->getThen())) {
+        auto* CS = llvm::dyn_cast<clang::CompoundStmt>(Node->getThen());
+        if (IsElseBranch) {
+            CheckStatementIndentation(CS->getRBracLoc(), Context,
+                    CurrentNestingLevel + SwitchNestingLevel - 1);
+        } else {
+            CheckStatementIndentation(CS->getRBracLoc(), Context,
                     CurrentNestingLevel + SwitchNestingLevel);
-            if (PP.isAtStartOfMacroExpansion(Stmt->getBody()->getBeginLoc())) {
-                CheckSourceRangeContinuationIndent(TrueLocation,
-                        checks::utils::GetMacroEndLocation(
-                                Stmt->getBody(), Context, PP),
-                        Context, CurrentNestingLevel, SwitchNestingLevel);
+        }
+    }
+    if (Node->hasElseStorage()) {
+        if (llvm::isa<clang::CompoundStmt>(Node->getElse())) {
+            auto* CS = llvm::dyn_cast<clang::CompoundStmt>(Node->getElse());
+            if (IsElseBranch) {
+                CheckStatementIndentation(CS->getRBracLoc(), Context,
+                        CurrentNestingLevel + SwitchNestingLevel - 1);
             } else {
-                CheckSourceRangeContinuationIndent(
-                        Stmt->getBody()->getBeginLoc(),
-                        Stmt->getBody()->getEndLoc(), Context,
-                        CurrentNestingLevel, SwitchNestingLevel);
+                CheckStatementIndentation(CS->getRBracLoc(), Context,
+                        CurrentNestingLevel + SwitchNestingLevel);
             }
         }
-
-        return true;
     }
+    auto& SM = Context->getSourceManager();
 
-    bool VisitForStmt(clang::ForStmt* Stmt) {
+    // We also need to check the if condition's continuation indent
+    auto LParenLoc = whitespace::GetNextNonWhitespaceLoc(
+            Node->getIfLoc().getLocWithOffset(2), SM);
 
-        if (!llvm::isa<clang::CompoundStmt>(Stmt->getBody()) &&
-                !StatementIsALoopConstruct(Stmt->getBody()) &&
-                !StatementIsAConditional(Stmt->getBody())) {
+    auto RParenLoc = whitespace::GetPreviousNonWhitespaceLoc(
+            Node->getThen()->getBeginLoc().getLocWithOffset(-1), SM);
 
-            auto TrueLocation = Context->getSourceManager().getFileLoc(
-                    Stmt->getBody()->getBeginLoc());
-            CheckStatementIndentation(TrueLocation, Context,
-                    CurrentNestingLevel + SwitchNestingLevel);
-            if (PP.isAtStartOfMacroExpansion(Stmt->getBody()->getBeginLoc())) {
-                CheckSourceRangeContinuationIndent(TrueLocation,
-                        checks::utils::GetMacroEndLocation(
-                                Stmt->getBody(), Context, PP),
-                        Context, CurrentNestingLevel, SwitchNestingLevel);
-            } else {
-                CheckSourceRangeContinuationIndent(
-                        Stmt->getBody()->getBeginLoc(),
-                        Stmt->getBody()->getEndLoc(), Context,
-                        CurrentNestingLevel, SwitchNestingLevel);
-            }
-        }
-
-        return true;
+    auto Level = SwitchNestingLevel > 0
+                         ? CurrentNestingLevel - SwitchNestingLevel
+                         : CurrentNestingLevel;
+    if (IsElseBranch) {
+        CheckSourceRangeContinuationIndent(LParenLoc.getLocWithOffset(1),
+                RParenLoc.getLocWithOffset(-1), Context,
+                Level + SwitchNestingLevel - 1, SwitchNestingLevel);
+    } else {
+        CheckSourceRangeContinuationIndent(LParenLoc.getLocWithOffset(1),
+                RParenLoc.getLocWithOffset(-1), Context,
+                Level + SwitchNestingLevel, SwitchNestingLevel);
     }
+}
 
-    bool VisitDoStmt(clang::DoStmt* Stmt) {
+void FunctionBodyIndentModule::EnterForStmt(
+        clang::ForStmt* Node, traversal::TraversalContext& Traversal) {
+    CheckStatementIndentation(Node->getBeginLoc(), Traversal.Context,
+            Traversal.CurrentNestingLevel + Traversal.SwitchNestingLevel);
+}
 
-        if (!llvm::isa<clang::CompoundStmt>(Stmt->getBody()) &&
-                !StatementIsALoopConstruct(Stmt->getBody()) &&
-                !StatementIsAConditional(Stmt->getBody())) {
-            auto TrueLocation = Context->getSourceManager().getFileLoc(
-                    Stmt->getBody()->getBeginLoc());
-            CheckStatementIndentation(TrueLocation, Context,
-                    CurrentNestingLevel + SwitchNestingLevel);
+void FunctionBodyIndentModule::LeaveForStmt(
+        clang::ForStmt* Node, traversal::TraversalContext& Traversal) {
 
-            if (PP.isAtStartOfMacroExpansion(Stmt->getBody()->getBeginLoc())) {
-                CheckSourceRangeContinuationIndent(TrueLocation,
-                        checks::utils::GetMacroEndLocation(
-                                Stmt->getBody(), Context, PP),
-                        Context, CurrentNestingLevel, SwitchNestingLevel);
-            } else {
-                CheckSourceRangeContinuationIndent(
-                        Stmt->getBody()->getBeginLoc(),
-                        Stmt->getBody()->getEndLoc(), Context,
-                        CurrentNestingLevel, SwitchNestingLevel);
-            }
-        }
+    auto* Context = Traversal.Context;
+    auto CurrentNestingLevel = Traversal.CurrentNestingLevel;
 
-        return true;
+    auto SwitchNestingLevel = Traversal.SwitchNestingLevel;
+
+    if (llvm::isa<clang::CompoundStmt>(Node->getBody())) {
+        // Check the right curly brace's location
+        auto* CS = llvm::dyn_cast<clang::CompoundStmt>(Node->getBody());
+        CheckStatementIndentation(CS->getRBracLoc(), Context,
+                CurrentNestingLevel + SwitchNestingLevel);
     }
 
-    bool VisitSwitchStmt(clang::SwitchStmt* Stmt) {
+    // Check the condition's continuation indent
+    auto Level = SwitchNestingLevel > 0
+                         ? CurrentNestingLevel - SwitchNestingLevel
+                         : CurrentNestingLevel;
 
-        auto& SM = Context->getSourceManager();
-        auto LangOpts = Context->getLangOpts();
+    CheckSourceRangeContinuationIndent(
+            Node->getLParenLoc().getLocWithOffset(1),
+            Node->getRParenLoc().getLocWithOffset(-1), Context,
+            Level + SwitchNestingLevel, SwitchNestingLevel);
+}
 
-        auto LParenLoc = whitespace::GetNextNonWhitespaceLoc(
-                Stmt->getSwitchLoc().getLocWithOffset(5), SM);
+void FunctionBodyIndentModule::EnterDoStmt(
+        clang::DoStmt* Node, traversal::TraversalContext& Traversal) {
+    CheckStatementIndentation(Node->getBeginLoc(), Traversal.Context,
+            Traversal.CurrentNestingLevel + Traversal.SwitchNestingLevel);
+}
 
-        auto RParenLoc = whitespace::GetPreviousNonWhitespaceLoc(
-                Stmt->getBody()->getBeginLoc().getLocWithOffset(-1), SM);
+void FunctionBodyIndentModule::LeaveDoStmt(
+        clang::DoStmt* Node, traversal::TraversalContext& Traversal) {
 
-        if (llvm::isa<clang::CompoundStmt>(Stmt->getBody())) {
-            CheckStatementIndentation(Stmt->getBeginLoc(), Context,
-                    CurrentNestingLevel + SwitchNestingLevel - 1);
-            CheckStatementIndentation(Stmt->getEndLoc(), Context,
-                    CurrentNestingLevel + SwitchNestingLevel - 1);
-            CheckSourceRangeContinuationIndent(LParenLoc.getLocWithOffset(1),
-                    RParenLoc.getLocWithOffset(-1), Context,
-                    CurrentNestingLevel - 1, SwitchNestingLevel);
-        } else {
-            // We have to reduce the nesting level more in order to compensate
-            // for the increase added by the TraverseSwitchStmt method for not
-            // having braces.
-            CheckStatementIndentation(Stmt->getBeginLoc(), Context,
-                    CurrentNestingLevel + SwitchNestingLevel - 2);
-            CheckSourceRangeContinuationIndent(LParenLoc.getLocWithOffset(1),
-                    RParenLoc.getLocWithOffset(-1), Context,
-                    CurrentNestingLevel - 2, SwitchNestingLevel);
-        }
+    auto* Context = Traversal.Context;
+    auto CurrentNestingLevel = Traversal.CurrentNestingLevel;
 
-        return true;
-    }
+    auto SwitchNestingLevel = Traversal.SwitchNestingLevel;
 
-    bool VisitVarDecl(clang::VarDecl* Decl) {
-        if (!llvm::isa<clang::ParmVarDecl>(Decl)) {
-            auto ParentNodes = Context->getParents(*Decl);
-            auto GrandparentNodes = Context->getParents(
-                    *(ParentNodes[0].get<clang::DeclStmt>()));
-
-            // We only want to check the indentation of variables who are
-            // part of a compound statement since this avoids declarations
-            // inside of loop initialisers etc. which do not require indentation
-            // checks (we use whitespace checks instead)
-            if (GrandparentNodes[0].get<clang::CompoundStmt>()) {
-
-                // We don't want to match enums or struct definitions
-                if (Decl->getType()->getAs<clang::EnumType>()) {
-                    return true;
-                }
-                if (Decl->getType()->getAs<clang::RecordType>()) {
-                    if (Decl->hasInit()) {
-                        // If we have a struct initialiser, we check its
-                        // continuation
-                        CheckSourceRangeContinuationIndent(Decl->getBeginLoc(),
-                                Decl->getEndLoc(), Context, CurrentNestingLevel,
-                                SwitchNestingLevel);
-                    }
-                    return true;
-                }
-                // We don't have a special check for switch statements since
-                // variables in a switch must be declared at the top (before any
-                // cases) if not using braces
-                CheckStatementIndentation(Decl->getBeginLoc(), Context,
-                        CurrentNestingLevel + SwitchNestingLevel);
-                CheckSourceRangeContinuationIndent(Decl->getBeginLoc(),
-                        Decl->getEndLoc(), Context, CurrentNestingLevel,
-                        SwitchNestingLevel);
-            }
-        }
-        return true;
+    if (!llvm::isa<clang::CompoundStmt>(Node->getBody())) {
+        // If we don't have a compound statement, we need to check the
+        // indentation of the 'while' instead of the right curly brace
+        CheckStatementIndentation(Node->getWhileLoc(), Context,
+                CurrentNestingLevel + SwitchNestingLevel);
+    } else {
+        // Check the right curly brace's location
+        auto* CS = llvm::dyn_cast<clang::CompoundStmt>(Node->getBody());
+        CheckStatementIndentation(CS->getRBracLoc(), Context,
+                CurrentNestingLevel + SwitchNestingLevel);
     }
 
-    bool VisitReturnStmt(clang::ReturnStmt* Stmt) {
+    auto& SM = Context->getSourceManager();
 
-        CheckStandardStatementIndentation(Stmt, Context, CurrentNestingLevel,
-                IsInSwitchStatement, SwitchNestingLevel);
+    // Finally, we check the condition's continuation indent
+    auto LParenLoc = whitespace::GetNextNonWhitespaceLoc(
+            Node->getWhileLoc().getLocWithOffset(5), SM);
 
-        auto ParentNodes = Context->getParents(*Stmt);
-        if (ParentNodes[0].get<clang::CompoundStmt>()) {
-            CheckSourceRangeContinuationIndent(Stmt->getBeginLoc(),
-                    Stmt->getEndLoc(), Context, CurrentNestingLevel,
-                    SwitchNestingLevel);
-        }
-        return true;
-    }
+    auto RParenLoc = Node->getRParenLoc();
 
-    bool VisitBinaryOperator(clang::BinaryOperator* Op) {
-        CheckStandardStatementIndentation(Op, Context, CurrentNestingLevel,
-                IsInSwitchStatement, SwitchNestingLevel);
+    auto Level = SwitchNestingLevel > 0
+                         ? CurrentNestingLevel - SwitchNestingLevel
+                         : CurrentNestingLevel;
 
-        auto ParentNodes = Context->getParents(*Op);
-        if (ParentNodes[0].get<clang::CompoundStmt>()) {
-            CheckSourceRangeContinuationIndent(Op->getBeginLoc(),
-                    Op->getEndLoc(), Context, CurrentNestingLevel,
-                    SwitchNestingLevel);
-        }
+    CheckSourceRangeContinuationIndent(LParenLoc.getLocWithOffset(1),
+            RParenLoc.getLocWithOffset(-1), Context,
+            Level + SwitchNestingLevel, SwitchNestingLevel);
+}
 
-        return true;
-    }
+void FunctionBodyIndentModule::EnterWhileStmt(
+        clang::WhileStmt* Node, traversal::TraversalContext& Traversal) {
+    CheckStatementIndentation(Node->getBeginLoc(), Traversal.Context,
+            Traversal.CurrentNestingLevel + Traversal.SwitchNestingLevel);
+}
 
-    bool VisitUnaryOperator(clang::UnaryOperator* Op) {
-        CheckStandardStatementIndentation(Op, Context, CurrentNestingLevel,
-                IsInSwitchStatement, SwitchNestingLevel);
+void FunctionBodyIndentModule::LeaveWhileStmt(
+        clang::WhileStmt* Node, traversal::TraversalContext& Traversal) {
 
-        auto ParentNodes = Context->getParents(*Op);
-        if (ParentNodes[0].get<clang::CompoundStmt>()) {
-            CheckSourceRangeContinuationIndent(Op->getBeginLoc(),
-                    Op->getEndLoc(), Context, CurrentNestingLevel,
-                    SwitchNestingLevel);
-        }
+    auto* Context = Traversal.Context;
+    auto CurrentNestingLevel = Traversal.CurrentNestingLevel;
 
-        return true;
+    auto SwitchNestingLevel = Traversal.SwitchNestingLevel;
+
+    if (llvm::isa<clang::CompoundStmt>(Node->getBody())) {
+        // If we do have a compound statement, we also check the right curly
+        // brace
+        auto* CS = llvm::dyn_cast<clang::CompoundStmt>(Node->getBody());
+        CheckStatementIndentation(CS->getRBracLoc(), Context,
+                CurrentNestingLevel + SwitchNestingLevel);
     }
 
-    bool VisitCallExpr(clang::CallExpr* Call) {
-        CheckStandardStatementIndentation(Call, Context, CurrentNestingLevel,
-                IsInSwitchStatement, SwitchNestingLevel);
+    auto& SM = Context->getSourceManager();
 
-        auto ParentNodes = Context->getParents(*Call);
-        if (ParentNodes[0].get<clang::CompoundStmt>()) {
-            CheckSourceRangeContinuationIndent(Call->getBeginLoc(),
-                    Call->getEndLoc(), Context, CurrentNestingLevel,
-                    SwitchNestingLevel);
-        }
+    // Finally, we check the condition's continuation indent
+    auto LParenLoc = whitespace::GetNextNonWhitespaceLoc(
+            Node->getWhileLoc().getLocWithOffset(5), SM);
 
-        return true;
-    }
+    auto RParenLoc = whitespace::GetPreviousNonWhitespaceLoc(
+            Node->getBody()->getBeginLoc().getLocWithOffset(-1), SM);
 
-    bool VisitBreakStmt(clang::BreakStmt* Stmt) {
-        CheckStandardStatementIndentation(Stmt, Context, CurrentNestingLevel,
-                IsInSwitchStatement, SwitchNestingLevel);
-        return true;
-    }
+    auto Level = SwitchNestingLevel > 0
+                         ? CurrentNestingLevel - SwitchNestingLevel
+                         : CurrentNestingLevel;
 
-    bool VisitContinueStmt(clang::ContinueStmt* Stmt) {
-        CheckStandardStatementIndentation(Stmt, Context, CurrentNestingLevel,
-                IsInSwitchStatement, SwitchNestingLevel);
-        return true;
-    }
+    CheckSourceRangeContinuationIndent(LParenLoc.getLocWithOffset(1),
+            RParenLoc.getLocWithOffset(-1), Context,
+            Level + SwitchNestingLevel, SwitchNestingLevel);
+}
 
-    bool VisitCaseStmt(clang::CaseStmt* Stmt) {
-        CheckStatementIndentation(Stmt->getBeginLoc(), Context,
-                CurrentNestingLevel + SwitchNestingLevel - 1);
+void FunctionBodyIndentModule::VisitIfStmt(
+        clang::IfStmt* Stmt, traversal::TraversalContext& Traversal) {
 
-        if (llvm::isa<clang::CompoundStmt>(Stmt->getSubStmt())) {
-            CheckStatementIndentation(Stmt->getEndLoc(), Context,
-                    CurrentNestingLevel + SwitchNestingLevel - 1);
-        }
-        return true;
-    }
+    auto* Context = Traversal.Context;
+    auto& PP = Traversal.PP;
+    auto CurrentNestingLevel = Traversal.CurrentNestingLevel;
+    auto SwitchNestingLevel = Traversal.SwitchNestingLevel;
 
-    bool VisitDefaultStmt(clang::DefaultStmt* Stmt) {
-        CheckStatementIndentation(Stmt->getBeginLoc(), Context,
-                CurrentNestingLevel + SwitchNestingLevel - 1);
+    // If the 'then' or 'else' components of the if statement are not
+    // compound statements, we need to check the nested statement
+    // indentation as well
+    if (!llvm::isa<clang::CompoundStmt>(Stmt->getThen()) &&
+            !StatementIsALoopConstruct(Stmt->getThen()) &&
+            !StatementIsAConditional(Stmt->getThen())) {
 
-        if (llvm::isa<clang::CompoundStmt>(Stmt->getSubStmt())) {
-            CheckStatementIndentation(Stmt->getEndLoc(), Context,
-                    CurrentNestingLevel + SwitchNestingLevel - 1);
+        // To account for macros, we need to use getFileLoc() to get
+        // the actual location within the file source instead of the
+        // macro location.
+        auto TrueLocation = Context->getSourceManager().getFileLoc(
+                Stmt->getThen()->getBeginLoc());
+
+        CheckStatementIndentation(TrueLocation, Context,
+                CurrentNestingLevel + SwitchNestingLevel);
+
+        if (PP.isAtStartOfMacroExpansion(Stmt->getThen()->getBeginLoc())) {
+            CheckSourceRangeContinuationIndent(TrueLocation,
+                    checks::utils::GetMacroEndLocation(
+                            Stmt->getThen(), Context, PP),
+                    Context, CurrentNestingLevel, SwitchNestingLevel);
+        } else {
+            CheckSourceRangeContinuationIndent(
+                    Stmt->getThen()->getBeginLoc(),
+                    Stmt->getThen()->getEndLoc(), Context,
+                    CurrentNestingLevel, SwitchNestingLevel);
         }
-        return true;
     }
+    if (Stmt->hasElseStorage()) {
+        if (!llvm::isa<clang::CompoundStmt>(Stmt->getElse()) &&
+                !StatementIsALoopConstruct(Stmt->getElse()) &&
+                !StatementIsAConditional(Stmt->getElse())) {
 
-    bool VisitCompoundStmt(clang::CompoundStmt* Stmt) {
-
-        // Here we need to check macro indentation.
-        // Since we cannot match a macro directly (as it is
-        // replaced by its content), we find it via the
-        // children of the compound statement.
-        for (auto* Child : Stmt->children()) {
-            if (StatementIsALoopConstruct(Child) ||
-                    StatementIsAConditional(Child)) {
-                continue;
-            }
-            if (PP.isAtStartOfMacroExpansion(Child->getBeginLoc())) {
+            auto TrueLocation = Context->getSourceManager().getFileLoc(
+                    Stmt->getElse()->getBeginLoc());
+            CheckStatementIndentation(TrueLocation, Context,
+                    CurrentNestingLevel + SwitchNestingLevel);
 
-                auto TrueLocation = Context->getSourceManager().getFileLoc(
-                        Child->getBeginLoc());
-                CheckStatementIndentation(TrueLocation, Context,
-                        CurrentNestingLevel + SwitchNestingLevel);
+            if (PP.isAtStartOfMacroExpansion(
+                        Stmt->getElse()->getBeginLoc())) {
                 CheckSourceRangeContinuationIndent(TrueLocation,
-                        checks::utils::GetMacroEndLocation(Child, Context, PP),
+                        checks::utils::GetMacroEndLocation(
+                                Stmt->getElse(), Context, PP),
                         Context, CurrentNestingLevel, SwitchNestingLevel);
+            } else {
+                CheckSourceRangeContinuationIndent(
+                        Stmt->getElse()->getBeginLoc(),
+                        Stmt->getElse()->getEndLoc(), Context,
+                        CurrentNestingLevel, SwitchNestingLevel);
             }
         }
-
-        return true;
     }
+}
 
-    bool VisitRecordDecl(clang::RecordDecl* Decl) {
-        CheckStructUnionBodyIndentation(
-                Decl, Context, PP, CurrentNestingLevel, SwitchNestingLevel);
-        return true;
-    }
+void FunctionBodyIndentModule::VisitWhileStmt(
+        clang::WhileStmt* Stmt, traversal::TraversalContext& Traversal) {
 
-    bool VisitEnumDecl(clang::EnumDecl* Decl) {
-        CheckEnumBodyIndentation(
-                Decl, Context, CurrentNestingLevel, SwitchNestingLevel);
-        return true;
-    }
+    auto* Context = Traversal.Context;
+    auto& PP = Traversal.PP;
+    auto CurrentNestingLevel = Traversal.CurrentNestingLevel;
+    auto SwitchNestingLevel = Traversal.SwitchNestingLevel;
 
-    bool VisitTypedefDecl(clang::TypedefDecl* Decl) {
-        CheckTypedefIndentation(
-                Decl, Context, CurrentNestingLevel, SwitchNestingLevel);
-        return true;
+    if (!llvm::isa<clang::CompoundStmt>(Stmt->getBody()) &&
+            !StatementIsALoopConstruct(Stmt->getBody()) &&
+            !StatementIsAConditional(Stmt->getBody())) {
+        auto TrueLocation = Context->getSourceManager().getFileLoc(
+                Stmt->getBody()->getBeginLoc());
+        CheckStatementIndentation(TrueLocation, Context,
+                CurrentNestingLevel + SwitchNestingLevel);
+        if (PP.isAtStartOfMacroExpansion(Stmt->getBody()->getBeginLoc())) {
+            CheckSourceRangeContinuationIndent(TrueLocation,
+                    checks::utils::GetMacroEndLocation(
+                            Stmt->getBody(), Context, PP),
+                    Context, CurrentNestingLevel, SwitchNestingLevel);
+        } else {
+            CheckSourceRangeContinuationIndent(
+                    Stmt->getBody()->getBeginLoc(),
+                    Stmt->getBody()->getEndLoc(), Context,
+                    CurrentNestingLevel, SwitchNestingLevel);
+        }
     }
+}
 
-    bool TraverseCompoundStmt(clang::CompoundStmt* Node) {
+void FunctionBodyIndentModule::VisitForStmt(
+        clang::ForStmt* Stmt, traversal::TraversalContext& Traversal) {
 
-        bool IsCaseStatementBody = false;
-        bool IsIfStatementBody = false;
+    auto* Context = Traversal.Context;
+    auto& PP = Traversal.PP;
+    auto CurrentNestingLevel = Traversal.CurrentNestingLevel;
+    auto SwitchNestingLevel = Traversal.SwitchNestingLevel;
 
-        auto ParentNodes = Context->getParents(*Node);
-        if (ParentNodes[0].get<clang::CaseStmt>()) {
-            IsCaseStatementBody = true;
-        } else if (ParentNodes[0].get<clang::IfStmt>()) {
-            IsIfStatementBody = true;
-        }
+    if (!llvm::isa<clang::CompoundStmt>(Stmt->getBody()) &&
+            !StatementIsALoopConstruct(Stmt->getBody()) &&
+            !StatementIsAConditional(Stmt->getBody())) {
 
-        if (!IsCaseStatementBody && !IsIfStatementBody) {
-            ++CurrentNestingLevel;
+        auto TrueLocation = Context->getSourceManager().getFileLoc(
+                Stmt->getBody()->getBeginLoc());
+        CheckStatementIndentation(TrueLocation, Context,
+                CurrentNestingLevel + SwitchNestingLevel);
+        if (PP.isAtStartOfMacroExpansion(Stmt->getBody()->getBeginLoc())) {
+            CheckSourceRangeContinuationIndent(TrueLocation,
+                    checks::utils::GetMacroEndLocation(
+                            Stmt->getBody(), Context, PP),
+                    Context, CurrentNestingLevel, SwitchNestingLevel);
+        } else {
+            CheckSourceRangeContinuationIndent(
+                    Stmt->getBody()->getBeginLoc(),
+                    Stmt->getBody()->getEndLoc(), Context,
+                    CurrentNestingLevel, SwitchNestingLevel);
         }
+    }
+}
 
-        Base::TraverseCompoundStmt(Node);
+void FunctionBodyIndentModule::VisitDoStmt(
+        clang::DoStmt* Stmt, traversal::TraversalContext& Traversal) {
 
-        if (!IsCaseStatementBody && !IsIfStatementBody) {
-            --CurrentNestingLevel;
-        }
+    auto* Context = Traversal.Context;
+    auto& PP = Traversal.PP;
+    auto CurrentNestingLevel = Traversal.CurrentNestingLevel;
+    auto SwitchNestingLevel = Traversal.SwitchNestingLevel;
+
+    if (!llvm::isa<clang::CompoundStmt>(Stmt->getBody()) &&
+            !StatementIsALoopConstruct(Stmt->getBody()) &&
+            !StatementIsAConditional(Stmt->getBody())) {
+        auto TrueLocation = Context->getSourceManager().getFileLoc(
+                Stmt->getBody()->getBeginLoc());
+        CheckStatementIndentation(TrueLocation, Context,
+                CurrentNestingLevel + SwitchNestingLevel);
 
-        return true;
+        if (PP.isAtStartOfMacroExpansion(Stmt->getBody()->getBeginLoc())) {
+            CheckSourceRangeContinuationIndent(TrueLocation,
+                    checks::utils::GetMacroEndLocation(
+                            Stmt->getBody(), Context, PP),
+                    Context, CurrentNestingLevel, SwitchNestingLevel);
+        } else {
+            CheckSourceRangeContinuationIndent(
+                    Stmt->getBody()->getBeginLoc(),
+                    Stmt->getBody()->getEndLoc(), Context,
+                    CurrentNestingLevel, SwitchNestingLevel);
+        }
     }
+}
 
-    bool TraverseSwitchStmt(clang::SwitchStmt* Node) {
-        bool SwitchHasNoBraces =
-                !llvm::isa<clang::CompoundStmt>(Node->getBody());
+void FunctionBodyIndentModule::VisitSwitchStmt(
+        clang::SwitchStmt* Stmt, traversal::TraversalContext& Traversal) {
 
-        ++SwitchNestingLevel;
-        IsInSwitchStatement = true;
+    auto* Context = Traversal.Context;
+    auto CurrentNestingLevel = Traversal.CurrentNestingLevel;
+    auto SwitchNestingLevel = Traversal.SwitchNestingLevel;
 
-        if (SwitchHasNoBraces) {
-            CurrentNestingLevel++;
-        }
+    auto& SM = Context->getSourceManager();
+    auto LangOpts = Context->getLangOpts();
 
-        Base::TraverseSwitchStmt(Node);
+    auto LParenLoc = whitespace::GetNextNonWhitespaceLoc(
+            Stmt->getSwitchLoc().getLocWithOffset(5), SM);
 
-        --SwitchNestingLevel;
-        if (SwitchNestingLevel == 0) {
-            IsInSwitchStatement = false;
-        }
-        if (SwitchHasNoBraces) {
-            CurrentNestingLevel--;
-        }
+    auto RParenLoc = whitespace::GetPreviousNonWhitespaceLoc(
+            Stmt->getBody()->getBeginLoc().getLocWithOffset(-1), SM);
 
-        return true;
+    if (llvm::isa<clang::CompoundStmt>(Stmt->getBody())) {
+        CheckStatementIndentation(Stmt->getBeginLoc(), Context,
+                CurrentNestingLevel + SwitchNestingLevel - 1);
+        CheckStatementIndentation(Stmt->getEndLoc(), Context,
+                CurrentNestingLevel + SwitchNestingLevel - 1);
+        CheckSourceRangeContinuationIndent(LParenLoc.getLocWithOffset(1),
+                RParenLoc.getLocWithOffset(-1), Context,
+                CurrentNestingLevel - 1, SwitchNestingLevel);
+    } else {
+        // We have to reduce the nesting level more in order to compensate
+        // for the increase added by the traversal to a switch without
+        // braces.
+        CheckStatementIndentation(Stmt->getBeginLoc(), Context,
+                CurrentNestingLevel + SwitchNestingLevel - 2);
+        CheckSourceRangeContinuationIndent(LParenLoc.getLocWithOffset(1),
+                RParenLoc.getLocWithOffset(-1), Context,
+                CurrentNestingLevel - 2, SwitchNestingLevel);
     }
+}
 
-    bool TraverseForStmt(clang::ForStmt* Node) {
-
-        CheckStatementIndentation(Node->getBeginLoc(), Context,
-                CurrentNestingLevel + SwitchNestingLevel);
-
-        bool ForHasNoBraces = !llvm::isa<clang::CompoundStmt>(Node->getBody());
+void FunctionBodyIndentModule::VisitVarDecl(
+        clang::VarDecl* Decl, traversal::TraversalContext& Traversal) {
 
-        if (ForHasNoBraces) {
-            CurrentNestingLevel++;
-        }
+    auto* Context = Traversal.Context;
+    auto CurrentNestingLevel = Traversal.CurrentNestingLevel;
+    auto SwitchNestingLevel = Traversal.SwitchNestingLevel;
 
-        Base::TraverseForStmt(Node);
+    if (!llvm::isa<clang::ParmVarDecl>(Decl)) {
+        // We only want to check the indentation of variables who are
+        // part of a compound statement since this avoids declarations
+        // inside of loop initialisers etc. which do not require indentation
+        // checks (we use whitespace checks instead)
+        if (Traversal.GetParent(1).get<clang::CompoundStmt>()) {
 
-        if (ForHasNoBraces) {
-            CurrentNestingLevel--;
-        } else {
-            // Check the right curly brace's location
-            auto* CS = llvm::dyn_cast<clang::CompoundStmt>(Node->getBody());
-            CheckStatementIndentation(CS->getRBracLoc(), Context,
+            // We don't want to match enums or struct definitions
+            if (Decl->getType()->getAs<clang::EnumType>()) {
+                return true;
+            }
+            if (Decl->getType()->getAs<clang::RecordType>()) {
+                if (Decl->hasInit()) {
+                    // If we have a struct initialiser, we check its
+                    // continuation
+                    CheckSourceRangeContinuationIndent(Decl->getBeginLoc(),
+                            Decl->getEndLoc(), Context, CurrentNestingLevel,
+                            SwitchNestingLevel);
+                }
+                return true;
+            }
+            // We don't have a special check for switch statements since
+            // variables in a switch must be declared at the top (before any
+            // cases) if not using braces
+            CheckStatementIndentation(Decl->getBeginLoc(), Context,
                     CurrentNestingLevel + SwitchNestingLevel);
+            CheckSourceRangeContinuationIndent(Decl->getBeginLoc(),
+                    Decl->getEndLoc(), Context, CurrentNestingLevel,
+                    SwitchNestingLevel);
         }
+    }
+}
 
-        // Check the condition's continuation indent
-        auto Level = SwitchNestingLevel > 0
-                             ? CurrentNestingLevel - SwitchNestingLevel
-                             : CurrentNestingLevel;
+void FunctionBodyIndentModule::VisitReturnStmt(
+        clang::ReturnStmt* Stmt, traversal::TraversalContext& Traversal) {
 
-        CheckSourceRangeContinuationIndent(
-                Node->getLParenLoc().getLocWithOffset(1),
-                Node->getRParenLoc().getLocWithOffset(-1), Context,
-                Level + SwitchNestingLevel, SwitchNestingLevel);
+    auto* Context = Traversal.Context;
+    auto CurrentNestingLevel = Traversal.CurrentNestingLevel;
+    auto SwitchNestingLevel = Traversal.SwitchNestingLevel;
+    auto IsInSwitchStatement = Traversal.IsInSwitchStatement;
 
-        return true;
+    CheckStandardStatementIndentation(Stmt, Traversal.GetParent(), Context,
+            CurrentNestingLevel, IsInSwitchStatement, SwitchNestingLevel);
+
+    if (Traversal.GetParent().get<clang::CompoundStmt>()) {
+        CheckSourceRangeContinuationIndent(Stmt->getBeginLoc(),
+                Stmt->getEndLoc(), Context, CurrentNestingLevel,
+                SwitchNestingLevel);
     }
+}
 
-    bool TraverseDoStmt(clang::DoStmt* Node) {
-        CheckStatementIndentation(Node->getBeginLoc(), Context,
-                CurrentNestingLevel + SwitchNestingLevel);
+void FunctionBodyIndentModule::VisitBinaryOperator(
+        clang::BinaryOperator* Op, traversal::TraversalContext& Traversal) {
 
-        bool DoHasNoBraces = !llvm::isa<clang::CompoundStmt>(Node->getBody());
+    auto* Context = Traversal.Context;
+    auto CurrentNestingLevel = Traversal.CurrentNestingLevel;
+    auto SwitchNestingLevel = Traversal.SwitchNestingLevel;
+    auto IsInSwitchStatement = Traversal.IsInSwitchStatement;
 
-        if (DoHasNoBraces) {
-            CurrentNestingLevel++;
-        }
+    CheckStandardStatementIndentation(Op, Traversal.GetParent(), Context,
+            CurrentNestingLevel, IsInSwitchStatement, SwitchNestingLevel);
 
-        Base::TraverseDoStmt(Node);
+    if (Traversal.GetParent().get<clang::CompoundStmt>()) {
+        CheckSourceRangeContinuationIndent(Op->getBeginLoc(),
+                Op->getEndLoc(), Context, CurrentNestingLevel,
+                SwitchNestingLevel);
+    }
+}
 
-        if (DoHasNoBraces) {
-            CurrentNestingLevel--;
-            // If we don't have a compound statement, we need to check the
-            // indentation of the 'while' instead of the right curly brace
-            CheckStatementIndentation(Node->getWhileLoc(), Context,
-                    CurrentNestingLevel + SwitchNestingLevel);
-        } else {
-            // Check the right curly brace's location
-            auto* CS = llvm::dyn_cast<clang::CompoundStmt>(Node->getBody());
-            CheckStatementIndentation(CS->getRBracLoc(), Context,
-                    CurrentNestingLevel + SwitchNestingLevel);
-        }
+void FunctionBodyIndentModule::VisitUnaryOperator(
+        clang::UnaryOperator* Op, traversal::TraversalContext& Traversal) {
 
-        auto& SM = Context->getSourceManager();
-        auto LangOpts = Context->getLangOpts();
+    auto* Context = Traversal.Context;
+    auto CurrentNestingLevel = Traversal.CurrentNestingLevel;
+    auto SwitchNestingLevel = Traversal.SwitchNestingLevel;
+    auto IsInSwitchStatement = Traversal.IsInSwitchStatement;
 
-        // Finally, we check the condition's continuation indent
-        auto LParenLoc = whitespace::GetNextNonWhitespaceLoc(
-                Node->getWhileLoc().getLocWithOffset(5), SM);
+    CheckStandardStatementIndentation(Op, Traversal.GetParent(), Context,
+            CurrentNestingLevel, IsInSwitchStatement, SwitchNestingLevel);
 
-        auto RParenLoc = Node->getRParenLoc();
+    if (Traversal.GetParent().get<clang::CompoundStmt>()) {
+        CheckSourceRangeContinuationIndent(Op->getBeginLoc(),
+                Op->getEndLoc(), Context, CurrentNestingLevel,
+                SwitchNestingLevel);
+    }
+}
 
-        auto Level = SwitchNestingLevel > 0
-                             ? CurrentNestingLevel - SwitchNestingLevel
-                             : CurrentNestingLevel;
+void FunctionBodyIndentModule::VisitCallExpr(
+        clang::CallExpr* Call, traversal::TraversalContext& Traversal) {
 
-        CheckSourceRangeContinuationIndent(LParenLoc.getLocWithOffset(1),
-                RParenLoc.getLocWithOffset(-1), Context,
-                Level + SwitchNestingLevel, SwitchNestingLevel);
+    auto* Context = Traversal.Context;
+    auto CurrentNestingLevel = Traversal.CurrentNestingLevel;
+    auto SwitchNestingLevel = Traversal.SwitchNestingLevel;
+    auto IsInSwitchStatement = Traversal.IsInSwitchStatement;
 
-        return true;
+    CheckStandardStatementIndentation(Call, Traversal.GetParent(), Context,
+            CurrentNestingLevel, IsInSwitchStatement, SwitchNestingLevel);
+
+    if (Traversal.GetParent().get<clang::CompoundStmt>()) {
+        CheckSourceRangeContinuationIndent(Call->getBeginLoc(),
+                Call->getEndLoc(), Context, CurrentNestingLevel,
+                SwitchNestingLevel);
     }
+}
 
-    bool TraverseWhileStmt(clang::WhileStmt* Node) {
+void FunctionBodyIndentModule::VisitBreakStmt(
+        clang::BreakStmt* Stmt, traversal::TraversalContext& Traversal) {
 
-        CheckStatementIndentation(Node->getBeginLoc(), Context,
-                CurrentNestingLevel + SwitchNestingLevel);
+    auto* Context = Traversal.Context;
+    auto CurrentNestingLevel = Traversal.CurrentNestingLevel;
+    auto SwitchNestingLevel = Traversal.SwitchNestingLevel;
+    auto IsInSwitchStatement = Traversal.IsInSwitchStatement;
 
-        bool WhileHasNoBraces =
-                !llvm::isa<clang::CompoundStmt>(Node->getBody());
+    CheckStandardStatementIndentation(Stmt, Traversal.GetParent(), Context,
+            CurrentNestingLevel, IsInSwitchStatement, SwitchNestingLevel);
+}
 
-        if (WhileHasNoBraces) {
-            CurrentNestingLevel++;
-        }
+void FunctionBodyIndentModule::VisitContinueStmt(
+        clang::ContinueStmt* Stmt, traversal::TraversalContext& Traversal) {
 
-        Base::TraverseWhileStmt(Node);
+    auto* Context = Traversal.Context;
+    auto CurrentNestingLevel = Traversal.CurrentNestingLevel;
+    auto SwitchNestingLevel = Traversal.SwitchNestingLevel;
+    auto IsInSwitchStatement = Traversal.IsInSwitchStatement;
 
-        if (WhileHasNoBraces) {
-            CurrentNestingLevel--;
-        } else {
-            // If we do have a compound statement, we also check the right curly
-            // brace
-            auto* CS = llvm::dyn_cast<clang::CompoundStmt>(Node->getBody());
-            CheckStatementIndentation(CS->getRBracLoc(), Context,
-                    CurrentNestingLevel + SwitchNestingLevel);
-        }
+    CheckStandardStatementIndentation(Stmt, Traversal.GetParent(), Context,
+            CurrentNestingLevel, IsInSwitchStatement, SwitchNestingLevel);
+}
+
+void FunctionBodyIndentModule::VisitCaseStmt(
+        clang::CaseStmt* Stmt, traversal::TraversalContext& Traversal) {
 
-        auto& SM = Context->getSourceManager();
-        auto LangOpts = Context->getLangOpts();
+    auto* Context = Traversal.Context;
+    auto CurrentNestingLevel = Traversal.CurrentNestingLevel;
+    auto SwitchNestingLevel = Traversal.SwitchNestingLevel;
 
-        // Finally, we check the condition's continuation indent
-        auto LParenLoc = whitespace::GetNextNonWhitespaceLoc(
-                Node->getWhileLoc().getLocWithOffset(5), SM);
+    CheckStatementIndentation(Stmt->getBeginLoc(), Context,
+            CurrentNestingLevel + SwitchNestingLevel - 1);
 
-        auto RParenLoc = whitespace::GetPreviousNonWhitespaceLoc(
-                Node->getBody()->getBeginLoc().getLocWithOffset(-1), SM);
+    if (llvm::isa<clang::CompoundStmt>(Stmt->getSubStmt())) {
+        CheckStatementIndentation(Stmt->getEndLoc(), Context,
+                CurrentNestingLevel + SwitchNestingLevel - 1);
+    }
+}
 
-        auto Level = SwitchNestingLevel > 0
-                             ? CurrentNestingLevel - SwitchNestingLevel
-                             : CurrentNestingLevel;
+void FunctionBodyIndentModule::VisitDefaultStmt(
+        clang::DefaultStmt* Stmt, traversal::TraversalContext& Traversal) {
 
-        CheckSourceRangeContinuationIndent(LParenLoc.getLocWithOffset(1),
-                RParenLoc.getLocWithOffset(-1), Context,
-                Level + SwitchNestingLevel, SwitchNestingLevel);
+    auto* Context = Traversal.Context;
+    auto CurrentNestingLevel = Traversal.CurrentNestingLevel;
+    auto SwitchNestingLevel = Traversal.SwitchNestingLevel;
 
-        return true;
+    CheckStatementIndentation(Stmt->getBeginLoc(), Context,
+            CurrentNestingLevel + SwitchNestingLevel - 1);
+
+    if (llvm::isa<clang::CompoundStmt>(Stmt->getSubStmt())) {
+        CheckStatementIndentation(Stmt->getEndLoc(), Context,
+                CurrentNestingLevel + SwitchNestingLevel - 1);
     }
+}
 
-    bool TraverseIfStmt(clang::IfStmt* Node) {
+void FunctionBodyIndentModule::VisitCompoundStmt(
+        clang::CompoundStmt* Stmt, traversal::TraversalContext& Traversal) {
 
-        // We only want to check the indentation of the
-        // 'if' token if it is not part of an else branch
-        auto ParentNodes = Context->getParents(*Node);
-        const auto* ParentIfStmt = ParentNodes[0].get<clang::IfStmt>();
-        auto IsElseBranch = false;
+    auto* Context = Traversal.Context;
+    auto& PP = Traversal.PP;
+    auto CurrentNestingLevel = Traversal.CurrentNestingLevel;
+    auto SwitchNestingLevel = Traversal.SwitchNestingLevel;
 
-        if (ParentIfStmt) {
-            if (ParentIfStmt->getThen()->getBeginLoc() == Node->getBeginLoc()) {
-                // We are the if branch of our parent
-                CheckStatementIndentation(Node->getBeginLoc(), Context,
-                        CurrentNestingLevel + SwitchNestingLevel);
-            } else if (ParentIfStmt->hasElseStorage()) {
-                IsElseBranch = true;
-            }
-        } else {
-            // We are the top of an if/else-if chain
-            CheckStatementIndentation(Node->getBeginLoc(), Context,
-                    CurrentNestingLevel + SwitchNestingLevel);
+    // Here we need to check macro indentation.
+    // Since we cannot match a macro directly (as it is
+    // replaced by its content), we find it via the
+    // children of the compound statement.
+    for (auto* Child : Stmt->children()) {
+        if (StatementIsALoopConstruct(Child) ||
+                StatementIsAConditional(Child)) {
+            continue;
         }
+        if (PP.isAtStartOfMacroExpansion(Child->getBeginLoc())) {
 
-        // We only check the 'else' token's indentation if the 'then'
-        // statement's body is not a compound statement and the statement has an
-        // else component
-        if (!llvm::isa<clang::CompoundStmt>(Node->getThen()) &&
-                Node->hasElseStorage()) {
-            if (IsElseBranch) {
-                CheckStatementIndentation(Node->getElseLoc(), Context,
-                        CurrentNestingLevel + SwitchNestingLevel - 1);
-            } else {
-                CheckStatementIndentation(Node->getElseLoc(), Context,
-                        CurrentNestingLevel + SwitchNestingLevel);
-            }
+            auto TrueLocation = Context->getSourceManager().getFileLoc(
+                    Child->getBeginLoc());
+            CheckStatementIndentation(TrueLocation, Context,
+                    CurrentNestingLevel + SwitchNestingLevel);
+            CheckSourceRangeContinuationIndent(TrueLocation,
+                    checks::utils::GetMacroEndLocation(Child, Context, PP),
+                    Context, CurrentNestingLevel, SwitchNestingLevel);
         }
+    }
+}
 
-        // If the 'then' or 'else' components of the if statement are compound
-        // statements, we need to check the indentation of the right curly brace
-        // '}'
-        if (llvm::isa<clang::CompoundStmt>(Node->getThen())) {
-            auto* CS = llvm::dyn_cast<clang::CompoundStmt>(Node->getThen());
-            if (IsElseBranch) {
-                CheckStatementIndentation(CS->getRBracLoc(), Context,
-                        CurrentNestingLevel + SwitchNestingLevel - 1);
-            } else {
-                CheckStatementIndentation(CS->getRBracLoc(), Context,
-                        CurrentNestingLevel + SwitchNestingLevel);
-            }
-        }
-        if (Node->hasElseStorage()) {
-            if (llvm::isa<clang::CompoundStmt>(Node->getElse())) {
-                auto* CS = llvm::dyn_cast<clang::CompoundStmt>(Node->getElse());
-                if (IsElseBranch) {
-                    CheckStatementIndentation(CS->getRBracLoc(), Context,
-                            CurrentNestingLevel + SwitchNestingLevel - 1);
-                } else {
-                    CheckStatementIndentation(CS->getRBracLoc(), Context,
-                            CurrentNestingLevel + SwitchNestingLevel);
-                }
-            }
-        }
-        auto& SM = Context->getSourceManager();
-        auto LangOpts = Context->getLangOpts();
+void FunctionBodyIndentModule::VisitRecordDecl(
+        clang::RecordDecl* Decl, traversal::TraversalContext& Traversal) {
 
-        // We also need to check the if condition's continuation indent
-        auto LParenLoc = whitespace::GetNextNonWhitespaceLoc(
-                Node->getIfLoc().getLocWithOffset(2), SM);
+    auto* Context = Traversal.Context;
+    auto& PP = Traversal.PP;
+    auto CurrentNestingLevel = Traversal.CurrentNestingLevel;
+    auto SwitchNestingLevel = Traversal.SwitchNestingLevel;
 
-        auto RParenLoc = whitespace::GetPreviousNonWhitespaceLoc(
-                Node->getThen()->getBeginLoc().getLocWithOffset(-1), SM);
+    CheckStructUnionBodyIndentation(
+            Decl, Context, PP, CurrentNestingLevel, SwitchNestingLevel);
+}
 
-        auto Level = SwitchNestingLevel > 0
-                             ? CurrentNestingLevel - SwitchNestingLevel
-                             : CurrentNestingLevel;
-        if (IsElseBranch) {
-            CheckSourceRangeContinuationIndent(LParenLoc.getLocWithOffset(1),
-                    RParenLoc.getLocWithOffset(-1), Context,
-                    Level + SwitchNestingLevel - 1, SwitchNestingLevel);
-        } else {
-            CheckSourceRangeContinuationIndent(LParenLoc.getLocWithOffset(1),
-                    RParenLoc.getLocWithOffset(-1), Context,
-                    Level + SwitchNestingLevel, SwitchNestingLevel);
-        }
+void FunctionBodyIndentModule::VisitEnumDecl(
+        clang::EnumDecl* Decl, traversal::TraversalContext& Traversal) {
 
-        if (!IsElseBranch) {
-            CurrentNestingLevel++;
-        }
+    auto* Context = Traversal.Context;
+    auto CurrentNestingLevel = Traversal.CurrentNestingLevel;
+    auto SwitchNestingLevel = Traversal.SwitchNestingLevel;
 
-        Base::TraverseIfStmt(Node);
+    CheckEnumBodyIndentation(
+            Decl, Context, CurrentNestingLevel, SwitchNestingLevel);
+}
 
-        if (!IsElseBranch) {
-            CurrentNestingLevel--;
-        }
+void FunctionBodyIndentModule::VisitTypedefDecl(
+        clang::TypedefDecl* Decl, traversal::TraversalContext& Traversal) {
 
-        return true;
-    }
+    auto* Context = Traversal.Context;
+    auto CurrentNestingLevel = Traversal.CurrentNestingLevel;
+    auto SwitchNestingLevel = Traversal.SwitchNestingLevel;
 
-    unsigned CurrentNestingLevel = 0;
-    unsigned SwitchNestingLevel = 0;
-    bool IsInSwitchStatement = false;
-    clang::ASTContext* Context;
-    clang::Preprocessor& PP;
-};
+    CheckTypedefIndentation(
+            Decl, Context, CurrentNestingLevel, SwitchNestingLevel);
+}
 
 void FunctionBodyIndentChecker::run(const MatchFinder::MatchResult& Result) {
 
@@ -676,9 +675,8 @@ void FunctionBodyIndentChecker::run(const MatchFinder::MatchResult& Result) {
             return;
         }
 
+        // The body itself is checked by the FunctionBodyChecker
         CheckStatementIndentation(Node->getEndLoc(), Result.Context, 0);
-        FunctionASTVisitor Visitor(Result.Context, PP);
-        Visitor.TraverseDecl(const_cast<clang::FunctionDecl*>(Node));
     }
 }
 
@@ -687,12 +685,11 @@ void FunctionBodyIndentChecker::run(const MatchFinder::MatchResult& Result) {
 // its direct surroundings (i.e. unary/binary operators,
 // break/continue statements, function calls etc.)
 static void CheckStandardStatementIndentation(clang::Stmt* Stmt,
-        clang::ASTContext* Context, unsigned int NestingLevel,
-        bool IsInSwitchStatement, unsigned int SwitchNestingLevel) {
-
-    auto ParentNodes = Context->getParents(*Stmt);
+        const clang::DynTypedNode& Parent, clang::ASTContext* Context,
+        unsigned int NestingLevel, bool IsInSwitchStatement,
+        unsigned int SwitchNestingLevel) {
 
-    if (ParentNodes[0].get<clang::CompoundStmt>()) {
+    if (Parent.get<clang::CompoundStmt>()) {
         if (IsInSwitchStatement) {
             CheckStatementIndentation(Stmt->getBeginLoc(), Context,
                     NestingLevel + SwitchNestingLevel);
@@ -700,14 +697,14 @@ static void CheckStandardStatementIndentation(clang::Stmt* Stmt,
             CheckStatementIndentation(
                     Stmt->getBeginLoc(), Context, NestingLevel);
         }
-    } else if (ParentNodes[0].get<clang::CaseStmt>() ||
-               ParentNodes[0].get<clang::DefaultStmt>()) {
+    } else if (Parent.get<clang::CaseStmt>() ||
+               Parent.get<clang::DefaultStmt>()) {
         
         if (llvm::isa<clang::UnaryOperator>(Stmt)) { 
             // We need to check for unary operators in case statements
             // since they are incorrectly picked up in indent checks
             //& SM = Context->getSourceManager();
-            auto CaseStmt = ParentNodes[0].get<clang::CaseStmt>();
+            auto CaseStmt = Parent.get<clang::CaseStmt>();
             if (CaseStmt) {
                 auto& SM = Context->getSourceManager();
                 auto CaseLineNo = SM.getExpansionLineNumber(CaseStmt->getBeginLoc());
@@ -4,6 +4,8 @@
 #ifndef LLVM_CLANG_TOOLS_EXTRA_NETT_CHECKS_INDENTATION_FUNCTIONBODYINDENTCHECK_HPP
 #define LLVM_CLANG_TOOLS_EXTRA_NETT_CHECKS_INDENTATION_FUNCTIONBODYINDENTCHECK_HPP
 
+#include "../traversal/FunctionTraversal.hpp"
+
 #include "clang/ASTMatchers/ASTMatchFinder.h"
 
 namespace nett {
@@ -13,14 +15,68 @@ namespace indentation {
 class FunctionBodyIndentChecker
     : public clang::ast_matchers::MatchFinder::MatchCallback {
     public:
-    FunctionBodyIndentChecker(clang::Preprocessor& PP) : PP(PP) {
-    }
-
     virtual void run(
             const clang::ast_matchers::MatchFinder::MatchResult& Result) override;
+};
+
+// Checks the indentation of the statements within a function's body as part
+// of a FunctionTraversal.
+class FunctionBodyIndentModule : public traversal::FunctionTraversalModule {
+    public:
+    bool BeginFunction(const clang::FunctionDecl* Node,
+            traversal::TraversalContext& Traversal);
+
+    void EnterIfStmt(
+            clang::IfStmt* Node, traversal::TraversalContext& Traversal);
+    void EnterForStmt(
+            clang::ForStmt* Node, traversal::TraversalContext& Traversal);
+    void LeaveForStmt(
+            clang::ForStmt* Node, traversal::TraversalContext& Traversal);
+    void EnterDoStmt(
+            clang::DoStmt* Node, traversal::TraversalContext& Traversal);
+    void LeaveDoStmt(
+            clang::DoStmt* Node, traversal::TraversalContext& Traversal);
+    void EnterWhileStmt(
+            clang::WhileStmt* Node, traversal::TraversalContext& Traversal);
+    void LeaveWhileStmt(
+            clang::WhileStmt* Node, traversal::TraversalContext& Traversal);
 
-    private:
-    clang::Preprocessor& PP;
+    void VisitIfStmt(
+            clang::IfStmt* Stmt, traversal::TraversalContext& Traversal);
+    void VisitWhileStmt(
+            clang::WhileStmt* Stmt, traversal::TraversalContext& Traversal);
+    void VisitForStmt(
+            clang::ForStmt* Stmt, traversal::TraversalContext& Traversal);
+    void VisitDoStmt(
+            clang::DoStmt* Stmt, traversal::TraversalContext& Traversal);
+    void VisitSwitchStmt(
+            clang::SwitchStmt* Stmt, traversal::TraversalContext& Traversal);
+    void VisitVarDecl(
+            clang::VarDecl* Decl, traversal::TraversalContext& Traversal);
+    void VisitReturnStmt(
+            clang::ReturnStmt* Stmt, traversal::TraversalContext& Traversal);
+    void VisitBinaryOperator(
+            clang::BinaryOperator* Op, traversal::TraversalContext& Traversal);
+    void VisitUnaryOperator(
+            clang::UnaryOperator* Op, traversal::TraversalContext& Traversal);
+    void VisitCallExpr(
+            clang::CallExpr* Call, traversal::TraversalContext& Traversal);
+    void VisitBreakStmt(
+            clang::BreakStmt* Stmt, traversal::TraversalContext& Traversal);
+    void VisitContinueStmt(
+            clang::ContinueStmt* Stmt, traversal::TraversalContext& Traversal);
+    void VisitCaseStmt(
+            clang::CaseStmt* Stmt, traversal::TraversalContext& Traversal);
+    void VisitDefaultStmt(
+            clang::DefaultStmt* Stmt, traversal::TraversalContext& Traversal);
+    void VisitCompoundStmt(
+            clang::CompoundStmt* Stmt, traversal::TraversalContext& Traversal);
+    void VisitRecordDecl(
+            clang::RecordDecl* Decl, traversal::TraversalContext& Traversal);
+    void VisitEnumDecl(
+            clang::EnumDecl* Decl, traversal::TraversalContext& Traversal);
+    void VisitTypedefDecl(
+            clang::TypedefDecl* Decl, traversal::TraversalContext& Traversal);
 };
 
 }  // namespace indentation
@@ -4,6 +4,7 @@
 #include "IndentCheck.hpp"
 
 #include "../../violations/ViolationManager.hpp"
+#include "../utils/SourceIndex.hpp"
 #include "../utils/Tokens.hpp"
 #include "../whitespace/WhitespaceCheck.hpp"
 #include "GlobalVarIndentCheck.hpp"
@@ -11,7 +12,6 @@
 
 #include "clang/Lex/Lexer.h"
 
-#include <sstream>
 #include <unordered_set>
 
 namespace nett {
@@ -25,25 +25,18 @@ void CheckStatementIndentation(clang::SourceLocation Loc,
     auto& SM = Context->getSourceManager();
     auto File = SM.getFilename(Loc);
     auto LocLineNo = SM.getExpansionLineNumber(Loc);
-    auto ActualIndent = SM.getSpellingColumnNumber(Loc) - 1;
+    auto ActualIndent = utils::GetColumnNumber(Loc, SM) - 1;
 
     if (ExpectedIndent == 0) {
         ExpectedIndent = INDENT_WIDTH * NestingLevel;
     }
 
     if (ActualIndent != ExpectedIndent) {
-        std::stringstream ErrMsg;
         auto InfractedToken = checks::utils::GetTokenSourceString(
                 Loc, SM, Context->getLangOpts());
 
-        if (InfractedToken.compare("") != 0) {
-            ErrMsg << "'" << InfractedToken << "' ";
-        }
-        ErrMsg << "Expected indent of " << ExpectedIndent << " spaces, found "
-               << ActualIndent << ".";
-
-        GlobalViolationManager.AddViolation(
-                new IndentationViolation(File.str(), LocLineNo, ErrMsg.str()));
+        GlobalViolationManager.AddViolation(Violation::Indent(File.str(),
+                LocLineNo, InfractedToken, ExpectedIndent, ActualIndent));
     }
 }
 
@@ -75,13 +68,13 @@ void CheckSourceRangeContinuationIndent(clang::SourceLocation StartLoc,
         if (SM.getExpansionLineNumber(NextTokenLoc) !=
                 SM.getExpansionLineNumber(NextLineLocation)) {
             // The current line is empty
-            std::stringstream ErrMsg;
             auto File = SM.getFilename(NextLineLocation);
             auto LineNo = SM.getExpansionLineNumber(NextLineLocation);
-            ErrMsg << "Line continuations should not contain blank lines.";
+            const char* ErrMsg = "Line continuations should not contain blank "
+                                 "lines.";
 
             GlobalViolationManager.AddViolation(
-                    new WhitespaceViolation(File.str(), LineNo, ErrMsg.str()));
+                    WhitespaceViolation(File.str(), LineNo, ErrMsg));
         } else {
             if (NextTokenLoc <= EndLoc) {
                 CheckStatementIndentation(NextTokenLoc, Context,
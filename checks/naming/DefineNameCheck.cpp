@@ -6,8 +6,6 @@
 #include "../../violations/ViolationManager.hpp"
 #include "NamingStyles.hpp"
 
-#include <sstream>
-
 namespace nett {
 namespace checks {
 namespace naming {
@@ -43,15 +41,9 @@ void DefineNameChecker::EndOfMainFile() {
 
             if (!nett::naming::IdentifierFollowsNamingStyle(
                         Name, nett::naming::UPPER_SNAKE_CASE)) {
-                if (!GlobalViolationManager.NameHasBeenInfracted(Name.str())) {
-                    std::stringstream ErrMsg;
-                    ErrMsg << "'" << Name.str()
-                           << "' misnamed. #defines should be NAMED_LIKE_THIS.";
-
-                    GlobalViolationManager.AddInfractedName(Name.str());
-                    GlobalViolationManager.AddViolation(new NamingViolation(
-                            File.str(), LineNo, ErrMsg.str()));
-                }
+                GlobalViolationManager.AddNameInfraction(Name.str(),
+                        Violation::Misnamed(
+                                File.str(), LineNo, Name, NAMING_DEFINE));
             }
         }
     }
@@ -6,8 +6,6 @@
 #include "../../violations/ViolationManager.hpp"
 #include "NamingStyles.hpp"
 
-#include <sstream>
-
 using namespace clang::ast_matchers;
 
 namespace nett {
@@ -32,14 +30,9 @@ void EnumConstNameChecker::run(const MatchFinder::MatchResult& Result) {
         // Enum constants need to be UPPER_SNAKE_CASE
         if (!nett::naming::IdentifierFollowsNamingStyle(
                     Name, nett::naming::UPPER_SNAKE_CASE)) {
-            std::stringstream ErrMsg;
-
-            ErrMsg << "'" << Name.str()
-                   << "' misnamed. Enum constants should be NAMED_LIKE_THIS.";
-
             GlobalViolationManager.AddInfractedName(Name.str());
-            GlobalViolationManager.AddViolation(
-                    new NamingViolation(File.str(), LineNo, ErrMsg.str()));
+            GlobalViolationManager.AddViolation(Violation::Misnamed(
+                    File.str(), LineNo, Name, NAMING_ENUM_CONSTANT));
         }
     }
 }
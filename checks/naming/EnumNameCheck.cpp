@@ -6,8 +6,6 @@
 #include "../../violations/ViolationManager.hpp"
 #include "NamingStyles.hpp"
 
-#include <sstream>
-
 using namespace clang::ast_matchers;
 
 namespace nett {
@@ -37,16 +35,11 @@ void EnumNameChecker::run(const MatchFinder::MatchResult& Result) {
         // Enum names need to be UpperCamelCase
         if (!nett::naming::IdentifierFollowsNamingStyle(
                     Name, nett::naming::UPPER_CAMEL_CASE)) {
-            std::stringstream ErrMsg;
-
             // We only want to log the error at the enum definition
             if (Node->isCompleteDefinition()) {
-                ErrMsg << "'" << Name.str()
-                       << "' misnamed. Enums should be NamedLikeThis.";
-
                 GlobalViolationManager.AddInfractedName(Name.str());
-                GlobalViolationManager.AddViolation(
-                        new NamingViolation(File.str(), LineNo, ErrMsg.str()));
+                GlobalViolationManager.AddViolation(Violation::Misnamed(
+                        File.str(), LineNo, Name, NAMING_ENUM));
             }
         }
     }
@@ -6,8 +6,6 @@
 #include "../../violations/ViolationManager.hpp"
 #include "NamingStyles.hpp"
 
-#include <sstream>
-
 using namespace clang::ast_matchers;
 
 namespace nett {
@@ -38,16 +36,11 @@ void FuncNameChecker::run(const MatchFinder::MatchResult& Result) {
         // Function names need to be lower_snake_case
         if (!nett::naming::IdentifierFollowsNamingStyle(
                     Name, nett::naming::LOWER_SNAKE_CASE)) {
-            std::stringstream ErrMsg;
-
             // We don't need to check if a function name has already been
             // infracted since function names must be unique within a C program.
-            ErrMsg << "'" << Name.str()
-                   << "' misnamed. Functions should be named_like_this.";
-
             GlobalViolationManager.AddInfractedName(Name.str());
-            GlobalViolationManager.AddViolation(
-                    new NamingViolation(File.str(), LineNo, ErrMsg.str()));
+            GlobalViolationManager.AddViolation(Violation::Misnamed(
+                    File.str(), LineNo, Name, NAMING_FUNCTION));
         }
     }
 }
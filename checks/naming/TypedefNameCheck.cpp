@@ -6,8 +6,6 @@
 #include "../../violations/ViolationManager.hpp"
 #include "NamingStyles.hpp"
 
-#include <sstream>
-
 using namespace clang::ast_matchers;
 
 namespace nett {
@@ -32,13 +30,9 @@ void TypedefNameChecker::run(const MatchFinder::MatchResult& Result) {
         // Typedef names need to be UpperCamelCase
         if (!nett::naming::IdentifierFollowsNamingStyle(
                     Name, nett::naming::UPPER_CAMEL_CASE)) {
-            std::stringstream ErrMsg;
-            ErrMsg << "'" << Name.str()
-                   << "' misnamed. Types should be NamedLikeThis.";
-
             GlobalViolationManager.AddInfractedName(Name.str());
-            GlobalViolationManager.AddViolation(
-                    new NamingViolation(File.str(), LineNo, ErrMsg.str()));
+            GlobalViolationManager.AddViolation(Violation::Misnamed(
+                    File.str(), LineNo, Name, NAMING_TYPE));
         }
     }
 }
@@ -7,8 +7,6 @@
 #include "Hungarian.hpp"
 #include "NamingStyles.hpp"
 
-#include <sstream>
-
 using namespace clang::ast_matchers;
 
 namespace nett {
@@ -38,40 +36,20 @@ void VarNameChecker::run(const MatchFinder::MatchResult& Result) {
         // Variables need to be lowerCamelCase
         if (!nett::naming::IdentifierFollowsNamingStyle(
                     Name, nett::naming::LOWER_CAMEL_CASE)) {
-            std::stringstream ErrMsg;
-
-            if (!GlobalViolationManager.NameHasBeenInfracted(Name.str())) {
-                ErrMsg << "'" << Name.str()
-                       << "' misnamed. Variables should be namedLikeThis.";
-
-                GlobalViolationManager.AddInfractedName(Name.str());
-                GlobalViolationManager.AddViolation(
-                        new NamingViolation(File.str(), LineNo, ErrMsg.str()));
-            } else if (GlobalViolationManager.WillOutputToFile()) {
-                ErrMsg << "'" << Name.str()
-                       << "' misnamed but has already been infracted.";
-                GlobalViolationManager.AddViolation(
-                        new NoteViolation(File.str(), LineNo, ErrMsg.str()));
-            }
+            GlobalViolationManager.AddNameInfraction(Name.str(),
+                    Violation::Misnamed(
+                            File.str(), LineNo, Name, NAMING_VARIABLE),
+                    Violation::AlreadyInfracted(
+                            File.str(), LineNo, Name, true));
         }
 
         // Variable names should not follow Hungarian notation
         if (nett::naming::IsHungarianVarName(Name, Node->getType())) {
-            std::stringstream ErrMsg;
-
-            if (!GlobalViolationManager.NameHasBeenInfracted(Name.str())) {
-                ErrMsg << "'" << Name.str()
-                       << "' misnamed. Hungarian notation is not to be used.";
-
-                GlobalViolationManager.AddInfractedName(Name.str());
-                GlobalViolationManager.AddViolation(
-                        new NamingViolation(File.str(), LineNo, ErrMsg.str()));
-            } else if (GlobalViolationManager.WillOutputToFile()) {
-                ErrMsg << "'" << Name.str()
-                       << "' misnamed but has already been infracted.";
-                GlobalViolationManager.AddViolation(
-                        new NoteViolation(File.str(), LineNo, ErrMsg.str()));
-            }
+            GlobalViolationManager.AddNameInfraction(Name.str(),
+                    Violation::Misnamed(
+                            File.str(), LineNo, Name, NAMING_HUNGARIAN),
+                    Violation::AlreadyInfracted(
+                            File.str(), LineNo, Name, true));
         }
     }
 }
@@ -5,8 +5,6 @@
 
 #include "../../violations/ViolationManager.hpp"
 
-#include <sstream>
-
 using namespace clang::ast_matchers;
 
 namespace nett {
@@ -29,11 +27,11 @@ void FuncDefinitionInHeaderChecker::run(
         auto LineNo = SM.getExpansionLineNumber(Loc);
 
         if (Node->isThisDeclarationADefinition() && File.endswith(".h")) {
-            std::stringstream ErrMsg;
-            ErrMsg << "Headers should not contain function definitions.";
+            const char* ErrMsg = "Headers should not contain function "
+                                 "definitions.";
 
             GlobalViolationManager.AddViolation(
-                    new OverallViolation(File.str(), LineNo, ErrMsg.str()));
+                    OverallViolation(File.str(), LineNo, ErrMsg));
         }
     }
 }
@@ -5,8 +5,6 @@
 
 #include "../../violations/ViolationManager.hpp"
 
-#include <sstream>
-
 using namespace clang::ast_matchers;
 
 namespace nett {
@@ -39,14 +37,9 @@ void FuncLengthChecker::run(const MatchFinder::MatchResult& Result) {
                     auto FunctionLength = EndLine - StartLine;
 
                     if (FunctionLength > MAX_FUNCTION_LENGTH) {
-                        std::stringstream ErrMsg;
-                        ErrMsg << "Function length of " << FunctionLength
-                               << " is over the maximum of "
-                               << MAX_FUNCTION_LENGTH << ".";
-
                         GlobalViolationManager.AddViolation(
-                                new OverallViolation(
-                                        File.str(), LineNo, ErrMsg.str()));
+                                Violation::FunctionLength(File.str(), LineNo,
+                                        FunctionLength, MAX_FUNCTION_LENGTH));
                     }
                 }
             }
@@ -5,8 +5,6 @@
 
 #include "../../violations/ViolationManager.hpp"
 
-#include <sstream>
-
 namespace nett {
 namespace checks {
 namespace overall {
@@ -22,11 +20,10 @@ void KeywordRedefChecker::MacroDefined(
         auto LineNo = SM.getExpansionLineNumber(Loc);
 
         if (MacroNameTok.getIdentifierInfo()->isKeyword(LangOpts)) {
-            std::stringstream ErrMsg;
-            ErrMsg << "Do not #define a keyword to something else.";
+            const char* ErrMsg = "Do not #define a keyword to something else.";
 
             GlobalViolationManager.AddViolation(
-                    new OverallViolation(File.str(), LineNo, ErrMsg.str()));
+                    OverallViolation(File.str(), LineNo, ErrMsg));
         }
     }
 }
@@ -0,0 +1,49 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#include "FunctionBodyCheck.hpp"
+
+#include "../../stats/Counters.hpp"
+#include "../braces/FunctionBodyBracesCheck.hpp"
+#include "../indentation/FunctionBodyIndentCheck.hpp"
+#include "../whitespace/FunctionBodyWhitespaceCheck.hpp"
+#include "../whitespace/StatementSemicolonWhitespaceCheck.hpp"
+#include "FunctionTraversal.hpp"
+
+using namespace clang::ast_matchers;
+
+namespace nett {
+namespace checks {
+namespace traversal {
+
+// The modules run over each function body. A new body check only needs
+// to be added here.
+using FunctionBodyTraversal =
+        FunctionTraversal<braces::FunctionBodyBracesModule,
+                whitespace::FunctionBodyWhitespaceModule,
+                whitespace::StatementSemicolonWhitespaceModule,
+                indentation::FunctionBodyIndentModule>;
+
+void FunctionBodyChecker::run(const MatchFinder::MatchResult& Result) {
+
+    if (const auto* Node =
+                    Result.Nodes.getNodeAs<clang::FunctionDecl>("funcDecl")) {
+
+        if (!Node->isThisDeclarationADefinition()) {
+            return;
+        }
+
+        FunctionBodyTraversal Traversal(Result.Context, PP);
+        Traversal.TraverseFunction(const_cast<clang::FunctionDecl*>(Node));
+        ParentLookups += Traversal.GetParentLookups();
+    }
+}
+
+void FunctionBodyChecker::onEndOfTranslationUnit() {
+    stats::AddToCounter(stats::COUNTER_PARENT_STACK_LOOKUPS, ParentLookups);
+    ParentLookups = 0;
+}
+
+}  // namespace traversal
+}  // namespace checks
+}  // namespace nett
@@ -0,0 +1,38 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#ifndef LLVM_CLANG_TOOLS_EXTRA_NETT_CHECKS_TRAVERSAL_FUNCTIONBODYCHECK_HPP
+#define LLVM_CLANG_TOOLS_EXTRA_NETT_CHECKS_TRAVERSAL_FUNCTIONBODYCHECK_HPP
+
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+
+#include <cstdint>
+
+namespace nett {
+namespace checks {
+namespace traversal {
+
+// Runs every check on the statements within a function's body (braces,
+// whitespace, semicolons and indentation) in a single walk over the body.
+class FunctionBodyChecker
+    : public clang::ast_matchers::MatchFinder::MatchCallback {
+    public:
+    FunctionBodyChecker(clang::Preprocessor& PP) : PP(PP), ParentLookups(0) {
+    }
+
+    virtual void run(
+            const clang::ast_matchers::MatchFinder::MatchResult& Result) override;
+
+    // Adds the parent lookups made while checking the file to the counters.
+    virtual void onEndOfTranslationUnit() override;
+
+    private:
+    clang::Preprocessor& PP;
+    uint64_t ParentLookups;
+};
+
+}  // namespace traversal
+}  // namespace checks
+}  // namespace nett
+
+#endif
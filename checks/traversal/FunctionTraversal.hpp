@@ -0,0 +1,391 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#ifndef LLVM_CLANG_TOOLS_EXTRA_NETT_CHECKS_TRAVERSAL_FUNCTIONTRAVERSAL_HPP
+#define LLVM_CLANG_TOOLS_EXTRA_NETT_CHECKS_TRAVERSAL_FUNCTIONTRAVERSAL_HPP
+
+#include "clang/AST/ASTTypeTraits.h"
+#include "clang/AST/RecursiveASTVisitor.h"
+#include "clang/Lex/Preprocessor.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace nett {
+namespace checks {
+namespace traversal {
+
+// The state of a function traversal shared by all of the modules. The nesting
+// levels are those used by the indentation checks: the body of a function is
+// at level 1, and each switch statement adds a level for its cases.
+struct TraversalContext {
+    clang::ASTContext* Context;
+    clang::Preprocessor& PP;
+    unsigned CurrentNestingLevel;
+    unsigned SwitchNestingLevel;
+    bool IsInSwitchStatement;
+
+    // The nodes from the function down to (and including) the node
+    // currently being visited.
+    std::vector<clang::DynTypedNode> Ancestors;
+
+    // The number of calls to GetParent, which the caller adds to the
+    // counters once it is done.
+    mutable uint64_t ParentLookups;
+
+    // Returns the parent of the node currently being visited, or an empty
+    // node if there is none. A depth of 1 gives the grandparent and so on.
+    // Unlike ASTContext::getParents, this never builds the parent map.
+    clang::DynTypedNode GetParent(unsigned Depth = 0) const {
+        ParentLookups++;
+
+        if (Ancestors.size() < Depth + 2) {
+            return clang::DynTypedNode();
+        }
+        return Ancestors[Ancestors.size() - Depth - 2];
+    }
+};
+
+// The base for the checks run by a FunctionTraversal. A module hides the
+// methods for the nodes it is interested in. Nothing is virtual: the traversal
+// knows the type of each of its modules, so every call is resolved (and can
+// be inlined) at compile time.
+class FunctionTraversalModule {
+    public:
+    // Called before a function is traversed. Returns false if the module
+    // should not check the function.
+    bool BeginFunction(
+            const clang::FunctionDecl* Node, TraversalContext& Traversal) {
+        return true;
+    }
+
+    // Called before and after the children of a statement are traversed. The
+    // nesting levels are those of the statement itself.
+    void EnterIfStmt(clang::IfStmt* Stmt, TraversalContext& Traversal) {
+    }
+    void EnterForStmt(clang::ForStmt* Stmt, TraversalContext& Traversal) {
+    }
+    void LeaveForStmt(clang::ForStmt* Stmt, TraversalContext& Traversal) {
+    }
+    void EnterDoStmt(clang::DoStmt* Stmt, TraversalContext& Traversal) {
+    }
+    void LeaveDoStmt(clang::DoStmt* Stmt, TraversalContext& Traversal) {
+    }
+    void EnterWhileStmt(clang::WhileStmt* Stmt, TraversalContext& Traversal) {
+    }
+    void LeaveWhileStmt(clang::WhileStmt* Stmt, TraversalContext& Traversal) {
+    }
+
+    // Called for each node in the function, in the same way as the
+    // Visit methods of a RecursiveASTVisitor.
+    void VisitIfStmt(clang::IfStmt* Stmt, TraversalContext& Traversal) {
+    }
+    void VisitForStmt(clang::ForStmt* Stmt, TraversalContext& Traversal) {
+    }
+    void VisitDoStmt(clang::DoStmt* Stmt, TraversalContext& Traversal) {
+    }
+    void VisitWhileStmt(clang::WhileStmt* Stmt, TraversalContext& Traversal) {
+    }
+    void VisitSwitchStmt(clang::SwitchStmt* Stmt, TraversalContext& Traversal) {
+    }
+    void VisitCaseStmt(clang::CaseStmt* Stmt, TraversalContext& Traversal) {
+    }
+    void VisitDefaultStmt(
+            clang::DefaultStmt* Stmt, TraversalContext& Traversal) {
+    }
+    void VisitCompoundStmt(
+            clang::CompoundStmt* Stmt, TraversalContext& Traversal) {
+    }
+    void VisitReturnStmt(clang::ReturnStmt* Stmt, TraversalContext& Traversal) {
+    }
+    void VisitBreakStmt(clang::BreakStmt* Stmt, TraversalContext& Traversal) {
+    }
+    void VisitContinueStmt(
+            clang::ContinueStmt* Stmt, TraversalContext& Traversal) {
+    }
+    void VisitBinaryOperator(
+            clang::BinaryOperator* Op, TraversalContext& Traversal) {
+    }
+    void VisitUnaryOperator(
+            clang::UnaryOperator* Op, TraversalContext& Traversal) {
+    }
+    void VisitCallExpr(clang::CallExpr* Call, TraversalContext& Traversal) {
+    }
+    void VisitVarDecl(clang::VarDecl* Decl, TraversalContext& Traversal) {
+    }
+    void VisitRecordDecl(clang::RecordDecl* Decl, TraversalContext& Traversal) {
+    }
+    void VisitEnumDecl(clang::EnumDecl* Decl, TraversalContext& Traversal) {
+    }
+    void VisitTypedefDecl(
+            clang::TypedefDecl* Decl, TraversalContext& Traversal) {
+    }
+};
+
+// Forwards a Visit method of the RecursiveASTVisitor to each of the modules.
+#define NETT_TRAVERSAL_VISIT(NodeType, Node)                                   \
+    bool Visit##NodeType(clang::NodeType* Node) {                              \
+        Dispatch([this, Node](auto& Module) {                                  \
+            Module.Visit##NodeType(Node, State);                               \
+        });                                                                    \
+        return true;                                                           \
+    }
+
+// Walks a function body once, passing every node to each of the given check
+// modules and keeping track of the nesting of statements on their behalf.
+// Adding a module to the list adds no extra walk over the function.
+template <typename... Modules>
+class FunctionTraversal
+    : public clang::RecursiveASTVisitor<FunctionTraversal<Modules...>> {
+    using Base = clang::RecursiveASTVisitor<FunctionTraversal<Modules...>>;
+
+    public:
+    explicit FunctionTraversal(
+            clang::ASTContext* Context, clang::Preprocessor& PP)
+        : State{Context, PP, 0, 0, false, {}, 0} {
+    }
+
+    // Traverses the given function definition with the modules which want
+    // to check it.
+    void TraverseFunction(clang::FunctionDecl* Node) {
+        CheckFunction(Node, std::index_sequence_for<Modules...>());
+
+        if (std::find(Active.begin(), Active.end(), true) != Active.end()) {
+            TraverseDecl(Node);
+        }
+    }
+
+    // Returns the number of parent lookups made by the modules so far.
+    uint64_t GetParentLookups(void) const {
+        return State.ParentLookups;
+    }
+
+    // The parent stack is kept up to date as statements and declarations
+    // are entered and left.
+    bool dataTraverseStmtPre(clang::Stmt* Node) {
+        State.Ancestors.push_back(clang::DynTypedNode::create(*Node));
+        return true;
+    }
+
+    bool dataTraverseStmtPost(clang::Stmt* Node) {
+        State.Ancestors.pop_back();
+        return true;
+    }
+
+    bool TraverseDecl(clang::Decl* Node) {
+        if (!Node) {
+            return true;
+        }
+
+        State.Ancestors.push_back(clang::DynTypedNode::create(*Node));
+        bool Result = Base::TraverseDecl(Node);
+        State.Ancestors.pop_back();
+
+        return Result;
+    }
+
+    NETT_TRAVERSAL_VISIT(IfStmt, Stmt)
+    NETT_TRAVERSAL_VISIT(ForStmt, Stmt)
+    NETT_TRAVERSAL_VISIT(DoStmt, Stmt)
+    NETT_TRAVERSAL_VISIT(WhileStmt, Stmt)
+    NETT_TRAVERSAL_VISIT(SwitchStmt, Stmt)
+    NETT_TRAVERSAL_VISIT(CaseStmt, Stmt)
+    NETT_TRAVERSAL_VISIT(DefaultStmt, Stmt)
+    NETT_TRAVERSAL_VISIT(CompoundStmt, Stmt)
+    NETT_TRAVERSAL_VISIT(ReturnStmt, Stmt)
+    NETT_TRAVERSAL_VISIT(BreakStmt, Stmt)
+    NETT_TRAVERSAL_VISIT(ContinueStmt, Stmt)
+    NETT_TRAVERSAL_VISIT(BinaryOperator, Op)
+    NETT_TRAVERSAL_VISIT(UnaryOperator, Op)
+    NETT_TRAVERSAL_VISIT(CallExpr, Call)
+    NETT_TRAVERSAL_VISIT(VarDecl, Decl)
+    NETT_TRAVERSAL_VISIT(RecordDecl, Decl)
+    NETT_TRAVERSAL_VISIT(EnumDecl, Decl)
+    NETT_TRAVERSAL_VISIT(TypedefDecl, Decl)
+
+    bool TraverseCompoundStmt(clang::CompoundStmt* Node) {
+
+        // The bodies of case and if statements are already accounted for
+        // by the statements themselves
+        auto Parent = State.GetParent();
+        bool IsNested = !Parent.get<clang::CaseStmt>() &&
+                        !Parent.get<clang::IfStmt>();
+
+        if (IsNested) {
+            ++State.CurrentNestingLevel;
+        }
+
+        Base::TraverseCompoundStmt(Node);
+
+        if (IsNested) {
+            --State.CurrentNestingLevel;
+        }
+
+        return true;
+    }
+
+    bool TraverseSwitchStmt(clang::SwitchStmt* Node) {
+        bool SwitchHasNoBraces =
+                !llvm::isa<clang::CompoundStmt>(Node->getBody());
+
+        ++State.SwitchNestingLevel;
+        State.IsInSwitchStatement = true;
+
+        if (SwitchHasNoBraces) {
+            State.CurrentNestingLevel++;
+        }
+
+        Base::TraverseSwitchStmt(Node);
+
+        --State.SwitchNestingLevel;
+        if (State.SwitchNestingLevel == 0) {
+            State.IsInSwitchStatement = false;
+        }
+        if (SwitchHasNoBraces) {
+            State.CurrentNestingLevel--;
+        }
+
+        return true;
+    }
+
+    bool TraverseForStmt(clang::ForStmt* Node) {
+        Dispatch([this, Node](auto& Module) {
+            Module.EnterForStmt(Node, State);
+        });
+
+        // A body with braces is nested by the compound statement
+        bool ForHasNoBraces =
+                !llvm::isa<clang::CompoundStmt>(Node->getBody());
+
+        if (ForHasNoBraces) {
+            State.CurrentNestingLevel++;
+        }
+
+        Base::TraverseForStmt(Node);
+
+        if (ForHasNoBraces) {
+            State.CurrentNestingLevel--;
+        }
+
+        Dispatch([this, Node](auto& Module) {
+            Module.LeaveForStmt(Node, State);
+        });
+        return true;
+    }
+
+    bool TraverseDoStmt(clang::DoStmt* Node) {
+        Dispatch([this, Node](auto& Module) {
+            Module.EnterDoStmt(Node, State);
+        });
+
+        // A body with braces is nested by the compound statement
+        bool DoHasNoBraces =
+                !llvm::isa<clang::CompoundStmt>(Node->getBody());
+
+        if (DoHasNoBraces) {
+            State.CurrentNestingLevel++;
+        }
+
+        Base::TraverseDoStmt(Node);
+
+        if (DoHasNoBraces) {
+            State.CurrentNestingLevel--;
+        }
+
+        Dispatch([this, Node](auto& Module) {
+            Module.LeaveDoStmt(Node, State);
+        });
+        return true;
+    }
+
+    bool TraverseWhileStmt(clang::WhileStmt* Node) {
+        Dispatch([this, Node](auto& Module) {
+            Module.EnterWhileStmt(Node, State);
+        });
+
+        // A body with braces is nested by the compound statement
+        bool WhileHasNoBraces =
+                !llvm::isa<clang::CompoundStmt>(Node->getBody());
+
+        if (WhileHasNoBraces) {
+            State.CurrentNestingLevel++;
+        }
+
+        Base::TraverseWhileStmt(Node);
+
+        if (WhileHasNoBraces) {
+            State.CurrentNestingLevel--;
+        }
+
+        Dispatch([this, Node](auto& Module) {
+            Module.LeaveWhileStmt(Node, State);
+        });
+        return true;
+    }
+
+    bool TraverseIfStmt(clang::IfStmt* Node) {
+        Dispatch([this, Node](auto& Module) {
+            Module.EnterIfStmt(Node, State);
+        });
+
+        // An 'else if' is at the same level as the 'if' it belongs to
+        const auto* ParentIfStmt = State.GetParent().get<clang::IfStmt>();
+        bool IsElseBranch = ParentIfStmt &&
+                            ParentIfStmt->getThen()->getBeginLoc() !=
+                                    Node->getBeginLoc() &&
+                            ParentIfStmt->hasElseStorage();
+
+        if (!IsElseBranch) {
+            State.CurrentNestingLevel++;
+        }
+
+        Base::TraverseIfStmt(Node);
+
+        if (!IsElseBranch) {
+            State.CurrentNestingLevel--;
+        }
+
+        return true;
+    }
+
+    private:
+    // Calls the given function for each module checking the current function.
+    template <typename Function>
+    void Dispatch(Function&& Call) {
+        DispatchTo(Call, std::index_sequence_for<Modules...>());
+    }
+
+    template <typename Function, size_t... Indices>
+    void DispatchTo(Function& Call, std::index_sequence<Indices...>) {
+        (void)std::initializer_list<int>{(Active[Indices]
+                        ? (Call(std::get<Indices>(Checks)), 0)
+                        : 0)...};
+    }
+
+    template <size_t... Indices>
+    void CheckFunction(
+            clang::FunctionDecl* Node, std::index_sequence<Indices...>) {
+        (void)std::initializer_list<int>{
+                (Active[Indices] =
+                                std::get<Indices>(Checks).BeginFunction(
+                                        Node, State),
+                        0)...};
+    }
+
+    TraversalContext State;
+    std::tuple<Modules...> Checks;
+    std::array<bool, sizeof...(Modules)> Active;
+};
+
+#undef NETT_TRAVERSAL_VISIT
+
+}  // namespace traversal
+}  // namespace checks
+}  // namespace nett
+
+#endif
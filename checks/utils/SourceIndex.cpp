@@ -0,0 +1,60 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#include "SourceIndex.hpp"
+
+#include "../../input/SourceIndex.hpp"
+
+#include "clang/Lex/Lexer.h"
+
+namespace nett {
+namespace checks {
+namespace utils {
+
+// Returns the line index of the file containing the given spelling
+// location, or nullptr if it has none.
+static const input::LineIndex* GetLineIndex(
+        clang::SourceLocation Loc, const clang::SourceManager& SM) {
+    const auto* Index =
+            input::GlobalSourceIndexManager->GetIndex(SM.getFilename(Loc));
+    return Index ? &Index->Lines : nullptr;
+}
+
+unsigned GetColumnNumber(
+        clang::SourceLocation Loc, const clang::SourceManager& SM) {
+
+    Loc = SM.getSpellingLoc(Loc);
+    if (const auto* Lines = GetLineIndex(Loc, SM)) {
+        return Lines->GetColumnNumber(SM.getFileOffset(Loc));
+    }
+    return SM.getSpellingColumnNumber(Loc);
+}
+
+unsigned GetLineIndentation(
+        clang::SourceLocation Loc, const clang::SourceManager& SM) {
+
+    Loc = SM.getSpellingLoc(Loc);
+    if (const auto* Lines = GetLineIndex(Loc, SM)) {
+        return Lines->GetIndentation(
+                Lines->GetLineNumber(SM.getFileOffset(Loc)));
+    }
+    return clang::Lexer::getIndentationForLine(Loc, SM).size();
+}
+
+clang::SourceLocation GetLineStartLocation(
+        clang::SourceLocation Loc, const clang::SourceManager& SM) {
+
+    Loc = SM.getSpellingLoc(Loc);
+    auto Offset = SM.getFileOffset(Loc);
+
+    if (const auto* Lines = GetLineIndex(Loc, SM)) {
+        auto LineStart = Lines->GetLineStart(Lines->GetLineNumber(Offset));
+        return Loc.getLocWithOffset(-static_cast<int>(Offset - LineStart));
+    }
+    return Loc.getLocWithOffset(
+            -static_cast<int>(SM.getSpellingColumnNumber(Loc) - 1));
+}
+
+}  // namespace utils
+}  // namespace checks
+}  // namespace nett
@@ -0,0 +1,35 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#ifndef LLVM_CLANG_TOOLS_EXTRA_NETT_CHECKS_UTILS_SOURCEINDEX_HPP
+#define LLVM_CLANG_TOOLS_EXTRA_NETT_CHECKS_UTILS_SOURCEINDEX_HPP
+
+#include "clang/Basic/SourceManager.h"
+
+namespace nett {
+namespace checks {
+namespace utils {
+
+// These use the index built when the file was sanitized, falling
+// back to the SourceManager for files which weren't (e.g. headers which
+// were not given as inputs). All of them work on spelling locations.
+
+// Returns the column number of the given location.
+unsigned GetColumnNumber(
+        clang::SourceLocation Loc, const clang::SourceManager& SM);
+
+// Returns the number of spaces at the start of the line containing the
+// given location.
+unsigned GetLineIndentation(
+        clang::SourceLocation Loc, const clang::SourceManager& SM);
+
+// Returns the location of the first character of the line containing the
+// given location.
+clang::SourceLocation GetLineStartLocation(
+        clang::SourceLocation Loc, const clang::SourceManager& SM);
+
+}  // namespace utils
+}  // namespace checks
+}  // namespace nett
+
+#endif
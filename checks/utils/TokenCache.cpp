@@ -0,0 +1,236 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#include "TokenCache.hpp"
+
+#include "clang/Lex/Lexer.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace nett {
+namespace checks {
+namespace utils {
+
+thread_local TokenCache GlobalTokenCache;
+
+TokenStream::TokenStream(clang::FileID FID, const clang::SourceManager& SM,
+        const clang::LangOptions& LangOpts) {
+
+    bool Invalid = false;
+    FileStart = SM.getLocForStartOfFile(FID);
+    Buffer = SM.getBufferData(FID, &Invalid);
+
+    if (Invalid) {
+        Buffer = llvm::StringRef();
+        Tokens.push_back({0, 0, 1, 1, clang::tok::eof});
+        MatchBrackets();
+        return;
+    }
+
+    clang::Lexer RawLexer(FileStart, LangOpts, Buffer.begin(),
+            Buffer.begin(), Buffer.end());
+    RawLexer.SetCommentRetentionState(true);
+
+    // The line and column of each token are worked out as we go, so every
+    // byte of the file is only looked at once.
+    unsigned Line = 1;
+    unsigned LineStart = 0;
+    unsigned Scanned = 0;
+    clang::Token Token;
+
+    do {
+        RawLexer.LexFromRawLexer(Token);
+
+        unsigned Offset = SM.getFileOffset(Token.getLocation());
+        for (; Scanned < Offset; Scanned++) {
+            if (Buffer[Scanned] == '\n') {
+                Line++;
+                LineStart = Scanned + 1;
+            }
+        }
+
+        Tokens.push_back({Offset, Token.getLength(), Line,
+                Offset - LineStart + 1, Token.getKind()});
+    } while (Token.isNot(clang::tok::eof));
+
+    MatchBrackets();
+}
+
+// Returns the opening bracket for the given closing bracket, or unknown if
+// the token isn't a closing bracket.
+static clang::tok::TokenKind GetOpeningBracket(clang::tok::TokenKind Kind) {
+    switch (Kind) {
+        case clang::tok::r_paren:
+            return clang::tok::l_paren;
+        case clang::tok::r_square:
+            return clang::tok::l_square;
+        case clang::tok::r_brace:
+            return clang::tok::l_brace;
+        default:
+            return clang::tok::unknown;
+    }
+}
+
+void TokenStream::MatchBrackets(void) {
+
+    Brackets.assign(Tokens.size(), {NoBracket, NoBracket});
+    std::vector<size_t> Open;
+
+    for (size_t Index = 0; Index < Tokens.size(); Index++) {
+        auto Kind = Tokens[Index].Kind;
+        if (!Open.empty()) {
+            Brackets[Index].Enclosing = Open.back();
+        }
+
+        if (Kind == clang::tok::l_paren || Kind == clang::tok::l_square ||
+                Kind == clang::tok::l_brace) {
+            Open.push_back(Index);
+            continue;
+        }
+
+        auto OpeningKind = GetOpeningBracket(Kind);
+        if (OpeningKind == clang::tok::unknown) {
+            continue;
+        }
+
+        // Preprocessor conditionals can leave brackets without a pair, so
+        // those between a closing bracket and its opening one are skipped.
+        // A closing bracket with no opening one at all is left unpaired.
+        auto It = std::find_if(Open.rbegin(), Open.rend(),
+                [&](size_t OpenIndex) {
+                    return Tokens[OpenIndex].Kind == OpeningKind;
+                });
+        if (It == Open.rend()) {
+            continue;
+        }
+
+        auto OpenIndex = *It;
+        Open.erase(std::next(It).base(), Open.end());
+        Brackets[Index].Match = OpenIndex;
+        Brackets[Index].Enclosing = Brackets[OpenIndex].Enclosing;
+        Brackets[OpenIndex].Match = Index;
+    }
+}
+
+size_t TokenStream::FindTokenAtOrAfter(unsigned Offset) const {
+
+    // The first token starting after the offset
+    auto It = std::upper_bound(Tokens.begin(), Tokens.end(), Offset,
+            [](unsigned Value, const CachedToken& Token) {
+                return Value < Token.Offset;
+            });
+
+    if (It != Tokens.begin()) {
+        const auto& Prev = *(It - 1);
+        if (Offset < Prev.Offset + Prev.Length) {
+            --It;
+        }
+    }
+    if (It == Tokens.end()) {
+        // Past the end of the file, so we stop at the eof token
+        --It;
+    }
+    return It - Tokens.begin();
+}
+
+clang::SourceLocation TokenCursor::GetLastCharLocation() const {
+    auto Length = Get().Length;
+    return GetLocation().getLocWithOffset(Length ? Length - 1 : 0);
+}
+
+clang::Token TokenCursor::GetToken() const {
+
+    clang::Token Result;
+    Result.startToken();
+    Result.setKind(GetKind());
+    Result.setLocation(GetLocation());
+    Result.setLength(GetLength());
+
+    if (GetKind() == clang::tok::raw_identifier) {
+        Result.setRawIdentifierData(GetText().data());
+    } else if (clang::tok::isLiteral(GetKind())) {
+        Result.setLiteralData(GetText().data());
+    }
+    return Result;
+}
+
+bool TokenCursor::Next() {
+    if (Index + 1 >= Stream->size()) {
+        return false;
+    }
+    Index++;
+    return true;
+}
+
+bool TokenCursor::Prev() {
+    if (Index == 0) {
+        return false;
+    }
+    Index--;
+    return true;
+}
+
+bool TokenCursor::NextCode() {
+    auto Start = Index;
+    while (Next()) {
+        if (!IsComment()) {
+            return true;
+        }
+    }
+    Index = Start;
+    return false;
+}
+
+bool TokenCursor::PrevCode() {
+    auto Start = Index;
+    while (Prev()) {
+        if (!IsComment()) {
+            return true;
+        }
+    }
+    Index = Start;
+    return false;
+}
+
+bool TokenCursor::MoveToMatch() {
+    auto Match = Stream->GetMatch(Index);
+    if (Match == TokenStream::NoBracket) {
+        return false;
+    }
+    Index = Match;
+    return true;
+}
+
+bool TokenCursor::MoveToEnclosing() {
+    auto Enclosing = Stream->GetEnclosing(Index);
+    if (Enclosing == TokenStream::NoBracket) {
+        return false;
+    }
+    Index = Enclosing;
+    return true;
+}
+
+const TokenStream& TokenCache::GetTokens(clang::FileID FID,
+        const clang::SourceManager& SM, const clang::LangOptions& LangOpts) {
+
+    auto& Stream = Streams[FID];
+    if (!Stream) {
+        Stream.reset(new TokenStream(FID, SM, LangOpts));
+    }
+    return *Stream;
+}
+
+TokenCursor TokenCache::GetCursor(clang::SourceLocation Loc,
+        const clang::SourceManager& SM, const clang::LangOptions& LangOpts) {
+
+    auto FileLoc = SM.getFileLoc(Loc);
+    auto LocInfo = SM.getDecomposedLoc(FileLoc);
+    const auto& Stream = GetTokens(LocInfo.first, SM, LangOpts);
+
+    return TokenCursor(Stream, Stream.FindTokenAtOrAfter(LocInfo.second));
+}
+
+}  // namespace utils
+}  // namespace checks
+}  // namespace nett
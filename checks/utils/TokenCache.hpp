@@ -0,0 +1,199 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#ifndef LLVM_CLANG_TOOLS_EXTRA_NETT_CHECKS_UTILS_TOKENCACHE_HPP
+#define LLVM_CLANG_TOOLS_EXTRA_NETT_CHECKS_UTILS_TOKENCACHE_HPP
+
+#include "clang/Basic/SourceManager.h"
+#include "clang/Basic/TokenKinds.h"
+#include "clang/Lex/Token.h"
+#include "llvm/ADT/DenseMap.h"
+
+#include <memory>
+#include <vector>
+
+namespace nett {
+namespace checks {
+namespace utils {
+
+// A single raw token of a file. Comments are kept as tokens. Lines and
+// columns start from 1, the same as the SourceManager's.
+struct CachedToken {
+    unsigned Offset;
+    unsigned Length;
+    unsigned Line;
+    unsigned Column;
+    clang::tok::TokenKind Kind;
+};
+
+// Every token of a file, lexed once in raw mode. The last token is always
+// an eof token at the end of the file. The (), [] and {} pairs are matched
+// up as the file is lexed.
+class TokenStream {
+    public:
+    // The index given for a bracket with no match, or for a token which
+    // isn't within any brackets.
+    static const size_t NoBracket = static_cast<size_t>(-1);
+
+    TokenStream(clang::FileID FID, const clang::SourceManager& SM,
+            const clang::LangOptions& LangOpts);
+
+    // Returns the index of the token containing the given offset, or of the
+    // first token after it if the offset is whitespace.
+    size_t FindTokenAtOrAfter(unsigned Offset) const;
+
+    const CachedToken& operator[](size_t Index) const {
+        return Tokens[Index];
+    }
+
+    size_t size() const {
+        return Tokens.size();
+    }
+
+    // Returns the index of the bracket paired with the bracket at the given
+    // index, or NoBracket if it isn't a bracket or has no pair.
+    size_t GetMatch(size_t Index) const {
+        return Brackets[Index].Match;
+    }
+
+    // Returns the index of the innermost opening bracket around the token at
+    // the given index, or NoBracket if it isn't within any brackets. A
+    // closing bracket is treated as being at the level of its opening one.
+    size_t GetEnclosing(size_t Index) const {
+        return Brackets[Index].Enclosing;
+    }
+
+    // Returns the location of the start of the given token.
+    clang::SourceLocation GetLocation(const CachedToken& Token) const {
+        return FileStart.getLocWithOffset(Token.Offset);
+    }
+
+    // Returns the source text of the given token.
+    llvm::StringRef GetText(const CachedToken& Token) const {
+        return Buffer.substr(Token.Offset, Token.Length);
+    }
+
+    private:
+    struct BracketLinks {
+        size_t Match;
+        size_t Enclosing;
+    };
+
+    // Pairs up the brackets of the lexed tokens.
+    void MatchBrackets(void);
+
+    clang::SourceLocation FileStart;
+    llvm::StringRef Buffer;
+    std::vector<CachedToken> Tokens;
+    std::vector<BracketLinks> Brackets;
+};
+
+// A position within a TokenStream. Moving past either end of the stream
+// leaves the cursor where it was.
+class TokenCursor {
+    public:
+    TokenCursor(const TokenStream& Stream, size_t Index)
+        : Stream(&Stream), Index(Index) {
+    }
+
+    const CachedToken& Get() const {
+        return (*Stream)[Index];
+    }
+
+    clang::tok::TokenKind GetKind() const {
+        return Get().Kind;
+    }
+
+    unsigned GetLine() const {
+        return Get().Line;
+    }
+
+    unsigned GetColumn() const {
+        return Get().Column;
+    }
+
+    unsigned GetLength() const {
+        return Get().Length;
+    }
+
+    llvm::StringRef GetText() const {
+        return Stream->GetText(Get());
+    }
+
+    // Returns the location of the first character of the token.
+    clang::SourceLocation GetLocation() const {
+        return Stream->GetLocation(Get());
+    }
+
+    // Returns the location of the last character of the token.
+    clang::SourceLocation GetLastCharLocation() const;
+
+    // Checks if the token contains the character at the given offset.
+    bool Contains(unsigned Offset) const {
+        return Get().Offset <= Offset && Offset < Get().Offset + Get().Length;
+    }
+
+    bool IsComment() const {
+        return GetKind() == clang::tok::comment;
+    }
+
+    bool IsEof() const {
+        return GetKind() == clang::tok::eof;
+    }
+
+    // Builds a clang::Token for the checks which still take one.
+    clang::Token GetToken() const;
+
+    // Moves to the next/previous token, including comments. Returns false
+    // if there is no such token.
+    bool Next();
+    bool Prev();
+
+    // Moves to the next/previous token which is not a comment. Returns
+    // false if there is no such token.
+    bool NextCode();
+    bool PrevCode();
+
+    // Moves to the bracket paired with the current one. Returns false if
+    // the token isn't a bracket or has no pair.
+    bool MoveToMatch();
+
+    // Moves to the innermost opening bracket around the current token.
+    // Returns false if the token isn't within any brackets.
+    bool MoveToEnclosing();
+
+    private:
+    const TokenStream* Stream;
+    size_t Index;
+};
+
+// Keeps the tokens of each file used by the checks in the current
+// translation unit, so that the same bytes are never lexed twice.
+class TokenCache {
+    public:
+    // Returns the tokens of the given file, lexing it on first use.
+    const TokenStream& GetTokens(clang::FileID FID,
+            const clang::SourceManager& SM, const clang::LangOptions& LangOpts);
+
+    // Returns a cursor at the token containing the given location, or at
+    // the first token after it. Macro locations are mapped to the file.
+    TokenCursor GetCursor(clang::SourceLocation Loc,
+            const clang::SourceManager& SM, const clang::LangOptions& LangOpts);
+
+    // Forgets every file. This must be called before the SourceManager the
+    // tokens were lexed from goes away.
+    void Clear(void) {
+        Streams.clear();
+    }
+
+    private:
+    llvm::DenseMap<clang::FileID, std::unique_ptr<TokenStream>> Streams;
+};
+
+extern thread_local TokenCache GlobalTokenCache;
+
+}  // namespace utils
+}  // namespace checks
+}  // namespace nett
+
+#endif
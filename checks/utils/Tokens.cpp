@@ -3,9 +3,9 @@
  */
 #include "Tokens.hpp"
 
-#include "clang/Lex/Lexer.h"
+#include "TokenCache.hpp"
 
-#include <sstream>
+#include <limits>
 
 namespace nett {
 namespace checks {
@@ -14,17 +14,12 @@ namespace utils {
 std::string GetTokenSourceString(clang::SourceLocation Loc,
         clang::SourceManager& SM, clang::LangOptions LangOpts) {
 
-    auto TokenStartLoc = clang::Lexer::GetBeginningOfToken(Loc, SM, LangOpts);
-    auto TokenLength =
-            clang::Lexer::MeasureTokenLength(TokenStartLoc, SM, LangOpts);
-    const auto* TokenSource = SM.getCharacterData(TokenStartLoc);
-
-    std::stringstream TokenString;
-    for (unsigned i = 0; i < TokenLength; i++) {
-        TokenString << TokenSource[i];
+    auto Cursor = GlobalTokenCache.GetCursor(Loc, SM, LangOpts);
+    if (!Cursor.Contains(SM.getFileOffset(SM.getFileLoc(Loc)))) {
+        // Whitespace isn't part of any token
+        return "";
     }
-
-    return TokenString.str();
+    return Cursor.GetText().str();
 }
 
 clang::SourceLocation GetMacroEndLocation(clang::Stmt* Stmt,
@@ -91,40 +86,66 @@ bool isWhitespace(clang::StringRef Text) {
 clang::tok::TokenKind getTokenKind(clang::SourceLocation Loc,
         const clang::SourceManager& SM, const clang::ASTContext* Context) {
 
-    clang::Token Tok;
-    clang::SourceLocation Beginning =
-            clang::Lexer::GetBeginningOfToken(Loc, SM, Context->getLangOpts());
-
-    const bool Invalid = clang::Lexer::getRawToken(
-            Beginning, Tok, SM, Context->getLangOpts());
-
-    if (Invalid) {
+    auto Cursor = GlobalTokenCache.GetCursor(Loc, SM, Context->getLangOpts());
+    if (!Cursor.Contains(SM.getFileOffset(SM.getFileLoc(Loc)))) {
         return clang::tok::NUM_TOKENS;
     }
-
-    return Tok.getKind();
+    return Cursor.GetKind();
 }
 
-clang::SourceLocation FindCharLocation(clang::SourceLocation StartLoc,
-        char Value, clang::SourceManager& SM, clang::ASTContext* Context) {
+llvm::Optional<clang::SourceLocation> FindCharLocation(
+        clang::SourceLocation StartLoc, char Value,
+        const clang::SourceManager& SM, const clang::ASTContext* Context,
+        clang::SourceLocation Limit) {
 
     StartLoc = SM.getFileLoc(StartLoc);
-    auto CharLoc = StartLoc;
-    while (true) {
-        clang::tok::TokenKind TokKind =
-                utils::getTokenKind(CharLoc, SM, Context);
-        if (TokKind == clang::tok::NUM_TOKENS ||
-                TokKind == clang::tok::comment) {
-            CharLoc = CharLoc.getLocWithOffset(1);
+    auto StartOffset = SM.getFileOffset(StartLoc);
+    auto Cursor =
+            GlobalTokenCache.GetCursor(StartLoc, SM, Context->getLangOpts());
+
+    // A limit in another file (e.g. from a macro defined in a header) can't
+    // bound the search, so the end of the file does instead.
+    auto LimitOffset = std::numeric_limits<unsigned>::max();
+    if (Limit.isValid()) {
+        Limit = SM.getFileLoc(Limit);
+        if (SM.getFileID(Limit) == SM.getFileID(StartLoc)) {
+            LimitOffset = SM.getFileOffset(Limit);
+        }
+    }
+
+    // Only the characters of tokens other than comments and literals can
+    // match, since anything between the tokens is whitespace.
+    for (; !Cursor.IsEof() && Cursor.Get().Offset <= LimitOffset;
+            Cursor.Next()) {
+        if (Cursor.IsComment() || clang::tok::isLiteral(Cursor.GetKind())) {
             continue;
         }
-        if (*SM.getCharacterData(CharLoc) == Value) {
-            break;
+
+        auto Text = Cursor.GetText();
+        auto TokenOffset = Cursor.Get().Offset;
+        auto Begin = StartOffset > TokenOffset ? StartOffset - TokenOffset : 0;
+        auto Found = Text.find(Value, Begin);
+
+        if (Found != llvm::StringRef::npos) {
+            return Cursor.GetLocation().getLocWithOffset(Found);
         }
-        CharLoc = CharLoc.getLocWithOffset(1);
     }
+    return llvm::None;
+}
 
-    return CharLoc;
+llvm::Optional<clang::SourceLocation> FindMatchingBracket(
+        clang::SourceLocation BracketLoc, const clang::SourceManager& SM,
+        const clang::ASTContext* Context) {
+
+    BracketLoc = SM.getFileLoc(BracketLoc);
+    auto Cursor =
+            GlobalTokenCache.GetCursor(BracketLoc, SM, Context->getLangOpts());
+
+    if (!Cursor.Contains(SM.getFileOffset(BracketLoc)) ||
+            !Cursor.MoveToMatch()) {
+        return llvm::None;
+    }
+    return Cursor.GetLocation();
 }
 
 }  // namespace utils
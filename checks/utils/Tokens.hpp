@@ -6,6 +6,7 @@
 
 #include "clang/ASTMatchers/ASTMatchFinder.h"
 #include "clang/Lex/Preprocessor.h"
+#include "llvm/ADT/Optional.h"
 
 #include <string>
 
@@ -35,10 +36,21 @@ bool isWhitespace(char C);
 clang::tok::TokenKind getTokenKind(clang::SourceLocation Loc,
         const clang::SourceManager& SM, const clang::ASTContext* Context);
 
-// Finds the location of Value at or after the given starting location
-// ignoring comments.
-clang::SourceLocation FindCharLocation(clang::SourceLocation StartLoc,
-        char Value, clang::SourceManager& SM, clang::ASTContext* Context);
+// Finds the location of Value at or after the given starting location,
+// searching up to and including the token at Limit (or to the end of the
+// file, if no Limit is given). Comments and literals are skipped whole.
+// Returns None if Value isn't found.
+llvm::Optional<clang::SourceLocation> FindCharLocation(
+        clang::SourceLocation StartLoc, char Value,
+        const clang::SourceManager& SM, const clang::ASTContext* Context,
+        clang::SourceLocation Limit = clang::SourceLocation());
+
+// Finds the location of the bracket paired with the '(', '[' or '{' (or
+// closing bracket) at the given location, taking nesting into account.
+// Returns None if there is no bracket there, or it has no pair.
+llvm::Optional<clang::SourceLocation> FindMatchingBracket(
+        clang::SourceLocation BracketLoc, const clang::SourceManager& SM,
+        const clang::ASTContext* Context);
 
 }  // namespace utils
 }  // namespace checks
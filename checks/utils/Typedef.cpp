@@ -3,11 +3,7 @@
  */
 #include "Typedef.hpp"
 
-#include "Tokens.hpp"
-
-#include "clang/Lex/Lexer.h"
-
-#include <sstream>
+#include "TokenCache.hpp"
 
 namespace nett {
 namespace checks {
@@ -20,39 +16,28 @@ static bool TypeDeclIsATypedef(
         const clang::TypeDecl* Decl, clang::ASTContext* Context) {
 
     auto& SM = Context->getSourceManager();
-    auto LangOpts = Context->getLangOpts();
-    auto CurrentLoc = Decl->getBeginLoc().getLocWithOffset(-1);
+    auto Token = GlobalTokenCache.GetCursor(
+            Decl->getBeginLoc(), SM, Context->getLangOpts());
 
     // Move to the previous token. If we reach the start of the file, we
     // cannot have a typedef
-    while (checks::utils::isWhitespace(*SM.getCharacterData(CurrentLoc))) {
-        CurrentLoc = CurrentLoc.getLocWithOffset(-1);
-        if (CurrentLoc.isInvalid()) {
-            // We are at the start of the file, so this is not a typedef
-            return false;
-        }
+    if (!Token.Prev()) {
+        return false;
     }
 
     // Now we check if the previous token is 'typedef'
-    auto TokenStartLoc =
-            clang::Lexer::GetBeginningOfToken(CurrentLoc, SM, LangOpts);
-    return checks::utils::GetTokenSourceString(TokenStartLoc, SM, LangOpts)
-                   .compare("typedef") == 0;
+    return Token.GetText().compare("typedef") == 0;
 }
 
 clang::SourceLocation GetTypeDeclBeginLoc(
         const clang::TypeDecl* Decl, clang::ASTContext* Context) {
 
     if (TypeDeclIsATypedef(Decl, Context)) {
-        auto& SM = Context->getSourceManager();
-        auto LangOpts = Context->getLangOpts();
-        auto CurrentLoc = Decl->getBeginLoc().getLocWithOffset(-1);
-
-        while (checks::utils::isWhitespace(*SM.getCharacterData(CurrentLoc))) {
-            CurrentLoc = CurrentLoc.getLocWithOffset(-1);
-        }
+        auto Token = GlobalTokenCache.GetCursor(Decl->getBeginLoc(),
+                Context->getSourceManager(), Context->getLangOpts());
+        Token.Prev();
 
-        return clang::Lexer::GetBeginningOfToken(CurrentLoc, SM, LangOpts);
+        return Token.GetLocation();
     }
     return Decl->getBeginLoc();
 }
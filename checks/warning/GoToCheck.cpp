@@ -5,8 +5,6 @@
 
 #include "../../violations/ViolationManager.hpp"
 
-#include <sstream>
-
 using namespace clang::ast_matchers;
 
 namespace nett {
@@ -27,10 +25,9 @@ void GoToChecker::run(const MatchFinder::MatchResult& Result) {
         auto File = SM.getFilename(Loc);
         auto LineNo = SM.getExpansionLineNumber(Loc);
 
-        std::stringstream ErrMsg;
-        ErrMsg << "'goto' is banned and should not be used.";
+        const char* ErrMsg = "'goto' is banned and should not be used.";
         GlobalViolationManager.AddViolation(
-                new WarningViolation(File.str(), LineNo, ErrMsg.str()));
+                WarningViolation(File.str(), LineNo, ErrMsg));
     }
 }
 
@@ -4,6 +4,7 @@
 #include "EnumWhitespaceCheck.hpp"
 
 #include "../../violations/ViolationManager.hpp"
+#include "../utils/TokenCache.hpp"
 #include "../utils/Tokens.hpp"
 #include "../utils/Typedef.hpp"
 #include "WhitespaceCheck.hpp"
@@ -13,8 +14,6 @@
 #include "clang/Lex/Lexer.h"
 #include "clang/Lex/Preprocessor.h"
 
-#include <sstream>
-
 using namespace clang::ast_matchers;
 
 namespace nett {
@@ -45,11 +44,11 @@ void EnumWhitespaceChecker::run(const MatchFinder::MatchResult& Result) {
             // We have a typedef
             if (SM.getExpansionLineNumber(TypedefBeginLoc) !=
                     SM.getExpansionLineNumber(EnumBeginLoc)) {
-                std::stringstream ErrMsg;
-                ErrMsg << "Typedef'd enums should look like: typedef enum ...";
-                GlobalViolationManager.AddViolation(new WhitespaceViolation(
+                const char* ErrMsg = "Typedef'd enums should look like: "
+                                     "typedef enum ...";
+                GlobalViolationManager.AddViolation(WhitespaceViolation(
                         File.str(), SM.getExpansionLineNumber(TypedefBeginLoc),
-                        ErrMsg.str()));
+                        ErrMsg));
             } else {
                 auto TypedefEndLoc = TypedefBeginLoc.getLocWithOffset(6);
                 CheckLocationWhitespace(
@@ -64,17 +63,17 @@ void EnumWhitespaceChecker::run(const MatchFinder::MatchResult& Result) {
         if (!isAnonymous) {
             // The name of the enum, and the 'enum' keyword should be
             // on the same line and single space separated
-            auto EnumName =
-                    clang::Lexer::findNextToken(EnumEndLoc, SM, LangOpts);
-            auto EnumNameStartLoc = EnumName->getLocation();
+            auto EnumName = utils::GlobalTokenCache.GetCursor(
+                    EnumEndLoc, SM, LangOpts);
+            EnumName.NextCode();
+            auto EnumNameStartLoc = EnumName.GetLocation();
 
             if (SM.getExpansionLineNumber(EnumEndLoc) !=
                     SM.getExpansionLineNumber(EnumNameStartLoc)) {
-                std::stringstream ErrMsg;
-                ErrMsg << "Enums should look like: enum X";
-                GlobalViolationManager.AddViolation(new WhitespaceViolation(
+                const char* ErrMsg = "Enums should look like: enum X";
+                GlobalViolationManager.AddViolation(WhitespaceViolation(
                         File.str(), SM.getExpansionLineNumber(EnumEndLoc),
-                        ErrMsg.str()));
+                        ErrMsg));
             } else {
                 CheckLocationWhitespace(
                         EnumEndLoc, EnumNameStartLoc, 1, SM, LangOpts);
@@ -84,26 +83,28 @@ void EnumWhitespaceChecker::run(const MatchFinder::MatchResult& Result) {
             // on the same line and be single space separated
             if (Node->isThisDeclarationADefinition()) {
                 auto EnumNameEndLoc = EnumNameStartLoc.getLocWithOffset(
-                        EnumName->getLength() - 1);
-                auto OpenBraceLoc = utils::FindCharLocation(
-                        EnumNameEndLoc, '{', SM, Result.Context);
+                        EnumName.GetLength() - 1);
+                auto OpenBraceLoc = utils::FindCharLocation(EnumNameEndLoc, '{',
+                        SM, Result.Context, Node->getBraceRange().getBegin());
 
-                if (SM.getExpansionLineNumber(EnumNameEndLoc) ==
-                        SM.getExpansionLineNumber(OpenBraceLoc)) {
+                if (OpenBraceLoc &&
+                        SM.getExpansionLineNumber(EnumNameEndLoc) ==
+                                SM.getExpansionLineNumber(*OpenBraceLoc)) {
                     CheckLocationWhitespace(
-                            EnumNameEndLoc, OpenBraceLoc, 1, SM, LangOpts);
+                            EnumNameEndLoc, *OpenBraceLoc, 1, SM, LangOpts);
                 }
             }
         } else {
             // The 'enum' keyword and the open curly brace should be
             // on the same line and be single space separated
             if (Node->isThisDeclarationADefinition()) {
-                auto OpenBraceLoc = utils::FindCharLocation(
-                        EnumEndLoc, '{', SM, Result.Context);
-                if (SM.getExpansionLineNumber(EnumEndLoc) ==
-                        SM.getExpansionLineNumber(OpenBraceLoc)) {
+                auto OpenBraceLoc = utils::FindCharLocation(EnumEndLoc, '{',
+                        SM, Result.Context, Node->getBraceRange().getBegin());
+                if (OpenBraceLoc &&
+                        SM.getExpansionLineNumber(EnumEndLoc) ==
+                                SM.getExpansionLineNumber(*OpenBraceLoc)) {
                     CheckLocationWhitespace(
-                            EnumEndLoc, OpenBraceLoc, 1, SM, LangOpts);
+                            EnumEndLoc, *OpenBraceLoc, 1, SM, LangOpts);
                 }
             }
         }
@@ -117,19 +118,22 @@ void EnumWhitespaceChecker::run(const MatchFinder::MatchResult& Result) {
 
         // Finally, we check that the ending semi-colon is directly after the
         // end of the enum
-        auto SemiLoc = utils::FindCharLocation(
+        auto FoundSemi = utils::FindCharLocation(
                 Node->getEndLoc(), ';', SM, Result.Context);
+        if (!FoundSemi) {
+            return;
+        }
+        auto SemiLoc = *FoundSemi;
         auto EndLoc =
                 GetPreviousNonWhitespaceLoc(SemiLoc.getLocWithOffset(-1), SM);
 
         if (SM.getExpansionLineNumber(SemiLoc) !=
                 SM.getExpansionLineNumber(EndLoc)) {
-            std::stringstream ErrMsg;
-            ErrMsg << "Semicolons should be on the same line as the end of a "
-                      "declaration.";
+            const char* ErrMsg = "Semicolons should be on the same line as the "
+                                 "end of a declaration.";
             GlobalViolationManager.AddViolation(
-                    new WhitespaceViolation(File.str(),
-                            SM.getExpansionLineNumber(SemiLoc), ErrMsg.str()));
+                    WhitespaceViolation(File.str(),
+                            SM.getExpansionLineNumber(SemiLoc), ErrMsg));
         } else {
             CheckLocationWhitespace(EndLoc, SemiLoc, 0, SM, LangOpts);
         }
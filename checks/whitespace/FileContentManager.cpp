@@ -7,11 +7,15 @@
 #include "../utils/Tokens.hpp"
 
 #include <algorithm>
-#include <sstream>
 
 namespace nett {
 
-FileContentManager GlobalFileContentManager;
+thread_local FileContentManager GlobalFileContentManager;
+
+// The name each type of entry is called in messages, by EntryType
+static const char* const ENTRY_TYPE_NAMES[] = {"Functions", "Enums",
+        "Structs", "Unions", "Functions", "Enums", "Structs", "Unions",
+        "Global Variables", "Typedefs", "Comments"};
 
 struct EntryInfo ConstructFileEntry(const clang::Decl* Node,
         clang::ASTContext* Context, EntryType Type, bool SemiColonTerminated) {
@@ -26,8 +30,11 @@ struct EntryInfo ConstructFileEntry(const clang::Decl* Node,
     clang::SourceLocation EndLoc = Node->getEndLoc();
 
     if (SemiColonTerminated) {
-        EndLoc = checks::utils::FindCharLocation(
+        auto SemiLoc = checks::utils::FindCharLocation(
                 Node->getEndLoc(), ';', SM, Context);
+        if (SemiLoc) {
+            EndLoc = *SemiLoc;
+        }
     }
     EndLine = SM.getExpansionLineNumber(EndLoc);
 
@@ -44,6 +51,16 @@ struct EntryInfo ConstructFileEntry(const clang::Decl* Node,
     return Result;
 }
 
+DefinitionEntry::DefinitionEntry(struct EntryInfo Info)
+    : StartLineNo(Info.StartLineNo), EndLineNo(Info.EndLineNo),
+      Type(Info.Type), EndOffset(0) {
+
+    if (Info.EndLoc.isValid()) {
+        const auto& SM = Info.Context->getSourceManager();
+        EndOffset = SM.getFileOffset(SM.getExpansionLoc(Info.EndLoc));
+    }
+}
+
 void FileContentManager::AddEntry(struct EntryInfo Info) {
 
     if (MethodMap.find(Info.File) == MethodMap.end()) {
@@ -76,6 +93,67 @@ void FileContentManager::AddEntry(struct EntryInfo Info) {
     }
 }
 
+void FileContentManager::MergeFrom(FileContentManager& Other) {
+
+    for (auto& FileEntry : Other.MethodMap) {
+        auto& Entries = MethodMap[FileEntry.first];
+        Entries.insert(
+                Entries.end(), FileEntry.second.begin(), FileEntry.second.end());
+    }
+    Other.MethodMap.clear();
+}
+
+llvm::json::Value FileContentManager::ToJSON(void) const {
+
+    // Each entry is stored as [start line, end line, type, end offset]
+    llvm::json::Object Files;
+    for (const auto& FileEntry : MethodMap) {
+        llvm::json::Array Entries;
+        for (const auto& Entry : FileEntry.second) {
+            Entries.push_back(llvm::json::Array{Entry.StartLineNo,
+                    Entry.EndLineNo, static_cast<int>(Entry.Type),
+                    Entry.EndOffset});
+        }
+        Files[FileEntry.first] = std::move(Entries);
+    }
+    return std::move(Files);
+}
+
+bool FileContentManager::FromJSON(const llvm::json::Value& Value) {
+
+    const auto* Files = Value.getAsObject();
+    if (!Files) {
+        return false;
+    }
+
+    for (const auto& FileEntry : *Files) {
+        const auto* Entries = FileEntry.second.getAsArray();
+        if (!Entries) {
+            return false;
+        }
+        llvm::StringRef File = FileEntry.first;
+        auto& Stored = MethodMap[File.str()];
+
+        for (const auto& Item : *Entries) {
+            const auto* Fields = Item.getAsArray();
+            if (!Fields || Fields->size() != 4) {
+                return false;
+            }
+            auto StartLineNo = (*Fields)[0].getAsInteger();
+            auto EndLineNo = (*Fields)[1].getAsInteger();
+            auto Type = (*Fields)[2].getAsInteger();
+            auto EndOffset = (*Fields)[3].getAsInteger();
+            if (!StartLineNo || !EndLineNo || !Type || !EndOffset ||
+                    *Type < ENTRY_FUNC_DECL || *Type > ENTRY_COMMENT) {
+                return false;
+            }
+            Stored.emplace_back(*StartLineNo, *EndLineNo,
+                    static_cast<EntryType>(*Type), *EndOffset);
+        }
+    }
+    return true;
+}
+
 bool CompareEntries(const DefinitionEntry& a, const DefinitionEntry& b) {
     if (a.StartLineNo == b.StartLineNo) {
         return a.EndLineNo < b.EndLineNo;
@@ -112,85 +190,93 @@ static bool IsSeparationViolation(DefinitionEntry E1, DefinitionEntry E2) {
     return false;
 }
 
-void FileContentManager::GenerateWhitespaceViolations(void) {
+// Generates the whitespace violations between the given entries, which
+// are the definitions within the given file.
+static void GenerateFileWhitespaceViolations(
+        const std::string& File, std::vector<DefinitionEntry> Entries) {
 
-    for (auto FileEntry : MethodMap) {
-        auto File = FileEntry.first;
-        auto Entries = FileEntry.second;
+    std::sort(Entries.begin(), Entries.end(), CompareEntries);
 
-        std::sort(Entries.begin(), Entries.end(), CompareEntries);
+    // Once we've sorted the entries, we need to remove
+    // comments which are within the bodies of other nodes
+    // (i.e. their source locations are within the bounds
+    // of their neighbours).
+    std::vector<DefinitionEntry> Filtered;
+    if (Entries.size() > 0) {
+        Filtered.push_back(Entries[0]);
+    }
+    unsigned curr = 1;
+    while (curr < Entries.size()) {
+        Filtered.push_back(Entries[curr]);
 
-        // Once we've sorted the entries, we need to remove
-        // comments which are within the bodies of other nodes
-        // (i.e. their source locations are within the bounds
-        // of their neighbours).
-        std::vector<DefinitionEntry> Filtered;
-        if (Entries.size() > 0) {
-            Filtered.push_back(Entries[0]);
-        }
-        unsigned curr = 1;
-        while (curr < Entries.size()) {
-            Filtered.push_back(Entries[curr]);
-
-            unsigned offset = 1;
-            while (curr + offset < Entries.size() &&
-                    Entries[curr + offset].EndLoc < Entries[curr].EndLoc) {
-                // The entry at the offset is nested in the current entry
-                offset += 1;
-            }
-            curr = curr + offset;
+        unsigned offset = 1;
+        while (curr + offset < Entries.size() &&
+                Entries[curr + offset].EndOffset < Entries[curr].EndOffset) {
+            // The entry at the offset is nested in the current entry
+            offset += 1;
         }
-        Entries = Filtered;
-
-        // Next, we need to filter out comments which overlap with
-        // function comments
-        Filtered = std::vector<DefinitionEntry>();
-        for (unsigned i = 0; i < Entries.size() - 1; i++) {
-            if (Entries[i].Type == EntryType::ENTRY_COMMENT &&
-                    Entries[i].StartLineNo == Entries[i + 1].StartLineNo) {
-                continue;
-            }
-            Filtered.push_back(Entries[i]);
+        curr = curr + offset;
+    }
+    Entries = Filtered;
+
+    // Next, we need to filter out comments which overlap with
+    // function comments
+    Filtered = std::vector<DefinitionEntry>();
+    for (unsigned i = 0; i < Entries.size() - 1; i++) {
+        if (Entries[i].Type == EntryType::ENTRY_COMMENT &&
+                Entries[i].StartLineNo == Entries[i + 1].StartLineNo) {
+            continue;
         }
-        Filtered.push_back(Entries[Entries.size() - 1]);
-        Entries = Filtered;
-
-        // Next, we need to move through and check whether the
-        // start of the next entry is sufficiently close to the
-        // end of the previous
-        for (unsigned i = 1; i < Entries.size(); i++) {
-            std::string TypeNames[] = {"Functions", "Enums", "Structs",
-                    "Unions", "Functions", "Enums", "Structs", "Unions",
-                    "Global Variables", "Typedefs", "Comments"};
-            std::string E1Type = TypeNames[Entries[i - 1].Type];
-            std::string E2Type = TypeNames[Entries[i].Type];
-
-            if (Entries[i].StartLineNo == Entries[i - 1].StartLineNo &&
-                    Entries[i].EndLineNo == Entries[i - 1].EndLineNo) {
-                // We have the same entry twice (which can happen)
-                continue;
-            }
-            if (Entries[i - 1].Type == EntryType::ENTRY_COMMENT ||
-                    Entries[i].Type == EntryType::ENTRY_COMMENT) {
-                // We ignore comments
-                continue;
-            }
+        Filtered.push_back(Entries[i]);
+    }
+    Filtered.push_back(Entries[Entries.size() - 1]);
+    Entries = Filtered;
 
-            if (IsSeparationViolation(Entries[i - 1], Entries[i])) {
-                std::stringstream ErrMsg;
+    // Next, we need to move through and check whether the
+    // start of the next entry is sufficiently close to the
+    // end of the previous
+    for (unsigned i = 1; i < Entries.size(); i++) {
+        llvm::StringRef E1Type = ENTRY_TYPE_NAMES[Entries[i - 1].Type];
+        llvm::StringRef E2Type = ENTRY_TYPE_NAMES[Entries[i].Type];
 
-                if (E1Type.compare(E2Type) == 0) {
-                    ErrMsg << E1Type;
-                } else {
-                    ErrMsg << E1Type << " and " << E2Type;
-                }
-                ErrMsg << " should be separated by reasonable whitespace.";
+        if (Entries[i].StartLineNo == Entries[i - 1].StartLineNo &&
+                Entries[i].EndLineNo == Entries[i - 1].EndLineNo) {
+            // We have the same entry twice (which can happen)
+            continue;
+        }
+        if (Entries[i - 1].Type == EntryType::ENTRY_COMMENT ||
+                Entries[i].Type == EntryType::ENTRY_COMMENT) {
+            // We ignore comments
+            continue;
+        }
 
-                GlobalViolationManager.AddViolation(new WhitespaceViolation(
-                        File, Entries[i - 1].EndLineNo + 1, ErrMsg.str()));
+        if (IsSeparationViolation(Entries[i - 1], Entries[i])) {
+            std::string ErrMsg = E1Type.str();
+            if (E1Type != E2Type) {
+                ErrMsg += " and " + E2Type.str();
             }
+            ErrMsg += " should be separated by reasonable whitespace.";
+
+            GlobalViolationManager.AddViolation(WhitespaceViolation(
+                    File, Entries[i - 1].EndLineNo + 1, ErrMsg));
         }
     }
 }
 
+void FileContentManager::GenerateWhitespaceViolations(void) {
+
+    for (const auto& FileEntry : MethodMap) {
+        GenerateFileWhitespaceViolations(FileEntry.first, FileEntry.second);
+    }
+}
+
+void FileContentManager::GenerateWhitespaceViolations(
+        const std::string& File) {
+
+    auto FileEntry = MethodMap.find(File);
+    if (FileEntry != MethodMap.end()) {
+        GenerateFileWhitespaceViolations(File, FileEntry->second);
+    }
+}
+
 }  // namespace nett
@@ -5,6 +5,7 @@
 #define LLVM_CLANG_TOOLS_EXTRA_NETT_FILECONTENTMANAGER_HPP
 
 #include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "llvm/Support/JSON.h"
 
 #include <map>
 #include <string>
@@ -38,17 +39,20 @@ struct EntryInfo {
     clang::ASTContext* Context;
 };
 
-// A file content entry
+// A file content entry. The end of the entry is kept as an offset into its
+// file, so that the entry doesn't depend on the SourceManager it came from.
 struct DefinitionEntry {
-    DefinitionEntry(struct EntryInfo Info)
-        : StartLineNo(Info.StartLineNo), EndLineNo(Info.EndLineNo),
-          Type(Info.Type), StartLoc(Info.StartLoc), EndLoc(Info.EndLoc){};
+    DefinitionEntry(struct EntryInfo Info);
+
+    DefinitionEntry(
+            int StartLineNo, int EndLineNo, EntryType Type, unsigned EndOffset)
+        : StartLineNo(StartLineNo), EndLineNo(EndLineNo), Type(Type),
+          EndOffset(EndOffset){};
 
     int StartLineNo;
     int EndLineNo;
     EntryType Type;
-    clang::SourceLocation StartLoc;
-    clang::SourceLocation EndLoc;
+    unsigned EndOffset;
 };
 
 // Keeps track of declarations/definitions within files
@@ -64,6 +68,20 @@ class FileContentManager {
     // current mapping information.
     void GenerateWhitespaceViolations(void);
 
+    // Generates the whitespace violations for the given file only.
+    void GenerateWhitespaceViolations(const std::string& File);
+
+    // Moves the entries found by another manager into this one. The other
+    // manager should hold the entries of files checked after ours.
+    void MergeFrom(FileContentManager& Other);
+
+    // Returns the entries of every file as JSON, for the result cache.
+    llvm::json::Value ToJSON(void) const;
+
+    // Adds the entries stored by ToJSON. Returns false if the value isn't
+    // in that form.
+    bool FromJSON(const llvm::json::Value& Value);
+
     // The mapping between files and the definitions they contain
     std::map<std::string, std::vector<DefinitionEntry>> MethodMap;
 };
@@ -73,7 +91,7 @@ struct EntryInfo ConstructFileEntry(const clang::Decl* Node,
         clang::ASTContext* Context, EntryType Type,
         bool SemiColonTerminated = false);
 
-extern FileContentManager GlobalFileContentManager;
+extern thread_local FileContentManager GlobalFileContentManager;
 
 }  // namespace nett
 
@@ -7,440 +7,467 @@
 #include "../utils/Tokens.hpp"
 #include "WhitespaceCheck.hpp"
 
-#include "clang/AST/ParentMap.h"
-#include "clang/AST/RecursiveASTVisitor.h"
 #include "clang/Lex/Lexer.h"
 #include "clang/Lex/Preprocessor.h"
 
-#include <sstream>
-
 using namespace clang::ast_matchers;
 
 namespace nett {
 namespace checks {
 namespace whitespace {
 
-class FunctionASTVisitor
-    : public clang::RecursiveASTVisitor<FunctionASTVisitor> {
-    using Base = clang::RecursiveASTVisitor<FunctionASTVisitor>;
-
-    public:
-    explicit FunctionASTVisitor(
-            clang::ASTContext* Context, clang::Preprocessor& PP)
-        : Context(Context), PP(PP) {
-    }
+bool FunctionBodyWhitespaceModule::BeginFunction(
+        const clang::FunctionDecl* Node,
+        traversal::TraversalContext& Traversal) {
+    return Traversal.Context->getSourceManager().isWrittenInMainFile(
+            Node->getBeginLoc());
+}
 
-    bool VisitIfStmt(clang::IfStmt* Stmt) {
+void FunctionBodyWhitespaceModule::VisitIfStmt(
+        clang::IfStmt* Stmt, traversal::TraversalContext& Traversal) {
 
-        auto& SM = Context->getSourceManager();
-        auto LangOpts = Context->getLangOpts();
-        auto File = SM.getFilename(Stmt->getBeginLoc());
-        auto IfLoc = Stmt->getIfLoc();
-        auto CondParenLoc = utils::FindCharLocation(IfLoc, '(', SM, Context);
+    auto* Context = Traversal.Context;
 
-        // First we check the whitespace between the if and the
-        // condition. If statements should look like if (cond...
-        auto IfLineNo = SM.getExpansionLineNumber(IfLoc);
+    auto& SM = Context->getSourceManager();
+    auto LangOpts = Context->getLangOpts();
+    auto File = SM.getFilename(Stmt->getBeginLoc());
+    auto IfLoc = Stmt->getIfLoc();
+    auto CondBeginLoc = Stmt->getCond()->getBeginLoc();
+    auto FoundCondParen = utils::FindCharLocation(
+            IfLoc, '(', SM, Context, CondBeginLoc);
+    if (!FoundCondParen) {
+        return;
+    }
+    auto CondParenLoc = *FoundCondParen;
+    auto FoundRParen = utils::FindMatchingBracket(CondParenLoc, SM, Context);
+    if (!FoundRParen) {
+        return;
+    }
 
-        if (IfLineNo != SM.getExpansionLineNumber(CondParenLoc)) {
-            std::stringstream ErrMsg;
-            ErrMsg << "If statements should look like: if (cond...";
-            GlobalViolationManager.AddViolation(new WhitespaceViolation(
-                    File.str(), IfLineNo, ErrMsg.str()));
-        } else {
-            CheckLocationWhitespace(
-                    IfLoc.getLocWithOffset(1), CondParenLoc, 1, SM, LangOpts);
-        }
+    // First we check the whitespace between the if and the
+    // condition. If statements should look like if (cond...
+    auto IfLineNo = SM.getExpansionLineNumber(IfLoc);
+
+    if (IfLineNo != SM.getExpansionLineNumber(CondParenLoc)) {
+        const char* ErrMsg = "If statements should look like: if (cond...";
+        GlobalViolationManager.AddViolation(WhitespaceViolation(
+                File.str(), IfLineNo, ErrMsg));
+    } else {
+        CheckLocationWhitespace(
+                IfLoc.getLocWithOffset(1), CondParenLoc, 1, SM, LangOpts);
+    }
 
-        // Next, we check the whitespace within the condition
-        auto LParenLoc = CondParenLoc;
-        auto CondRange = Stmt->getCond()->getSourceRange();
-        auto RParenLoc = utils::FindCharLocation(
-                SM.getExpansionRange(CondRange).getEnd().getLocWithOffset(1),
-                ')', SM, Context);
+    // Next, we check the whitespace within the condition
+    auto LParenLoc = CondParenLoc;
+    auto RParenLoc = *FoundRParen;
+    CheckParenWhitespace(LParenLoc, RParenLoc, SM, LangOpts);
 
-        // Stmt->getCond()->getEndLoc().getLocWithOffset(1)
-        CheckParenWhitespace(LParenLoc, RParenLoc, SM, LangOpts);
+    // Next, we check the whitespace between the condition and the
+    // opening brace -> ...cond) {
+    if (llvm::isa<clang::CompoundStmt>(Stmt->getThen())) {
+        CheckLocationWhitespace(
+                RParenLoc, Stmt->getThen()->getBeginLoc(), 1, SM, LangOpts);
+    }
 
-        // Next, we check the whitespace between the condition and the
-        // opening brace -> ...cond) {
-        if (llvm::isa<clang::CompoundStmt>(Stmt->getThen())) {
-            CheckLocationWhitespace(
-                    RParenLoc, Stmt->getThen()->getBeginLoc(), 1, SM, LangOpts);
-        }
+    // Next, we check the whitespace between the closing brace and
+    // the else statement
+    if (llvm::isa<clang::CompoundStmt>(Stmt->getThen()) &&
+            Stmt->hasElseStorage()) {
+        CheckLocationWhitespace(Stmt->getThen()->getEndLoc(),
+                Stmt->getElseLoc(), 1, SM, LangOpts);
+    }
 
-        // Next, we check the whitespace between the closing brace and
-        // the else statement
-        if (llvm::isa<clang::CompoundStmt>(Stmt->getThen()) &&
-                Stmt->hasElseStorage()) {
-            CheckLocationWhitespace(Stmt->getThen()->getEndLoc(),
-                    Stmt->getElseLoc(), 1, SM, LangOpts);
+    // Then we check the whitespace between the else and the if
+    if (Stmt->hasElseStorage() &&
+            llvm::isa<clang::IfStmt>(Stmt->getElse())) {
+        auto ElseLineNo = SM.getExpansionLineNumber(Stmt->getElseLoc());
+        auto IfLineNo =
+                SM.getExpansionLineNumber(Stmt->getElse()->getBeginLoc());
+
+        if (ElseLineNo != IfLineNo) {
+            const char* ErrMsg = "else-if statements should look like: } else "
+                                 "if (cond...";
+            GlobalViolationManager.AddViolation(WhitespaceViolation(
+                    File.str(), ElseLineNo, ErrMsg));
+        } else {
+            CheckLocationWhitespace(Stmt->getElseLoc().getLocWithOffset(3),
+                    Stmt->getElse()->getBeginLoc(), 1, SM, LangOpts);
         }
+    }
 
-        // Then we check the whitespace between the else and the if
-        if (Stmt->hasElseStorage() &&
-                llvm::isa<clang::IfStmt>(Stmt->getElse())) {
+    // Finally, we check the space between the else and the open curly brace
+    if (Stmt->hasElseStorage() &&
+            !llvm::isa<clang::IfStmt>(Stmt->getElse())) {
+        if (llvm::isa<clang::CompoundStmt>(Stmt->getElse())) {
             auto ElseLineNo = SM.getExpansionLineNumber(Stmt->getElseLoc());
-            auto IfLineNo =
-                    SM.getExpansionLineNumber(Stmt->getElse()->getBeginLoc());
-
-            if (ElseLineNo != IfLineNo) {
-                std::stringstream ErrMsg;
-                ErrMsg << "else-if statements should look like: } else if "
-                          "(cond...";
-                GlobalViolationManager.AddViolation(new WhitespaceViolation(
-                        File.str(), ElseLineNo, ErrMsg.str()));
-            } else {
-                CheckLocationWhitespace(Stmt->getElseLoc().getLocWithOffset(3),
-                        Stmt->getElse()->getBeginLoc(), 1, SM, LangOpts);
-            }
-        }
+            auto BraceLineNo = SM.getExpansionLineNumber(
+                    Stmt->getElse()->getBeginLoc());
 
-        // Finally, we check the space between the else and the open curly brace
-        if (Stmt->hasElseStorage() &&
-                !llvm::isa<clang::IfStmt>(Stmt->getElse())) {
-            if (llvm::isa<clang::CompoundStmt>(Stmt->getElse())) {
-                auto ElseLineNo = SM.getExpansionLineNumber(Stmt->getElseLoc());
-                auto BraceLineNo = SM.getExpansionLineNumber(
-                        Stmt->getElse()->getBeginLoc());
-
-                if (BraceLineNo == ElseLineNo) {
-                    CheckLocationWhitespace(
-                            Stmt->getElseLoc().getLocWithOffset(3),
-                            Stmt->getElse()->getBeginLoc(), 1, SM, LangOpts);
-                }
+            if (BraceLineNo == ElseLineNo) {
+                CheckLocationWhitespace(
+                        Stmt->getElseLoc().getLocWithOffset(3),
+                        Stmt->getElse()->getBeginLoc(), 1, SM, LangOpts);
             }
         }
-
-        return true;
     }
+}
 
-    bool VisitForStmt(clang::ForStmt* Stmt) {
+void FunctionBodyWhitespaceModule::VisitForStmt(
+        clang::ForStmt* Stmt, traversal::TraversalContext& Traversal) {
 
-        auto& SM = Context->getSourceManager();
-        auto LangOpts = Context->getLangOpts();
-        auto File = SM.getFilename(Stmt->getBeginLoc());
+    auto* Context = Traversal.Context;
 
-        // First, we check the space between the 'for'
-        // and the condition parenthesis
-        auto ForLoc = Stmt->getForLoc().getLocWithOffset(2);
-        auto LParenLoc = utils::FindCharLocation(ForLoc, '(', SM, Context);
-        if (SM.getExpansionLineNumber(ForLoc) !=
-                SM.getExpansionLineNumber(LParenLoc)) {
-            std::stringstream ErrMsg;
-            ErrMsg << "For loops should look like: for (...";
-            GlobalViolationManager.AddViolation(
-                    new WhitespaceViolation(File.str(),
-                            SM.getExpansionLineNumber(ForLoc), ErrMsg.str()));
-        } else {
-            CheckLocationWhitespace(ForLoc, LParenLoc, 1, SM, LangOpts);
-        }
+    auto& SM = Context->getSourceManager();
+    auto LangOpts = Context->getLangOpts();
+    auto File = SM.getFilename(Stmt->getBeginLoc());
 
-        // Then we check the condition's whitespace
-        auto RParenLoc = Stmt->getBody()->getBeginLoc();
-        while (*SM.getCharacterData(RParenLoc) != ')') {
-            RParenLoc = RParenLoc.getLocWithOffset(-1);
-        }
-        CheckParenWhitespace(LParenLoc, RParenLoc, SM, LangOpts);
+    // First, we check the space between the 'for'
+    // and the condition parenthesis
+    auto ForLoc = Stmt->getForLoc().getLocWithOffset(2);
+    auto FoundLParen = utils::FindCharLocation(
+            ForLoc, '(', SM, Context, Stmt->getBody()->getBeginLoc());
+    if (!FoundLParen) {
+        return;
+    }
+    auto LParenLoc = *FoundLParen;
+    if (SM.getExpansionLineNumber(ForLoc) !=
+            SM.getExpansionLineNumber(LParenLoc)) {
+        const char* ErrMsg = "For loops should look like: for (...";
+        GlobalViolationManager.AddViolation(
+                WhitespaceViolation(File.str(),
+                        SM.getExpansionLineNumber(ForLoc), ErrMsg));
+    } else {
+        CheckLocationWhitespace(ForLoc, LParenLoc, 1, SM, LangOpts);
+    }
 
-        // Next, we check the space between the end
-        // of the condition and the opening curly brace
-        if (llvm::isa<clang::CompoundStmt>(Stmt->getBody())) {
-            if (SM.getExpansionLineNumber(RParenLoc) ==
-                    SM.getExpansionLineNumber(Stmt->getBody()->getBeginLoc())) {
-                CheckLocationWhitespace(RParenLoc,
-                        Stmt->getBody()->getBeginLoc(), 1, SM, LangOpts);
-            }
+    // Then we check the condition's whitespace
+    auto FoundRParen = utils::FindMatchingBracket(LParenLoc, SM, Context);
+    if (!FoundRParen) {
+        return;
+    }
+    auto RParenLoc = *FoundRParen;
+    CheckParenWhitespace(LParenLoc, RParenLoc, SM, LangOpts);
+
+    // Next, we check the space between the end
+    // of the condition and the opening curly brace
+    if (llvm::isa<clang::CompoundStmt>(Stmt->getBody())) {
+        if (SM.getExpansionLineNumber(RParenLoc) ==
+                SM.getExpansionLineNumber(Stmt->getBody()->getBeginLoc())) {
+            CheckLocationWhitespace(RParenLoc,
+                    Stmt->getBody()->getBeginLoc(), 1, SM, LangOpts);
         }
+    }
 
-        // Finally, we check the spacing around the semicolons
-        // within the condition
-        auto InitSemiLoc = utils::FindCharLocation(LParenLoc, ';', SM, Context);
-        auto IncSemiLoc = utils::FindCharLocation(
-                InitSemiLoc.getLocWithOffset(1), ';', SM, Context);
-        auto InitEndLoc = GetPreviousNonWhitespaceLoc(
-                InitSemiLoc.getLocWithOffset(-1), SM);
-        auto CondStartLoc =
-                GetNextNonWhitespaceLoc(InitSemiLoc.getLocWithOffset(1), SM);
-        auto CondEndLoc = GetPreviousNonWhitespaceLoc(
-                IncSemiLoc.getLocWithOffset(-1), SM);
-
-        if (Stmt->getInit()) {
-            // The semicolon should be on the same line as the end of the
-            // initialiser.
-            auto InitEndLineNo = SM.getExpansionLineNumber(InitEndLoc);
-            auto SemiLineNo = SM.getExpansionLineNumber(InitSemiLoc);
-
-            if (InitEndLineNo != SemiLineNo) {
-                std::stringstream ErrMsg;
-                ErrMsg << "For loop initialisers should look like: for (init; "
-                          "...";
-                GlobalViolationManager.AddViolation(new WhitespaceViolation(
-                        File.str(), InitEndLineNo, ErrMsg.str()));
-            } else {
-                CheckLocationWhitespace(
-                        InitEndLoc, InitSemiLoc, 0, SM, LangOpts);
-            }
+    // Finally, we check the spacing around the semicolons
+    // within the condition
+    auto FoundInitSemi =
+            utils::FindCharLocation(LParenLoc, ';', SM, Context, RParenLoc);
+    if (!FoundInitSemi) {
+        return;
+    }
+    auto InitSemiLoc = *FoundInitSemi;
+    auto FoundIncSemi = utils::FindCharLocation(
+            InitSemiLoc.getLocWithOffset(1), ';', SM, Context, RParenLoc);
+    if (!FoundIncSemi) {
+        return;
+    }
+    auto IncSemiLoc = *FoundIncSemi;
+    auto InitEndLoc = GetPreviousNonWhitespaceLoc(
+            InitSemiLoc.getLocWithOffset(-1), SM);
+    auto CondStartLoc =
+            GetNextNonWhitespaceLoc(InitSemiLoc.getLocWithOffset(1), SM);
+    auto CondEndLoc = GetPreviousNonWhitespaceLoc(
+            IncSemiLoc.getLocWithOffset(-1), SM);
+
+    if (Stmt->getInit()) {
+        // The semicolon should be on the same line as the end of the
+        // initialiser.
+        auto InitEndLineNo = SM.getExpansionLineNumber(InitEndLoc);
+        auto SemiLineNo = SM.getExpansionLineNumber(InitSemiLoc);
+
+        if (InitEndLineNo != SemiLineNo) {
+            const char* ErrMsg = "For loop initialisers should look like: for "
+                                 "(init; ...";
+            GlobalViolationManager.AddViolation(WhitespaceViolation(
+                    File.str(), InitEndLineNo, ErrMsg));
+        } else {
+            CheckLocationWhitespace(
+                    InitEndLoc, InitSemiLoc, 0, SM, LangOpts);
         }
+    }
 
-        if (Stmt->getCond()) {
-            // There should be a single space between the previous semicolon if
-            // they are on the same line. Also, the next semicolon should be
-            // on the same line as the end of the condition.
-            auto InitSemiLineNo = SM.getExpansionLineNumber(InitSemiLoc);
-            auto CondStartLineNo = SM.getExpansionLineNumber(CondStartLoc);
-            auto CondEndLineNo = SM.getExpansionLineNumber(CondEndLoc);
-            auto IncSemiLineNo = SM.getExpansionLineNumber(IncSemiLoc);
+    if (Stmt->getCond()) {
+        // There should be a single space between the previous semicolon if
+        // they are on the same line. Also, the next semicolon should be
+        // on the same line as the end of the condition.
+        auto InitSemiLineNo = SM.getExpansionLineNumber(InitSemiLoc);
+        auto CondStartLineNo = SM.getExpansionLineNumber(CondStartLoc);
+        auto CondEndLineNo = SM.getExpansionLineNumber(CondEndLoc);
+        auto IncSemiLineNo = SM.getExpansionLineNumber(IncSemiLoc);
 
-            if (InitSemiLineNo == CondStartLineNo) {
-                CheckLocationWhitespace(
-                        InitSemiLoc, CondStartLoc, 1, SM, LangOpts);
-            }
+        if (InitSemiLineNo == CondStartLineNo) {
+            CheckLocationWhitespace(
+                    InitSemiLoc, CondStartLoc, 1, SM, LangOpts);
+        }
 
-            if (CondEndLineNo != IncSemiLineNo) {
-                std::stringstream ErrMsg;
-                ErrMsg << "For loop conditions should look like: for (...; "
-                          "cond; ...";
-                GlobalViolationManager.AddViolation(new WhitespaceViolation(
-                        File.str(), CondEndLineNo, ErrMsg.str()));
-            } else {
-                CheckLocationWhitespace(
-                        CondEndLoc, IncSemiLoc, 0, SM, LangOpts);
-            }
+        if (CondEndLineNo != IncSemiLineNo) {
+            const char* ErrMsg = "For loop conditions should look like: for "
+                                 "(...; cond; ...";
+            GlobalViolationManager.AddViolation(WhitespaceViolation(
+                    File.str(), CondEndLineNo, ErrMsg));
         } else {
-            // If there is no condition, there should be no space between
-            // the two semicolons
-            auto InitSemiLineNo = SM.getExpansionLineNumber(InitSemiLoc);
-            auto IncSemiLineNo = SM.getExpansionLineNumber(IncSemiLoc);
-
-            if (InitSemiLineNo != IncSemiLineNo) {
-                std::stringstream ErrMsg;
-                ErrMsg << "Missing for loop conditions should look like: for "
-                          "(...;; ...";
-                GlobalViolationManager.AddViolation(new WhitespaceViolation(
-                        File.str(), InitSemiLineNo, ErrMsg.str()));
-            } else {
-                CheckLocationWhitespace(
-                        InitSemiLoc, IncSemiLoc, 0, SM, LangOpts);
-            }
+            CheckLocationWhitespace(
+                    CondEndLoc, IncSemiLoc, 0, SM, LangOpts);
+        }
+    } else {
+        // If there is no condition, there should be no space between
+        // the two semicolons
+        auto InitSemiLineNo = SM.getExpansionLineNumber(InitSemiLoc);
+        auto IncSemiLineNo = SM.getExpansionLineNumber(IncSemiLoc);
+
+        if (InitSemiLineNo != IncSemiLineNo) {
+            const char* ErrMsg = "Missing for loop conditions should look "
+                                 "like: for (...;; ...";
+            GlobalViolationManager.AddViolation(WhitespaceViolation(
+                    File.str(), InitSemiLineNo, ErrMsg));
+        } else {
+            CheckLocationWhitespace(
+                    InitSemiLoc, IncSemiLoc, 0, SM, LangOpts);
         }
-
-        return true;
     }
+}
 
-    bool VisitDoStmt(clang::DoStmt* Stmt) {
-
-        auto& SM = Context->getSourceManager();
-        auto LangOpts = Context->getLangOpts();
-        auto File = SM.getFilename(Stmt->getBeginLoc());
+void FunctionBodyWhitespaceModule::VisitDoStmt(
+        clang::DoStmt* Stmt, traversal::TraversalContext& Traversal) {
 
-        if (llvm::isa<clang::CompoundStmt>(Stmt->getBody())) {
+    auto* Context = Traversal.Context;
 
-            // First we check the spacing between the 'do' and the open curly
-            // brace
-            auto DoLoc = Stmt->getDoLoc().getLocWithOffset(1);
-            auto OpenBraceLoc = Stmt->getBody()->getBeginLoc();
+    auto& SM = Context->getSourceManager();
+    auto LangOpts = Context->getLangOpts();
+    auto File = SM.getFilename(Stmt->getBeginLoc());
 
-            if (SM.getExpansionLineNumber(DoLoc) ==
-                    SM.getExpansionLineNumber(OpenBraceLoc)) {
-                CheckLocationWhitespace(DoLoc, OpenBraceLoc, 1, SM, LangOpts);
-            }
+    if (llvm::isa<clang::CompoundStmt>(Stmt->getBody())) {
 
-            // Then we check the spacing between the closing curly brace and the
-            // 'while'
-            auto CloseBraceLoc = Stmt->getBody()->getEndLoc();
-            auto WhileLoc = Stmt->getWhileLoc();
+        // First we check the spacing between the 'do' and the open curly
+        // brace
+        auto DoLoc = Stmt->getDoLoc().getLocWithOffset(1);
+        auto OpenBraceLoc = Stmt->getBody()->getBeginLoc();
 
-            if (SM.getExpansionLineNumber(CloseBraceLoc) ==
-                    SM.getExpansionLineNumber(WhileLoc)) {
-                CheckLocationWhitespace(
-                        CloseBraceLoc, WhileLoc, 1, SM, LangOpts);
-            }
+        if (SM.getExpansionLineNumber(DoLoc) ==
+                SM.getExpansionLineNumber(OpenBraceLoc)) {
+            CheckLocationWhitespace(DoLoc, OpenBraceLoc, 1, SM, LangOpts);
         }
 
-        // Then we check the spacing between the 'while' and the condition.
-        // Both must be on the same line, and must be separated by a single
-        // space
-        auto WhileEndLoc = Stmt->getWhileLoc().getLocWithOffset(4);
-        auto CondStartLoc =
-                utils::FindCharLocation(WhileEndLoc, '(', SM, Context);
-        auto CondLineNo = SM.getExpansionLineNumber(CondStartLoc);
-
-        if (SM.getExpansionLineNumber(WhileEndLoc) != CondLineNo) {
-            std::stringstream ErrMsg;
-            ErrMsg << "Do-While loop conditions should look like: while (...";
-            GlobalViolationManager.AddViolation(new WhitespaceViolation(
-                    File.str(), CondLineNo, ErrMsg.str()));
-        } else {
-            CheckLocationWhitespace(WhileEndLoc, CondStartLoc, 1, SM, LangOpts);
-        }
+        // Then we check the spacing between the closing curly brace and the
+        // 'while'
+        auto CloseBraceLoc = Stmt->getBody()->getEndLoc();
+        auto WhileLoc = Stmt->getWhileLoc();
 
-        // Next, we check the spacing within the condition
-        auto CondRange = Stmt->getCond()->getSourceRange();
-        auto CondEndLoc = utils::FindCharLocation(
-                SM.getExpansionRange(CondRange).getEnd().getLocWithOffset(1),
-                ')', SM, Context);
-        CheckParenWhitespace(CondStartLoc, CondEndLoc, SM, LangOpts);
-
-        // Finally, we check the space between the end of the condition
-        // and the semicolon
-        auto SemiLoc = utils::FindCharLocation(CondEndLoc, ';', SM, Context);
-        auto SemiLineNo = SM.getExpansionLineNumber(SemiLoc);
-
-        if (SM.getExpansionLineNumber(CondEndLoc) != SemiLineNo) {
-            std::stringstream ErrMsg;
-            ErrMsg << "Do-While loop conditions should look like: ...);";
-            GlobalViolationManager.AddViolation(new WhitespaceViolation(
-                    File.str(), CondLineNo, ErrMsg.str()));
-        } else {
-            CheckLocationWhitespace(CondEndLoc, SemiLoc, 0, SM, LangOpts);
+        if (SM.getExpansionLineNumber(CloseBraceLoc) ==
+                SM.getExpansionLineNumber(WhileLoc)) {
+            CheckLocationWhitespace(
+                    CloseBraceLoc, WhileLoc, 1, SM, LangOpts);
         }
-
-        return true;
     }
 
-    bool VisitWhileStmt(clang::WhileStmt* Stmt) {
-
-        auto& SM = Context->getSourceManager();
-        auto LangOpts = Context->getLangOpts();
-        auto File = SM.getFilename(Stmt->getBeginLoc());
+    // Then we check the spacing between the 'while' and the condition.
+    // Both must be on the same line, and must be separated by a single
+    // space
+    auto WhileEndLoc = Stmt->getWhileLoc().getLocWithOffset(4);
+    auto CondBeginLoc = Stmt->getCond()->getBeginLoc();
+    auto FoundCondStart = utils::FindCharLocation(
+            WhileEndLoc, '(', SM, Context, CondBeginLoc);
+    if (!FoundCondStart) {
+        return;
+    }
+    auto CondStartLoc = *FoundCondStart;
+    auto FoundCondEnd = utils::FindMatchingBracket(CondStartLoc, SM, Context);
+    if (!FoundCondEnd) {
+        return;
+    }
+    auto CondEndLoc = *FoundCondEnd;
+    auto CondLineNo = SM.getExpansionLineNumber(CondStartLoc);
+
+    if (SM.getExpansionLineNumber(WhileEndLoc) != CondLineNo) {
+        const char* ErrMsg = "Do-While loop conditions should look like: while "
+                             "(...";
+        GlobalViolationManager.AddViolation(WhitespaceViolation(
+                File.str(), CondLineNo, ErrMsg));
+    } else {
+        CheckLocationWhitespace(WhileEndLoc, CondStartLoc, 1, SM, LangOpts);
+    }
 
-        // First, we check the space between the 'while' and the condition.
-        auto WhileLoc = Stmt->getWhileLoc().getLocWithOffset(4);
-        auto CondStartLoc = utils::FindCharLocation(WhileLoc, '(', SM, Context);
+    // Next, we check the spacing within the condition
+    CheckParenWhitespace(CondStartLoc, CondEndLoc, SM, LangOpts);
 
-        if (SM.getExpansionLineNumber(WhileLoc) !=
-                SM.getExpansionLineNumber(CondStartLoc)) {
-            std::stringstream ErrMsg;
-            ErrMsg << "While loops should look like: while (...";
-            GlobalViolationManager.AddViolation(
-                    new WhitespaceViolation(File.str(),
-                            SM.getExpansionLineNumber(WhileLoc), ErrMsg.str()));
-        } else {
-            CheckLocationWhitespace(WhileLoc, CondStartLoc, 1, SM, LangOpts);
-        }
+    // Finally, we check the space between the end of the condition
+    // and the semicolon
+    auto FoundSemi = utils::FindCharLocation(CondEndLoc, ';', SM, Context);
+    if (!FoundSemi) {
+        return;
+    }
+    auto SemiLoc = *FoundSemi;
+    auto SemiLineNo = SM.getExpansionLineNumber(SemiLoc);
+
+    if (SM.getExpansionLineNumber(CondEndLoc) != SemiLineNo) {
+        const char* ErrMsg = "Do-While loop conditions should look like: ...);";
+        GlobalViolationManager.AddViolation(WhitespaceViolation(
+                File.str(), CondLineNo, ErrMsg));
+    } else {
+        CheckLocationWhitespace(CondEndLoc, SemiLoc, 0, SM, LangOpts);
+    }
+}
 
-        // Then we check the condition spacing
-        auto CondRange = Stmt->getCond()->getSourceRange();
-        auto CondEndLoc = utils::FindCharLocation(
-                SM.getExpansionRange(CondRange).getEnd().getLocWithOffset(1),
-                ')', SM, Context);
-        CheckParenWhitespace(CondStartLoc, CondEndLoc, SM, LangOpts);
+void FunctionBodyWhitespaceModule::VisitWhileStmt(
+        clang::WhileStmt* Stmt, traversal::TraversalContext& Traversal) {
 
-        // Finally we check space between the condition and the open curly brace
-        if (llvm::isa<clang::CompoundStmt>(Stmt->getBody())) {
-            auto OpenBraceLoc = Stmt->getBody()->getBeginLoc();
+    auto* Context = Traversal.Context;
 
-            if (SM.getExpansionLineNumber(CondEndLoc) ==
-                    SM.getExpansionLineNumber(OpenBraceLoc)) {
-                CheckLocationWhitespace(
-                        CondEndLoc, OpenBraceLoc, 1, SM, LangOpts);
-            }
-        }
+    auto& SM = Context->getSourceManager();
+    auto LangOpts = Context->getLangOpts();
+    auto File = SM.getFilename(Stmt->getBeginLoc());
 
-        return true;
+    // First, we check the space between the 'while' and the condition.
+    auto WhileLoc = Stmt->getWhileLoc().getLocWithOffset(4);
+    auto CondBeginLoc = Stmt->getCond()->getBeginLoc();
+    auto FoundCondStart = utils::FindCharLocation(
+            WhileLoc, '(', SM, Context, CondBeginLoc);
+    if (!FoundCondStart) {
+        return;
+    }
+    auto CondStartLoc = *FoundCondStart;
+    auto FoundCondEnd = utils::FindMatchingBracket(CondStartLoc, SM, Context);
+    if (!FoundCondEnd) {
+        return;
+    }
+    auto CondEndLoc = *FoundCondEnd;
+
+    if (SM.getExpansionLineNumber(WhileLoc) !=
+            SM.getExpansionLineNumber(CondStartLoc)) {
+        const char* ErrMsg = "While loops should look like: while (...";
+        GlobalViolationManager.AddViolation(
+                WhitespaceViolation(File.str(),
+                        SM.getExpansionLineNumber(WhileLoc), ErrMsg));
+    } else {
+        CheckLocationWhitespace(WhileLoc, CondStartLoc, 1, SM, LangOpts);
     }
 
-    bool VisitSwitchStmt(clang::SwitchStmt* Stmt) {
-
-        auto& SM = Context->getSourceManager();
-        auto LangOpts = Context->getLangOpts();
-        auto File = SM.getFilename(Stmt->getBeginLoc());
+    // Then we check the condition spacing
+    CheckParenWhitespace(CondStartLoc, CondEndLoc, SM, LangOpts);
 
-        // First, we check the space between the 'switch' and the condition.
-        auto SwitchLoc = Stmt->getSwitchLoc().getLocWithOffset(5);
-        auto CondStartLoc =
-                utils::FindCharLocation(SwitchLoc, '(', SM, Context);
+    // Finally we check space between the condition and the open curly brace
+    if (llvm::isa<clang::CompoundStmt>(Stmt->getBody())) {
+        auto OpenBraceLoc = Stmt->getBody()->getBeginLoc();
 
-        if (SM.getExpansionLineNumber(SwitchLoc) !=
-                SM.getExpansionLineNumber(CondStartLoc)) {
-            std::stringstream ErrMsg;
-            ErrMsg << "Switch statements should look like: switch (...";
-            GlobalViolationManager.AddViolation(new WhitespaceViolation(
-                    File.str(), SM.getExpansionLineNumber(SwitchLoc),
-                    ErrMsg.str()));
-        } else {
-            CheckLocationWhitespace(SwitchLoc, CondStartLoc, 1, SM, LangOpts);
+        if (SM.getExpansionLineNumber(CondEndLoc) ==
+                SM.getExpansionLineNumber(OpenBraceLoc)) {
+            CheckLocationWhitespace(
+                    CondEndLoc, OpenBraceLoc, 1, SM, LangOpts);
         }
+    }
+}
 
-        // Then we check the condition spacing
-        auto CondRange = Stmt->getCond()->getSourceRange();
-        auto CondEndLoc = utils::FindCharLocation(
-                SM.getExpansionRange(CondRange).getEnd().getLocWithOffset(1),
-                ')', SM, Context);
-        CheckParenWhitespace(CondStartLoc, CondEndLoc, SM, LangOpts);
+void FunctionBodyWhitespaceModule::VisitSwitchStmt(
+        clang::SwitchStmt* Stmt, traversal::TraversalContext& Traversal) {
 
-        // Finally we check space between the condition and the open curly brace
-        if (llvm::isa<clang::CompoundStmt>(Stmt->getBody())) {
-            auto OpenBraceLoc = Stmt->getBody()->getBeginLoc();
+    auto* Context = Traversal.Context;
 
-            if (SM.getExpansionLineNumber(CondEndLoc) ==
-                    SM.getExpansionLineNumber(OpenBraceLoc)) {
-                CheckLocationWhitespace(
-                        CondEndLoc, OpenBraceLoc, 1, SM, LangOpts);
-            }
-        }
+    auto& SM = Context->getSourceManager();
+    auto LangOpts = Context->getLangOpts();
+    auto File = SM.getFilename(Stmt->getBeginLoc());
 
-        return true;
+    // First, we check the space between the 'switch' and the condition.
+    auto SwitchLoc = Stmt->getSwitchLoc().getLocWithOffset(5);
+    auto CondBeginLoc = Stmt->getCond()->getBeginLoc();
+    auto FoundCondStart = utils::FindCharLocation(
+            SwitchLoc, '(', SM, Context, CondBeginLoc);
+    if (!FoundCondStart) {
+        return;
+    }
+    auto CondStartLoc = *FoundCondStart;
+    auto FoundCondEnd = utils::FindMatchingBracket(CondStartLoc, SM, Context);
+    if (!FoundCondEnd) {
+        return;
+    }
+    auto CondEndLoc = *FoundCondEnd;
+
+    if (SM.getExpansionLineNumber(SwitchLoc) !=
+            SM.getExpansionLineNumber(CondStartLoc)) {
+        const char* ErrMsg = "Switch statements should look like: switch (...";
+        GlobalViolationManager.AddViolation(WhitespaceViolation(
+                File.str(), SM.getExpansionLineNumber(SwitchLoc),
+                ErrMsg));
+    } else {
+        CheckLocationWhitespace(SwitchLoc, CondStartLoc, 1, SM, LangOpts);
     }
 
-    bool VisitCaseStmt(clang::CaseStmt* Stmt) {
-
-        auto& SM = Context->getSourceManager();
-        auto LangOpts = Context->getLangOpts();
-        auto File = SM.getFilename(Stmt->getBeginLoc());
+    // Then we check the condition spacing
+    CheckParenWhitespace(CondStartLoc, CondEndLoc, SM, LangOpts);
 
-        // First, we check that the case and its associated expression are
-        // on the same line and are one space apart
-        auto CaseLoc = Stmt->getCaseLoc().getLocWithOffset(3);
-        auto CondStartLoc =
-                GetNextNonWhitespaceLoc(CaseLoc.getLocWithOffset(1), SM);
+    // Finally we check space between the condition and the open curly brace
+    if (llvm::isa<clang::CompoundStmt>(Stmt->getBody())) {
+        auto OpenBraceLoc = Stmt->getBody()->getBeginLoc();
 
-        if (SM.getExpansionLineNumber(CaseLoc) !=
-                SM.getExpansionLineNumber(CondStartLoc)) {
-            std::stringstream ErrMsg;
-            ErrMsg << "Case statements should look like: case X:";
-            GlobalViolationManager.AddViolation(
-                    new WhitespaceViolation(File.str(),
-                            SM.getExpansionLineNumber(CaseLoc), ErrMsg.str()));
-        } else {
-            CheckLocationWhitespace(CaseLoc, CondStartLoc, 1, SM, LangOpts);
+        if (SM.getExpansionLineNumber(CondEndLoc) ==
+                SM.getExpansionLineNumber(OpenBraceLoc)) {
+            CheckLocationWhitespace(
+                    CondEndLoc, OpenBraceLoc, 1, SM, LangOpts);
         }
+    }
+}
 
-        // Then we check that the expression and the colon are on the
-        // same line and have no spaces between them.
-        auto ColonLoc = Stmt->getColonLoc();
-        auto CondEndLoc =
-                GetPreviousNonWhitespaceLoc(ColonLoc.getLocWithOffset(-1), SM);
+void FunctionBodyWhitespaceModule::VisitCaseStmt(
+        clang::CaseStmt* Stmt, traversal::TraversalContext& Traversal) {
+
+    auto* Context = Traversal.Context;
+
+    auto& SM = Context->getSourceManager();
+    auto LangOpts = Context->getLangOpts();
+    auto File = SM.getFilename(Stmt->getBeginLoc());
+
+    // First, we check that the case and its associated expression are
+    // on the same line and are one space apart
+    auto CaseLoc = Stmt->getCaseLoc().getLocWithOffset(3);
+    auto CondStartLoc =
+            GetNextNonWhitespaceLoc(CaseLoc.getLocWithOffset(1), SM);
+
+    if (SM.getExpansionLineNumber(CaseLoc) !=
+            SM.getExpansionLineNumber(CondStartLoc)) {
+        const char* ErrMsg = "Case statements should look like: case X:";
+        GlobalViolationManager.AddViolation(
+                WhitespaceViolation(File.str(),
+                        SM.getExpansionLineNumber(CaseLoc), ErrMsg));
+    } else {
+        CheckLocationWhitespace(CaseLoc, CondStartLoc, 1, SM, LangOpts);
+    }
 
-        if (SM.getExpansionLineNumber(CondEndLoc) !=
-                SM.getExpansionLineNumber(ColonLoc)) {
-            std::stringstream ErrMsg;
-            ErrMsg << "Case expressions should look like: case X:";
-            GlobalViolationManager.AddViolation(new WhitespaceViolation(
-                    File.str(), SM.getExpansionLineNumber(CondEndLoc),
-                    ErrMsg.str()));
-        } else {
-            CheckLocationWhitespace(CondEndLoc, ColonLoc, 0, SM, LangOpts);
-        }
+    // Then we check that the expression and the colon are on the
+    // same line and have no spaces between them.
+    auto ColonLoc = Stmt->getColonLoc();
+    auto CondEndLoc =
+            GetPreviousNonWhitespaceLoc(ColonLoc.getLocWithOffset(-1), SM);
+
+    if (SM.getExpansionLineNumber(CondEndLoc) !=
+            SM.getExpansionLineNumber(ColonLoc)) {
+        const char* ErrMsg = "Case expressions should look like: case X:";
+        GlobalViolationManager.AddViolation(WhitespaceViolation(
+                File.str(), SM.getExpansionLineNumber(CondEndLoc),
+                ErrMsg));
+    } else {
+        CheckLocationWhitespace(CondEndLoc, ColonLoc, 0, SM, LangOpts);
+    }
 
-        // Finally, if the case statement is a compound statement, we
-        // check that the colon and open brace are a single space apart
-        if (llvm::isa<clang::CompoundStmt>(Stmt->getSubStmt())) {
-            auto BraceLoc = Stmt->getSubStmt()->getBeginLoc();
+    // Finally, if the case statement is a compound statement, we
+    // check that the colon and open brace are a single space apart
+    if (llvm::isa<clang::CompoundStmt>(Stmt->getSubStmt())) {
+        auto BraceLoc = Stmt->getSubStmt()->getBeginLoc();
 
-            if (SM.getExpansionLineNumber(BraceLoc) ==
-                    SM.getExpansionLineNumber(ColonLoc)) {
-                CheckLocationWhitespace(ColonLoc, BraceLoc, 1, SM, LangOpts);
-            }
+        if (SM.getExpansionLineNumber(BraceLoc) ==
+                SM.getExpansionLineNumber(ColonLoc)) {
+            CheckLocationWhitespace(ColonLoc, BraceLoc, 1, SM, LangOpts);
         }
-
-        return true;
     }
-
-    clang::ASTContext* Context;
-    clang::Preprocessor& PP;
-};
+}
 
 void FunctionBodyWhitespaceChecker::run(
         const MatchFinder::MatchResult& Result) {
@@ -456,24 +483,25 @@ void FunctionBodyWhitespaceChecker::run(
             return;
         }
 
-        if (Node->isThisDeclarationADefinition()) {
-            FunctionASTVisitor Visitor(Result.Context, PP);
-            Visitor.TraverseDecl(const_cast<clang::FunctionDecl*>(Node));
-        } else {
-            // There should be no space between the end of the declaration
-            // and the closing semi-colon
-            auto SemiLoc = utils::FindCharLocation(
+        // The bodies of definitions are checked by the FunctionBodyChecker.
+        // There should be no space between the end of a prototype and the
+        // closing semi-colon.
+        llvm::Optional<clang::SourceLocation> FoundSemi;
+        if (!Node->isThisDeclarationADefinition()) {
+            FoundSemi = utils::FindCharLocation(
                     Node->getEndLoc(), ';', SM, Result.Context);
+        }
+        if (FoundSemi) {
+            auto SemiLoc = *FoundSemi;
             auto DeclEndLoc = GetPreviousNonWhitespaceLoc(
                     SemiLoc.getLocWithOffset(-1), SM);
             auto SemiLineNo = SM.getExpansionLineNumber(SemiLoc);
 
             if (SemiLineNo != SM.getExpansionLineNumber(DeclEndLoc)) {
-                std::stringstream ErrMsg;
-                ErrMsg << "Semicolons should be on the same line as the end of "
-                          "a declaration.";
-                GlobalViolationManager.AddViolation(new WhitespaceViolation(
-                        File.str(), SemiLineNo, ErrMsg.str()));
+                const char* ErrMsg = "Semicolons should be on the same line as "
+                                     "the end of a declaration.";
+                GlobalViolationManager.AddViolation(WhitespaceViolation(
+                        File.str(), SemiLineNo, ErrMsg));
             } else {
                 CheckLocationWhitespace(DeclEndLoc, SemiLoc, 0, SM, LangOpts);
             }
@@ -483,44 +511,43 @@ void FunctionBodyWhitespaceChecker::run(
         // same line as its name. For example: int main(...)
         if (SM.getExpansionLineNumber(Node->getLocation()) !=
                 SM.getExpansionLineNumber(Node->getBeginLoc())) {
-            std::stringstream ErrMsg;
-            ErrMsg << "A function's return type should be on the same line as "
-                      "its name.";
-            GlobalViolationManager.AddViolation(new WhitespaceViolation(
+            const char* ErrMsg = "A function's return type should be on the "
+                                 "same line as its name.";
+            GlobalViolationManager.AddViolation(WhitespaceViolation(
                     File.str(), SM.getExpansionLineNumber(Node->getBeginLoc()),
-                    ErrMsg.str()));
+                    ErrMsg));
         }
 
         // The opening parameter parenthesis and the function name should
         // have no spaces between them
-        auto LParenLoc = utils::FindCharLocation(
-                Node->getLocation(), '(', SM, Result.Context);
+        auto FoundLParen = utils::FindCharLocation(Node->getLocation(), '(',
+                SM, Result.Context, Node->getEndLoc());
+        if (!FoundLParen) {
+            return;
+        }
+        auto LParenLoc = *FoundLParen;
         auto NameEndLoc =
                 GetPreviousNonWhitespaceLoc(LParenLoc.getLocWithOffset(-1), SM);
 
         if (SM.getExpansionLineNumber(LParenLoc) !=
                 SM.getExpansionLineNumber(NameEndLoc)) {
-            std::stringstream ErrMsg;
-            ErrMsg << "Function declarations should look like func_name(...";
-            GlobalViolationManager.AddViolation(new WhitespaceViolation(
+            const char* ErrMsg = "Function declarations should look like "
+                                 "func_name(...";
+            GlobalViolationManager.AddViolation(WhitespaceViolation(
                     File.str(), SM.getExpansionLineNumber(LParenLoc),
-                    ErrMsg.str()));
+                    ErrMsg));
         } else {
             CheckLocationWhitespace(NameEndLoc, LParenLoc, 0, SM, LangOpts);
         }
 
         // The first and last function parameters should have no space between
         // them and the declaration parentheses
-        clang::SourceLocation RParenLoc;
-        if (Node->getNumParams() == 0) {
-            RParenLoc =
-                    utils::FindCharLocation(LParenLoc, ')', SM, Result.Context);
-        } else {
-            auto LastParamLoc =
-                    Node->getParamDecl(Node->getNumParams() - 1)->getEndLoc();
-            RParenLoc = utils::FindCharLocation(
-                    LastParamLoc.getLocWithOffset(1), ')', SM, Result.Context);
+        auto FoundRParen =
+                utils::FindMatchingBracket(LParenLoc, SM, Result.Context);
+        if (!FoundRParen) {
+            return;
         }
+        auto RParenLoc = *FoundRParen;
         CheckParenWhitespace(LParenLoc, RParenLoc, SM, LangOpts);
 
         // Next we check the whitespace throughout the declaration from the
@@ -4,6 +4,8 @@
 #ifndef LLVM_CLANG_TOOLS_EXTRA_NETT_CHECKS_WHITESPACE_FUNCTIONBODYWHITESPACECHECK_HPP
 #define LLVM_CLANG_TOOLS_EXTRA_NETT_CHECKS_WHITESPACE_FUNCTIONBODYWHITESPACECHECK_HPP
 
+#include "../traversal/FunctionTraversal.hpp"
+
 #include "clang/ASTMatchers/ASTMatchFinder.h"
 
 namespace nett {
@@ -13,13 +15,29 @@ namespace whitespace {
 class FunctionBodyWhitespaceChecker
     : public clang::ast_matchers::MatchFinder::MatchCallback {
     public:
-    FunctionBodyWhitespaceChecker(clang::Preprocessor& PP) : PP(PP) {
-    }
     virtual void run(
             const clang::ast_matchers::MatchFinder::MatchResult& Result) override;
+};
 
-    private:
-    clang::Preprocessor& PP;
+// Checks the whitespace of the statements within a function's body as part
+// of a FunctionTraversal.
+class FunctionBodyWhitespaceModule
+    : public traversal::FunctionTraversalModule {
+    public:
+    bool BeginFunction(const clang::FunctionDecl* Node,
+            traversal::TraversalContext& Traversal);
+    void VisitIfStmt(
+            clang::IfStmt* Stmt, traversal::TraversalContext& Traversal);
+    void VisitForStmt(
+            clang::ForStmt* Stmt, traversal::TraversalContext& Traversal);
+    void VisitDoStmt(
+            clang::DoStmt* Stmt, traversal::TraversalContext& Traversal);
+    void VisitWhileStmt(
+            clang::WhileStmt* Stmt, traversal::TraversalContext& Traversal);
+    void VisitSwitchStmt(
+            clang::SwitchStmt* Stmt, traversal::TraversalContext& Traversal);
+    void VisitCaseStmt(
+            clang::CaseStmt* Stmt, traversal::TraversalContext& Traversal);
 };
 
 }  // namespace whitespace
@@ -12,8 +12,6 @@
 #include "clang/Lex/Lexer.h"
 #include "clang/Lex/Preprocessor.h"
 
-#include <sstream>
-
 using namespace clang::ast_matchers;
 
 namespace nett {
@@ -34,9 +32,13 @@ void FunctionCallWhitespaceChecker::run(
             return;
         }
 
-        auto LParenLoc = utils::FindCharLocation(
-                Node->getBeginLoc(), '(', SM, Result.Context);
         auto RParenLoc = Node->getRParenLoc();
+        auto FoundLParen = utils::FindCharLocation(
+                Node->getBeginLoc(), '(', SM, Result.Context, RParenLoc);
+        if (!FoundLParen) {
+            return;
+        }
+        auto LParenLoc = *FoundLParen;
         auto NameEndLoc =
                 GetPreviousNonWhitespaceLoc(LParenLoc.getLocWithOffset(-1), SM);
 
@@ -44,11 +46,11 @@ void FunctionCallWhitespaceChecker::run(
         // name if they are on the same line, there should be no spaces
         if (SM.getExpansionLineNumber(NameEndLoc) !=
                 SM.getExpansionLineNumber(LParenLoc)) {
-            std::stringstream ErrMsg;
-            ErrMsg << "Function calls should look like: func_call(...";
-            GlobalViolationManager.AddViolation(new WhitespaceViolation(
+            const char* ErrMsg = "Function calls should look like: "
+                                 "func_call(...";
+            GlobalViolationManager.AddViolation(WhitespaceViolation(
                     File.str(), SM.getExpansionLineNumber(NameEndLoc),
-                    ErrMsg.str()));
+                    ErrMsg));
         } else {
             CheckLocationWhitespace(NameEndLoc, LParenLoc, 0, SM, LangOpts);
         }
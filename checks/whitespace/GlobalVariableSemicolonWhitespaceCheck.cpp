@@ -12,8 +12,6 @@
 #include "clang/Lex/Lexer.h"
 #include "clang/Lex/Preprocessor.h"
 
-#include <sstream>
-
 using namespace clang::ast_matchers;
 
 namespace nett {
@@ -34,8 +32,12 @@ void GlobalVariableSemicolonWhitespaceChecker::run(
             return;
         }
 
-        auto ColonLoc = utils::FindCharLocation(
+        auto FoundColon = utils::FindCharLocation(
                 Node->getEndLoc(), ';', SM, Result.Context);
+        if (!FoundColon) {
+            return;
+        }
+        auto ColonLoc = *FoundColon;
         auto ColonLineNo = SM.getExpansionLineNumber(ColonLoc);
 
         // Now we've found the semi-colon, so we move backward
@@ -52,11 +54,10 @@ void GlobalVariableSemicolonWhitespaceChecker::run(
         auto PrevLineNo = SM.getExpansionLineNumber(PrevLoc);
 
         if (PrevLineNo != ColonLineNo) {
-            std::stringstream ErrMsg;
-            ErrMsg << "Semicolons should be on the same line as the end of a "
-                      "declaration.";
-            GlobalViolationManager.AddViolation(new WhitespaceViolation(
-                    File.str(), ColonLineNo, ErrMsg.str()));
+            const char* ErrMsg = "Semicolons should be on the same line as the "
+                                 "end of a declaration.";
+            GlobalViolationManager.AddViolation(WhitespaceViolation(
+                    File.str(), ColonLineNo, ErrMsg));
         } else {
             CheckLocationWhitespace(PrevLoc, ColonLoc, 0, SM, LangOpts);
         }
@@ -3,16 +3,99 @@
  */
 #include "PointerStyles.hpp"
 
+#include "../../violations/ViolationManager.hpp"
+
 namespace nett {
 namespace checks {
 namespace whitespace {
 
-// We start off without any particular pointer style in use.
-enum PointerStyle PtrStyle = PTR_UNSET;
+thread_local PointerStyleManager GlobalPointerStyleManager;
+
+void PointerStyleManager::AddPointerUse(
+        std::string File, uint LineNo, enum PointerStyle Style) {
+
+    PointerUses.push_back({File, LineNo, Style});
+}
+
+enum PointerStyle PointerStyleManager::GetPointerStyle(void) {
+
+    // We start off without any particular pointer style in use.
+    if (PointerUses.empty()) {
+        return PointerStyle::PTR_UNSET;
+    }
+    return PointerUses.front().Style;
+}
+
+void PointerStyleManager::MergeFrom(PointerStyleManager& Other) {
+
+    PointerUses.insert(PointerUses.end(), Other.PointerUses.begin(),
+            Other.PointerUses.end());
+    Other.PointerUses.clear();
+}
+
+llvm::json::Value PointerStyleManager::ToJSON(void) const {
+
+    llvm::json::Array Uses;
+    for (const auto& Use : PointerUses) {
+        Uses.push_back(llvm::json::Array{
+                Use.File, Use.LineNo, static_cast<int>(Use.Style)});
+    }
+    return std::move(Uses);
+}
+
+bool PointerStyleManager::FromJSON(const llvm::json::Value& Value) {
+
+    const auto* Uses = Value.getAsArray();
+    if (!Uses) {
+        return false;
+    }
+
+    for (const auto& Item : *Uses) {
+        const auto* Fields = Item.getAsArray();
+        if (!Fields || Fields->size() != 3) {
+            return false;
+        }
+        auto File = (*Fields)[0].getAsString();
+        auto LineNo = (*Fields)[1].getAsInteger();
+        auto Style = (*Fields)[2].getAsInteger();
+        if (!File || !LineNo || !Style || *Style < PTR_LEFT ||
+                *Style > PTR_UNSET) {
+            return false;
+        }
+        AddPointerUse(File->str(), *LineNo, static_cast<PointerStyle>(*Style));
+    }
+    return true;
+}
+
+// Generates a violation for the given pointer if it doesn't follow the
+// given pointer style.
+static void CheckPointerUse(const PointerUse& Use, enum PointerStyle Style) {
+
+    if (Use.Style != Style) {
+        const char* ErrMsg = "Pointers should consistently be a* b or a *b, "
+                             "not a mix.";
+        GlobalViolationManager.AddViolation(
+                WhitespaceViolation(Use.File, Use.LineNo, ErrMsg));
+    }
+}
+
+void PointerStyleManager::GeneratePointerViolations(void) {
+
+    auto PtrStyle = GetPointerStyle();
+
+    for (const auto& Use : PointerUses) {
+        CheckPointerUse(Use, PtrStyle);
+    }
+}
+
+void PointerStyleManager::GeneratePointerViolations(const std::string& File) {
+
+    auto PtrStyle = GetPointerStyle();
 
-void SetPointerStyle(enum PointerStyle Style) {
-    if (PtrStyle == PointerStyle::PTR_UNSET) {
-        PtrStyle = Style;
+    for (const auto& Use : PointerUses) {
+        if (Use.File == File) {
+            CheckPointerUse(Use, PtrStyle);
+        }
     }
 }
 
@@ -4,6 +4,11 @@
 #ifndef LLVM_CLANG_TOOLS_EXTRA_NETT_CHECKS_WHITESPACE_POINTERSTYLES_HPP
 #define LLVM_CLANG_TOOLS_EXTRA_NETT_CHECKS_WHITESPACE_POINTERSTYLES_HPP
 
+#include "llvm/Support/JSON.h"
+
+#include <string>
+#include <vector>
+
 namespace nett {
 namespace checks {
 namespace whitespace {
@@ -14,17 +19,57 @@ enum PointerStyle {
     PTR_UNSET   // no pointer style found yet
 };
 
-// Sets the pointer style to use while checking.
-// If the pointer style has already been set, it is unchanged.
-void SetPointerStyle(enum PointerStyle Style);
+// A pointer whose alignment has been determined during checking
+struct PointerUse {
+    std::string File;
+    uint LineNo;
+    enum PointerStyle Style;
+};
+
+// Keeps track of the pointer styles in use for all source files.
+// Every file must use the style of the first pointer seen, so we only
+// generate violations once all of the files have been checked (and the
+// pointers are seen in the order the files were given to us).
+class PointerStyleManager {
+    public:
+    // Records a pointer with the given alignment at the given location.
+    void AddPointerUse(std::string File, uint LineNo, enum PointerStyle Style);
+
+    // Returns the style of the first pointer seen, or PTR_UNSET if no
+    // pointers have been seen yet.
+    enum PointerStyle GetPointerStyle(void);
+
+    // Appends the pointers recorded by another manager. The other manager
+    // should hold the pointers seen in files checked after ours.
+    void MergeFrom(PointerStyleManager& Other);
+
+    // Generates violations for all of the pointers which don't follow
+    // the first pointer style seen.
+    void GeneratePointerViolations(void);
+
+    // Generates the pointer violations for the given file only. Every file
+    // checked before it must have been merged in already.
+    void GeneratePointerViolations(const std::string& File);
+
+    // Returns the pointers recorded by the manager as JSON, for the result
+    // cache.
+    llvm::json::Value ToJSON(void) const;
+
+    // Appends the pointers stored by ToJSON. Returns false if the value
+    // isn't in that form.
+    bool FromJSON(const llvm::json::Value& Value);
+
+    private:
+    std::vector<PointerUse> PointerUses;
+};
 
-// We need to keep track of the pointer style in use for all source files.
-// The global variable allows us to perform pointer style checks
-// without having to inject the variable into any classes.
-extern enum PointerStyle PtrStyle;
+// The global variable allows us to record pointer styles without having to
+// inject the manager into any classes. Each thread which checks files
+// keeps its own manager.
+extern thread_local PointerStyleManager GlobalPointerStyleManager;
 
 }  // namespace whitespace
 }  // namespace checks
 }  // namespace nett
 
-#endif
\ No newline at end of file
+#endif
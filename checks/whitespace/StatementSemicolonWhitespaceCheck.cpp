@@ -7,14 +7,10 @@
 #include "../utils/Tokens.hpp"
 #include "WhitespaceCheck.hpp"
 
-#include "clang/AST/ParentMap.h"
-#include "clang/AST/RecursiveASTVisitor.h"
 #include "clang/Lex/Lexer.h"
 #include "clang/Lex/Preprocessor.h"
 
-#include <sstream>
-
-using namespace clang::ast_matchers;
+#include <iterator>
 
 namespace nett {
 namespace checks {
@@ -22,62 +18,74 @@ namespace whitespace {
 
 static bool isConstructStatement(const clang::Stmt* Stmt);
 
-void StatementSemicolonWhitespaceChecker::run(
-        const MatchFinder::MatchResult& Result) {
-
-    if (const auto* Node = Result.Nodes.getNodeAs<clang::Stmt>("stmt")) {
-
-        auto& SM = *Result.SourceManager;
-        auto LangOpts = Result.Context->getLangOpts();
-        auto File = SM.getFilename(Node->getBeginLoc());
-
-        if (!SM.isWrittenInMainFile(Node->getBeginLoc())) {
-            return;
-        }
-
-        // Constructs (compound statements, loops etc.)
-        // don't have semi-colons
-        if (isConstructStatement(Node)) {
-            return;
-        }
-
-        auto ColonLoc = utils::FindCharLocation(
-                Node->getEndLoc(), ';', SM, Result.Context);
-
-        // Here, we narrow down our statement matches to only
-        // get statements which are direct children of compound
-        // statements. This is because children are also matched
-        // which causes multiple errors to be generated.
-        // Note that we have to check constructs without braces
-        // separately for the same reason.
-        auto ParentNodes = Result.Context->getParents(*Node);
-        if (!ParentNodes[0].get<clang::CompoundStmt>()) {
-            return;
-        }
-
-        // Now we've found the semi-colon, so we move backward
-        auto PrevLoc = ColonLoc.getLocWithOffset(-1);
-        while (utils::isWhitespace(*SM.getCharacterData(PrevLoc))) {
-            PrevLoc = PrevLoc.getLocWithOffset(-1);
-        }
-
-        if (PrevLoc <= Node->getBeginLoc()) {
-            // We have an empty statement
-            return;
-        }
-
-        auto PrevLineNo = SM.getExpansionLineNumber(PrevLoc);
-        auto ColonLineNo = SM.getExpansionLineNumber(ColonLoc);
-
-        if (PrevLineNo != ColonLineNo) {
-            std::stringstream ErrMsg;
-            ErrMsg << "Semicolons should be on the same line as the end of a "
-                      "statement.";
-            GlobalViolationManager.AddViolation(new WhitespaceViolation(
-                    File.str(), ColonLineNo, ErrMsg.str()));
-        } else {
-            CheckLocationWhitespace(PrevLoc, ColonLoc, 0, SM, LangOpts);
-        }
+static void CheckStatementSemicolon(const clang::Stmt* Node,
+        clang::SourceLocation Limit, clang::ASTContext* Context);
+
+// Only the statements which are direct children of a compound statement are
+// checked, since their children would otherwise generate multiple errors.
+// Note that we have to check constructs without braces separately for the
+// same reason. A statement's semicolon comes before the next statement, or
+// before the closing brace.
+void StatementSemicolonWhitespaceModule::VisitCompoundStmt(
+        clang::CompoundStmt* Stmt, traversal::TraversalContext& Traversal) {
+
+    auto Body = Stmt->body();
+    for (auto It = Body.begin(); It != Body.end(); ++It) {
+        auto Next = std::next(It);
+        auto Limit = Next != Body.end() ? (*Next)->getBeginLoc()
+                                        : Stmt->getRBracLoc();
+        CheckStatementSemicolon(*It, Limit, Traversal.Context);
+    }
+}
+
+// Checks that the semicolon ending the given statement, which is found
+// before the given limit, is on the same line as the end of the statement,
+// with no whitespace before it.
+static void CheckStatementSemicolon(const clang::Stmt* Node,
+        clang::SourceLocation Limit, clang::ASTContext* Context) {
+
+    auto& SM = Context->getSourceManager();
+    auto LangOpts = Context->getLangOpts();
+    auto File = SM.getFilename(Node->getBeginLoc());
+
+    if (!SM.isWrittenInMainFile(Node->getBeginLoc())) {
+        return;
+    }
+
+    // Constructs (compound statements, loops etc.)
+    // don't have semi-colons
+    if (isConstructStatement(Node)) {
+        return;
+    }
+
+    auto FoundColon = utils::FindCharLocation(
+            Node->getEndLoc(), ';', SM, Context, Limit);
+    if (!FoundColon) {
+        return;
+    }
+    auto ColonLoc = *FoundColon;
+
+    // Now we've found the semi-colon, so we move backward
+    auto PrevLoc = ColonLoc.getLocWithOffset(-1);
+    while (utils::isWhitespace(*SM.getCharacterData(PrevLoc))) {
+        PrevLoc = PrevLoc.getLocWithOffset(-1);
+    }
+
+    if (PrevLoc <= Node->getBeginLoc()) {
+        // We have an empty statement
+        return;
+    }
+
+    auto PrevLineNo = SM.getExpansionLineNumber(PrevLoc);
+    auto ColonLineNo = SM.getExpansionLineNumber(ColonLoc);
+
+    if (PrevLineNo != ColonLineNo) {
+        const char* ErrMsg = "Semicolons should be on the same line as the end "
+                             "of a statement.";
+        GlobalViolationManager.AddViolation(WhitespaceViolation(
+                File.str(), ColonLineNo, ErrMsg));
+    } else {
+        CheckLocationWhitespace(PrevLoc, ColonLoc, 0, SM, LangOpts);
     }
 }
 
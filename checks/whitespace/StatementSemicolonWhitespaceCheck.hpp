@@ -4,17 +4,19 @@
 #ifndef LLVM_CLANG_TOOLS_EXTRA_NETT_CHECKS_WHITESPACE_STATEMENTSEMICOLONWHITESPACECHECK_HPP
 #define LLVM_CLANG_TOOLS_EXTRA_NETT_CHECKS_WHITESPACE_STATEMENTSEMICOLONWHITESPACECHECK_HPP
 
-#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "../traversal/FunctionTraversal.hpp"
 
 namespace nett {
 namespace checks {
 namespace whitespace {
 
-class StatementSemicolonWhitespaceChecker
-    : public clang::ast_matchers::MatchFinder::MatchCallback {
+// Checks the whitespace before the semicolon of each statement within a
+// function's body as part of a FunctionTraversal.
+class StatementSemicolonWhitespaceModule
+    : public traversal::FunctionTraversalModule {
     public:
-    virtual void run(
-            const clang::ast_matchers::MatchFinder::MatchResult& Result) override;
+    void VisitCompoundStmt(
+            clang::CompoundStmt* Stmt, traversal::TraversalContext& Traversal);
 };
 
 }  // namespace whitespace
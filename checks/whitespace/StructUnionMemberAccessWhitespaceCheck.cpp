@@ -7,8 +7,6 @@
 #include "../utils/Tokens.hpp"
 #include "WhitespaceCheck.hpp"
 
-#include <sstream>
-
 using namespace clang::ast_matchers;
 
 namespace nett {
@@ -29,7 +27,7 @@ void StructUnionMemberAccessWhitespaceChecker::run(
             return;
         }
 
-        std::string OpString = Node->isArrow() ? "->" : ".";
+        llvm::StringRef OpString = Node->isArrow() ? "->" : ".";
         auto OpLoc = Node->getOperatorLoc();
         auto OpEndLoc = OpLoc.getLocWithOffset(OpString.size() - 1);
 
@@ -44,10 +42,8 @@ void StructUnionMemberAccessWhitespaceChecker::run(
         auto LHSLineNo = SM.getExpansionLineNumber(LHSLoc);
 
         if (LHSLineNo != OpLineNo) {
-            std::stringstream ErrMsg;
-            ErrMsg << "Member accesses should look like: X" << OpString << "a";
-            GlobalViolationManager.AddViolation(new WhitespaceViolation(
-                    File.str(), OpLineNo, ErrMsg.str()));
+            GlobalViolationManager.AddViolation(
+                    Violation::MemberAccess(File.str(), OpLineNo, OpString));
         } else {
             // There should be no spaces to the left
             CheckLocationWhitespace(LHSLoc, OpLoc, 0, SM, LangOpts);
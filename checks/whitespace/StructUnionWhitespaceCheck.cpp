@@ -4,6 +4,7 @@
 #include "StructUnionWhitespaceCheck.hpp"
 
 #include "../../violations/ViolationManager.hpp"
+#include "../utils/TokenCache.hpp"
 #include "../utils/Tokens.hpp"
 #include "../utils/Typedef.hpp"
 #include "WhitespaceCheck.hpp"
@@ -13,14 +14,33 @@
 #include "clang/Lex/Lexer.h"
 #include "clang/Lex/Preprocessor.h"
 
-#include <sstream>
-
 using namespace clang::ast_matchers;
 
 namespace nett {
 namespace checks {
 namespace whitespace {
 
+// Checks that the given semicolon ending a field is on the same line as the
+// end of the field, with no whitespace before it.
+static void CheckFieldSemicolon(clang::SourceLocation SemiLoc,
+        llvm::StringRef File, clang::SourceManager& SM,
+        const clang::LangOptions& LangOpts) {
+
+    auto FieldEndLoc =
+            GetPreviousNonWhitespaceLoc(SemiLoc.getLocWithOffset(-1), SM);
+
+    if (SM.getExpansionLineNumber(SemiLoc) !=
+            SM.getExpansionLineNumber(FieldEndLoc)) {
+        const char* ErrMsg = "Semicolons should be on the same line as the end "
+                             "of a declaration.";
+        GlobalViolationManager.AddViolation(
+                WhitespaceViolation(File.str(),
+                        SM.getExpansionLineNumber(SemiLoc), ErrMsg));
+    } else {
+        CheckLocationWhitespace(FieldEndLoc, SemiLoc, 0, SM, LangOpts);
+    }
+}
+
 void StructUnionWhitespaceChecker::run(const MatchFinder::MatchResult& Result) {
 
     if (const auto* Node =
@@ -45,17 +65,15 @@ void StructUnionWhitespaceChecker::run(const MatchFinder::MatchResult& Result) {
             // We have a typedef
             if (SM.getExpansionLineNumber(RecordBeginLoc) !=
                     SM.getExpansionLineNumber(TypedefBeginLoc)) {
-                std::stringstream ErrMsg;
+                const char* ErrMsg = "Typedef'd structs should look like: "
+                                     "typedef struct ...";
                 if (Node->isUnion()) {
-                    ErrMsg << "Typedef'd unions should look like: typedef "
-                              "union ...";
-                } else {
-                    ErrMsg << "Typedef'd structs should look like: typedef "
-                              "struct ...";
+                    ErrMsg = "Typedef'd unions should look like: typedef "
+                             "union ...";
                 }
-                GlobalViolationManager.AddViolation(new WhitespaceViolation(
+                GlobalViolationManager.AddViolation(WhitespaceViolation(
                         File.str(), SM.getExpansionLineNumber(RecordBeginLoc),
-                        ErrMsg.str()));
+                        ErrMsg));
             } else {
                 auto TypedefEndLoc = TypedefBeginLoc.getLocWithOffset(6);
                 CheckLocationWhitespace(
@@ -75,21 +93,20 @@ void StructUnionWhitespaceChecker::run(const MatchFinder::MatchResult& Result) {
         if (!isAnonymous) {
             // The name of the record, and the 'struct/union' keyword should be
             // on the same line and single space separated
-            auto RecordName =
-                    clang::Lexer::findNextToken(RecordEndLoc, SM, LangOpts);
-            auto RecordNameStartLoc = RecordName->getLocation();
+            auto RecordName = utils::GlobalTokenCache.GetCursor(
+                    RecordEndLoc, SM, LangOpts);
+            RecordName.NextCode();
+            auto RecordNameStartLoc = RecordName.GetLocation();
 
             if (SM.getExpansionLineNumber(RecordEndLoc) !=
                     SM.getExpansionLineNumber(RecordNameStartLoc)) {
-                std::stringstream ErrMsg;
+                const char* ErrMsg = "Structs should look like: struct X";
                 if (Node->isUnion()) {
-                    ErrMsg << "Unions should look like: union X";
-                } else {
-                    ErrMsg << "Structs should look like: struct X";
+                    ErrMsg = "Unions should look like: union X";
                 }
-                GlobalViolationManager.AddViolation(new WhitespaceViolation(
+                GlobalViolationManager.AddViolation(WhitespaceViolation(
                         File.str(), SM.getExpansionLineNumber(RecordEndLoc),
-                        ErrMsg.str()));
+                        ErrMsg));
             } else {
                 CheckLocationWhitespace(
                         RecordEndLoc, RecordNameStartLoc, 1, SM, LangOpts);
@@ -99,26 +116,29 @@ void StructUnionWhitespaceChecker::run(const MatchFinder::MatchResult& Result) {
             // on the same line and be single space separated
             if (Node->isThisDeclarationADefinition()) {
                 auto RecordNameEndLoc = RecordNameStartLoc.getLocWithOffset(
-                        RecordName->getLength() - 1);
-                auto OpenBraceLoc = utils::FindCharLocation(
-                        RecordNameEndLoc, '{', SM, Result.Context);
-
-                if (SM.getExpansionLineNumber(RecordNameEndLoc) ==
-                        SM.getExpansionLineNumber(OpenBraceLoc)) {
+                        RecordName.GetLength() - 1);
+                auto OpenBraceLoc = utils::FindCharLocation(RecordNameEndLoc,
+                        '{', SM, Result.Context,
+                        Node->getBraceRange().getBegin());
+
+                if (OpenBraceLoc &&
+                        SM.getExpansionLineNumber(RecordNameEndLoc) ==
+                                SM.getExpansionLineNumber(*OpenBraceLoc)) {
                     CheckLocationWhitespace(
-                            RecordNameEndLoc, OpenBraceLoc, 1, SM, LangOpts);
+                            RecordNameEndLoc, *OpenBraceLoc, 1, SM, LangOpts);
                 }
             }
         } else {
             // The 'struct/union' keyword and the open curly brace should be
             // on the same line and be single space separated
             if (Node->isThisDeclarationADefinition()) {
-                auto OpenBraceLoc = utils::FindCharLocation(
-                        RecordEndLoc, '{', SM, Result.Context);
-                if (SM.getExpansionLineNumber(RecordEndLoc) ==
-                        SM.getExpansionLineNumber(OpenBraceLoc)) {
+                auto OpenBraceLoc = utils::FindCharLocation(RecordEndLoc, '{',
+                        SM, Result.Context, Node->getBraceRange().getBegin());
+                if (OpenBraceLoc &&
+                        SM.getExpansionLineNumber(RecordEndLoc) ==
+                                SM.getExpansionLineNumber(*OpenBraceLoc)) {
                     CheckLocationWhitespace(
-                            RecordEndLoc, OpenBraceLoc, 1, SM, LangOpts);
+                            RecordEndLoc, *OpenBraceLoc, 1, SM, LangOpts);
                 }
             }
         }
@@ -132,22 +152,11 @@ void StructUnionWhitespaceChecker::run(const MatchFinder::MatchResult& Result) {
                     continue;
                 }
 
-                auto SemiLoc = utils::FindCharLocation(
-                        Field->getEndLoc(), ';', SM, Result.Context);
-                auto FieldEndLoc = GetPreviousNonWhitespaceLoc(
-                        SemiLoc.getLocWithOffset(-1), SM);
-
-                if (SM.getExpansionLineNumber(SemiLoc) !=
-                        SM.getExpansionLineNumber(FieldEndLoc)) {
-                    std::stringstream ErrMsg;
-                    ErrMsg << "Semicolons should be on the same line as the "
-                              "end of a declaration.";
-                    GlobalViolationManager.AddViolation(new WhitespaceViolation(
-                            File.str(), SM.getExpansionLineNumber(SemiLoc),
-                            ErrMsg.str()));
-                } else {
-                    CheckLocationWhitespace(
-                            FieldEndLoc, SemiLoc, 0, SM, LangOpts);
+                auto SemiLoc = utils::FindCharLocation(Field->getEndLoc(),
+                        ';', SM, Result.Context,
+                        Node->getBraceRange().getEnd());
+                if (SemiLoc) {
+                    CheckFieldSemicolon(*SemiLoc, File, SM, LangOpts);
                 }
 
                 CheckSourceRangeWhitespaceTokens(
@@ -157,19 +166,22 @@ void StructUnionWhitespaceChecker::run(const MatchFinder::MatchResult& Result) {
 
         // Finally, we check that the ending semi-colon is directly after the
         // end of the record
-        auto SemiLoc = utils::FindCharLocation(
+        auto FoundSemi = utils::FindCharLocation(
                 Node->getEndLoc(), ';', SM, Result.Context);
+        if (!FoundSemi) {
+            return;
+        }
+        auto SemiLoc = *FoundSemi;
         auto EndLoc =
                 GetPreviousNonWhitespaceLoc(SemiLoc.getLocWithOffset(-1), SM);
 
         if (SM.getExpansionLineNumber(SemiLoc) !=
                 SM.getExpansionLineNumber(EndLoc)) {
-            std::stringstream ErrMsg;
-            ErrMsg << "Semicolons should be on the same line as the end of a "
-                      "declaration.";
+            const char* ErrMsg = "Semicolons should be on the same line as the "
+                                 "end of a declaration.";
             GlobalViolationManager.AddViolation(
-                    new WhitespaceViolation(File.str(),
-                            SM.getExpansionLineNumber(SemiLoc), ErrMsg.str()));
+                    WhitespaceViolation(File.str(),
+                            SM.getExpansionLineNumber(SemiLoc), ErrMsg));
         } else {
             CheckLocationWhitespace(EndLoc, SemiLoc, 0, SM, LangOpts);
         }
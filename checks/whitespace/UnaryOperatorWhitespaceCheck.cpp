@@ -12,8 +12,6 @@
 #include "clang/Lex/Lexer.h"
 #include "clang/Lex/Preprocessor.h"
 
-#include <sstream>
-
 using namespace clang::ast_matchers;
 
 namespace nett {
@@ -34,7 +32,7 @@ void UnaryOperatorWhitespaceChecker::run(
             return;
         }
 
-        auto OpString = Node->getOpcodeStr(Node->getOpcode()).str();
+        auto OpString = Node->getOpcodeStr(Node->getOpcode());
         auto OpLoc = Node->getOperatorLoc();
         auto OpEndLoc = OpLoc.getLocWithOffset(OpString.size() - 1);
         auto ExprLoc = OpLoc;
@@ -61,16 +59,8 @@ void UnaryOperatorWhitespaceChecker::run(
         auto ExprLineNo = SM.getExpansionLineNumber(ExprLoc);
 
         if (OpLineNo != ExprLineNo) {
-            std::stringstream ErrMsg;
-            ErrMsg << "Unary operators should look like: ";
-
-            if (Node->isPostfix()) {
-                ErrMsg << "X" << OpString;
-            } else {
-                ErrMsg << OpString << "X";
-            }
-            GlobalViolationManager.AddViolation(new WhitespaceViolation(
-                    File.str(), OpLineNo, ErrMsg.str()));
+            GlobalViolationManager.AddViolation(Violation::UnaryOperator(
+                    File.str(), OpLineNo, OpString, Node->isPostfix()));
         } else {
             if (Node->isPostfix()) {  // postfix: x++
                 CheckLocationWhitespace(ExprLoc, OpLoc, 0, SM, LangOpts);
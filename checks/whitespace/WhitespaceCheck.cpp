@@ -4,13 +4,12 @@
 #include "WhitespaceCheck.hpp"
 
 #include "../../violations/ViolationManager.hpp"
+#include "../utils/TokenCache.hpp"
 #include "../utils/Tokens.hpp"
 #include "PointerStyles.hpp"
 
 #include "clang/Lex/Lexer.h"
 
-#include <sstream>
-
 namespace nett {
 namespace checks {
 namespace whitespace {
@@ -22,21 +21,9 @@ void GenerateWhitespaceViolation(clang::SourceLocation ErrLoc,
     auto File = SM.getFilename(ErrLoc);
     auto LineNo = SM.getSpellingLineNumber(ErrLoc);
 
-    std::string SpaceString;
-    if (ExpectedSpaces == 1) {
-        SpaceString = "space";
-    } else {
-        SpaceString = "spaces";
-    }
-
-    std::stringstream ErrMsg;
-    ErrMsg << "'" << TokenString << "' "
-           << "at position " << ColNo << ", "
-           << "expected " << ExpectedSpaces << " " << SpaceString << ", "
-           << "found " << ActualSpaces;
-
-    GlobalViolationManager.AddViolation(
-            new WhitespaceViolation(File.str(), LineNo, ErrMsg.str()));
+    // The message is only formatted if the violation gets printed
+    GlobalViolationManager.AddViolation(Violation::TokenSpacing(File, LineNo,
+            ColNo, TokenString, ExpectedSpaces, ActualSpaces));
 }
 
 void CheckLocationWhitespace(clang::SourceLocation StartLoc,
@@ -112,10 +99,9 @@ void CheckParenWhitespace(clang::SourceLocation LParenLoc,
     }
 
     if (SM.getSpellingLineNumber(CurrentLoc) != RParenLineNo) {
-        std::stringstream ErrMsg;
-        ErrMsg << "Closing parentheses should look like: ...X)";
-        GlobalViolationManager.AddViolation(new WhitespaceViolation(
-                File.str(), RParenLineNo, ErrMsg.str()));
+        const char* ErrMsg = "Closing parentheses should look like: ...X)";
+        GlobalViolationManager.AddViolation(WhitespaceViolation(
+                File.str(), RParenLineNo, ErrMsg));
     } else {
         if (LParenLoc != CurrentLoc) {
             CheckLocationWhitespace(CurrentLoc, RParenLoc, 0, SM, LangOpts);
@@ -141,20 +127,18 @@ void CheckSourceRangeCommaWhitespace(clang::SourceLocation StartLoc,
         auto NextTokenLoc = GetNextNonWhitespaceLoc(
                 NextCommaLocation.getLocWithOffset(1), SM);
 
-        // Check that we aren't inside a string
-        auto CurrentTokenLoc = clang::Lexer::GetBeginningOfToken(
+        // Check that we aren't inside a string or a comment
+        auto CurrentToken = utils::GlobalTokenCache.GetCursor(
                 NextCommaLocation, SM, LangOpts);
-        auto CurrentToken = clang::Lexer::findNextToken(
-                CurrentTokenLoc.getLocWithOffset(-1), SM, LangOpts);
 
-        if (CurrentToken->getKind() != clang::tok::comma) {
+        if (CurrentToken.GetKind() != clang::tok::comma) {
             Offset = SourceText.find(",", Offset + Comma.size());
             continue;
         }
 
         // We also need to skip comments
-        clang::Token Temp;
-        clang::Lexer::getRawToken(NextTokenLoc, Temp, SM, LangOpts);
+        auto NextToken =
+                utils::GlobalTokenCache.GetCursor(NextTokenLoc, SM, LangOpts);
 
         if (SM.getSpellingLineNumber(PrevTokenLoc) ==
                 SM.getSpellingLineNumber(NextCommaLocation)) {
@@ -162,7 +146,7 @@ void CheckSourceRangeCommaWhitespace(clang::SourceLocation StartLoc,
             CheckLocationWhitespace(
                     PrevTokenLoc, NextCommaLocation, 0, SM, LangOpts);
         }
-        if (Temp.getKind() != clang::tok::comment &&
+        if (!NextToken.IsComment() &&
                 SM.getSpellingLineNumber(NextTokenLoc) ==
                         SM.getSpellingLineNumber(NextCommaLocation)) {
             // There should be one space after the comma
@@ -190,51 +174,42 @@ int CountLocationWhitespace(clang::SourceLocation StartLoc,
     return EndColNo - StartColNo - 1;
 }
 
+// Records the alignment of the given pointer. Whether or not it follows the
+// pointer style in use is decided once all of the files have been checked.
 void CheckPointerAlignment(clang::SourceLocation PtrLoc,
         enum PointerStyle ExpectedStyle, clang::SourceManager& SM) {
 
     auto File = SM.getFilename(PtrLoc);
 
-    if (PtrStyle != ExpectedStyle) {
-        std::stringstream ErrMsg;
-        ErrMsg << "Pointers should consistently be a* b or a *b, not a mix.";
-        GlobalViolationManager.AddViolation(new WhitespaceViolation(
-                File.str(), SM.getExpansionLineNumber(PtrLoc), ErrMsg.str()));
-    }
+    GlobalPointerStyleManager.AddPointerUse(
+            File.str(), SM.getExpansionLineNumber(PtrLoc), ExpectedStyle);
 }
 
 // Checks if the given pointer token is within brackets '[]'
 // If so, it is not a pointer, but a multiplication sign. So we return true.
-// Otherwise, if no brackets are found within the given min and
+// Otherwise, if no brackets around it are found within the given min and
 // max source locations, returns false.
 bool PointerInBrackets(llvm::Optional<clang::Token> Token,
         clang::SourceManager& SM, clang::LangOptions LangOpts,
         clang::SourceLocation RangeMinLoc, clang::SourceLocation RangeMaxLoc) {
 
-    auto PointerLoc = SM.getFileLoc(Token->getLocation());
-    auto LHS = PointerLoc.getLocWithOffset(-1);
-    auto RHS = PointerLoc.getLocWithOffset(1);
-
-    bool FoundOpeningBracket = false;
-    bool FoundClosingBracket = false;
+    auto MinOffset = SM.getFileOffset(SM.getFileLoc(RangeMinLoc));
+    auto MaxOffset = SM.getFileOffset(SM.getFileLoc(RangeMaxLoc));
+    auto Cursor = utils::GlobalTokenCache.GetCursor(
+            Token->getLocation(), SM, LangOpts);
 
-    while (LHS >= RangeMinLoc) {
-        if (*SM.getCharacterData(LHS) == '[') {
-            FoundOpeningBracket = true;
-            break;
+    // The brackets are paired when the file is lexed, so we only need to
+    // look at those around the pointer (e.g. the '[' in a[(b * c)]).
+    while (Cursor.MoveToEnclosing() && Cursor.Get().Offset >= MinOffset) {
+        if (Cursor.GetKind() != clang::tok::l_square) {
+            continue;
         }
-        LHS = LHS.getLocWithOffset(-1);
-    }
-
-    while (RHS <= RangeMaxLoc) {
-        if (*SM.getCharacterData(RHS) == ']') {
-            FoundClosingBracket = true;
-            break;
+        auto Bracket = Cursor;
+        if (Bracket.MoveToMatch() && Bracket.Get().Offset <= MaxOffset) {
+            return true;
         }
-        RHS = RHS.getLocWithOffset(1);
     }
-
-    return FoundOpeningBracket && FoundClosingBracket;
+    return false;
 }
 
 void CheckPointerSpacing(llvm::Optional<clang::Token> CurrentToken,
@@ -253,11 +228,10 @@ void CheckPointerSpacing(llvm::Optional<clang::Token> CurrentToken,
         auto RightPtrLoc = NextToken->getLocation();
         if (SM.getExpansionLineNumber(LeftPtrLoc) !=
                 SM.getExpansionLineNumber(RightPtrLoc)) {
-            std::stringstream ErrMsg;
-            ErrMsg << "Pointers should not be split across lines.";
-            GlobalViolationManager.AddViolation(new WhitespaceViolation(
+            const char* ErrMsg = "Pointers should not be split across lines.";
+            GlobalViolationManager.AddViolation(WhitespaceViolation(
                     File.str(), SM.getExpansionLineNumber(LeftPtrLoc),
-                    ErrMsg.str()));
+                    ErrMsg));
         } else {
             CheckLocationWhitespace(LeftPtrLoc, RightPtrLoc, 0, SM, LangOpts);
         }
@@ -276,11 +250,10 @@ void CheckPointerSpacing(llvm::Optional<clang::Token> CurrentToken,
 
         if (SM.getExpansionLineNumber(PtrLoc) !=
                 SM.getExpansionLineNumber(TokenLoc)) {
-            std::stringstream ErrMsg;
-            ErrMsg << "Pointers should look like this: *X";
+            const char* ErrMsg = "Pointers should look like this: *X";
             GlobalViolationManager.AddViolation(
-                    new WhitespaceViolation(File.str(),
-                            SM.getExpansionLineNumber(PtrLoc), ErrMsg.str()));
+                    WhitespaceViolation(File.str(),
+                            SM.getExpansionLineNumber(PtrLoc), ErrMsg));
             return;
         }
 
@@ -291,12 +264,13 @@ void CheckPointerSpacing(llvm::Optional<clang::Token> CurrentToken,
         //      -> it is a left-aligned pointer: int[* token]
 
         // Function pointer case
-        auto RParenToken = clang::Lexer::findNextToken(
+        auto ParenToken = utils::GlobalTokenCache.GetCursor(
                 NextToken->getLocation(), SM, LangOpts);
-        auto LParenToken = clang::Lexer::findNextToken(
-                RParenToken->getLocation(), SM, LangOpts);
-        if (*SM.getCharacterData(RParenToken->getLocation()) == ')' &&
-                *SM.getCharacterData(LParenToken->getLocation()) == '(') {
+        ParenToken.NextCode();
+        bool IsRParen = ParenToken.GetKind() == clang::tok::r_paren;
+        ParenToken.NextCode();
+        bool IsLParen = ParenToken.GetKind() == clang::tok::l_paren;
+        if (IsRParen && IsLParen) {
             // There should be no space between the pointer and the variable
             // name
             CheckLocationWhitespace(PtrLoc, TokenLoc, 0, SM, LangOpts);
@@ -309,13 +283,10 @@ void CheckPointerSpacing(llvm::Optional<clang::Token> CurrentToken,
         }
 
         // Pointer alignment case
-        auto PrevTokenStart = clang::Lexer::GetBeginningOfToken(
-                GetPreviousNonWhitespaceLoc(PtrLoc.getLocWithOffset(-1), SM),
-                SM, LangOpts);
-        auto PrevToken = clang::Lexer::findNextToken(
-                PrevTokenStart.getLocWithOffset(-1), SM, LangOpts);
-        auto PrevTokenLoc = PrevToken->getLocation().getLocWithOffset(
-                PrevToken->getLength() - 1);
+        auto PrevToken =
+                utils::GlobalTokenCache.GetCursor(PtrLoc, SM, LangOpts);
+        PrevToken.PrevCode();
+        auto PrevTokenLoc = PrevToken.GetLastCharLocation();
 
         // We don't check alignment if all three parts are not on the same line
         if (SM.getExpansionLineNumber(PrevTokenLoc) !=
@@ -336,7 +307,6 @@ void CheckPointerSpacing(llvm::Optional<clang::Token> CurrentToken,
 
         if (PrevToPtrSpaceCount == 0 && PtrToNextSpaceCount != 0) {
             // We have: token* token (left aligned)
-            SetPointerStyle(PointerStyle::PTR_LEFT);
             CheckPointerAlignment(PtrLoc, PointerStyle::PTR_LEFT, SM);
         } else if (PrevToPtrSpaceCount != 0 && PtrToNextSpaceCount == 0) {
             // We have: token *token (right aligned)
@@ -345,13 +315,11 @@ void CheckPointerSpacing(llvm::Optional<clang::Token> CurrentToken,
                 // checked elsewhere
                 return;
             }
-            SetPointerStyle(PointerStyle::PTR_RIGHT);
             CheckPointerAlignment(PtrLoc, PointerStyle::PTR_RIGHT, SM);
         } else if (PrevToPtrSpaceCount == 0 && PtrToNextSpaceCount == 0) {
             // We have: token*token
             if (*SM.getCharacterData(PrevTokenLoc) == '*') {
                 // We have: **token (right alignment)
-                SetPointerStyle(PointerStyle::PTR_RIGHT);
                 CheckPointerAlignment(PtrLoc, PointerStyle::PTR_RIGHT, SM);
                 return;
             } else if (*SM.getCharacterData(PrevTokenLoc) == '(') {
@@ -363,18 +331,16 @@ void CheckPointerSpacing(llvm::Optional<clang::Token> CurrentToken,
             }
 
             // We have too little space.
-            std::stringstream ErrMsg;
-            ErrMsg << "Pointers should be a* b or a *b, not a*b.";
+            const char* ErrMsg = "Pointers should be a* b or a *b, not a*b.";
             GlobalViolationManager.AddViolation(
-                    new WhitespaceViolation(File.str(),
-                            SM.getExpansionLineNumber(PtrLoc), ErrMsg.str()));
+                    WhitespaceViolation(File.str(),
+                            SM.getExpansionLineNumber(PtrLoc), ErrMsg));
         } else if (PrevToPtrSpaceCount != 0 && PtrToNextSpaceCount != 0) {
             // We have: token * token (too much space)
-            std::stringstream ErrMsg;
-            ErrMsg << "Pointers should be a* b or a *b, not a * b.";
+            const char* ErrMsg = "Pointers should be a* b or a *b, not a * b.";
             GlobalViolationManager.AddViolation(
-                    new WhitespaceViolation(File.str(),
-                            SM.getExpansionLineNumber(PtrLoc), ErrMsg.str()));
+                    WhitespaceViolation(File.str(),
+                            SM.getExpansionLineNumber(PtrLoc), ErrMsg));
         }
     }
     if (CurrentTokenData != '*' && NextTokenData == '*') {
@@ -393,11 +359,10 @@ void CheckPointerSpacing(llvm::Optional<clang::Token> CurrentToken,
 
         if (SM.getExpansionLineNumber(PtrLoc) !=
                 SM.getExpansionLineNumber(TokenLoc)) {
-            std::stringstream ErrMsg;
-            ErrMsg << "Pointers should look like this: X*";
+            const char* ErrMsg = "Pointers should look like this: X*";
             GlobalViolationManager.AddViolation(
-                    new WhitespaceViolation(File.str(),
-                            SM.getExpansionLineNumber(PtrLoc), ErrMsg.str()));
+                    WhitespaceViolation(File.str(),
+                            SM.getExpansionLineNumber(PtrLoc), ErrMsg));
             return;
         }
 
@@ -413,8 +378,10 @@ void CheckPointerSpacing(llvm::Optional<clang::Token> CurrentToken,
         }
 
         // Pointer alignment case
-        auto NextToken = clang::Lexer::findNextToken(PtrLoc, SM, LangOpts);
-        auto NextTokenLoc = NextToken->getLocation();
+        auto NextToken =
+                utils::GlobalTokenCache.GetCursor(PtrLoc, SM, LangOpts);
+        NextToken.NextCode();
+        auto NextTokenLoc = NextToken.GetLocation();
 
         // We don't check alignment if all three parts are not on the same line
         if (SM.getExpansionLineNumber(NextTokenLoc) !=
@@ -435,17 +402,14 @@ void CheckPointerSpacing(llvm::Optional<clang::Token> CurrentToken,
 
         if (PrevToPtrSpaceCount == 0 && PtrToNextSpaceCount != 0) {
             // We have: token* nextToken (left aligned)
-            SetPointerStyle(PointerStyle::PTR_LEFT);
             CheckPointerAlignment(PtrLoc, PointerStyle::PTR_LEFT, SM);
         } else if (PrevToPtrSpaceCount != 0 && PtrToNextSpaceCount == 0) {
             // We have: token *nextToken (right aligned)
-            SetPointerStyle(PointerStyle::PTR_RIGHT);
             CheckPointerAlignment(PtrLoc, PointerStyle::PTR_RIGHT, SM);
         } else if (PrevToPtrSpaceCount == 0 && PtrToNextSpaceCount == 0) {
             // We have: token*nextToken
             if (*SM.getCharacterData(NextTokenLoc) == '*') {
                 // We have: token** (left alignment)
-                SetPointerStyle(PointerStyle::PTR_LEFT);
                 CheckPointerAlignment(PtrLoc, PointerStyle::PTR_LEFT, SM);
                 return;
             } else if (*SM.getCharacterData(NextTokenLoc) == ')') {
@@ -460,18 +424,16 @@ void CheckPointerSpacing(llvm::Optional<clang::Token> CurrentToken,
             }
 
             // Otherwise we have too little space
-            std::stringstream ErrMsg;
-            ErrMsg << "Pointers should be a* b or a *b, not a*b.";
+            const char* ErrMsg = "Pointers should be a* b or a *b, not a*b.";
             GlobalViolationManager.AddViolation(
-                    new WhitespaceViolation(File.str(),
-                            SM.getExpansionLineNumber(PtrLoc), ErrMsg.str()));
+                    WhitespaceViolation(File.str(),
+                            SM.getExpansionLineNumber(PtrLoc), ErrMsg));
         } else if (PrevToPtrSpaceCount != 0 && PtrToNextSpaceCount != 0) {
             // We have: token * nextToken (too much space)
-            std::stringstream ErrMsg;
-            ErrMsg << "Pointers should be a* b or a *b, not a * b.";
+            const char* ErrMsg = "Pointers should be a* b or a *b, not a * b.";
             GlobalViolationManager.AddViolation(
-                    new WhitespaceViolation(File.str(),
-                            SM.getExpansionLineNumber(PtrLoc), ErrMsg.str()));
+                    WhitespaceViolation(File.str(),
+                            SM.getExpansionLineNumber(PtrLoc), ErrMsg));
         }
     }
 }
@@ -491,11 +453,10 @@ void CheckSquareBracketSpacing(llvm::Optional<clang::Token> CurrentToken,
         auto RightBracketLoc = NextToken->getLocation();
         if (SM.getExpansionLineNumber(LeftBracketLoc) !=
                 SM.getExpansionLineNumber(RightBracketLoc)) {
-            std::stringstream ErrMsg;
-            ErrMsg << "Empty brackets should look like: []";
-            GlobalViolationManager.AddViolation(new WhitespaceViolation(
+            const char* ErrMsg = "Empty brackets should look like: []";
+            GlobalViolationManager.AddViolation(WhitespaceViolation(
                     File.str(), SM.getExpansionLineNumber(LeftBracketLoc),
-                    ErrMsg.str()));
+                    ErrMsg));
         } else {
             CheckLocationWhitespace(
                     LeftBracketLoc, RightBracketLoc, 0, SM, LangOpts);
@@ -508,11 +469,10 @@ void CheckSquareBracketSpacing(llvm::Optional<clang::Token> CurrentToken,
         auto TokenLoc = NextToken->getLocation();
         if (SM.getExpansionLineNumber(LeftBracketLoc) !=
                 SM.getExpansionLineNumber(TokenLoc)) {
-            std::stringstream ErrMsg;
-            ErrMsg << "Opening brackets should look like: [X...";
-            GlobalViolationManager.AddViolation(new WhitespaceViolation(
+            const char* ErrMsg = "Opening brackets should look like: [X...";
+            GlobalViolationManager.AddViolation(WhitespaceViolation(
                     File.str(), SM.getExpansionLineNumber(LeftBracketLoc),
-                    ErrMsg.str()));
+                    ErrMsg));
         } else {
             CheckLocationWhitespace(LeftBracketLoc, TokenLoc, 0, SM, LangOpts);
         }
@@ -525,11 +485,10 @@ void CheckSquareBracketSpacing(llvm::Optional<clang::Token> CurrentToken,
         auto RightBracketLoc = NextToken->getLocation();
         if (SM.getExpansionLineNumber(TokenLoc) !=
                 SM.getExpansionLineNumber(RightBracketLoc)) {
-            std::stringstream ErrMsg;
-            ErrMsg << "Closing brackets should look like: ...X]";
-            GlobalViolationManager.AddViolation(new WhitespaceViolation(
+            const char* ErrMsg = "Closing brackets should look like: ...X]";
+            GlobalViolationManager.AddViolation(WhitespaceViolation(
                     File.str(), SM.getExpansionLineNumber(RightBracketLoc),
-                    ErrMsg.str()));
+                    ErrMsg));
         } else {
             CheckLocationWhitespace(TokenLoc, RightBracketLoc, 0, SM, LangOpts);
         }
@@ -543,11 +502,10 @@ void CheckSquareBracketSpacing(llvm::Optional<clang::Token> CurrentToken,
 
         if (SM.getExpansionLineNumber(TokenLoc) !=
                 SM.getExpansionLineNumber(LeftBracketLoc)) {
-            std::stringstream ErrMsg;
-            ErrMsg << "Opening brackets should look like: ...X[";
-            GlobalViolationManager.AddViolation(new WhitespaceViolation(
+            const char* ErrMsg = "Opening brackets should look like: ...X[";
+            GlobalViolationManager.AddViolation(WhitespaceViolation(
                     File.str(), SM.getExpansionLineNumber(LeftBracketLoc),
-                    ErrMsg.str()));
+                    ErrMsg));
         } else {
             CheckLocationWhitespace(TokenLoc, LeftBracketLoc, 0, SM, LangOpts);
         }
@@ -580,11 +538,10 @@ void CheckParenthesisSpacing(llvm::Optional<clang::Token> CurrentToken,
         auto ParenLoc = NextToken->getLocation();
         if (SM.getExpansionLineNumber(TokenLoc) !=
                 SM.getExpansionLineNumber(ParenLoc)) {
-            std::stringstream ErrMsg;
-            ErrMsg << "Closing parentheses should look like: ...X)";
+            const char* ErrMsg = "Closing parentheses should look like: ...X)";
             GlobalViolationManager.AddViolation(
-                    new WhitespaceViolation(File.str(),
-                            SM.getExpansionLineNumber(ParenLoc), ErrMsg.str()));
+                    WhitespaceViolation(File.str(),
+                            SM.getExpansionLineNumber(ParenLoc), ErrMsg));
         } else {
             CheckLocationWhitespace(TokenLoc, ParenLoc, 0, SM, LangOpts);
         }
@@ -597,11 +554,11 @@ void CheckParenthesisSpacing(llvm::Optional<clang::Token> CurrentToken,
         auto LParenLoc = NextToken->getLocation();
         if (SM.getExpansionLineNumber(RParenLoc) !=
                 SM.getExpansionLineNumber(LParenLoc)) {
-            std::stringstream ErrMsg;
-            ErrMsg << "Function pointer parentheses should look like: ...)(...";
-            GlobalViolationManager.AddViolation(new WhitespaceViolation(
+            const char* ErrMsg = "Function pointer parentheses should look "
+                                 "like: ...)(...";
+            GlobalViolationManager.AddViolation(WhitespaceViolation(
                     File.str(), SM.getExpansionLineNumber(LParenLoc),
-                    ErrMsg.str()));
+                    ErrMsg));
         } else {
             CheckLocationWhitespace(RParenLoc, LParenLoc, 0, SM, LangOpts);
         }
@@ -623,11 +580,10 @@ void CheckCurlyBraceSpacing(llvm::Optional<clang::Token> CurrentToken,
         auto RightBracketLoc = NextToken->getLocation();
         if (SM.getExpansionLineNumber(LeftBracketLoc) !=
                 SM.getExpansionLineNumber(RightBracketLoc)) {
-            std::stringstream ErrMsg;
-            ErrMsg << "Empty curly braces should look like: {}";
-            GlobalViolationManager.AddViolation(new WhitespaceViolation(
+            const char* ErrMsg = "Empty curly braces should look like: {}";
+            GlobalViolationManager.AddViolation(WhitespaceViolation(
                     File.str(), SM.getExpansionLineNumber(LeftBracketLoc),
-                    ErrMsg.str()));
+                    ErrMsg));
         } else {
             CheckLocationWhitespace(
                     LeftBracketLoc, RightBracketLoc, 0, SM, LangOpts);
@@ -664,11 +620,10 @@ void CheckCurlyBraceSpacing(llvm::Optional<clang::Token> CurrentToken,
 
         if (SM.getExpansionLineNumber(TokenLoc) !=
                 SM.getExpansionLineNumber(LeftBracketLoc)) {
-            std::stringstream ErrMsg;
-            ErrMsg << "Opening braces should look like: ...X {";
-            GlobalViolationManager.AddViolation(new WhitespaceViolation(
+            const char* ErrMsg = "Opening braces should look like: ...X {";
+            GlobalViolationManager.AddViolation(WhitespaceViolation(
                     File.str(), SM.getExpansionLineNumber(LeftBracketLoc),
-                    ErrMsg.str()));
+                    ErrMsg));
         } else {
             CheckLocationWhitespace(TokenLoc, LeftBracketLoc, 1, SM, LangOpts);
         }
@@ -702,11 +657,10 @@ void CheckCommaSpacing(llvm::Optional<clang::Token> CurrentToken,
         auto CommaLoc = NextToken->getLocation();
         if (SM.getExpansionLineNumber(CommaLoc) !=
                 SM.getExpansionLineNumber(TokenLoc)) {
-            std::stringstream ErrMsg;
-            ErrMsg << "Commas should look like: X,";
+            const char* ErrMsg = "Commas should look like: X,";
             GlobalViolationManager.AddViolation(
-                    new WhitespaceViolation(File.str(),
-                            SM.getExpansionLineNumber(CommaLoc), ErrMsg.str()));
+                    WhitespaceViolation(File.str(),
+                            SM.getExpansionLineNumber(CommaLoc), ErrMsg));
         } else {
             CheckLocationWhitespace(TokenLoc, CommaLoc, 0, SM, LangOpts);
         }
@@ -738,8 +692,8 @@ void CheckGeneralSpacing(llvm::Optional<clang::Token> CurrentToken,
     // Here we have two tokens which aren't special cases.
     // They don't need to be on the same line, but if they are
     // there must be a single space separating them
-    auto CurrentTokenEndLoc = clang::Lexer::getLocForEndOfToken(
-            CurrentToken->getLocation(), 1, SM, LangOpts);
+    auto CurrentTokenEndLoc = CurrentToken->getLocation().getLocWithOffset(
+            CurrentToken->getLength() - 1);
     auto NextTokenStartLoc = NextToken->getLocation();
 
     if (SM.getExpansionLineNumber(CurrentTokenEndLoc) ==
@@ -753,21 +707,13 @@ void CheckSourceRangeWhitespaceTokens(clang::SourceLocation StartLoc,
         clang::SourceLocation EndLoc, clang::SourceManager& SM,
         clang::LangOptions LangOpts) {
 
-    clang::Token CurrentToken;
-    clang::Token NextToken;
-
     StartLoc = GetNextNonWhitespaceLoc(StartLoc, SM);
-    clang::Lexer::getRawToken(StartLoc, CurrentToken, SM, LangOpts);
+    auto Cursor = utils::GlobalTokenCache.GetCursor(StartLoc, SM, LangOpts);
+    auto EndOffset = SM.getFileOffset(SM.getFileLoc(EndLoc));
 
-    do {
-        auto CurrEndLoc = CurrentToken.getEndLoc();
-        auto NextStartLoc = GetNextNonWhitespaceLoc(CurrEndLoc, SM);
-        clang::Lexer::getRawToken(NextStartLoc, NextToken, SM, LangOpts);
-
-        if (NextToken.getLocation() > EndLoc ||
-                CurrentToken.getLocation() == NextToken.getLocation()) {
-            break;
-        }
+    auto CurrentToken = Cursor.GetToken();
+    while (Cursor.Next() && Cursor.Get().Offset <= EndOffset) {
+        auto NextToken = Cursor.GetToken();
 
         auto CurrTok = llvm::Optional<clang::Token>(CurrentToken);
         auto NextTok = llvm::Optional<clang::Token>(NextToken);
@@ -779,28 +725,20 @@ void CheckSourceRangeWhitespaceTokens(clang::SourceLocation StartLoc,
         CheckGeneralSpacing(CurrTok, NextTok, SM, LangOpts);
 
         CurrentToken = NextToken;
-    } while (NextToken.getLocation() <= EndLoc);
+    }
 }
 
 void CheckSourceRangeWhitespaceTokensNoPointers(clang::SourceLocation StartLoc,
         clang::SourceLocation EndLoc, clang::SourceManager& SM,
         clang::LangOptions LangOpts) {
 
-    clang::Token CurrentToken;
-    clang::Token NextToken;
-
     StartLoc = GetNextNonWhitespaceLoc(StartLoc, SM);
-    clang::Lexer::getRawToken(StartLoc, CurrentToken, SM, LangOpts);
-
-    do {
-        auto CurrEndLoc = CurrentToken.getEndLoc();
-        auto NextStartLoc = GetNextNonWhitespaceLoc(CurrEndLoc, SM);
-        clang::Lexer::getRawToken(NextStartLoc, NextToken, SM, LangOpts);
+    auto Cursor = utils::GlobalTokenCache.GetCursor(StartLoc, SM, LangOpts);
+    auto EndOffset = SM.getFileOffset(SM.getFileLoc(EndLoc));
 
-        if (NextToken.getLocation() > EndLoc ||
-                CurrentToken.getLocation() == NextToken.getLocation()) {
-            break;
-        }
+    auto CurrentToken = Cursor.GetToken();
+    while (Cursor.Next() && Cursor.Get().Offset <= EndOffset) {
+        auto NextToken = Cursor.GetToken();
 
         auto CurrTok = llvm::Optional<clang::Token>(CurrentToken);
         auto NextTok = llvm::Optional<clang::Token>(NextToken);
@@ -811,7 +749,7 @@ void CheckSourceRangeWhitespaceTokensNoPointers(clang::SourceLocation StartLoc,
         CheckGeneralSpacing(CurrTok, NextTok, SM, LangOpts);
 
         CurrentToken = NextToken;
-    } while (NextToken.getLocation() <= EndLoc);
+    }
 }
 
 }  // namespace whitespace
@@ -0,0 +1,69 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#include "Corpus.hpp"
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+
+#include <algorithm>
+#include <fstream>
+
+namespace nett {
+namespace input {
+
+bool ReadCorpusManifest(
+        std::string ManifestPath, std::vector<std::string>& Submissions) {
+
+    std::ifstream Manifest(ManifestPath);
+    if (!Manifest.is_open()) {
+        return false;
+    }
+
+    auto ManifestDir = llvm::sys::path::parent_path(ManifestPath);
+    std::string Line;
+
+    while (std::getline(Manifest, Line)) {
+        auto Entry = llvm::StringRef(Line).trim();
+
+        if (Entry.empty() || Entry.startswith("#")) {
+            continue;
+        }
+
+        llvm::SmallString<128> SubmissionPath(Entry);
+        if (llvm::sys::path::is_relative(SubmissionPath)) {
+            SubmissionPath = ManifestDir;
+            llvm::sys::path::append(SubmissionPath, Entry);
+        }
+        Submissions.push_back(SubmissionPath.str().str());
+    }
+
+    return true;
+}
+
+std::vector<std::string> GetSubmissionFiles(std::string SubmissionPath) {
+
+    std::vector<std::string> Files;
+    std::error_code EC;
+
+    for (llvm::sys::fs::directory_iterator It(SubmissionPath, EC), End;
+            It != End && !EC; It.increment(EC)) {
+        auto Extension = llvm::sys::path::extension(It->path());
+
+        if (Extension != ".c" && Extension != ".h") {
+            continue;
+        }
+        if (!llvm::sys::fs::is_regular_file(It->path())) {
+            continue;
+        }
+        Files.push_back(It->path());
+    }
+
+    std::sort(Files.begin(), Files.end());
+    return Files;
+}
+
+}  // namespace input
+}  // namespace nett
@@ -0,0 +1,28 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#ifndef LLVM_CLANG_TOOLS_EXTRA_NETT_INPUT_CORPUS_HPP
+#define LLVM_CLANG_TOOLS_EXTRA_NETT_INPUT_CORPUS_HPP
+
+#include <string>
+#include <vector>
+
+namespace nett {
+namespace input {
+
+// Reads the submission directories listed in the corpus manifest at the
+// given filepath. Each line of the manifest names a single directory, and
+// relative paths are taken relative to the manifest itself. Blank lines
+// and lines starting with '#' are skipped.
+// Returns true if the manifest could be read, else returns false.
+bool ReadCorpusManifest(
+        std::string ManifestPath, std::vector<std::string>& Submissions);
+
+// Returns the C source and header files found directly within the given
+// submission directory, sorted by name.
+std::vector<std::string> GetSubmissionFiles(std::string SubmissionPath);
+
+}  // namespace input
+}  // namespace nett
+
+#endif
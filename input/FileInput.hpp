@@ -4,16 +4,20 @@
 #ifndef LLVM_CLANG_TOOLS_EXTRA_NETT_INPUT_FILEINPUT_HPP
 #define LLVM_CLANG_TOOLS_EXTRA_NETT_INPUT_FILEINPUT_HPP
 
+#include "llvm/ADT/StringRef.h"
+
 #include <string>
 
 namespace nett {
 namespace input {
 
-// Returns the sanitized content of the file at the given
-// filepath as a single string. Style checks on line length,
-// file naming etc. are performed on the file during the
-// sanitizing process.
-std::string GetSanitizedFileContent(const std::string FilePath);
+// Returns the sanitized version of the given content, which belongs to the
+// file at the given filepath. Style checks on line length, file naming
+// etc. are performed on the content during the sanitizing process, and the
+// index (lines and regions) of the sanitized content is added to the
+// GlobalSourceIndexManager.
+std::string GetSanitizedContent(
+        const std::string FilePath, llvm::StringRef Content);
 
 // Checks if the file at the given filepath can be accessed.
 // Returns true if the file is accessible, returns false otherwise.
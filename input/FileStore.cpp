@@ -0,0 +1,102 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#include "FileStore.hpp"
+
+#include "FileInput.hpp"
+
+#include <utility>
+
+namespace nett {
+namespace input {
+
+thread_local FileStore* GlobalFileStore = nullptr;
+
+// A memory buffer which owns the string it was made from, so that the
+// sanitized content can be handed to clang without being copied again.
+class StringMemoryBuffer : public llvm::MemoryBuffer {
+    public:
+    StringMemoryBuffer(std::string Content, llvm::StringRef Name)
+        : Content(std::move(Content)), Name(Name.str()) {
+        init(this->Content.data(), this->Content.data() + this->Content.size(),
+                true);
+    }
+
+    BufferKind getBufferKind() const override {
+        return MemoryBuffer_Malloc;
+    }
+
+    llvm::StringRef getBufferIdentifier() const override {
+        return Name;
+    }
+
+    private:
+    std::string Content;
+    std::string Name;
+};
+
+bool FileStore::AddFile(const std::string& FilePath) {
+
+    // Large files are mapped rather than read, and the original content is
+    // kept for the .styled files.
+    auto Buffer = llvm::MemoryBuffer::getFile(FilePath);
+    if (!Buffer) {
+        AddContent(FilePath, "");
+        return false;
+    }
+
+    auto& File = Files[FilePath];
+    File.Original = std::move(*Buffer);
+    File.Sanitized.reset(new StringMemoryBuffer(
+            GetSanitizedContent(FilePath, File.Original->getBuffer()),
+            FilePath));
+    return true;
+}
+
+void FileStore::AddContent(
+        const std::string& FilePath, llvm::StringRef Content) {
+
+    auto& File = Files[FilePath];
+    File.Original.reset();
+    File.Sanitized.reset(new StringMemoryBuffer(
+            GetSanitizedContent(FilePath, Content), FilePath));
+}
+
+llvm::StringRef FileStore::GetContent(llvm::StringRef FilePath) const {
+
+    auto Entry = Files.find(FilePath);
+    if (Entry == Files.end() || !Entry->second.Sanitized) {
+        return llvm::StringRef();
+    }
+    return Entry->second.Sanitized->getBuffer();
+}
+
+llvm::StringRef FileStore::GetOriginalContent(llvm::StringRef FilePath) const {
+
+    auto Entry = Files.find(FilePath);
+    if (Entry == Files.end() || !Entry->second.Original) {
+        return llvm::StringRef();
+    }
+    return Entry->second.Original->getBuffer();
+}
+
+llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> FileStore::CreateFileSystem(
+        llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> Base) const {
+
+    // The in-memory buffers only refer to the stored content
+    llvm::IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> Memory(
+            new llvm::vfs::InMemoryFileSystem());
+    for (const auto& Entry : Files) {
+        Memory->addFile(Entry.getKey(), 0,
+                llvm::MemoryBuffer::getMemBuffer(
+                        Entry.second.Sanitized->getMemBufferRef()));
+    }
+
+    llvm::IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> Overlay(
+            new llvm::vfs::OverlayFileSystem(Base));
+    Overlay->pushOverlay(Memory);
+    return Overlay;
+}
+
+}  // namespace input
+}  // namespace nett
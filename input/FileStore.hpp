@@ -0,0 +1,74 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#ifndef LLVM_CLANG_TOOLS_EXTRA_NETT_INPUT_FILESTORE_HPP
+#define LLVM_CLANG_TOOLS_EXTRA_NETT_INPUT_FILESTORE_HPP
+
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/VirtualFileSystem.h"
+
+#include <memory>
+#include <string>
+
+namespace nett {
+namespace input {
+
+// Keeps the content of each input file, by file path. Every file is read
+// from disk once and sanitized once, and the checks and the output stage
+// are given the stored bytes instead of reading the file again. The files
+// are all added before any of the checks run, so the store can be read
+// from any thread.
+class FileStore {
+    public:
+    // Reads and sanitizes the file at the given filepath. A file which
+    // can't be read is stored as empty, and false is returned.
+    bool AddFile(const std::string& FilePath);
+
+    // Sanitizes the given content (e.g. an unsaved editor buffer) as the
+    // file at the given filepath. Only the sanitized content is kept.
+    void AddContent(const std::string& FilePath, llvm::StringRef Content);
+
+    // Returns true if the given file has been added to the store.
+    bool HasFile(llvm::StringRef FilePath) const {
+        return Files.count(FilePath) != 0;
+    }
+
+    // Returns the sanitized content of the given file, or an empty string
+    // if the file hasn't been added.
+    llvm::StringRef GetContent(llvm::StringRef FilePath) const;
+
+    // Returns the content of the given file as it was read from disk, or an
+    // empty string if the file hasn't been read.
+    llvm::StringRef GetOriginalContent(llvm::StringRef FilePath) const;
+
+    // Returns a file system which serves the sanitized content of the
+    // stored files on top of the given file system. The content isn't
+    // copied, so the file system must not be used after the store is
+    // cleared.
+    llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> CreateFileSystem(
+            llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> Base) const;
+
+    void Clear(void) {
+        Files.clear();
+    }
+
+    private:
+    struct StoredFile {
+        std::unique_ptr<llvm::MemoryBuffer> Original;
+        std::unique_ptr<llvm::MemoryBuffer> Sanitized;
+    };
+
+    llvm::StringMap<StoredFile> Files;
+};
+
+// The file store of the session checking files on the current thread. Each
+// session installs its own (see runner/Session.hpp).
+extern thread_local FileStore* GlobalFileStore;
+
+}  // namespace input
+}  // namespace nett
+
+#endif
@@ -9,10 +9,6 @@
 namespace nett {
 namespace input {
 
-// Replaces all of the occurrences of SearchStr in String with ReplaceStr.
-void ReplaceAll(std::string& String, std::string SearchStr,
-        const std::string ReplaceStr);
-
 // Extracts and returns the file name from the given filepath.
 // Note that this does not work for files ending with '/'.
 std::string ExtractFileName(const std::string FilePath);
@@ -0,0 +1,182 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#include "LineFilter.hpp"
+
+#include "llvm/ADT/SmallVector.h"
+
+#include <algorithm>
+
+namespace nett {
+namespace input {
+
+thread_local LineFilter* GlobalLineFilter = nullptr;
+
+bool ParseLineRanges(llvm::StringRef Spec, std::string& FilePath,
+        std::vector<LineRange>& Ranges) {
+
+    // The file name may itself hold colons, so the ranges start after the
+    // last one
+    auto Split = Spec.rsplit(':');
+    if (Split.first.empty() || Split.second.empty()) {
+        return false;
+    }
+    FilePath = Split.first.str();
+
+    llvm::SmallVector<llvm::StringRef, 4> Parts;
+    Split.second.split(Parts, ',');
+
+    for (auto Part : Parts) {
+        auto Bounds = Part.split('-');
+        LineRange Range;
+
+        if (Bounds.first.trim().getAsInteger(10, Range.First)) {
+            return false;
+        }
+        Range.Last = Range.First;
+        if (!Bounds.second.empty() &&
+                Bounds.second.trim().getAsInteger(10, Range.Last)) {
+            return false;
+        }
+        if (Range.First == 0 || Range.Last < Range.First) {
+            return false;
+        }
+        Ranges.push_back(Range);
+    }
+    return true;
+}
+
+// Reads the start line and line count of one side of a hunk header (e.g.
+// "+12,3"). The count is 1 if it isn't given.
+static bool ParseHunkSide(
+        llvm::StringRef Side, unsigned& Start, unsigned& Count) {
+
+    auto Split = Side.drop_front().split(',');
+    if (Split.first.getAsInteger(10, Start)) {
+        return false;
+    }
+    Count = 1;
+    return Split.second.empty() || !Split.second.getAsInteger(10, Count);
+}
+
+llvm::StringMap<std::vector<LineRange>> ParseUnifiedDiff(
+        llvm::StringRef Diff) {
+
+    llvm::StringMap<std::vector<LineRange>> Changes;
+    std::vector<LineRange>* FileChanges = nullptr;
+    unsigned NewLine = 0;
+    unsigned OldRemaining = 0;
+    unsigned NewRemaining = 0;
+
+    while (!Diff.empty()) {
+        auto Split = Diff.split('\n');
+        auto Line = Split.first.rtrim('\r');
+        Diff = Split.second;
+
+        // Within a hunk, the counts from its header say where it ends, so
+        // removed lines starting with "---" aren't mistaken for headers
+        if (OldRemaining || NewRemaining) {
+            if (Line.startswith("+")) {
+                if (FileChanges) {
+                    FileChanges->push_back({NewLine, NewLine});
+                }
+                NewLine++;
+                NewRemaining -= NewRemaining ? 1 : 0;
+            } else if (Line.startswith("-")) {
+                // The change shows up on the line now in the removed
+                // line's place
+                if (FileChanges) {
+                    FileChanges->push_back({NewLine, NewLine});
+                }
+                OldRemaining -= OldRemaining ? 1 : 0;
+            } else if (!Line.startswith("\\")) {
+                NewLine++;
+                NewRemaining -= NewRemaining ? 1 : 0;
+                OldRemaining -= OldRemaining ? 1 : 0;
+            }
+            continue;
+        }
+
+        if (Line.startswith("+++ ")) {
+            // The path may be followed by a tab and a timestamp
+            auto Path = Line.drop_front(4).split('\t').first;
+            if (Path == "/dev/null") {
+                FileChanges = nullptr;
+                continue;
+            }
+            if (Path.startswith("b/")) {
+                Path = Path.drop_front(2);
+            }
+            FileChanges = &Changes[Path];
+        } else if (Line.startswith("@@ ")) {
+            llvm::SmallVector<llvm::StringRef, 4> Fields;
+            Line.split(Fields, ' ');
+            unsigned OldStart;
+            if (Fields.size() < 3 ||
+                    !ParseHunkSide(Fields[1], OldStart, OldRemaining) ||
+                    !ParseHunkSide(Fields[2], NewLine, NewRemaining)) {
+                OldRemaining = 0;
+                NewRemaining = 0;
+                continue;
+            }
+            // An empty new side gives the line before the removed lines
+            if (NewRemaining == 0) {
+                NewLine++;
+            }
+        }
+    }
+
+    return Changes;
+}
+
+void LineFilter::AddRange(llvm::StringRef FilePath, LineRange Range) {
+
+    auto& FileRanges = Ranges[FilePath];
+    auto It = std::lower_bound(FileRanges.begin(), FileRanges.end(), Range,
+            [](const LineRange& A, const LineRange& B) {
+                return A.First < B.First;
+            });
+    It = FileRanges.insert(It, Range);
+
+    // The new range is joined with any ranges it overlaps or touches
+    if (It != FileRanges.begin() && (It - 1)->Last + 1 >= It->First) {
+        --It;
+        It->Last = std::max(It->Last, (It + 1)->Last);
+        FileRanges.erase(It + 1);
+    }
+    while (It + 1 != FileRanges.end() && It->Last + 1 >= (It + 1)->First) {
+        It->Last = std::max(It->Last, (It + 1)->Last);
+        FileRanges.erase(It + 1);
+    }
+}
+
+bool LineFilter::Overlaps(
+        llvm::StringRef FilePath, unsigned First, unsigned Last) const {
+
+    auto Entry = Ranges.find(FilePath);
+    if (Entry == Ranges.end()) {
+        return false;
+    }
+
+    // The first range ending at or after the first line is the only one
+    // which can overlap
+    const auto& FileRanges = Entry->second;
+    auto It = std::lower_bound(FileRanges.begin(), FileRanges.end(), First,
+            [](const LineRange& Range, unsigned Line) {
+                return Range.Last < Line;
+            });
+    return It != FileRanges.end() && It->First <= Last;
+}
+
+std::vector<std::string> LineFilter::GetFiles(void) const {
+
+    std::vector<std::string> Files;
+    for (const auto& Entry : Ranges) {
+        Files.push_back(Entry.getKey().str());
+    }
+    std::sort(Files.begin(), Files.end());
+    return Files;
+}
+
+}  // namespace input
+}  // namespace nett
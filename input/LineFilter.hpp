@@ -0,0 +1,75 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#ifndef LLVM_CLANG_TOOLS_EXTRA_NETT_INPUT_LINEFILTER_HPP
+#define LLVM_CLANG_TOOLS_EXTRA_NETT_INPUT_LINEFILTER_HPP
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <string>
+#include <vector>
+
+namespace nett {
+namespace input {
+
+// An inclusive range of lines. Lines start from 1.
+struct LineRange {
+    unsigned First;
+    unsigned Last;
+};
+
+// Reads a range of lines given as "file:first-last", where a single line
+// can also be given as "file:line" and several ranges can be separated by
+// commas. Returns false if the range can't be read.
+bool ParseLineRanges(llvm::StringRef Spec, std::string& FilePath,
+        std::vector<LineRange>& Ranges);
+
+// Returns the lines added or changed in each file by the given unified
+// diff (e.g. the output of 'git diff'), by the file's path in the new
+// version. Where lines were only removed, the line that now sits in their
+// place is taken to have changed. Files which were deleted are skipped.
+llvm::StringMap<std::vector<LineRange>> ParseUnifiedDiff(
+        llvm::StringRef Diff);
+
+// The lines of each file which are to be checked, when only part of the
+// input (e.g. the lines changed by a commit) is of interest. The filter is
+// filled before any of the checks run, so it can be read from any thread.
+class LineFilter {
+    public:
+    // Adds the given range of lines of the given file.
+    void AddRange(llvm::StringRef FilePath, LineRange Range);
+
+    // Returns true if any ranges have been added, in which case the lines
+    // outside them aren't checked.
+    bool IsActive(void) const {
+        return !Ranges.empty();
+    }
+
+    // Returns true if any of the given lines of the given file are within
+    // the filter's ranges.
+    bool Overlaps(llvm::StringRef FilePath, unsigned First,
+            unsigned Last) const;
+
+    // Returns true if the given line of the given file is to be checked.
+    // Every line is checked while the filter isn't active.
+    bool Contains(llvm::StringRef FilePath, unsigned LineNo) const {
+        return !IsActive() || Overlaps(FilePath, LineNo, LineNo);
+    }
+
+    // Returns the files with ranges in the filter, sorted by path.
+    std::vector<std::string> GetFiles(void) const;
+
+    private:
+    // The ranges of each file, sorted and with no two touching
+    llvm::StringMap<std::vector<LineRange>> Ranges;
+};
+
+// The line filter of the session checking files on the current thread. Each
+// session installs its own (see runner/Session.hpp).
+extern thread_local LineFilter* GlobalLineFilter;
+
+}  // namespace input
+}  // namespace nett
+
+#endif
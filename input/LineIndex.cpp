@@ -0,0 +1,22 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#include "LineIndex.hpp"
+
+#include <algorithm>
+
+namespace nett {
+namespace input {
+
+unsigned LineIndex::GetLineNumber(size_t Offset) const {
+
+    // The first line starting after the offset is the line after ours
+    auto Next = std::upper_bound(Lines.begin(), Lines.end(), Offset,
+            [](size_t Value, const Line& Entry) {
+                return Value < Entry.Start;
+            });
+    return Next - Lines.begin();
+}
+
+}  // namespace input
+}  // namespace nett
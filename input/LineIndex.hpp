@@ -0,0 +1,68 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#ifndef LLVM_CLANG_TOOLS_EXTRA_NETT_INPUT_LINEINDEX_HPP
+#define LLVM_CLANG_TOOLS_EXTRA_NETT_INPUT_LINEINDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace nett {
+namespace input {
+
+// The start, length and indentation of every line of a file's sanitized
+// content. Lines and columns start from 1, the same as the SourceManager's.
+class LineIndex {
+    public:
+    LineIndex() {
+    }
+
+    // Adds the next line of the content. Lines must be added in order.
+    void AddLine(uint32_t Start, uint32_t Length, uint32_t Indentation) {
+        Lines.push_back({Start, Length, Indentation});
+    }
+
+    // Returns the number of lines in the content. Content ending in a
+    // newline has an empty final line.
+    unsigned GetLineCount(void) const {
+        return Lines.size();
+    }
+
+    // Returns the line containing the given offset.
+    unsigned GetLineNumber(size_t Offset) const;
+
+    // Returns the column of the given offset within its line.
+    unsigned GetColumnNumber(size_t Offset) const {
+        return Offset - Lines[GetLineNumber(Offset) - 1].Start + 1;
+    }
+
+    // Returns the offset of the first character of the given line.
+    size_t GetLineStart(unsigned LineNo) const {
+        return Lines[LineNo - 1].Start;
+    }
+
+    // Returns the length of the given line, not counting the newline.
+    unsigned GetLineLength(unsigned LineNo) const {
+        return Lines[LineNo - 1].Length;
+    }
+
+    // Returns the number of spaces at the start of the given line.
+    unsigned GetIndentation(unsigned LineNo) const {
+        return Lines[LineNo - 1].Indentation;
+    }
+
+    private:
+    struct Line {
+        uint32_t Start;
+        uint32_t Length;
+        uint32_t Indentation;
+    };
+
+    std::vector<Line> Lines;
+};
+
+}  // namespace input
+}  // namespace nett
+
+#endif
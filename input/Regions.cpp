@@ -0,0 +1,102 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#include "Regions.hpp"
+
+namespace nett {
+namespace input {
+
+static const char* C_DIGRAPHS[] = {"<:", ":>", "<%", "%>", "%:", "%:%:"};
+static const char* C_TRIGRAPHS[] = {"\?\?=", "\?\?/", "\?\?'", "\?\?(", "\?\?)",
+        "\?\?!", "\?\?<", "\?\?>", "\?\?-"};
+
+// Adds the given offset to NGraphs once for each digraph or trigraph which
+// starts there. Overlapping ones (e.g. '%:' within '%:%:') are each counted.
+static void FindNGraphsAt(
+        llvm::StringRef Content, size_t Offset, std::vector<size_t>& NGraphs) {
+
+    auto Rest = Content.substr(Offset);
+
+    if (Rest[0] == '?') {
+        for (const auto* Trigraph : C_TRIGRAPHS) {
+            if (Rest.startswith(Trigraph)) {
+                NGraphs.push_back(Offset);
+            }
+        }
+        return;
+    }
+    for (const auto* Digraph : C_DIGRAPHS) {
+        if (Rest.startswith(Digraph)) {
+            NGraphs.push_back(Offset);
+        }
+    }
+}
+
+std::vector<size_t> FindNGraphsInCode(llvm::StringRef Content) {
+
+    std::vector<size_t> NGraphs;
+    RegionKind State = REGION_CODE;
+    size_t i = 0;
+
+    while (i < Content.size()) {
+        char C = Content[i];
+        char Next = i + 1 < Content.size() ? Content[i + 1] : '\0';
+
+        switch (State) {
+        case REGION_CODE:
+            if (C == '/' && Next == '/') {
+                State = REGION_LINE_COMMENT;
+            } else if (C == '/' && Next == '*') {
+                // The opening '/*' can't also close the comment
+                State = REGION_BLOCK_COMMENT;
+                i += 2;
+                continue;
+            } else if (C == '"') {
+                State = REGION_STRING;
+            } else if (C == '\'') {
+                State = REGION_CHAR;
+            } else if (C == '<' || C == ':' || C == '%' || C == '?') {
+                FindNGraphsAt(Content, i, NGraphs);
+            }
+            break;
+
+        case REGION_LINE_COMMENT:
+            if (C == '\\' && Next == '\n') {
+                // The comment carries on to the next line
+                i++;
+            } else if (C == '\n') {
+                State = REGION_CODE;
+            }
+            break;
+
+        case REGION_BLOCK_COMMENT:
+            if (C == '*' && Next == '/') {
+                State = REGION_CODE;
+                i += 2;
+                continue;
+            }
+            break;
+
+        case REGION_STRING:
+        case REGION_CHAR:
+            if (C == '\\' && Next != '\0') {
+                // Escaped characters (including newlines) don't end it
+                i++;
+            } else if (C == '\n') {
+                // An unterminated literal ends with its line
+                State = REGION_CODE;
+            } else if ((State == REGION_STRING && C == '"') ||
+                       (State == REGION_CHAR && C == '\'')) {
+                State = REGION_CODE;
+            }
+            break;
+        }
+
+        i++;
+    }
+
+    return NGraphs;
+}
+
+}  // namespace input
+}  // namespace nett
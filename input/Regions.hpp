@@ -0,0 +1,34 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#ifndef LLVM_CLANG_TOOLS_EXTRA_NETT_INPUT_REGIONS_HPP
+#define LLVM_CLANG_TOOLS_EXTRA_NETT_INPUT_REGIONS_HPP
+
+#include "llvm/ADT/StringRef.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace nett {
+namespace input {
+
+// The lexical regions of a file's content. The delimiters of a comment or
+// literal (e.g. the quotes of a string) are part of it.
+enum RegionKind : uint8_t {
+    REGION_CODE,
+    REGION_LINE_COMMENT,
+    REGION_BLOCK_COMMENT,
+    REGION_STRING,
+    REGION_CHAR
+};
+
+// Returns the offset of each digraph and trigraph in the given content,
+// found in a single forward pass. Those inside comments, strings and
+// character literals are skipped, and overlapping ones (e.g. '%:' within
+// '%:%:') are each returned.
+std::vector<size_t> FindNGraphsInCode(llvm::StringRef Content);
+
+}  // namespace input
+}  // namespace nett
+
+#endif
@@ -0,0 +1,202 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#include "Sanitizer.hpp"
+
+#include "llvm/Support/MathExtras.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace nett {
+namespace input {
+
+// Returns the offset of the first tab, carriage return or newline at or
+// after Pos, or Size if there is none. Most of the input is ordinary
+// characters, so these are skipped a vector at a time where possible.
+static size_t FindSpecialChar(const char* Data, size_t Pos, size_t Size) {
+
+#if defined(__AVX2__)
+    const __m256i Tabs = _mm256_set1_epi8('\t');
+    const __m256i Returns = _mm256_set1_epi8('\r');
+    const __m256i Newlines = _mm256_set1_epi8('\n');
+
+    for (; Pos + 32 <= Size; Pos += 32) {
+        auto Chunk = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(Data + Pos));
+        auto Matches = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(Chunk, Tabs),
+                        _mm256_cmpeq_epi8(Chunk, Returns)),
+                _mm256_cmpeq_epi8(Chunk, Newlines));
+        uint32_t Mask = _mm256_movemask_epi8(Matches);
+        if (Mask) {
+            return Pos + llvm::countTrailingZeros(Mask);
+        }
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i Tabs16 = _mm_set1_epi8('\t');
+    const __m128i Returns16 = _mm_set1_epi8('\r');
+    const __m128i Newlines16 = _mm_set1_epi8('\n');
+
+    for (; Pos + 16 <= Size; Pos += 16) {
+        auto Chunk =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(Data + Pos));
+        auto Matches = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(Chunk, Tabs16),
+                        _mm_cmpeq_epi8(Chunk, Returns16)),
+                _mm_cmpeq_epi8(Chunk, Newlines16));
+        uint32_t Mask = _mm_movemask_epi8(Matches);
+        if (Mask) {
+            return Pos + llvm::countTrailingZeros(Mask);
+        }
+    }
+#endif
+
+    for (; Pos < Size; Pos++) {
+        char C = Data[Pos];
+        if (C == '\t' || C == '\r' || C == '\n') {
+            return Pos;
+        }
+    }
+    return Size;
+}
+
+// The output of the sanitizer. The buffer is sized up front for the input
+// plus some room for tabs, and only grows if a file has a lot of them.
+class OutputBuffer {
+    public:
+    explicit OutputBuffer(size_t InputSize) {
+        Buffer.resize(InputSize + InputSize / 8 + 64);
+    }
+
+    void Append(const char* Data, size_t Length) {
+        Reserve(Length);
+        std::memcpy(&Buffer[Size], Data, Length);
+        Size += Length;
+    }
+
+    void Append(char C) {
+        Reserve(1);
+        Buffer[Size++] = C;
+    }
+
+    void AppendSpaces(size_t Count) {
+        Reserve(Count);
+        std::memset(&Buffer[Size], ' ', Count);
+        Size += Count;
+    }
+
+    size_t GetSize() const {
+        return Size;
+    }
+
+    std::string Take() {
+        Buffer.resize(Size);
+        return std::move(Buffer);
+    }
+
+    private:
+    void Reserve(size_t Length) {
+        if (Size + Length > Buffer.size()) {
+            Buffer.resize(std::max(Buffer.size() * 2, Size + Length));
+        }
+    }
+
+    std::string Buffer;
+    size_t Size = 0;
+};
+
+std::string SanitizeContent(llvm::StringRef Raw, unsigned TabSize,
+        unsigned MaxLineLength, LineIndex& Lines, LongLineCallback OnLongLine) {
+
+    const char* Data = Raw.data();
+    size_t Size = Raw.size();
+    OutputBuffer Output(Size);
+
+    size_t Pos = 0;
+    size_t LineStart = 0;
+    unsigned LineNo = 1;
+    unsigned Indentation = 0;
+
+    // The column used for tab stops. Carriage returns take up a column here
+    // even though they are removed, the same as when tabs were expanded
+    // before the carriage returns were stripped.
+    unsigned Column = 0;
+    bool AtLineStart = true;
+
+    auto ExpandTab = [&]() {
+        unsigned Spaces = TabSize - (Column % TabSize);
+        Output.AppendSpaces(Spaces);
+        Column += Spaces;
+        return Spaces;
+    };
+
+    auto EndLine = [&]() {
+        unsigned Length = Output.GetSize() - LineStart;
+        Lines.AddLine(LineStart, Length, Indentation);
+        if (Length > MaxLineLength) {
+            OnLongLine(LineNo, Length);
+        }
+    };
+
+    while (Pos < Size) {
+        if (AtLineStart) {
+            // The indentation of the line is counted as it is expanded
+            for (; Pos < Size; Pos++) {
+                if (Data[Pos] == ' ') {
+                    Output.Append(' ');
+                    Column++;
+                    Indentation++;
+                } else if (Data[Pos] == '\t') {
+                    Indentation += ExpandTab();
+                } else if (Data[Pos] == '\r') {
+                    Column++;
+                } else {
+                    break;
+                }
+            }
+            AtLineStart = false;
+        }
+
+        size_t Special = FindSpecialChar(Data, Pos, Size);
+        Output.Append(Data + Pos, Special - Pos);
+        Column += Special - Pos;
+        Pos = Special;
+
+        if (Pos == Size) {
+            break;
+        }
+
+        switch (Data[Pos++]) {
+        case '\t':
+            ExpandTab();
+            break;
+        case '\r':
+            Column++;
+            break;
+        case '\n':
+            EndLine();
+            Output.Append('\n');
+
+            LineStart = Output.GetSize();
+            LineNo++;
+            Indentation = 0;
+            Column = 0;
+            AtLineStart = true;
+            break;
+        }
+    }
+
+    // The final line has no newline (and is empty if the content ends in one)
+    EndLine();
+
+    return Output.Take();
+}
+
+}  // namespace input
+}  // namespace nett
@@ -0,0 +1,31 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#ifndef LLVM_CLANG_TOOLS_EXTRA_NETT_INPUT_SANITIZER_HPP
+#define LLVM_CLANG_TOOLS_EXTRA_NETT_INPUT_SANITIZER_HPP
+
+#include "LineIndex.hpp"
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <string>
+
+namespace nett {
+namespace input {
+
+// Called with the number and length of each line that is longer than the
+// maximum line length.
+using LongLineCallback = llvm::function_ref<void(unsigned, unsigned)>;
+
+// Sanitizes the given raw file content in a single pass: tabs are expanded
+// with spaces up to the next tab stop and carriage returns are removed. The
+// lines of the sanitized content are added to Lines as they are found, and
+// OnLongLine is called for each line over MaxLineLength.
+std::string SanitizeContent(llvm::StringRef Raw, unsigned TabSize,
+        unsigned MaxLineLength, LineIndex& Lines, LongLineCallback OnLongLine);
+
+}  // namespace input
+}  // namespace nett
+
+#endif
@@ -0,0 +1,12 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#include "SourceIndex.hpp"
+
+namespace nett {
+namespace input {
+
+thread_local SourceIndexManager* GlobalSourceIndexManager = nullptr;
+
+}  // namespace input
+}  // namespace nett
@@ -0,0 +1,53 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#ifndef LLVM_CLANG_TOOLS_EXTRA_NETT_INPUT_SOURCEINDEX_HPP
+#define LLVM_CLANG_TOOLS_EXTRA_NETT_INPUT_SOURCEINDEX_HPP
+
+#include "LineIndex.hpp"
+
+#include "llvm/ADT/StringMap.h"
+
+#include <utility>
+
+namespace nett {
+namespace input {
+
+// What is known about a file's sanitized content before it is parsed.
+struct SourceIndex {
+    LineIndex Lines;
+};
+
+// Keeps the index of each file that has been sanitized, by file path.
+// The indexes are all added before any of the checks run, so the checks
+// can read them from any thread.
+class SourceIndexManager {
+    public:
+    // Stores the index for the given file, replacing any previous one.
+    void AddIndex(llvm::StringRef FilePath, SourceIndex Index) {
+        Indexes[FilePath] = std::move(Index);
+    }
+
+    // Returns the index for the given file, or nullptr if the file
+    // hasn't been sanitized.
+    const SourceIndex* GetIndex(llvm::StringRef FilePath) const {
+        auto Entry = Indexes.find(FilePath);
+        return Entry != Indexes.end() ? &Entry->second : nullptr;
+    }
+
+    void Clear(void) {
+        Indexes.clear();
+    }
+
+    private:
+    llvm::StringMap<SourceIndex> Indexes;
+};
+
+// The source indexes of the session checking files on the current thread. Each
+// session installs its own (see runner/Session.hpp).
+extern thread_local SourceIndexManager* GlobalSourceIndexManager;
+
+}  // namespace input
+}  // namespace nett
+
+#endif
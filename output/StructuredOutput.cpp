@@ -0,0 +1,166 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#include "StructuredOutput.hpp"
+
+#include "../violations/ViolationManager.hpp"
+
+#include "llvm/ADT/StringExtras.h"
+
+namespace nett {
+namespace output {
+
+#define SARIF_SCHEMA "https://json.schemastore.org/sarif-2.1.0.json"
+#define SARIF_VERSION "2.1.0"
+#define NETT_URI "https://github.com/dgrobb/nett"
+
+// Returns the given text as a JSON string. Source files aren't always
+// valid UTF-8, so any invalid sequences are replaced.
+static llvm::json::Value ToJSONString(llvm::StringRef Text) {
+
+    if (llvm::json::isUTF8(Text)) {
+        return Text.str();
+    }
+    return llvm::json::fixUTF8(Text);
+}
+
+// Returns the file URI of the given absolute filepath.
+static std::string ToFileURI(llvm::StringRef FilePath) {
+
+    std::string URI = "file://";
+    for (unsigned char Char : FilePath) {
+        if (llvm::isAlnum(Char) || llvm::StringRef("/-_.~").count(Char)) {
+            URI += Char;
+        } else {
+            URI += "%";
+            URI += llvm::hexdigit(Char >> 4);
+            URI += llvm::hexdigit(Char & 0xF);
+        }
+    }
+    return URI;
+}
+
+// Writes a single violation as a JSON Lines entry.
+static void WriteJSONLViolation(
+        llvm::json::OStream& JOS, const Violation& Viol) {
+
+    JOS.objectBegin();
+    JOS.attribute("line", Viol.GetLineNumber());
+    if (Viol.GetColumnNumber()) {
+        JOS.attribute("column", Viol.GetColumnNumber());
+    }
+    JOS.attribute("category", GetViolationTypeName(Viol.Type()));
+    JOS.attribute("message", ToJSONString(Viol.GetMessage()));
+    JOS.objectEnd();
+}
+
+// Writes a single violation as a SARIF result.
+static void WriteSARIFResult(llvm::json::OStream& JOS,
+        const std::string& FileURI, const Violation& Viol) {
+
+    JOS.objectBegin();
+    JOS.attribute("ruleId", GetViolationTypeName(Viol.Type()));
+    JOS.attribute("level",
+            Viol.Type() == ViolationType::NOTE ? "note" : "warning");
+    JOS.attribute("message",
+            llvm::json::Object{{"text", ToJSONString(Viol.GetMessage())}});
+
+    llvm::json::Object Location{
+            {"artifactLocation", llvm::json::Object{{"uri", FileURI}}}};
+    if (Viol.GetLineNumber()) {
+        llvm::json::Object Region{{"startLine", Viol.GetLineNumber()}};
+        if (Viol.GetColumnNumber()) {
+            Region["startColumn"] = Viol.GetColumnNumber();
+        }
+        Location["region"] = std::move(Region);
+    }
+    JOS.attribute("locations",
+            llvm::json::Array{llvm::json::Object{
+                    {"physicalLocation", std::move(Location)}}});
+    JOS.objectEnd();
+}
+
+ResultStream::ResultStream(OutputFormat Format, llvm::raw_ostream& OS)
+    : Format(Format), OS(OS) {
+
+    if (Format != FORMAT_SARIF) {
+        return;
+    }
+
+    // Everything up to the results is known before any file is checked
+    llvm::json::Array Rules;
+    for (int Type = ViolationType::NAMING; Type < ViolationType::UNSPEC;
+            Type++) {
+        Rules.push_back(llvm::json::Object{
+                {"id", GetViolationTypeName((ViolationType)Type)}});
+    }
+
+    ResultStream::SARIF.reset(new llvm::json::OStream(OS));
+    auto& JOS = *ResultStream::SARIF;
+    JOS.objectBegin();
+    JOS.attribute("$schema", SARIF_SCHEMA);
+    JOS.attribute("version", SARIF_VERSION);
+    JOS.attributeBegin("runs");
+    JOS.arrayBegin();
+    JOS.objectBegin();
+    JOS.attribute("tool",
+            llvm::json::Object{{"driver",
+                    llvm::json::Object{{"name", "nett"},
+                            {"informationUri", NETT_URI},
+                            {"rules", std::move(Rules)}}}});
+    JOS.attributeBegin("results");
+    JOS.arrayBegin();
+    OS.flush();
+}
+
+ResultStream::~ResultStream() {
+    ResultStream::Finish();
+}
+
+void ResultStream::WriteFile(const std::string& FilePath) {
+
+    const auto& Violations = GlobalViolationManager.GetFileViolations(FilePath);
+
+    if (ResultStream::Format == FORMAT_JSONL) {
+        llvm::json::OStream JOS(ResultStream::OS);
+        JOS.objectBegin();
+        JOS.attribute("file", ToJSONString(FilePath));
+        JOS.attributeBegin("violations");
+        JOS.arrayBegin();
+        for (const auto* Viol : Violations.GetViolations()) {
+            WriteJSONLViolation(JOS, *Viol);
+        }
+        JOS.arrayEnd();
+        JOS.attributeEnd();
+        JOS.objectEnd();
+        ResultStream::OS << "\n";
+    } else if (ResultStream::SARIF) {
+        auto FileURI = ToFileURI(FilePath);
+        for (const auto* Viol : Violations.GetViolations()) {
+            WriteSARIFResult(*ResultStream::SARIF, FileURI, *Viol);
+        }
+    }
+
+    ResultStream::OS.flush();
+}
+
+void ResultStream::Finish(void) {
+
+    if (!ResultStream::SARIF) {
+        return;
+    }
+
+    auto& JOS = *ResultStream::SARIF;
+    JOS.arrayEnd();
+    JOS.attributeEnd();
+    JOS.objectEnd();
+    JOS.arrayEnd();
+    JOS.attributeEnd();
+    JOS.objectEnd();
+    ResultStream::SARIF.reset();
+    ResultStream::OS << "\n";
+    ResultStream::OS.flush();
+}
+
+}  // namespace output
+}  // namespace nett
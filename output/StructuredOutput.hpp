@@ -0,0 +1,50 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#ifndef LLVM_CLANG_TOOLS_EXTRA_NETT_OUTPUT_STRUCTUREDOUTPUT_HPP
+#define LLVM_CLANG_TOOLS_EXTRA_NETT_OUTPUT_STRUCTUREDOUTPUT_HPP
+
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <memory>
+#include <string>
+
+namespace nett {
+namespace output {
+
+// The formats the violations can be printed in
+enum OutputFormat {
+    FORMAT_TEXT,   // the terminal output
+    FORMAT_JSONL,  // a JSON object per file, one per line
+    FORMAT_SARIF   // a single SARIF 2.1.0 log
+};
+
+// Writes the violations of each file in a machine readable format as soon
+// as the file is settled, rather than once every file has been checked.
+// Each file's violations are flushed as they are written, so at most one
+// file's output is buffered at a time.
+class ResultStream {
+    public:
+    // The format must be FORMAT_JSONL or FORMAT_SARIF.
+    ResultStream(OutputFormat Format, llvm::raw_ostream& OS);
+    ~ResultStream();
+
+    // Writes the violations of the given file held by the
+    // GlobalViolationManager. The file's violations must be settled.
+    void WriteFile(const std::string& FilePath);
+
+    // Closes off the output. Nothing more can be written afterwards.
+    void Finish(void);
+
+    private:
+    OutputFormat Format;
+    llvm::raw_ostream& OS;
+    // The SARIF log stays open between files
+    std::unique_ptr<llvm::json::OStream> SARIF;
+};
+
+}  // namespace output
+}  // namespace nett
+
+#endif
@@ -3,6 +3,7 @@
  */
 #include "UserOutput.hpp"
 
+#include "../input/FileStore.hpp"
 #include "../violations/ViolationManager.hpp"
 #include "OutputColors.hpp"
 
@@ -11,6 +12,7 @@
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <tuple>
 
 namespace nett {
 namespace output {
@@ -41,27 +43,28 @@ std::string TruncateFilePath(std::string FilePath) {
     return NewPath;
 }
 
-void OutputViolationsToTerminal(std::vector<std::string> FilePaths) {
+void OutputViolationsToTerminal(
+        std::vector<std::string> FilePaths, llvm::raw_ostream& OS) {
 
     for (auto FilePath : FilePaths) {
         auto TruncatedPath = TruncateFilePath(FilePath);
         auto Padding = STATUS_COLUMN_START - TruncatedPath.length();
         TruncatedPath.append(Padding, ' ');
 
-        llvm::outs() << TruncatedPath;
+        OS << TruncatedPath;
 
-        auto Violations = GlobalViolationManager.GetViolationsInFile(FilePath);
+        const auto& Violations =
+                GlobalViolationManager.GetFileViolations(FilePath);
 
         if (Violations.empty()) {
-            llvm::outs() << colors::Colorize("OK", colors::COLOR_GREEN) << "\n";
+            OS << colors::Colorize("OK", colors::COLOR_GREEN) << "\n";
             continue;
         } else {
-            llvm::outs() << colors::Colorize("ERRORS", colors::COLOR_ORANGE)
-                         << "\n";
+            OS << colors::Colorize("ERRORS", colors::COLOR_ORANGE) << "\n";
         }
 
-        for (auto* Violation : Violations) {
-            llvm::outs() << Violation->ToTerminalString() << "\n";
+        for (auto* Violation : Violations.GetViolations()) {
+            OS << Violation->ToTerminalString() << "\n";
         }
     }
 }
@@ -72,31 +75,28 @@ void OutputViolationsToFiles(std::vector<std::string> FilePaths) {
         std::stringstream NewFilePath;
         NewFilePath << FilePath << ".styled";
 
-        std::ifstream OriginalFile(FilePath);
+        // The file was read when it was checked, so we use that content
+        // rather than reading it from disk again.
+        auto Remaining = input::GlobalFileStore->GetOriginalContent(FilePath);
         std::ofstream NewFile(NewFilePath.str());
         int CurrentLineNo = 1;
-        std::string CurrentLineContent;
 
-        std::map<ViolationType, int> ViolationsAddedToFile;
-        std::map<ViolationType, bool> ViolationLimitNoted;
+        // The file's violations are grouped by line, so the file is
+        // written in a single pass over its lines and violations.
+        const auto& ViolationsInFile =
+                GlobalViolationManager.GetFileViolations(FilePath);
+        uint ViolationsAddedToFile[ViolationType::UNSPEC + 1] = {};
 
-        auto ViolationsInFile =
-                GlobalViolationManager.GetViolationsInFile(FilePath);
-        std::map<ViolationType, int> ViolationTotalsForFile;
+        while (!Remaining.empty()) {
+            llvm::StringRef CurrentLineContent;
+            std::tie(CurrentLineContent, Remaining) = Remaining.split('\n');
+            bool ViolationCategoriesInfracted[ViolationType::UNSPEC + 1] = {};
 
-        for (auto* Violation : ViolationsInFile) {
-            ViolationTotalsForFile[Violation->Type()]++;
-        }
-
-        while (std::getline(OriginalFile, CurrentLineContent)) {
-            auto ViolationsOnLine = GlobalViolationManager.GetViolationsOnLine(
-                    FilePath, CurrentLineNo);
-            std::unordered_set<ViolationType> ViolationCategoriesInfracted;
-
-            for (auto* Violation : ViolationsOnLine) {
+            for (auto* Violation :
+                    ViolationsInFile.GetViolationsOnLine(CurrentLineNo)) {
                 auto ViolType = Violation->Type();
 
-                if (ViolationCategoriesInfracted.count(ViolType) > 0) {
+                if (ViolationCategoriesInfracted[ViolType]) {
                     continue;
                 }
 
@@ -108,14 +108,14 @@ void OutputViolationsToFiles(std::vector<std::string> FilePaths) {
                 }
 
                 NewFile << Violation->ToFileString() << "\n";
-                ViolationCategoriesInfracted.insert(ViolType);
+                ViolationCategoriesInfracted[ViolType] = true;
                 ViolationsAddedToFile[ViolType]++;
 
                 // If we reached the cap, and there are more
                 // violations of this type, then add a note
                 if (ViolationsAddedToFile[ViolType] ==
                                 MAX_VIOLATIONS_PER_CATEGORY_PER_FILE &&
-                        ViolationTotalsForFile[ViolType] >
+                        ViolationsInFile.GetTypeCount(ViolType) >
                                 MAX_VIOLATIONS_PER_CATEGORY_PER_FILE &&
                         ViolType != ViolationType::NOTE) {
                     NewFile << "[NOTE] More violations of this category "
@@ -123,11 +123,11 @@ void OutputViolationsToFiles(std::vector<std::string> FilePaths) {
                                "reached.\n";
                 }
             }
-            NewFile << CurrentLineContent << "\n";
+            NewFile.write(CurrentLineContent.data(), CurrentLineContent.size());
+            NewFile << "\n";
             CurrentLineNo++;
         }
 
-        OriginalFile.close();
         NewFile.close();
     }
 }
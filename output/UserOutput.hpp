@@ -4,6 +4,8 @@
 #ifndef LLVM_CLANG_TOOLS_EXTRA_NETT_OUTPUT_USEROUTPUT_HPP
 #define LLVM_CLANG_TOOLS_EXTRA_NETT_OUTPUT_USEROUTPUT_HPP
 
+#include "llvm/Support/raw_ostream.h"
+
 #include <string>
 #include <vector>
 
@@ -11,11 +13,14 @@ namespace nett {
 namespace output {
 
 // Prints the style violations found within the given files to the terminal.
-void OutputViolationsToTerminal(std::vector<std::string> FilePaths);
+// The same output can be written to another stream (e.g. a report file).
+void OutputViolationsToTerminal(std::vector<std::string> FilePaths,
+        llvm::raw_ostream& OS = llvm::outs());
 
 // Generates duplicates of the files at the given file paths
 // amended with the style violations found within those files.
-// Each duplicate is given a '.styled' extension.
+// Each duplicate is given a '.styled' extension. The files'
+// content is taken from the GlobalFileStore.
 void OutputViolationsToFiles(std::vector<std::string> FilePaths);
 
 }  // namespace output
@@ -0,0 +1,77 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#include "CheckResults.hpp"
+
+#include "../stats/Profiler.hpp"
+
+#include <utility>
+
+namespace nett {
+
+using checks::whitespace::GlobalPointerStyleManager;
+
+CheckResults TakeCheckResults(void) {
+
+    CheckResults Results;
+    std::swap(Results.Violations, GlobalViolationManager);
+    std::swap(Results.FunctionComments, GlobalFunctionCommentManager);
+    std::swap(Results.FileContents, GlobalFileContentManager);
+    std::swap(Results.PointerStyles, GlobalPointerStyleManager);
+
+    // The output mode is a setting rather than a result, so the
+    // fresh manager needs to keep it.
+    if (Results.Violations.WillOutputToFile()) {
+        GlobalViolationManager.SetOutputToFile();
+    }
+
+    return Results;
+}
+
+void DiscardCheckResults(void) {
+
+    // The results are freed once they go out of scope
+    TakeCheckResults();
+}
+
+void MergeCheckResults(CheckResults& Results) {
+
+    GlobalViolationManager.MergeFrom(Results.Violations);
+    GlobalFunctionCommentManager.MergeFrom(Results.FunctionComments);
+    GlobalFileContentManager.MergeFrom(Results.FileContents);
+    GlobalPointerStyleManager.MergeFrom(Results.PointerStyles);
+}
+
+void GenerateDeferredViolations(void) {
+
+    {
+        stats::ProfileScope Profile("deferred/FunctionComments");
+        GlobalFunctionCommentManager.GenerateCommentViolations();
+    }
+    {
+        stats::ProfileScope Profile("deferred/Whitespace");
+        GlobalFileContentManager.GenerateWhitespaceViolations();
+    }
+    stats::ProfileScope Profile("deferred/PointerStyles");
+    GlobalPointerStyleManager.GeneratePointerViolations();
+}
+
+std::unordered_set<std::string> GetUnsettledFiles(void) {
+
+    // Only a function's comment can come from a file checked later on
+    return GlobalFunctionCommentManager.GetFilesAwaitingComments();
+}
+
+void GenerateDeferredViolations(const std::string& FilePath) {
+
+    // A settled file has no uncommented functions, so it has no comment
+    // violations to generate.
+    {
+        stats::ProfileScope Profile("deferred/Whitespace", FilePath);
+        GlobalFileContentManager.GenerateWhitespaceViolations(FilePath);
+    }
+    stats::ProfileScope Profile("deferred/PointerStyles", FilePath);
+    GlobalPointerStyleManager.GeneratePointerViolations(FilePath);
+}
+
+}  // namespace nett
@@ -0,0 +1,55 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#ifndef LLVM_CLANG_TOOLS_EXTRA_NETT_RUNNER_CHECKRESULTS_HPP
+#define LLVM_CLANG_TOOLS_EXTRA_NETT_RUNNER_CHECKRESULTS_HPP
+
+#include "../checks/comments/CommentManager.hpp"
+#include "../checks/whitespace/FileContentManager.hpp"
+#include "../checks/whitespace/PointerStyles.hpp"
+#include "../violations/ViolationManager.hpp"
+
+#include <string>
+#include <unordered_set>
+
+namespace nett {
+
+// The results of checking one or more files. The checks store their
+// results in the global managers of the thread doing the checking, so
+// this allows results to be moved off a thread and merged elsewhere.
+struct CheckResults {
+    ViolationManager Violations;
+    FunctionCommentManager FunctionComments;
+    FileContentManager FileContents;
+    checks::whitespace::PointerStyleManager PointerStyles;
+};
+
+// Moves the results held by the current thread's global managers into
+// a new set of results, leaving the managers empty.
+CheckResults TakeCheckResults(void);
+
+// Frees the results held by the current thread's global managers. The
+// strings pooled for their violations are freed along with the session.
+void DiscardCheckResults(void);
+
+// Merges the given results into the current thread's global managers.
+// Results must be merged in the order that the files were given to us
+// for the output to match checking the files one after another.
+void MergeCheckResults(CheckResults& Results);
+
+// Generates the violations which can only be found once all of the
+// files have been checked and their results merged.
+void GenerateDeferredViolations(void);
+
+// Returns the files whose violations could still change as more files are
+// checked and merged. All other merged files are settled: once their
+// deferred violations are generated, nothing can add to them.
+std::unordered_set<std::string> GetUnsettledFiles(void);
+
+// Generates the deferred violations of a single settled file. Running
+// GenerateDeferredViolations afterwards adds nothing more to the file.
+void GenerateDeferredViolations(const std::string& FilePath);
+
+}  // namespace nett
+
+#endif
@@ -0,0 +1,901 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#include "Checker.hpp"
+
+#include "CheckResults.hpp"
+#include "Session.hpp"
+
+#include "../checks/braces/EnumBracesCheck.hpp"
+#include "../checks/braces/FunctionBodyBracesCheck.hpp"
+#include "../checks/braces/StructUnionBracesCheck.hpp"
+#include "../checks/comments/CommentManager.hpp"
+#include "../checks/comments/FunctionCommentCheck.hpp"
+#include "../checks/comments/GlobalVarCommentCheck.hpp"
+#include "../checks/indentation/EnumBodyIndentCheck.hpp"
+#include "../checks/indentation/FuncDeclParamContIndentCheck.hpp"
+#include "../checks/indentation/FunctionBodyIndentCheck.hpp"
+#include "../checks/indentation/GlobalVarIndentCheck.hpp"
+#include "../checks/indentation/StructUnionBodyIndentCheck.hpp"
+#include "../checks/indentation/TypedefIndentCheck.hpp"
+#include "../checks/naming/DefineNameCheck.hpp"
+#include "../checks/naming/EnumConstNameCheck.hpp"
+#include "../checks/naming/EnumNameCheck.hpp"
+#include "../checks/naming/FuncNameCheck.hpp"
+#include "../checks/naming/StructUnionFieldNameCheck.hpp"
+#include "../checks/naming/StructUnionNameCheck.hpp"
+#include "../checks/naming/TypedefNameCheck.hpp"
+#include "../checks/naming/VarNameCheck.hpp"
+#include "../checks/overall/FuncDefinitionInHeaderCheck.hpp"
+#include "../checks/overall/FuncLengthCheck.hpp"
+#include "../checks/overall/KeywordRedefCheck.hpp"
+#include "../checks/traversal/FunctionBodyCheck.hpp"
+#include "../checks/utils/TokenCache.hpp"
+#include "../checks/warning/GoToCheck.hpp"
+#include "../checks/whitespace/BinaryOperatorWhitespaceCheck.hpp"
+#include "../checks/whitespace/EnumWhitespaceCheck.hpp"
+#include "../checks/whitespace/FileContentManager.hpp"
+#include "../checks/whitespace/FunctionBodyWhitespaceCheck.hpp"
+#include "../checks/whitespace/FunctionCallWhitespaceCheck.hpp"
+#include "../checks/whitespace/GlobalVariableSemicolonWhitespaceCheck.hpp"
+#include "../checks/whitespace/StructUnionMemberAccessWhitespaceCheck.hpp"
+#include "../checks/whitespace/StructUnionWhitespaceCheck.hpp"
+#include "../checks/whitespace/TernaryOperatorWhitespaceCheck.hpp"
+#include "../checks/whitespace/UnaryOperatorWhitespaceCheck.hpp"
+#include "../checks/whitespace/VarDeclWhitespaceCheck.hpp"
+#include "../input/FileStore.hpp"
+#include "../input/LineFilter.hpp"
+#include "../input/SourceIndex.hpp"
+#include "../output/StructuredOutput.hpp"
+#include "../stats/Counters.hpp"
+#include "../stats/MemoryUsage.hpp"
+#include "../stats/Profiler.hpp"
+#include "../stats/TimeTrace.hpp"
+#include "../violations/ViolationManager.hpp"
+
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "clang/ASTMatchers/ASTMatchers.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/FrontendActions.h"
+#include "clang/Frontend/Utils.h"
+#include "clang/Lex/Lexer.h"
+#include "clang/Lex/Preprocessor.h"
+#include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/TimeProfiler.h"
+#include "llvm/Support/VirtualFileSystem.h"
+
+#include <chrono>
+
+using namespace clang;
+using namespace clang::tooling;
+using namespace clang::ast_matchers;
+using namespace llvm;
+
+namespace nett {
+
+// How many files per worker thread may be checked ahead of the next file
+// whose results are merged
+#define CHECK_AHEAD_FACTOR 4
+
+// How many tokens are parsed between checks of a file's memory budget
+#define MEMORY_CHECK_TOKENS 8192
+
+// SUPPRESSIONS ---------------------------------------------------------------
+
+// The WarningDiagConsumer allows us to suppress warning and error messages
+// which are raised when a file is being parsed by clang. We do nothing when
+// handling a diagnostic since we are simply style checking code which we
+// assume already compiles.
+class WarningDiagConsumer : public DiagnosticConsumer {
+
+    public:
+    virtual void HandleDiagnostic(
+            DiagnosticsEngine::Level Level, const Diagnostic& Info) override {
+        // simply do nothing
+    }
+};
+
+// MATCHERS -------------------------------------------------------------------
+
+namespace {
+
+AST_MATCHER(VarDecl, isLocalVariable) {
+    return Node.isLocalVarDecl();
+}
+
+// Matches declarations which are not nested within a struct/union or a
+// function. The lexical contexts are walked directly (unlike hasAncestor,
+// which builds the parent map of the whole translation unit).
+AST_MATCHER(Decl, isTopLevelDecl) {
+    for (const auto* Context = Node.getLexicalDeclContext(); Context;
+            Context = Context->getLexicalParent()) {
+        if (llvm::isa<RecordDecl>(Context) ||
+                llvm::isa<FunctionDecl>(Context)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Variable declaration matcher
+auto VarDeclMatcher = varDecl().bind("varDecl");
+// Function declaration matcher
+auto FuncDeclMatcher = functionDecl().bind("funcDecl");
+// Struct/Union declaration matcher
+auto StructUnionDeclMatcher = recordDecl().bind("recordDecl");
+// Struct/Union field matcher
+auto StructUnionFieldMatcher = fieldDecl().bind("fieldDecl");
+// Enum declaration matcher
+auto EnumDeclMatcher = enumDecl().bind("enumDecl");
+// Enum constant matcher
+auto EnumConstMatcher = enumConstantDecl().bind("enumConstDecl");
+// Typedef matcher
+auto TypedefMatcher = typedefDecl().bind("typedefDecl");
+// goto statement matcher
+auto GoToMatcher = gotoStmt().bind("gotoStmt");
+// Global variable matcher
+auto GlobalVarMatcher = varDecl(hasGlobalStorage(), unless(isLocalVariable()),
+        unless(matchesName("::g[A-Z]")))
+                                .bind("globalVar");
+// Top level struct/union matcher
+auto TopLevelRecordMatcher =
+        recordDecl(isTopLevelDecl()).bind("topLevelRecordDecl");
+// Top level enum matcher
+auto TopLevelEnumMatcher =
+        enumDecl(isTopLevelDecl()).bind("topLevelEnumDecl");
+// Top level typedef matcher
+auto TopLevelTypedefMatcher =
+        typedefDecl(isTopLevelDecl()).bind("topLevelTypedefDecl");
+// Binary operator matcher
+auto BinOpMatcher = binaryOperator().bind("binOp");
+
+// Member expression (X->a / X.a) matcher
+auto MemberExprMatcher = memberExpr().bind("memberExpr");
+
+// Unary operator matcher
+auto UnaryOpMatcher = unaryOperator().bind("unaryOp");
+
+// Function call matcher
+auto FuncCallMatcher = callExpr().bind("funcCall");
+
+// Ternary expression matcher
+auto TernaryMatcher = conditionalOperator().bind("ternaryExpr");
+
+}  // namespace
+
+// PROFILING ------------------------------------------------------------------
+
+// Gives a check the name its time is recorded under when the checks are
+// being profiled. The MatchFinder times each callback under its ID.
+class NamedCheck : public MatchFinder::MatchCallback {
+
+    public:
+    NamedCheck(StringRef Name, MatchFinder::MatchCallback* Check)
+        : Name(Name), Check(Check) {
+    }
+
+    void run(const MatchFinder::MatchResult& Result) override {
+        llvm::TimeTraceScope Trace(Name);
+        Check->run(Result);
+    }
+
+    void onStartOfTranslationUnit() override {
+        Check->onStartOfTranslationUnit();
+    }
+
+    void onEndOfTranslationUnit() override {
+        Check->onEndOfTranslationUnit();
+    }
+
+    StringRef getID() const override {
+        return Name;
+    }
+
+    private:
+    StringRef Name;
+    std::unique_ptr<MatchFinder::MatchCallback> Check;
+};
+
+// Times a preprocessor check on the given file. Only the callbacks used by
+// the preprocessor checks are passed on.
+class ProfiledPPCallbacks : public PPCallbacks {
+
+    public:
+    ProfiledPPCallbacks(StringRef Name, StringRef FilePath, PPCallbacks* Check)
+        : Name(Name), FilePath(FilePath.str()), Check(Check) {
+    }
+
+    ~ProfiledPPCallbacks() {
+        stats::GlobalCheckProfiler.AddTime(Name, FilePath, Elapsed.count());
+    }
+
+    void MacroDefined(const Token& MacroNameTok,
+            const MacroDirective* MD) override {
+        auto Start = std::chrono::steady_clock::now();
+        Check->MacroDefined(MacroNameTok, MD);
+        Elapsed += std::chrono::steady_clock::now() - Start;
+    }
+
+    void EndOfMainFile() override {
+        auto Start = std::chrono::steady_clock::now();
+        Check->EndOfMainFile();
+        Elapsed += std::chrono::steady_clock::now() - Start;
+    }
+
+    private:
+    StringRef Name;
+    std::string FilePath;
+    std::unique_ptr<PPCallbacks> Check;
+    std::chrono::duration<double> Elapsed{0};
+};
+
+// Returns the bytes held by the SourceManager for the content of the files it
+// has read, and for its other buffers (e.g. the predefines).
+static uint64_t GetSourceBufferBytes(const SourceManager& SM) {
+
+    uint64_t Bytes = 0;
+    for (auto It = SM.fileinfo_begin(); It != SM.fileinfo_end(); ++It) {
+        Bytes += It->second->getSizeBytesMapped();
+    }
+    auto Buffers = SM.getMemoryBufferSizes();
+    return Bytes + Buffers.malloc_bytes + Buffers.mmap_bytes;
+}
+
+// TRAVERSAL SETUP ------------------------------------------------------------
+
+// The ASTConsumer allows us to dictate which AST nodes we match and how we
+// want to handle those matches.
+class NettASTConsumer : public ASTConsumer {
+
+    public:
+    NettASTConsumer(clang::Preprocessor& PP, StringRef FilePath,
+            uint64_t MaxMemory)
+        : FilePath(FilePath.str()), MaxMemory(MaxMemory),
+          Matcher(GetMatcherOptions()) {
+        if (MaxMemory) {
+            PP.setTokenWatcher([this, &PP](const Token& Tok) {
+                WatchMemoryBudget(PP, Tok);
+            });
+        }
+
+        // Here we add all of the checks that should be run
+        // when the AST is traversed by using AddCheck
+
+        // NAMING checks
+        AddCheck(VarDeclMatcher, "naming/VarName",
+                new checks::naming::VarNameChecker());
+        AddCheck(FuncDeclMatcher, "naming/FuncName",
+                new checks::naming::FuncNameChecker());
+        AddCheck(StructUnionDeclMatcher, "naming/RecordName",
+                new checks::naming::RecordNameChecker());
+        AddCheck(StructUnionFieldMatcher, "naming/RecordFieldName",
+                new checks::naming::RecordFieldNameChecker());
+        AddCheck(EnumDeclMatcher, "naming/EnumName",
+                new checks::naming::EnumNameChecker());
+        AddCheck(EnumConstMatcher, "naming/EnumConstName",
+                new checks::naming::EnumConstNameChecker());
+        AddCheck(TypedefMatcher, "naming/TypedefName",
+                new checks::naming::TypedefNameChecker());
+
+        // COMMENTS checks
+        AddCheck(GlobalVarMatcher, "comments/GlobalVarComment",
+                new checks::comments::GlobalVarCommentChecker());
+        AddCheck(FuncDeclMatcher, "comments/FunctionComment",
+                new checks::comments::FunctionCommentChecker());
+
+        // BRACES checks
+        AddCheck(FuncDeclMatcher, "braces/FunctionBodyBraces",
+                new checks::braces::FunctionBodyBracesChecker());
+        AddCheck(EnumDeclMatcher, "braces/EnumBraces",
+                new checks::braces::EnumBracesChecker());
+        AddCheck(StructUnionDeclMatcher, "braces/StructUnionBraces",
+                new checks::braces::StructUnionBracesChecker());
+
+        // WHITESPACE checks
+        AddCheck(BinOpMatcher, "whitespace/BinaryOperator",
+                new checks::whitespace::BinaryOperatorWhitespaceChecker());
+        AddCheck(MemberExprMatcher, "whitespace/StructUnionMemberAccess",
+                new checks::whitespace::
+                        StructUnionMemberAccessWhitespaceChecker());
+        AddCheck(UnaryOpMatcher, "whitespace/UnaryOperator",
+                new checks::whitespace::UnaryOperatorWhitespaceChecker());
+        AddCheck(GlobalVarMatcher, "whitespace/GlobalVariableSemicolon",
+                new checks::whitespace::
+                        GlobalVariableSemicolonWhitespaceChecker());
+        AddCheck(FuncDeclMatcher, "whitespace/FunctionBody",
+                new checks::whitespace::FunctionBodyWhitespaceChecker());
+        AddCheck(EnumDeclMatcher, "whitespace/Enum",
+                new checks::whitespace::EnumWhitespaceChecker(PP));
+        AddCheck(StructUnionDeclMatcher, "whitespace/StructUnion",
+                new checks::whitespace::StructUnionWhitespaceChecker(PP));
+        AddCheck(FuncCallMatcher, "whitespace/FunctionCall",
+                new checks::whitespace::FunctionCallWhitespaceChecker(PP));
+        AddCheck(VarDeclMatcher, "whitespace/VarDecl",
+                new checks::whitespace::VarDeclWhitespaceChecker(PP));
+        AddCheck(TernaryMatcher, "whitespace/TernaryOperator",
+                new checks::whitespace::TernaryOperatorWhitespaceChecker());
+
+        // INDENTATION checks
+        AddCheck(FuncDeclMatcher, "indentation/FuncDeclParamCont",
+                new checks::indentation::FuncDeclParamContIndentChecker());
+        AddCheck(FuncDeclMatcher, "indentation/FunctionBody",
+                new checks::indentation::FunctionBodyIndentChecker());
+        AddCheck(GlobalVarMatcher, "indentation/GlobalVar",
+                new checks::indentation::GlobalVarIndentChecker());
+        AddCheck(TopLevelRecordMatcher, "indentation/StructUnionBody",
+                new checks::indentation::StructUnionBodyIndentChecker(PP));
+        AddCheck(TopLevelEnumMatcher, "indentation/EnumBody",
+                new checks::indentation::EnumBodyIndentChecker(PP));
+        AddCheck(TopLevelTypedefMatcher, "indentation/Typedef",
+                new checks::indentation::TypedefIndentChecker());
+
+        // FUNCTION BODY checks (braces, whitespace and indentation are
+        // all checked in a single walk over each body)
+        AddCheck(FuncDeclMatcher, "traversal/FunctionBody",
+                new checks::traversal::FunctionBodyChecker(PP));
+
+        // OVERALL checks
+        AddCheck(FuncDeclMatcher, "overall/FuncDefinitionInHeader",
+                new checks::overall::FuncDefinitionInHeaderChecker());
+        AddCheck(FuncDeclMatcher, "overall/FuncLength",
+                new checks::overall::FuncLengthChecker());
+
+        // WARNING checks
+        AddCheck(GoToMatcher, "warning/GoTo",
+                new checks::warning::GoToChecker());
+    }
+
+    ~NettASTConsumer() {
+        if (Parsing) {
+            llvm::timeTraceProfilerEnd();
+        }
+    }
+
+    // Parsing starts once the consumer is given the ASTContext, and is
+    // done when it's given the translation unit.
+    void Initialize(ASTContext& Context) override {
+        NettASTConsumer::Context = &Context;
+        if (llvm::timeTraceProfilerEnabled()) {
+            llvm::timeTraceProfilerBegin("Parse", FilePath);
+            Parsing = true;
+        }
+    }
+
+    // Stops parsing the file once it has used up its memory budget, and
+    // otherwise keeps the declarations to match.
+    bool HandleTopLevelDecl(DeclGroupRef Group) override {
+
+        if (Group.isNull()) {
+            return true;
+        }
+        if (ExceedsMemoryBudget((*Group.begin())->getBeginLoc())) {
+            return false;
+        }
+
+        // None of the checks look at code from the system headers, so we
+        // only match the declarations written in the student's files. Their
+        // own headers are kept since e.g. a prototype's comment counts for
+        // the function it declares. The declarations of the preamble are
+        // never handed to us, so they don't have to be read from it.
+        const auto& SM = Context->getSourceManager();
+        for (auto* Node : Group) {
+            auto Loc = Node->getLocation();
+            if (Loc.isValid() && !SM.isInSystemHeader(Loc)) {
+                TraversalScope.push_back(Node);
+            }
+        }
+        return true;
+    }
+
+    void HandleTranslationUnit(ASTContext& Context) override {
+
+        if (Parsing) {
+            llvm::timeTraceProfilerEnd();
+            Parsing = false;
+        }
+        if (ExceedsMemoryBudget(SourceLocation())) {
+            return;
+        }
+
+        // Only the declarations kept while parsing are matched, rather than
+        // every declaration of the translation unit (which would read each
+        // one in the preamble).
+        if (input::GlobalLineFilter->IsActive()) {
+            TraversalScope = FilterTraversalScope(
+                    TraversalScope, Context.getSourceManager());
+        }
+        Context.setTraversalScope(TraversalScope);
+
+        {
+            llvm::TimeTraceScope Trace("Match", FilePath);
+            Matcher.matchAST(Context);
+        }
+
+        // The times are only recorded when the checks are being profiled
+        for (const auto& Check : CheckTimes) {
+            stats::GlobalCheckProfiler.AddTime(Check.getKey(), FilePath,
+                    Check.getValue().getWallTime());
+        }
+    }
+
+    // Only called when function bodies are being skipped, in which case we
+    // still need the bodies of the functions in the file being checked.
+    bool shouldSkipFunctionBody(Decl* Node) override {
+        const auto& SM = Node->getASTContext().getSourceManager();
+        return !SM.isWrittenInMainFile(Node->getLocation());
+    }
+
+    // Records the memory used checking the file. This must be called while
+    // the ASTContext is still around.
+    void RecordMemoryUsage(void) {
+
+        stats::FileMemory Memory;
+        if (Context) {
+            Memory.AST = Context->getASTAllocatedMemory();
+            Memory.SourceBuffers =
+                    GetSourceBufferBytes(Context->getSourceManager());
+        }
+        if (input::GlobalFileStore->HasFile(FilePath)) {
+            Memory.Sanitized =
+                    input::GlobalFileStore->GetContent(FilePath).size();
+        }
+        Memory.Violations = GlobalViolationManager.GetMemoryUsage(FilePath);
+        Memory.OverBudget = OverBudget;
+        stats::GlobalMemoryUsage.RecordFile(FilePath, Memory);
+    }
+
+    private:
+    // Checks if the AST and source buffers have grown past the memory
+    // budget, in which case a violation is added on the line of the given
+    // location (or the first line, if it's not in the file). The violation
+    // is only added the first time.
+    bool ExceedsMemoryBudget(SourceLocation Loc) {
+
+        if (OverBudget) {
+            return true;
+        }
+        if (!MaxMemory || !Context) {
+            return false;
+        }
+        const auto& SM = Context->getSourceManager();
+        if (Context->getASTAllocatedMemory() + GetSourceBufferBytes(SM) <=
+                MaxMemory) {
+            return false;
+        }
+
+        unsigned LineNo = 1;
+        if (Loc.isValid() && SM.isWrittenInMainFile(SM.getExpansionLoc(Loc))) {
+            LineNo = SM.getExpansionLineNumber(Loc);
+        }
+        auto Message = "Stopped checking this file after it used more "
+                       "than " + std::to_string(MaxMemory >> 20) +
+                       " MiB of memory.";
+        GlobalViolationManager.AddViolation(
+                ResourceViolation(FilePath, LineNo, Message));
+        OverBudget = true;
+        return true;
+    }
+
+    // Called on each token the parser is given. A single declaration (e.g.
+    // a huge table) can use up the budget by itself, so the budget is also
+    // checked every MEMORY_CHECK_TOKENS tokens. Once it is used up, the
+    // rest of the file being read is cut off, so the parser runs out of
+    // tokens and stops.
+    void WatchMemoryBudget(Preprocessor& PP, const Token& Tok) {
+
+        if (!OverBudget) {
+            if (++TokensSinceMemoryCheck < MEMORY_CHECK_TOKENS) {
+                return;
+            }
+            TokensSinceMemoryCheck = 0;
+            if (!ExceedsMemoryBudget(Tok.getLocation())) {
+                return;
+            }
+        }
+        // Files are only ever read by a Lexer
+        if (auto* FileLexer = PP.getCurrentFileLexer()) {
+            static_cast<Lexer*>(FileLexer)->cutOffLexing();
+        }
+    }
+
+    // Returns the options of the MatchFinder, which times each check when
+    // the checks are being profiled.
+    MatchFinder::MatchFinderOptions GetMatcherOptions(void) {
+        MatchFinder::MatchFinderOptions Options;
+        if (stats::GlobalCheckProfiler.IsEnabled()) {
+            Options.CheckProfiling.emplace(CheckTimes);
+        }
+        return Options;
+    }
+
+    // Adds a check, which is run on each node the given matcher matches,
+    // under the given name.
+    template <typename NodeMatcher>
+    void AddCheck(const NodeMatcher& Node, StringRef Name,
+            MatchFinder::MatchCallback* Check) {
+        Checks.emplace_back(new NamedCheck(Name, Check));
+        Matcher.addMatcher(Node, Checks.back().get());
+    }
+
+    // Keeps the declarations near the lines being checked. A declaration
+    // is kept if any line from the end of the declaration before it to the
+    // start of the one after it is being checked, so that the spacing
+    // between it and its neighbours is still checked. Prototypes are always
+    // kept, since their comments count for the functions they declare.
+    static std::vector<Decl*> FilterTraversalScope(
+            const std::vector<Decl*>& Decls, const SourceManager& SM) {
+
+        struct DeclLines {
+            Decl* Node;
+            StringRef File;
+            unsigned First;
+            unsigned Last;
+        };
+        std::vector<DeclLines> Lines;
+        for (auto* Node : Decls) {
+            auto Begin = SM.getExpansionLoc(Node->getBeginLoc());
+            auto End = SM.getExpansionLoc(Node->getEndLoc());
+            Lines.push_back({Node, SM.getFilename(Begin),
+                    SM.getExpansionLineNumber(Begin),
+                    SM.getExpansionLineNumber(End)});
+        }
+
+        std::vector<Decl*> Kept;
+        for (unsigned i = 0; i < Lines.size(); i++) {
+            const auto* Function = dyn_cast<FunctionDecl>(Lines[i].Node);
+            if (Function && !Function->isThisDeclarationADefinition()) {
+                Kept.push_back(Lines[i].Node);
+                continue;
+            }
+
+            // The declarations of each file are in the order they appear,
+            // though other files' declarations may come in between
+            unsigned First = 1;
+            unsigned Last = UINT_MAX;
+            for (unsigned j = i; j-- > 0;) {
+                if (Lines[j].File == Lines[i].File) {
+                    First = std::min(Lines[j].Last, Lines[i].First);
+                    break;
+                }
+            }
+            for (unsigned j = i + 1; j < Lines.size(); j++) {
+                if (Lines[j].File == Lines[i].File) {
+                    Last = std::max(Lines[j].First, Lines[i].Last);
+                    break;
+                }
+            }
+            if (input::GlobalLineFilter->Overlaps(Lines[i].File, First, Last)) {
+                Kept.push_back(Lines[i].Node);
+            }
+        }
+        return Kept;
+    }
+
+    std::string FilePath;
+    uint64_t MaxMemory;
+    ASTContext* Context = nullptr;
+    bool Parsing = false;
+    bool OverBudget = false;
+    unsigned TokensSinceMemoryCheck = 0;
+    // The top-level declarations to match, in the order they were parsed
+    std::vector<Decl*> TraversalScope;
+    llvm::StringMap<llvm::TimeRecord> CheckTimes;
+    std::vector<std::unique_ptr<MatchFinder::MatchCallback>> Checks;
+    MatchFinder Matcher;
+};
+
+// The FrontEndAction is the main entry point for the clang tooling library
+// and allows us to add callbacks for checks via PPCallback and
+// ASTConsumer classes.
+class NettFrontEndAction : public ASTFrontendAction {
+
+    public:
+    // The files read while checking, other than the system headers, are
+    // added to Dependencies if it is given.
+    NettFrontEndAction(const CheckOptions& Options,
+            std::vector<std::string>* Dependencies = nullptr)
+        : Options(Options), Dependencies(Dependencies) {
+    }
+
+    virtual std::unique_ptr<ASTConsumer> CreateASTConsumer(
+            CompilerInstance& CI, StringRef file) override {
+
+        if (Dependencies) {
+            Collector = std::make_shared<DependencyCollector>();
+            Collector->attachToPreprocessor(CI.getPreprocessor());
+            CI.addDependencyCollector(Collector);
+        }
+
+        // Here we add any checks which require the preprocessor.
+        AddPPCheck(CI, file, "naming/DefineName",
+                new checks::naming::DefineNameChecker(CI.getSourceManager()));
+
+        AddPPCheck(CI, file, "overall/KeywordRedef",
+                new checks::overall::KeywordRedefChecker(
+                        CI.getSourceManager(), CI.getLangOpts()));
+
+        // The parser asks the consumer which function bodies it can skip
+        if (Options.SkipHeaderBodies) {
+            CI.getFrontendOpts().SkipFunctionBodies = true;
+        }
+
+        Consumer = new NettASTConsumer(
+                CI.getPreprocessor(), file, Options.MaxMemory);
+        return std::unique_ptr<ASTConsumer>(Consumer);
+    }
+
+    // The cached tokens point into this file's SourceManager, so they
+    // can't outlive it.
+    virtual void EndSourceFileAction() override {
+        checks::utils::GlobalTokenCache.Clear();
+
+        if (Consumer && stats::GlobalMemoryUsage.IsEnabled()) {
+            Consumer->RecordMemoryUsage();
+        }
+
+        // The files are named relative to the tool's working directory
+        if (Collector) {
+            auto& FS = getCompilerInstance().getVirtualFileSystem();
+            for (const auto& File : Collector->getDependencies()) {
+                llvm::SmallString<128> FullPath(File);
+                FS.makeAbsolute(FullPath);
+                llvm::sys::path::remove_dots(FullPath, true);
+                Dependencies->push_back(FullPath.str().str());
+            }
+        }
+    }
+
+    private:
+    // Adds a preprocessor check, which is timed under the given name when
+    // the checks are being profiled.
+    static void AddPPCheck(CompilerInstance& CI, StringRef FilePath,
+            StringRef Name, PPCallbacks* Check) {
+        if (stats::GlobalCheckProfiler.IsEnabled()) {
+            Check = new ProfiledPPCallbacks(Name, FilePath, Check);
+        }
+        CI.getPreprocessor().addPPCallbacks(
+                std::unique_ptr<PPCallbacks>(Check));
+    }
+
+    const CheckOptions& Options;
+    std::vector<std::string>* Dependencies;
+    std::shared_ptr<DependencyCollector> Collector;
+    // Owned by the CompilerInstance, which keeps it until after the source
+    // file action ends
+    NettASTConsumer* Consumer = nullptr;
+};
+
+// Makes a NettFrontEndAction for each file a tool checks, all of which
+// use the same options and add the files they read to the same
+// Dependencies.
+class NettFrontEndActionFactory : public FrontendActionFactory {
+
+    public:
+    NettFrontEndActionFactory(const CheckOptions& Options,
+            std::vector<std::string>* Dependencies = nullptr)
+        : Options(Options), Dependencies(Dependencies) {
+    }
+
+    std::unique_ptr<FrontendAction> create() override {
+        return std::unique_ptr<FrontendAction>(
+                new NettFrontEndAction(Options, Dependencies));
+    }
+
+    private:
+    const CheckOptions& Options;
+    std::vector<std::string>* Dependencies;
+};
+
+std::vector<std::string> GetDefaultCompileFlags(void) {
+    return {"-fparse-all-comments", "-std=gnu99", "-trigraphs", "-O0"};
+}
+
+std::string GetFullPath(const std::string& FilePath) {
+
+    auto AbsPath = getAbsolutePath(*vfs::getRealFileSystem(), FilePath);
+    if (!AbsPath) {
+        llvm::consumeError(AbsPath.takeError());
+        return FilePath;
+    }
+    return *AbsPath;
+}
+
+// Returns the working directory and arguments the given file is compiled
+// with, which the cached results of the file depend on.
+static std::vector<std::string> GetCompileCommandLine(
+        const CompilationDatabase& Compilations, const std::string& FilePath) {
+
+    std::vector<std::string> CommandLine;
+    for (const auto& Command : Compilations.getCompileCommands(FilePath)) {
+        CommandLine.push_back(Command.Directory);
+        CommandLine.insert(CommandLine.end(), Command.CommandLine.begin(),
+                Command.CommandLine.end());
+    }
+    return CommandLine;
+}
+
+// Checks each of the given files using its own clang tool, spreading the
+// tools over a pool of worker threads. The results for each file are merged
+// back in the order the files were given to us, which makes the violations
+// found identical to those found by a single tool checking every file.
+// OnFileMerged is called with the index of each file once its results have
+// been merged. Only a few files are checked ahead of the next file to merge,
+// so finished results don't pile up while waiting for a slow file. Files
+// whose results are in the cache aren't parsed at all. The workers join the
+// caller's session.
+static void RunChecksInParallel(const CompilationDatabase& Compilations,
+        const std::vector<std::string>& FileList, const CheckOptions& Options,
+        const ArgumentsAdjuster& PreambleAdjuster,
+        llvm::function_ref<void(unsigned)> OnFileMerged = nullptr) {
+
+    std::vector<CheckResults> Results(FileList.size());
+    std::vector<std::shared_future<void>> Futures;
+    auto Strategy = llvm::hardware_concurrency(Options.Jobs);
+    llvm::ThreadPool Pool(Strategy);
+    unsigned Window = Strategy.compute_thread_count() * CHECK_AHEAD_FACTOR;
+    auto* Session = GetCurrentSession();
+    auto* Cache = Options.Cache;
+
+    auto StartFile = [&](unsigned i) {
+        Futures.push_back(Pool.async([&Compilations, &FileList, &Options,
+                                             &PreambleAdjuster, &Results,
+                                             Session, Cache, i]() {
+            SessionScope Scope(*Session);
+            stats::TimeTraceThread TraceThread;
+            stats::ThreadCounterScope Counting;
+            llvm::TimeTraceScope Trace("CheckFile", FileList[i]);
+
+            if (Options.GenerateFiles) {
+                GlobalViolationManager.SetOutputToFile();
+            }
+
+            std::string FilePath;
+            std::vector<std::string> CommandLine;
+            if (Cache) {
+                FilePath = GetFullPath(FileList[i]);
+                CommandLine = GetCompileCommandLine(Compilations, FileList[i]);
+                if (auto Cached = Cache->Load(FilePath, CommandLine)) {
+                    Results[i] = std::move(*Cached);
+                    return;
+                }
+            }
+
+            // The tools each get their own view of the file system so that
+            // they don't fight over the process's working directory.
+            WarningDiagConsumer DiagConsumer;
+            ClangTool Tool(Compilations, FileList[i],
+                    std::make_shared<PCHContainerOperations>(),
+                    input::GlobalFileStore->CreateFileSystem(
+                            IntrusiveRefCntPtr<vfs::FileSystem>(
+                                    vfs::createPhysicalFileSystem()
+                                            .release())));
+            Tool.setDiagnosticConsumer(&DiagConsumer);
+            if (PreambleAdjuster) {
+                Tool.appendArgumentsAdjuster(PreambleAdjuster);
+            }
+            std::vector<std::string> Dependencies;
+            NettFrontEndActionFactory Factory(
+                    Options, Cache ? &Dependencies : nullptr);
+            Tool.run(&Factory);
+
+            Results[i] = TakeCheckResults();
+            if (Cache) {
+                Cache->Store(FilePath, CommandLine, Results[i], Dependencies);
+            }
+        }));
+    };
+
+    for (unsigned i = 0; i < FileList.size() && i < Window; i++) {
+        StartFile(i);
+    }
+
+    for (unsigned i = 0; i < FileList.size(); i++) {
+        Futures[i].wait();
+        MergeCheckResults(Results[i]);
+        if (i + Window < FileList.size()) {
+            StartFile(i + Window);
+        }
+        if (OnFileMerged) {
+            OnFileMerged(i);
+        }
+    }
+}
+
+std::vector<std::string> CheckFiles(const CompilationDatabase& Compilations,
+        const std::vector<std::string>& FileList, const CheckOptions& Options,
+        const llvm::StringMap<std::string>& Buffers,
+        output::ResultStream* Stream) {
+
+    // The files are read and sanitized (e.g. tabs converted into spaces)
+    // once, and the store then serves their content to the checks and to
+    // the output stage. The indexes and content of the previous run's files
+    // are no longer needed.
+    input::GlobalSourceIndexManager->Clear();
+    input::GlobalFileStore->Clear();
+
+    std::vector<std::string> FilePaths;
+    std::vector<llvm::StringRef> FileContents;
+
+    for (const auto& FilePath : FileList) {
+        // The violations are stored under the path the tool gives clang
+        FilePaths.push_back(GetFullPath(FilePath));
+
+        auto Buffer = Buffers.find(FilePath);
+        if (Buffer != Buffers.end()) {
+            input::GlobalFileStore->AddContent(
+                    FilePaths.back(), Buffer->second);
+        } else {
+            input::GlobalFileStore->AddFile(FilePaths.back());
+        }
+        FileContents.push_back(
+                input::GlobalFileStore->GetContent(FilePaths.back()));
+    }
+
+    // Most of the time spent parsing a file goes into the system headers
+    // it includes, so files sharing the same headers share a preamble.
+    ArgumentsAdjuster PreambleAdjuster;
+    if (Options.Preambles) {
+        Options.Preambles->PrepareForFiles(
+                Compilations, FileList, FileContents);
+        PreambleAdjuster = Options.Preambles->GetArgumentsAdjuster();
+    }
+
+    // Now that the files are ready, we can run the checks. Streaming the
+    // results needs to know when each file is done, and the cache needs
+    // each file's results on their own, so every file then gets its own
+    // tool.
+    std::vector<unsigned> UnwrittenFiles;
+    if (Stream) {
+        auto WriteSettledFiles = [&](unsigned Merged) {
+            UnwrittenFiles.push_back(Merged);
+            auto Unsettled = GetUnsettledFiles();
+            std::vector<unsigned> StillUnwritten;
+
+            for (auto i : UnwrittenFiles) {
+                if (Unsettled.count(FilePaths[i])) {
+                    StillUnwritten.push_back(i);
+                    continue;
+                }
+                GenerateDeferredViolations(FilePaths[i]);
+                stats::ProfileScope Profile("output/Structured", FilePaths[i]);
+                Stream->WriteFile(FilePaths[i]);
+            }
+            UnwrittenFiles.swap(StillUnwritten);
+        };
+        RunChecksInParallel(Compilations, FileList, Options, PreambleAdjuster,
+                WriteSettledFiles);
+    } else if (Options.Jobs != 1 || Options.Cache) {
+        RunChecksInParallel(Compilations, FileList, Options, PreambleAdjuster);
+    } else {
+        // Clang reads the stored content through the file system we give
+        // it, in place of the files on disk.
+        WarningDiagConsumer DiagConsumer;
+        ClangTool Tool(Compilations, FileList,
+                std::make_shared<PCHContainerOperations>(),
+                input::GlobalFileStore->CreateFileSystem(
+                        vfs::getRealFileSystem()));
+        Tool.setDiagnosticConsumer(&DiagConsumer);
+        if (PreambleAdjuster) {
+            Tool.appendArgumentsAdjuster(PreambleAdjuster);
+        }
+        NettFrontEndActionFactory Factory(Options);
+        Tool.run(&Factory);
+    }
+
+    // Some of the checks (e.g. function comments) can only be done once
+    // everything has been processed. We do those checks here.
+    GenerateDeferredViolations();
+
+    for (auto i : UnwrittenFiles) {
+        stats::ProfileScope Profile("output/Structured", FilePaths[i]);
+        Stream->WriteFile(FilePaths[i]);
+    }
+
+    return FilePaths;
+}
+
+}  // namespace nett
@@ -0,0 +1,59 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#ifndef LLVM_CLANG_TOOLS_EXTRA_NETT_RUNNER_CHECKER_HPP
+#define LLVM_CLANG_TOOLS_EXTRA_NETT_RUNNER_CHECKER_HPP
+
+#include "Preamble.hpp"
+#include "ResultCache.hpp"
+#include "../output/StructuredOutput.hpp"
+
+#include "clang/Tooling/CompilationDatabase.h"
+#include "llvm/ADT/StringMap.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace nett {
+
+// The options which change how a set of files is checked.
+struct CheckOptions {
+    // The number of worker threads, or 0 for every hardware thread
+    unsigned Jobs = 1;
+    // Whether the violations will be written to .styled files
+    bool GenerateFiles = false;
+    // Whether the function bodies of included headers are skipped
+    bool SkipHeaderBodies = false;
+    // The bytes a file may use before it stops being checked, or 0
+    uint64_t MaxMemory = 0;
+    // The preamble shared by the files, if one should be used
+    PreambleManager* Preambles = nullptr;
+    // The results kept from earlier runs, if the cache is in use
+    ResultCache* Cache = nullptr;
+};
+
+// Returns the compiler flags every file needs to be checked correctly
+// (e.g. keeping every comment in the AST).
+std::vector<std::string> GetDefaultCompileFlags(void);
+
+// Returns the full path of the given file, which is the path its
+// violations are stored under.
+std::string GetFullPath(const std::string& FilePath);
+
+// Checks the given files in the current thread's session, leaving the
+// violations found in the global managers of the current thread. Files with
+// an entry in Buffers are checked using that content instead of what is on
+// disk. Settled files are written to Stream as they are done, if it is
+// given. Returns the full paths of the files, which are needed to look up
+// their violations.
+std::vector<std::string> CheckFiles(
+        const clang::tooling::CompilationDatabase& Compilations,
+        const std::vector<std::string>& FileList, const CheckOptions& Options,
+        const llvm::StringMap<std::string>& Buffers =
+                llvm::StringMap<std::string>(),
+        output::ResultStream* Stream = nullptr);
+
+}  // namespace nett
+
+#endif
@@ -0,0 +1,266 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#include "Preamble.hpp"
+
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Frontend/FrontendActions.h"
+#include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/VirtualFileSystem.h"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+
+using namespace clang::tooling;
+
+namespace nett {
+
+// A preamble is only worth building when it is shared, either by the files
+// of one call or by those of several (e.g. the requests a server gets)
+#define MIN_PREAMBLE_FILES 2
+
+// Returns the full, normalised version of the given path. The tool and the
+// files given to us don't always spell the same path the same way.
+static std::string NormalisePath(llvm::StringRef Path) {
+
+    llvm::SmallString<128> FullPath(Path);
+    llvm::sys::fs::make_absolute(FullPath);
+    llvm::sys::path::remove_dots(FullPath, true);
+
+    return FullPath.str().str();
+}
+
+// Checks if a file with the given leading includes can use a preamble
+// made from the given preamble includes.
+static bool IncludesMatch(const std::vector<std::string>& FileIncludes,
+        const std::vector<std::string>& PreambleIncludes) {
+
+    if (PreambleIncludes.empty() ||
+            FileIncludes.size() < PreambleIncludes.size()) {
+        return false;
+    }
+
+    return std::equal(PreambleIncludes.begin(), PreambleIncludes.end(),
+            FileIncludes.begin());
+}
+
+// Returns the number of files which could use a preamble made from
+// the given includes.
+static unsigned CountMatches(
+        const std::vector<std::vector<std::string>>& FileIncludes,
+        const std::vector<std::string>& PreambleIncludes) {
+
+    unsigned Matches = 0;
+    for (const auto& Includes : FileIncludes) {
+        if (IncludesMatch(Includes, PreambleIncludes)) {
+            Matches++;
+        }
+    }
+
+    return Matches;
+}
+
+PreambleManager::PreambleManager() : HitCount(0), MissCount(0) {}
+
+PreambleManager::~PreambleManager() {
+    RemovePreamble();
+}
+
+std::vector<std::string> PreambleManager::GetLeadingIncludes(
+        llvm::StringRef Content) {
+
+    std::vector<std::string> Includes;
+
+    while (true) {
+        Content = Content.ltrim();
+
+        // Comments (e.g. a file header) may come before the includes
+        if (Content.startswith("//")) {
+            Content = Content.drop_until([](char C) { return C == '\n'; });
+            continue;
+        }
+        if (Content.startswith("/*")) {
+            auto CommentEnd = Content.find("*/", 2);
+            if (CommentEnd == llvm::StringRef::npos) {
+                break;
+            }
+            Content = Content.drop_front(CommentEnd + 2);
+            continue;
+        }
+
+        // Anything but a system include ends the block, since local headers
+        // change too often to be worth precompiling and other directives
+        // can change what the headers mean.
+        auto Line = Content.take_until([](char C) { return C == '\n'; });
+        auto Directive = Line;
+
+        if (!Directive.consume_front("#")) {
+            break;
+        }
+        Directive = Directive.ltrim(" \t");
+        if (!Directive.consume_front("include")) {
+            break;
+        }
+        Directive = Directive.trim(" \t\r");
+        if (!Directive.startswith("<") || !Directive.endswith(">")) {
+            break;
+        }
+
+        Includes.push_back(Directive.str());
+        Content = Content.drop_front(Line.size());
+    }
+
+    return Includes;
+}
+
+void PreambleManager::PrepareForFiles(const CompilationDatabase& Compilations,
+        const std::vector<std::string>& FilePaths,
+        const std::vector<llvm::StringRef>& FileContents) {
+
+    std::vector<std::vector<std::string>> FileIncludes;
+
+    for (const auto& Content : FileContents) {
+        FileIncludes.push_back(GetLeadingIncludes(Content));
+        if (!FileIncludes.back().empty()) {
+            BlockCounts[FileIncludes.back()]++;
+        }
+    }
+
+    // We take the block of these files that has been seen most often so far,
+    // favouring the first one seen so that the choice doesn't depend on
+    // anything but the input.
+    std::vector<std::string> BestIncludes;
+    unsigned BestCount = 0;
+
+    for (const auto& Includes : FileIncludes) {
+        if (Includes.empty() || FailedIncludes.count(Includes)) {
+            continue;
+        }
+        auto Count = BlockCounts[Includes];
+        if (Count > BestCount) {
+            BestIncludes = Includes;
+            BestCount = Count;
+        }
+    }
+
+    // A preamble that is already built is only replaced by one that has
+    // been needed more often, so that files alternating between two blocks
+    // don't rebuild it every time.
+    auto BestMatches = CountMatches(FileIncludes, BestIncludes);
+    auto CurrentMatches = CountMatches(FileIncludes, PreambleIncludes);
+    auto CurrentCount =
+            PreambleIncludes.empty() ? 0 : BlockCounts[PreambleIncludes];
+
+    if (BestMatches > CurrentMatches && BestCount >= MIN_PREAMBLE_FILES &&
+            BestCount > CurrentCount) {
+        if (!BuildPreamble(Compilations, BestIncludes)) {
+            FailedIncludes.insert(BestIncludes);
+        }
+    }
+
+    MatchingFiles.clear();
+    for (unsigned i = 0; i < FilePaths.size(); i++) {
+        if (IncludesMatch(FileIncludes[i], PreambleIncludes)) {
+            MatchingFiles.insert(NormalisePath(FilePaths[i]));
+            HitCount++;
+        } else {
+            MissCount++;
+        }
+    }
+}
+
+ArgumentsAdjuster PreambleManager::GetArgumentsAdjuster(void) {
+
+    // The adjuster may be used by several tools at once, so it gets
+    // its own copy of everything it needs.
+    auto PCH = PCHPath;
+    auto Files = MatchingFiles;
+
+    return [PCH, Files](const CommandLineArguments& Args,
+                   llvm::StringRef Filename) {
+        if (PCH.empty() || !Files.count(NormalisePath(Filename))) {
+            return Args;
+        }
+
+        CommandLineArguments AdjustedArgs(Args);
+        AdjustedArgs.insert(
+                AdjustedArgs.begin() + 1, {"-include-pch", PCH});
+        return AdjustedArgs;
+    };
+}
+
+unsigned PreambleManager::GetHitCount(void) {
+    return HitCount;
+}
+
+unsigned PreambleManager::GetMissCount(void) {
+    return MissCount;
+}
+
+bool PreambleManager::BuildPreamble(const CompilationDatabase& Compilations,
+        const std::vector<std::string>& Includes) {
+
+    RemovePreamble();
+
+    llvm::SmallString<128> Directory;
+    if (llvm::sys::fs::createUniqueDirectory("nett-preamble", Directory)) {
+        return false;
+    }
+    PreambleDirectory = Directory.str().str();
+
+    llvm::SmallString<128> Header(Directory);
+    llvm::sys::path::append(Header, "preamble.h");
+    HeaderPath = Header.str().str();
+
+    std::ofstream HeaderFile(HeaderPath);
+    for (const auto& Include : Includes) {
+        HeaderFile << "#include " << Include << "\n";
+    }
+    HeaderFile.close();
+
+    // The preamble has to be built with the same flags as the files which
+    // use it, so we build it with the tool the files are checked with.
+    PCHPath = HeaderPath + ".pch";
+    clang::IgnoringDiagConsumer DiagConsumer;
+    ClangTool Tool(Compilations, HeaderPath,
+            std::make_shared<clang::PCHContainerOperations>(),
+            llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem>(
+                    llvm::vfs::createPhysicalFileSystem().release()));
+    Tool.setDiagnosticConsumer(&DiagConsumer);
+    Tool.appendArgumentsAdjuster(getInsertArgumentAdjuster(
+            CommandLineArguments{"-o", PCHPath},
+            ArgumentInsertPosition::END));
+
+    if (Tool.run(newFrontendActionFactory<clang::GeneratePCHAction>().get()) ||
+            !llvm::sys::fs::exists(PCHPath)) {
+        RemovePreamble();
+        return false;
+    }
+
+    PreambleIncludes = Includes;
+    return true;
+}
+
+void PreambleManager::RemovePreamble(void) {
+
+    if (!PCHPath.empty()) {
+        llvm::sys::fs::remove(PCHPath);
+    }
+    if (!HeaderPath.empty()) {
+        llvm::sys::fs::remove(HeaderPath);
+    }
+    if (!PreambleDirectory.empty()) {
+        llvm::sys::fs::remove(PreambleDirectory);
+    }
+
+    PreambleIncludes.clear();
+    PreambleDirectory.clear();
+    HeaderPath.clear();
+    PCHPath.clear();
+}
+
+}  // namespace nett
@@ -0,0 +1,73 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#ifndef LLVM_CLANG_TOOLS_EXTRA_NETT_RUNNER_PREAMBLE_HPP
+#define LLVM_CLANG_TOOLS_EXTRA_NETT_RUNNER_PREAMBLE_HPP
+
+#include "clang/Tooling/ArgumentsAdjusters.h"
+#include "clang/Tooling/CompilationDatabase.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace nett {
+
+// Keeps a precompiled header of the system headers which the input files
+// include before any of their own code. The checks only look at the main
+// file, so parsing those headers once and sharing the result between the
+// files saves most of the time spent parsing each file.
+class PreambleManager {
+    public:
+    PreambleManager();
+    ~PreambleManager();
+
+    // Returns the system headers (e.g. <stdio.h>) included at the top of the
+    // given content, in order, before any other code or directives.
+    static std::vector<std::string> GetLeadingIncludes(llvm::StringRef Content);
+
+    // Makes sure there is a preamble suited to the given files. Include
+    // blocks are counted across calls, so files checked one at a time (e.g.
+    // by the server) get a preamble once their block has been seen twice.
+    // The most common block is used, and a preamble that is already built is
+    // kept if it suits at least as many of the files or was needed as often.
+    void PrepareForFiles(
+            const clang::tooling::CompilationDatabase& Compilations,
+            const std::vector<std::string>& FilePaths,
+            const std::vector<llvm::StringRef>& FileContents);
+
+    // Returns an adjuster which makes the files that start with the
+    // preamble's headers use it. Other files are left alone.
+    clang::tooling::ArgumentsAdjuster GetArgumentsAdjuster(void);
+
+    // Returns the number of files prepared which could use the preamble.
+    unsigned GetHitCount(void);
+
+    // Returns the number of files prepared which had to be parsed in full.
+    unsigned GetMissCount(void);
+
+    private:
+    // Builds the preamble for the given headers. Returns false if it
+    // could not be built.
+    bool BuildPreamble(const clang::tooling::CompilationDatabase& Compilations,
+            const std::vector<std::string>& Includes);
+
+    // Removes the files of the current preamble, if there is one.
+    void RemovePreamble(void);
+
+    std::vector<std::string> PreambleIncludes;
+    std::string PreambleDirectory;
+    std::string HeaderPath;
+    std::string PCHPath;
+    std::set<std::vector<std::string>> FailedIncludes;
+    std::map<std::vector<std::string>, unsigned> BlockCounts;
+    std::set<std::string> MatchingFiles;
+    unsigned HitCount;
+    unsigned MissCount;
+};
+
+}  // namespace nett
+
+#endif
@@ -0,0 +1,227 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#include "ResultCache.hpp"
+
+#include "../input/FileStore.hpp"
+#include "../stats/Counters.hpp"
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace nett {
+
+// Changed whenever the layout of the entries changes, so that entries
+// written by older builds are never read
+#define CACHE_FORMAT_VERSION "2"
+
+// Returns the hex MD5 of the given content.
+static std::string HashContent(llvm::StringRef Content) {
+
+    llvm::MD5 Hash;
+    Hash.update(Content);
+    llvm::MD5::MD5Result Result;
+    Hash.final(Result);
+    return Result.digest().str().str();
+}
+
+// Returns the hash of the given file as clang would read it: the sanitized
+// content for the input files, and what is on disk for the rest. A file
+// which can't be read gets an empty hash.
+static std::string HashFile(llvm::StringRef FilePath) {
+
+    if (input::GlobalFileStore->HasFile(FilePath)) {
+        return HashContent(input::GlobalFileStore->GetContent(FilePath));
+    }
+
+    auto Buffer = llvm::MemoryBuffer::getFile(FilePath);
+    if (!Buffer) {
+        return std::string();
+    }
+    return HashContent((*Buffer)->getBuffer());
+}
+
+ResultCache::ResultCache(std::string Directory, llvm::StringRef BuildID,
+        llvm::StringRef Options)
+    : Directory(std::move(Directory)) {
+
+    Salt = CACHE_FORMAT_VERSION;
+    Salt += '\0';
+    Salt += BuildID;
+    Salt += '\0';
+    Salt += Options;
+    Salt += '\0';
+}
+
+std::string ResultCache::GetDefaultDirectory(void) {
+
+    llvm::SmallString<256> Path;
+    if (auto CacheHome = llvm::sys::Process::GetEnv("XDG_CACHE_HOME")) {
+        Path = *CacheHome;
+    }
+    if (Path.empty() || llvm::sys::path::is_relative(Path)) {
+        // The spec says relative paths are to be ignored
+        Path.clear();
+        if (!llvm::sys::path::home_directory(Path)) {
+            return std::string();
+        }
+        llvm::sys::path::append(Path, ".cache");
+    }
+    llvm::sys::path::append(Path, "nett");
+    return Path.str().str();
+}
+
+std::string ResultCache::GetBuildID(const char* Argv0, void* MainAddr) {
+
+    auto Executable = llvm::sys::fs::getMainExecutable(Argv0, MainAddr);
+    llvm::sys::fs::file_status Status;
+    if (Executable.empty() || llvm::sys::fs::status(Executable, Status)) {
+        return std::string();
+    }
+
+    return Executable + ":" + std::to_string(Status.getSize()) + ":" +
+           std::to_string(
+                   Status.getLastModificationTime().time_since_epoch().count());
+}
+
+std::string ResultCache::GetKey(llvm::StringRef FilePath,
+        llvm::ArrayRef<std::string> CommandLine) const {
+
+    // The strings are all separated by nul characters, so that no two sets
+    // of strings hash the same bytes
+    llvm::MD5 Hash;
+    Hash.update(ResultCache::Salt);
+    for (const auto& Arg : CommandLine) {
+        Hash.update(Arg);
+        Hash.update(llvm::StringRef("\0", 1));
+    }
+    Hash.update(FilePath);
+    Hash.update(llvm::StringRef("\0", 1));
+    Hash.update(input::GlobalFileStore->GetContent(FilePath));
+
+    llvm::MD5::MD5Result Result;
+    Hash.final(Result);
+    return Result.digest().str().str();
+}
+
+std::string ResultCache::GetEntryPath(llvm::StringRef Key) const {
+
+    // The entries are spread over subdirectories by the start of their key,
+    // like git's objects, to keep the directories small
+    llvm::SmallString<256> Path(ResultCache::Directory);
+    llvm::sys::path::append(Path, Key.take_front(2), Key.drop_front(2));
+    return Path.str().str();
+}
+
+llvm::Optional<CheckResults> ResultCache::Load(llvm::StringRef FilePath,
+        llvm::ArrayRef<std::string> CommandLine) {
+
+    auto Miss = [](void) -> llvm::Optional<CheckResults> {
+        stats::IncrementCounter(stats::COUNTER_CACHE_MISSES);
+        return llvm::None;
+    };
+
+    auto Buffer = llvm::MemoryBuffer::getFile(
+            GetEntryPath(GetKey(FilePath, CommandLine)));
+    if (!Buffer) {
+        return Miss();
+    }
+
+    // Entries which can't be read (e.g. one cut short by a full disk) are
+    // treated as missing, and replaced once the file has been checked.
+    auto Entry = llvm::json::parse((*Buffer)->getBuffer());
+    if (!Entry) {
+        llvm::consumeError(Entry.takeError());
+        return Miss();
+    }
+    const auto* Fields = Entry->getAsObject();
+    if (!Fields) {
+        return Miss();
+    }
+    const auto* Dependencies = Fields->getArray("dependencies");
+    const auto* Violations = Fields->get("violations");
+    const auto* Comments = Fields->get("comments");
+    const auto* Contents = Fields->get("contents");
+    const auto* Pointers = Fields->get("pointers");
+    if (!Dependencies || !Violations || !Comments || !Contents ||
+            !Pointers) {
+        return Miss();
+    }
+
+    for (const auto& Item : *Dependencies) {
+        const auto* Dependency = Item.getAsArray();
+        if (!Dependency || Dependency->size() != 2) {
+            return Miss();
+        }
+        auto Path = (*Dependency)[0].getAsString();
+        auto Hash = (*Dependency)[1].getAsString();
+        if (!Path || !Hash || HashFile(*Path) != *Hash) {
+            return Miss();
+        }
+    }
+
+    CheckResults Results;
+    if (!Results.Violations.FromJSON(*Violations) ||
+            !Results.FunctionComments.FromJSON(*Comments) ||
+            !Results.FileContents.FromJSON(*Contents) ||
+            !Results.PointerStyles.FromJSON(*Pointers)) {
+        return Miss();
+    }
+
+    stats::IncrementCounter(stats::COUNTER_CACHE_HITS);
+    return std::move(Results);
+}
+
+void ResultCache::Store(llvm::StringRef FilePath,
+        llvm::ArrayRef<std::string> CommandLine, const CheckResults& Results,
+        llvm::ArrayRef<std::string> Dependencies) {
+
+    llvm::json::Array DependencyHashes;
+    for (const auto& Dependency : Dependencies) {
+        DependencyHashes.push_back(
+                llvm::json::Array{Dependency, HashFile(Dependency)});
+    }
+
+    llvm::json::Object Entry{{"dependencies", std::move(DependencyHashes)},
+            {"violations", Results.Violations.ToJSON()},
+            {"comments", Results.FunctionComments.ToJSON()},
+            {"contents", Results.FileContents.ToJSON()},
+            {"pointers", Results.PointerStyles.ToJSON()}};
+
+    // The entry is written under a temporary name and then renamed, so
+    // that other runs never see half of an entry. A cache which can't be
+    // written to just means the file is checked again next time.
+    auto EntryPath = GetEntryPath(GetKey(FilePath, CommandLine));
+    if (llvm::sys::fs::create_directories(
+                llvm::sys::path::parent_path(EntryPath))) {
+        return;
+    }
+
+    int FD;
+    llvm::SmallString<256> TempPath;
+    if (llvm::sys::fs::createUniqueFile(
+                EntryPath + "-%%%%%%%%.tmp", FD, TempPath)) {
+        return;
+    }
+    {
+        llvm::raw_fd_ostream OS(FD, true);
+        OS << llvm::json::Value(std::move(Entry));
+        OS.close();
+        if (OS.has_error()) {
+            OS.clear_error();
+            llvm::sys::fs::remove(TempPath);
+            return;
+        }
+    }
+    if (llvm::sys::fs::rename(TempPath, EntryPath)) {
+        llvm::sys::fs::remove(TempPath);
+    }
+}
+
+}  // namespace nett
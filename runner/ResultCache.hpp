@@ -0,0 +1,70 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#ifndef LLVM_CLANG_TOOLS_EXTRA_NETT_RUNNER_RESULTCACHE_HPP
+#define LLVM_CLANG_TOOLS_EXTRA_NETT_RUNNER_RESULTCACHE_HPP
+
+#include "CheckResults.hpp"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <string>
+#include <vector>
+
+namespace nett {
+
+// Keeps the results of checking each file on disk, so that a file which
+// hasn't changed since it was last checked isn't parsed again. An entry is
+// found by hashing the file's sanitized content and path, how it is
+// compiled, the nett build and the options which change the results. Each
+// entry lists the other files (e.g. local headers) read while checking,
+// and is only used if none of them have changed either.
+//
+// The results stored are those of the file's own tool, before they are
+// merged with any other file's, so the cross-file checks (e.g. function
+// comments) are still worked out afresh on every run.
+class ResultCache {
+    public:
+    // Uses the cache in the given directory, which is created once the
+    // first entry is stored. Entries made by another build or with other
+    // options are never used.
+    ResultCache(std::string Directory, llvm::StringRef BuildID,
+            llvm::StringRef Options);
+
+    // Returns $XDG_CACHE_HOME/nett, or ~/.cache/nett if that isn't set.
+    static std::string GetDefaultDirectory(void);
+
+    // Returns an id for the build of the running executable, made from its
+    // path, size and modification time.
+    static std::string GetBuildID(const char* Argv0, void* MainAddr);
+
+    // Returns the stored results of checking the given file (which must be
+    // in the GlobalFileStore) with the given command line, if there are any
+    // and none of the files read for them have changed.
+    llvm::Optional<CheckResults> Load(llvm::StringRef FilePath,
+            llvm::ArrayRef<std::string> CommandLine);
+
+    // Stores the results of checking the given file with the given command
+    // line, along with the other files which were read to get them.
+    void Store(llvm::StringRef FilePath,
+            llvm::ArrayRef<std::string> CommandLine,
+            const CheckResults& Results,
+            llvm::ArrayRef<std::string> Dependencies);
+
+    private:
+    // Returns the name of the entry for the given file and command line.
+    std::string GetKey(llvm::StringRef FilePath,
+            llvm::ArrayRef<std::string> CommandLine) const;
+
+    // Returns the path of the entry with the given key.
+    std::string GetEntryPath(llvm::StringRef Key) const;
+
+    std::string Directory;
+    std::string Salt;
+};
+
+}  // namespace nett
+
+#endif
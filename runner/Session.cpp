@@ -0,0 +1,35 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#include "Session.hpp"
+
+namespace nett {
+
+static thread_local CheckSession* CurrentSession = nullptr;
+
+SessionScope::SessionScope(CheckSession& Session)
+    : Files(input::GlobalFileStore),
+      Indexes(input::GlobalSourceIndexManager),
+      Lines(input::GlobalLineFilter), Strings(GlobalStringPool),
+      Previous(CurrentSession) {
+
+    input::GlobalFileStore = &Session.Files;
+    input::GlobalSourceIndexManager = &Session.Indexes;
+    input::GlobalLineFilter = &Session.Lines;
+    GlobalStringPool = &Session.Strings;
+    CurrentSession = &Session;
+}
+
+SessionScope::~SessionScope() {
+    input::GlobalFileStore = Files;
+    input::GlobalSourceIndexManager = Indexes;
+    input::GlobalLineFilter = Lines;
+    GlobalStringPool = Strings;
+    CurrentSession = Previous;
+}
+
+CheckSession* GetCurrentSession(void) {
+    return CurrentSession;
+}
+
+}  // namespace nett
@@ -0,0 +1,49 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#ifndef LLVM_CLANG_TOOLS_EXTRA_NETT_RUNNER_SESSION_HPP
+#define LLVM_CLANG_TOOLS_EXTRA_NETT_RUNNER_SESSION_HPP
+
+#include "../input/FileStore.hpp"
+#include "../input/LineFilter.hpp"
+#include "../input/SourceIndex.hpp"
+#include "../violations/StringPool.hpp"
+
+namespace nett {
+
+// The state shared by every thread checking the same set of files: their
+// content, their indexes, the lines being checked and the strings pooled
+// for their violations. Sessions are independent of each other, so files
+// can be checked in several sessions at once.
+struct CheckSession {
+    input::FileStore Files;
+    input::SourceIndexManager Indexes;
+    input::LineFilter Lines;
+    StringPool Strings;
+};
+
+// Makes the given session the one used by the current thread until the
+// scope ends, when the session used before it is put back.
+class SessionScope {
+    public:
+    explicit SessionScope(CheckSession& Session);
+    ~SessionScope();
+
+    SessionScope(const SessionScope&) = delete;
+    SessionScope& operator=(const SessionScope&) = delete;
+
+    private:
+    input::FileStore* Files;
+    input::SourceIndexManager* Indexes;
+    input::LineFilter* Lines;
+    StringPool* Strings;
+    CheckSession* Previous;
+};
+
+// Returns the session used by the current thread, or nullptr if there
+// isn't one. Worker threads use this to join their caller's session.
+CheckSession* GetCurrentSession(void);
+
+}  // namespace nett
+
+#endif
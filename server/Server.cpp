@@ -0,0 +1,405 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#include "Server.hpp"
+
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace nett {
+namespace server {
+
+// The first line of every request, used to catch stray connections. It is
+// followed by the length of the rest of the request on its own line.
+#define PROTOCOL_HEADER "NETT 2\n"
+
+// The first line of every response, saying whether the request succeeded
+#define RESPONSE_SUCCEEDED "OK\n"
+#define RESPONSE_FAILED "FAILED\n"
+#define MAX_PENDING_CONNECTIONS 16
+
+// How long a client has to send its whole request, and the largest request
+// the server accepts. Clients that are slower or send more are dropped, so
+// they can't hold up the clients waiting behind them.
+#define REQUEST_TIMEOUT_MS 10000
+#define MAX_REQUEST_BYTES (1ULL << 30)
+
+// Set once the server has been asked to stop
+static volatile sig_atomic_t StopRequested = 0;
+
+// Signal handler used to stop the server.
+static void RequestStop(int Signal) {
+    StopRequested = 1;
+}
+
+// The upper end of the first latency bucket, and how much wider each
+// bucket is than the one before it
+#define LATENCY_FIRST_BUCKET_MS 0.1
+#define LATENCY_BUCKET_GROWTH 1.05
+
+LatencyTracker::LatencyTracker() : SampleCount(0), MaxSample(0) {
+    Counts.fill(0);
+}
+
+size_t LatencyTracker::GetBucket(double Milliseconds) {
+
+    if (Milliseconds <= LATENCY_FIRST_BUCKET_MS) {
+        return 0;
+    }
+    auto Bucket = static_cast<size_t>(
+            std::ceil(std::log(Milliseconds / LATENCY_FIRST_BUCKET_MS) /
+                    std::log(LATENCY_BUCKET_GROWTH)));
+    return std::min<size_t>(Bucket, LATENCY_BUCKETS - 1);
+}
+
+void LatencyTracker::AddSample(double Milliseconds) {
+    Counts[GetBucket(Milliseconds)]++;
+    SampleCount++;
+    MaxSample = std::max(MaxSample, Milliseconds);
+}
+
+double LatencyTracker::GetPercentile(double Percentile) const {
+
+    if (SampleCount == 0) {
+        return 0;
+    }
+
+    // We use the nearest rank, and report the upper end of its bucket
+    auto Rank = static_cast<uint64_t>(
+            std::ceil(Percentile / 100.0 * SampleCount));
+    Rank = std::max<uint64_t>(Rank, 1);
+
+    uint64_t Seen = 0;
+    for (size_t Bucket = 0; Bucket < LATENCY_BUCKETS; Bucket++) {
+        Seen += Counts[Bucket];
+        if (Seen >= Rank) {
+            auto UpperBound = LATENCY_FIRST_BUCKET_MS *
+                    std::pow(LATENCY_BUCKET_GROWTH, Bucket);
+            return std::min(UpperBound, MaxSample);
+        }
+    }
+    return MaxSample;
+}
+
+// Fills in the address of the socket at the given path.
+// Returns false if the path is too long to be a socket address.
+static bool GetSocketAddress(std::string SocketPath, sockaddr_un& Address) {
+
+    std::memset(&Address, 0, sizeof(Address));
+    Address.sun_family = AF_UNIX;
+
+    if (SocketPath.size() >= sizeof(Address.sun_path)) {
+        return false;
+    }
+    std::strcpy(Address.sun_path, SocketPath.c_str());
+    return true;
+}
+
+// Reads whatever is available from the given socket, waiting until the
+// given deadline at most. Returns the number of bytes read, 0 if the other
+// end stopped writing, or -1 if the read fails or times out.
+static ssize_t ReadUntil(int Socket, char* Buffer, size_t Size,
+        std::chrono::steady_clock::time_point Deadline) {
+
+    while (true) {
+        auto Remaining = std::chrono::duration_cast<std::chrono::microseconds>(
+                Deadline - std::chrono::steady_clock::now());
+        if (Remaining.count() <= 0) {
+            return -1;
+        }
+        timeval Timeout;
+        Timeout.tv_sec = Remaining.count() / 1000000;
+        Timeout.tv_usec = Remaining.count() % 1000000;
+        if (setsockopt(Socket, SOL_SOCKET, SO_RCVTIMEO, &Timeout,
+                    sizeof(Timeout)) < 0) {
+            return -1;
+        }
+
+        auto BytesRead = read(Socket, Buffer, Size);
+        if (BytesRead < 0 && errno == EINTR) {
+            continue;
+        }
+        return BytesRead;
+    }
+}
+
+// Reads a request from the given socket into Data, without its header and
+// length. Returns false if the request is malformed, larger than
+// MAX_REQUEST_BYTES or not sent within REQUEST_TIMEOUT_MS.
+static bool ReadRequest(int Socket, std::string& Data) {
+
+    auto Deadline = std::chrono::steady_clock::now() +
+                    std::chrono::milliseconds(REQUEST_TIMEOUT_MS);
+    char Buffer[4096];
+    std::string Received;
+    llvm::Optional<uint64_t> Length;
+
+    while (!Length || Received.size() < *Length) {
+        auto BytesRead = ReadUntil(Socket, Buffer, sizeof(Buffer), Deadline);
+        if (BytesRead <= 0) {
+            return false;
+        }
+        Received.append(Buffer, BytesRead);
+
+        // The header and length come first, each on their own line
+        if (!Length) {
+            llvm::StringRef Header(Received);
+            auto LengthEnd = Header.find('\n', sizeof(PROTOCOL_HEADER) - 1);
+            if (LengthEnd == llvm::StringRef::npos) {
+                if (Received.size() > sizeof(PROTOCOL_HEADER) + 20) {
+                    return false;
+                }
+                continue;
+            }
+
+            uint64_t RequestLength;
+            if (!Header.consume_front(PROTOCOL_HEADER) ||
+                    Header.consumeInteger(10, RequestLength) ||
+                    !Header.consume_front("\n") ||
+                    RequestLength > MAX_REQUEST_BYTES) {
+                return false;
+            }
+            Length = RequestLength;
+            Received = Header.str();
+        }
+    }
+
+    Data = std::move(Received);
+    return Data.size() == *Length;
+}
+
+// Reads from the given socket until the other end stops writing.
+// Returns false if the read fails.
+static bool ReadAll(int Socket, std::string& Data) {
+
+    char Buffer[4096];
+
+    while (true) {
+        auto BytesRead = read(Socket, Buffer, sizeof(Buffer));
+
+        if (BytesRead == 0) {
+            return true;
+        } else if (BytesRead < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        Data.append(Buffer, BytesRead);
+    }
+}
+
+// Writes all of the given data to the given socket.
+// Returns false if the write fails.
+static bool WriteAll(int Socket, llvm::StringRef Data) {
+
+    while (!Data.empty()) {
+        auto BytesWritten = write(Socket, Data.data(), Data.size());
+
+        if (BytesWritten < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        Data = Data.drop_front(BytesWritten);
+    }
+    return true;
+}
+
+// Converts the given request into the form sent over the socket.
+// Each file is sent as a 'FILE <path length> <content length>' line
+// followed by its path and content. A content length of -1 means
+// that the server should read the file from disk. The files are preceded
+// by the protocol header and their length.
+static std::string SerializeRequest(const CheckRequest& Request) {
+
+    std::string Data;
+
+    for (const auto& File : Request.Files) {
+        Data += "FILE " + std::to_string(File.FilePath.size()) + " ";
+        if (File.Content) {
+            Data += std::to_string(File.Content->size()) + "\n";
+        } else {
+            Data += "-1\n";
+        }
+        Data += File.FilePath;
+        if (File.Content) {
+            Data += *File.Content;
+        }
+    }
+
+    return PROTOCOL_HEADER + std::to_string(Data.size()) + "\n" + Data;
+}
+
+// Parses the files of a request received over the socket.
+// Returns false if the request is malformed.
+static bool ParseRequest(llvm::StringRef Data, CheckRequest& Request) {
+
+    while (!Data.empty()) {
+        size_t PathLength;
+        long long ContentLength;
+
+        if (!Data.consume_front("FILE ") ||
+                Data.consumeInteger(10, PathLength) ||
+                !Data.consume_front(" ") ||
+                Data.consumeInteger(10, ContentLength) ||
+                !Data.consume_front("\n") || Data.size() < PathLength) {
+            return false;
+        }
+
+        RequestFile File;
+        File.FilePath = Data.take_front(PathLength).str();
+        Data = Data.drop_front(PathLength);
+
+        if (ContentLength >= 0) {
+            if (Data.size() < static_cast<size_t>(ContentLength)) {
+                return false;
+            }
+            File.Content = Data.take_front(ContentLength).str();
+            Data = Data.drop_front(ContentLength);
+        }
+        Request.Files.push_back(File);
+    }
+
+    return true;
+}
+
+bool RunServer(std::string SocketPath, RequestHandler Handler) {
+
+    sockaddr_un Address;
+    if (!GetSocketAddress(SocketPath, Address)) {
+        return false;
+    }
+
+    // A socket left behind by a previous server can be replaced, but
+    // we never remove anything else.
+    llvm::sys::fs::file_status Status;
+    if (!llvm::sys::fs::status(SocketPath, Status) &&
+            Status.type() == llvm::sys::fs::file_type::socket_file) {
+        unlink(SocketPath.c_str());
+    }
+
+    int Listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (Listener < 0) {
+        return false;
+    }
+    if (bind(Listener, reinterpret_cast<sockaddr*>(&Address),
+                sizeof(Address)) < 0 ||
+            listen(Listener, MAX_PENDING_CONNECTIONS) < 0) {
+        close(Listener);
+        return false;
+    }
+
+    // Interrupting the server should stop it cleanly, so we make sure
+    // that waiting for a connection is not restarted after a signal.
+    struct sigaction StopAction;
+    std::memset(&StopAction, 0, sizeof(StopAction));
+    StopAction.sa_handler = RequestStop;
+    sigaction(SIGINT, &StopAction, nullptr);
+    sigaction(SIGTERM, &StopAction, nullptr);
+
+    // Clients that go away early shouldn't take the server with them
+    signal(SIGPIPE, SIG_IGN);
+
+    llvm::errs() << "Listening on " << SocketPath << "\n";
+    LatencyTracker Latencies;
+
+    while (!StopRequested) {
+        int Client = accept(Listener, nullptr, nullptr);
+
+        if (Client < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        auto StartTime = std::chrono::steady_clock::now();
+        std::string Data;
+        CheckRequest Request;
+        CheckResponse Response;
+
+        if (ReadRequest(Client, Data) && ParseRequest(Data, Request)) {
+            Response = Handler(Request);
+        } else {
+            Response = {false, "Error: Malformed request\n"};
+        }
+        WriteAll(Client, Response.Succeeded ? RESPONSE_SUCCEEDED
+                                            : RESPONSE_FAILED);
+        WriteAll(Client, Response.Output);
+        close(Client);
+
+        std::chrono::duration<double, std::milli> Elapsed =
+                std::chrono::steady_clock::now() - StartTime;
+        Latencies.AddSample(Elapsed.count());
+
+        llvm::errs() << "Request " << Latencies.GetSampleCount() << ": "
+                     << Request.Files.size() << " file(s) in "
+                     << llvm::format("%.1f", Elapsed.count()) << " ms (p50 "
+                     << llvm::format("%.1f", Latencies.GetPercentile(50))
+                     << " ms, p99 "
+                     << llvm::format("%.1f", Latencies.GetPercentile(99))
+                     << " ms)\n";
+    }
+
+    close(Listener);
+    unlink(SocketPath.c_str());
+    llvm::errs() << "Served " << Latencies.GetSampleCount() << " request(s)\n";
+
+    return true;
+}
+
+bool SendRequest(std::string SocketPath, const CheckRequest& Request,
+        CheckResponse& Response) {
+
+    sockaddr_un Address;
+    if (!GetSocketAddress(SocketPath, Address)) {
+        return false;
+    }
+
+    int Server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (Server < 0) {
+        return false;
+    }
+    if (connect(Server, reinterpret_cast<sockaddr*>(&Address),
+                sizeof(Address)) < 0) {
+        close(Server);
+        return false;
+    }
+
+    // The server closes its end once it has sent the response
+    std::string Data;
+    bool Sent = WriteAll(Server, SerializeRequest(Request)) &&
+                ReadAll(Server, Data);
+    close(Server);
+
+    llvm::StringRef Reply(Data);
+    if (!Sent) {
+        return false;
+    } else if (Reply.consume_front(RESPONSE_SUCCEEDED)) {
+        Response.Succeeded = true;
+    } else if (Reply.consume_front(RESPONSE_FAILED)) {
+        Response.Succeeded = false;
+    } else {
+        return false;
+    }
+    Response.Output = Reply.str();
+    return true;
+}
+
+}  // namespace server
+}  // namespace nett
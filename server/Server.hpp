@@ -0,0 +1,89 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#ifndef LLVM_CLANG_TOOLS_EXTRA_NETT_SERVER_SERVER_HPP
+#define LLVM_CLANG_TOOLS_EXTRA_NETT_SERVER_SERVER_HPP
+
+#include "llvm/ADT/Optional.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace nett {
+namespace server {
+
+// The number of buckets request times are counted in, which covers times
+// of up to several hours (see LatencyTracker)
+#define LATENCY_BUCKETS 400
+
+// A file to be checked by the server. If no content is given, the server
+// reads the file from disk.
+struct RequestFile {
+    std::string FilePath;
+    llvm::Optional<std::string> Content;
+};
+
+// A request to check a set of files
+struct CheckRequest {
+    std::vector<RequestFile> Files;
+};
+
+// The server's reply to a request. Output holds either the violations found
+// or, if the request failed, the error.
+struct CheckResponse {
+    bool Succeeded;
+    std::string Output;
+};
+
+// Handles a single request, returning the response to send to the client.
+using RequestHandler = std::function<CheckResponse(const CheckRequest&)>;
+
+// Keeps track of how long requests take to be served. The times are
+// counted in a fixed set of buckets, each 5% wider than the last, so a
+// long-running server uses the same memory (and time) for every request.
+class LatencyTracker {
+    public:
+    LatencyTracker();
+
+    // Records the time taken (in milliseconds) to serve a request.
+    void AddSample(double Milliseconds);
+
+    // Returns the given percentile (0-100) of the recorded request times.
+    // This is the upper end of the bucket it falls in, so it is at most
+    // 5% more than the recorded time.
+    double GetPercentile(double Percentile) const;
+
+    // Returns the number of requests recorded.
+    size_t GetSampleCount(void) const {
+        return SampleCount;
+    }
+
+    private:
+    // Returns the bucket holding the given time.
+    static size_t GetBucket(double Milliseconds);
+
+    std::array<uint64_t, LATENCY_BUCKETS> Counts;
+    size_t SampleCount;
+    double MaxSample;
+};
+
+// Listens for requests on a Unix socket at the given path, passing each
+// one to the handler, until the process is interrupted. Requests are
+// served one at a time, and a client that doesn't send its whole request
+// in time is dropped. Returns false if the socket could not be set up.
+bool RunServer(std::string SocketPath, RequestHandler Handler);
+
+// Sends the given request to the server listening at the given socket path
+// and fills in its response.
+// Returns false if the server could not be reached, or didn't reply.
+bool SendRequest(std::string SocketPath, const CheckRequest& Request,
+        CheckResponse& Response);
+
+}  // namespace server
+}  // namespace nett
+
+#endif
@@ -0,0 +1,39 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#include "Counters.hpp"
+
+#include "llvm/Support/ErrorHandling.h"
+
+#include <cstdlib>
+#include <new>
+
+// Every allocation made with new (by nett or by clang) goes through here,
+// so that --counters can show how much the checks allocate. Without
+// --counters this costs a single check of a flag, and with it each thread
+// only adds to its own count. The array and nothrow forms of new and the
+// sized forms of delete all end up in these two by default.
+
+void* operator new(std::size_t Size) {
+
+    nett::stats::IncrementCounter(nett::stats::COUNTER_ALLOCATIONS);
+    if (Size == 0) {
+        Size = 1;
+    }
+
+    while (true) {
+        if (void* Memory = std::malloc(Size)) {
+            return Memory;
+        }
+        auto Handler = std::get_new_handler();
+        if (!Handler) {
+            // nett is built without exceptions, the same as clang
+            llvm::report_bad_alloc_error("Allocation failed");
+        }
+        Handler();
+    }
+}
+
+void operator delete(void* Memory) noexcept {
+    std::free(Memory);
+}
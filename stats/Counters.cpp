@@ -0,0 +1,67 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#include "Counters.hpp"
+
+#include <sys/resource.h>
+
+namespace nett {
+namespace stats {
+
+bool CountersEnabled = false;
+thread_local uint64_t ThreadCounters[COUNTER_COUNT];
+
+// The counts published by every thread
+static std::atomic<uint64_t> Counters[COUNTER_COUNT];
+
+static const char* CounterNames[] = {
+        "parent stack lookups", // COUNTER_PARENT_STACK_LOOKUPS
+        "heap allocations",     // COUNTER_ALLOCATIONS
+        "result cache hits",    // COUNTER_CACHE_HITS
+        "result cache misses"   // COUNTER_CACHE_MISSES
+};
+
+void EnableCounters(void) {
+    CountersEnabled = true;
+}
+
+void PublishThreadCounters(void) {
+
+    if (!CountersEnabled) {
+        return;
+    }
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        if (ThreadCounters[i] != 0) {
+            Counters[i].fetch_add(ThreadCounters[i], std::memory_order_relaxed);
+            ThreadCounters[i] = 0;
+        }
+    }
+}
+
+uint64_t GetCounter(enum Counter Counter) {
+    return Counters[Counter].load(std::memory_order_relaxed);
+}
+
+uint64_t GetPeakResidentMemory(void) {
+
+    struct rusage Usage;
+    if (getrusage(RUSAGE_SELF, &Usage) != 0) {
+        return 0;
+    }
+    return Usage.ru_maxrss;
+}
+
+void PrintCounters(llvm::raw_ostream& OS) {
+
+    // The worker threads have published their counts by now
+    PublishThreadCounters();
+
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        auto Counter = static_cast<enum Counter>(i);
+        OS << CounterNames[i] << ": " << GetCounter(Counter) << "\n";
+    }
+    OS << "peak resident memory: " << GetPeakResidentMemory() << " KiB\n";
+}
+
+}  // namespace stats
+}  // namespace nett
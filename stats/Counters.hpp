@@ -0,0 +1,81 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#ifndef LLVM_CLANG_TOOLS_EXTRA_NETT_STATS_COUNTERS_HPP
+#define LLVM_CLANG_TOOLS_EXTRA_NETT_STATS_COUNTERS_HPP
+
+#include "llvm/Support/raw_ostream.h"
+
+#include <atomic>
+#include <cstdint>
+
+namespace nett {
+namespace stats {
+
+// The events counted while checking files. These show how much work the
+// checks are doing (e.g. how often they look up a node's parents).
+enum Counter {
+    COUNTER_PARENT_STACK_LOOKUPS,
+    COUNTER_ALLOCATIONS,
+    COUNTER_CACHE_HITS,
+    COUNTER_CACHE_MISSES,
+    COUNTER_COUNT
+};
+
+// Whether the events are being counted (with --counters). This is only set
+// before any worker threads start.
+extern bool CountersEnabled;
+
+// The events counted by the current thread which haven't been added to the
+// totals yet. Each thread counts on its own so that counting (e.g. every
+// allocation) doesn't make the threads contend with one another.
+extern thread_local uint64_t ThreadCounters[COUNTER_COUNT];
+
+// Starts counting events. This must be called before any worker threads
+// start.
+void EnableCounters(void);
+
+// Adds the given amount to the given counter.
+inline void AddToCounter(enum Counter Counter, uint64_t Count) {
+    if (CountersEnabled) {
+        ThreadCounters[Counter] += Count;
+    }
+}
+
+// Adds one to the given counter.
+inline void IncrementCounter(enum Counter Counter) {
+    AddToCounter(Counter, 1);
+}
+
+// Adds the current thread's counts to the totals.
+void PublishThreadCounters(void);
+
+// Publishes the current thread's counts when it goes out of scope, e.g. at
+// the end of each file a worker thread checks.
+class ThreadCounterScope {
+    public:
+    ThreadCounterScope() {
+    }
+
+    ~ThreadCounterScope() {
+        PublishThreadCounters();
+    }
+
+    ThreadCounterScope(const ThreadCounterScope&) = delete;
+    ThreadCounterScope& operator=(const ThreadCounterScope&) = delete;
+};
+
+// Returns the total of the given counter, as published so far.
+uint64_t GetCounter(enum Counter Counter);
+
+// Returns the most memory the process has had resident at once, in KiB.
+uint64_t GetPeakResidentMemory(void);
+
+// Writes the value of every counter, and the peak resident memory, to the
+// given stream.
+void PrintCounters(llvm::raw_ostream& OS);
+
+}  // namespace stats
+}  // namespace nett
+
+#endif
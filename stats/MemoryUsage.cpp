@@ -0,0 +1,87 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#include "MemoryUsage.hpp"
+
+#include "Counters.hpp"
+
+#include "llvm/Support/Format.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace nett {
+namespace stats {
+
+MemoryUsage GlobalMemoryUsage;
+
+// Returns the given number of bytes in KiB, rounded up.
+static unsigned long long ToKiB(uint64_t Bytes) {
+    return (Bytes + 1023) / 1024;
+}
+
+void MemoryUsage::RecordFile(
+        llvm::StringRef FilePath, const FileMemory& Memory) {
+
+    std::lock_guard<std::mutex> Lock(Mutex);
+    auto File = Files.find(FilePath);
+    if (File != Files.end()) {
+        if (File->getValue().GetTotal() < Memory.GetTotal()) {
+            File->getValue() = Memory;
+        }
+        return;
+    }
+
+    if (Files.size() >= MAX_RECORDED_FILES) {
+        DroppedFiles++;
+        auto Smallest = std::min_element(Files.begin(), Files.end(),
+                [](const llvm::StringMapEntry<FileMemory>& A,
+                        const llvm::StringMapEntry<FileMemory>& B) {
+                    return A.getValue().GetTotal() < B.getValue().GetTotal();
+                });
+        if (Smallest->getValue().GetTotal() >= Memory.GetTotal()) {
+            return;
+        }
+        Files.erase(Smallest);
+    }
+    Files.insert({FilePath, Memory});
+}
+
+void MemoryUsage::Print(llvm::raw_ostream& OS) {
+
+    std::lock_guard<std::mutex> Lock(Mutex);
+    std::vector<std::pair<llvm::StringRef, const FileMemory*>> Sorted;
+    for (const auto& File : Files) {
+        Sorted.push_back({File.getKey(), &File.getValue()});
+    }
+    std::sort(Sorted.begin(), Sorted.end(),
+            [](const std::pair<llvm::StringRef, const FileMemory*>& A,
+                    const std::pair<llvm::StringRef, const FileMemory*>& B) {
+                if (A.second->GetTotal() != B.second->GetTotal()) {
+                    return A.second->GetTotal() > B.second->GetTotal();
+                }
+                return A.first < B.first;
+            });
+
+    OS << "Memory used by each file (KiB):\n";
+    OS << "        AST   sources sanitized violations  file\n";
+    for (const auto& File : Sorted) {
+        const auto& Memory = *File.second;
+        OS << llvm::format("  %9llu %9llu %9llu %10llu  ", ToKiB(Memory.AST),
+                      ToKiB(Memory.SourceBuffers), ToKiB(Memory.Sanitized),
+                      ToKiB(Memory.Violations))
+           << File.first;
+        if (Memory.OverBudget) {
+            OS << " (over budget)";
+        }
+        OS << "\n";
+    }
+    if (DroppedFiles) {
+        OS << "  (" << DroppedFiles << " smaller record(s) dropped)\n";
+    }
+    OS << "peak resident memory: " << GetPeakResidentMemory() << " KiB\n";
+}
+
+}  // namespace stats
+}  // namespace nett
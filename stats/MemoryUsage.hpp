@@ -0,0 +1,74 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#ifndef LLVM_CLANG_TOOLS_EXTRA_NETT_STATS_MEMORYUSAGE_HPP
+#define LLVM_CLANG_TOOLS_EXTRA_NETT_STATS_MEMORYUSAGE_HPP
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdint>
+#include <mutex>
+
+namespace nett {
+namespace stats {
+
+// The memory used while checking a single file (translation unit), in
+// bytes.
+struct FileMemory {
+    // Allocated by the ASTContext
+    uint64_t AST = 0;
+    // The buffers of the files read by the SourceManager
+    uint64_t SourceBuffers = 0;
+    // The file's sanitized content
+    uint64_t Sanitized = 0;
+    // The file's violations
+    uint64_t Violations = 0;
+    // Whether checking stopped early because the budget was used up
+    bool OverBudget = false;
+
+    uint64_t GetTotal(void) const {
+        return AST + SourceBuffers + Sanitized + Violations;
+    }
+};
+
+// The most files whose memory is kept. Past this, only the largest files
+// are kept, so that a server or corpus run records any number of files in
+// the same memory.
+#define MAX_RECORDED_FILES 1000
+
+// The memory used by each file checked, shared by every thread.
+class MemoryUsage {
+    public:
+    // Turns on recording the memory of each file.
+    void Enable(void) {
+        Enabled = true;
+    }
+
+    bool IsEnabled(void) const {
+        return Enabled;
+    }
+
+    // Records the memory used checking the given file. A file checked more
+    // than once keeps the largest of its records, and a new file replaces
+    // the smallest one kept once MAX_RECORDED_FILES are.
+    void RecordFile(llvm::StringRef FilePath, const FileMemory& Memory);
+
+    // Writes the memory used by each file, largest first, to the given
+    // stream.
+    void Print(llvm::raw_ostream& OS);
+
+    private:
+    bool Enabled = false;
+    std::mutex Mutex;
+    llvm::StringMap<FileMemory> Files;
+    // The number of records which weren't kept, or were replaced
+    size_t DroppedFiles = 0;
+};
+
+extern MemoryUsage GlobalMemoryUsage;
+
+}  // namespace stats
+}  // namespace nett
+
+#endif
@@ -0,0 +1,142 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#include "Profiler.hpp"
+
+#include "llvm/Support/Format.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace nett {
+namespace stats {
+
+// The name shown for work which isn't done for a single file
+#define ALL_FILES_NAME "(all files)"
+// The name shown for the files past MAX_PROFILED_FILES
+#define OTHER_FILES_NAME "(other files)"
+
+CheckProfiler GlobalCheckProfiler;
+
+// A name and the seconds spent on it.
+typedef std::pair<std::string, double> ProfileEntry;
+
+// Sorts the entries from slowest to fastest, breaking ties by name so
+// the order doesn't change from run to run.
+static void SortEntries(std::vector<ProfileEntry>& Entries) {
+
+    std::sort(Entries.begin(), Entries.end(),
+            [](const ProfileEntry& A, const ProfileEntry& B) {
+                if (A.second != B.second) {
+                    return A.second > B.second;
+                }
+                return A.first < B.first;
+            });
+}
+
+// Writes a table of the given entries, each with its share of the total.
+static void PrintTable(llvm::raw_ostream& OS, llvm::StringRef Title,
+        const std::vector<ProfileEntry>& Entries, double Total) {
+
+    OS << Title << ":\n";
+    OS << "    seconds   share  name\n";
+    for (const auto& Entry : Entries) {
+        OS << llvm::format("  %9.4f  %5.1f%%  ", Entry.second,
+                      Total > 0 ? Entry.second * 100 / Total : 0.0)
+           << Entry.first << "\n";
+    }
+}
+
+void CheckProfiler::AddTime(
+        llvm::StringRef Check, llvm::StringRef FilePath, double Seconds) {
+
+    std::lock_guard<std::mutex> Lock(Mutex);
+    auto File = Times.find(FilePath);
+    if (File != Times.end()) {
+        File->getValue()[Check] += Seconds;
+    } else if (Times.size() < MAX_PROFILED_FILES) {
+        Times[FilePath][Check] = Seconds;
+    } else {
+        OtherTimes[Check] += Seconds;
+    }
+}
+
+void CheckProfiler::Print(llvm::raw_ostream& OS) {
+
+    std::lock_guard<std::mutex> Lock(Mutex);
+    llvm::StringMap<double> CheckTimes;
+    std::vector<ProfileEntry> Files;
+    double Total = 0;
+
+    for (const auto& File : Times) {
+        double FileTotal = 0;
+        for (const auto& Check : File.getValue()) {
+            CheckTimes[Check.getKey()] += Check.getValue();
+            FileTotal += Check.getValue();
+        }
+        auto Name = File.getKey().empty() ? ALL_FILES_NAME : File.getKey();
+        Files.push_back({Name.str(), FileTotal});
+        Total += FileTotal;
+    }
+    if (!OtherTimes.empty()) {
+        double OtherTotal = 0;
+        for (const auto& Check : OtherTimes) {
+            CheckTimes[Check.getKey()] += Check.getValue();
+            OtherTotal += Check.getValue();
+        }
+        Files.push_back({OTHER_FILES_NAME, OtherTotal});
+        Total += OtherTotal;
+    }
+
+    std::vector<ProfileEntry> Checks;
+    for (const auto& Check : CheckTimes) {
+        Checks.push_back({Check.getKey().str(), Check.getValue()});
+    }
+    SortEntries(Checks);
+    SortEntries(Files);
+
+    PrintTable(OS, "Time spent in each check", Checks, Total);
+    PrintTable(OS, "Time spent on each file", Files, Total);
+    OS << llvm::format("Total: %.4f seconds\n", Total);
+}
+
+llvm::json::Value CheckProfiler::ToJSON(void) {
+
+    std::lock_guard<std::mutex> Lock(Mutex);
+    std::vector<std::string> FilePaths;
+    for (const auto& File : Times) {
+        FilePaths.push_back(File.getKey().str());
+    }
+    std::sort(FilePaths.begin(), FilePaths.end());
+
+    // Each file is listed with the time of each of its checks, which is
+    // enough to total the checks up across any number of runs.
+    llvm::json::Array Files;
+    for (const auto& FilePath : FilePaths) {
+        llvm::json::Object Checks;
+        for (const auto& Check : Times[FilePath]) {
+            Checks[Check.getKey()] = Check.getValue();
+        }
+
+        llvm::json::Object Entry{{"checks", std::move(Checks)}};
+        if (!FilePath.empty()) {
+            Entry["file"] = FilePath;
+        }
+        Files.push_back(std::move(Entry));
+    }
+
+    // The files past MAX_PROFILED_FILES share an entry
+    if (!OtherTimes.empty()) {
+        llvm::json::Object Checks;
+        for (const auto& Check : OtherTimes) {
+            Checks[Check.getKey()] = Check.getValue();
+        }
+        Files.push_back(llvm::json::Object{
+                {"checks", std::move(Checks)}, {"otherFiles", true}});
+    }
+    return llvm::json::Object{{"files", std::move(Files)}};
+}
+
+}  // namespace stats
+}  // namespace nett
@@ -0,0 +1,107 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#ifndef LLVM_CLANG_TOOLS_EXTRA_NETT_STATS_PROFILER_HPP
+#define LLVM_CLANG_TOOLS_EXTRA_NETT_STATS_PROFILER_HPP
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/TimeProfiler.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <chrono>
+#include <mutex>
+#include <string>
+
+namespace nett {
+namespace stats {
+
+// The most files whose times are kept apart. The times of any files after
+// those are added up together, so that a server or corpus run profiles
+// any number of files in the same memory.
+#define MAX_PROFILED_FILES 1000
+
+// The time spent in each check on each file, shared by every thread. Work
+// which isn't done for a single file (e.g. the checks run once every file
+// has been processed) is recorded under an empty filepath.
+class CheckProfiler {
+    public:
+    // Turns profiling on. This must be done before any checks are run.
+    void Enable(void) {
+        Enabled = true;
+    }
+
+    bool IsEnabled(void) const {
+        return Enabled;
+    }
+
+    // Adds the given wall time, in seconds, to the check on the given file.
+    void AddTime(llvm::StringRef Check, llvm::StringRef FilePath,
+            double Seconds);
+
+    // Writes the time spent in each check, and on each file, to the given
+    // stream. Both tables are sorted from slowest to fastest.
+    void Print(llvm::raw_ostream& OS);
+
+    // Returns the time spent in each check on each file.
+    llvm::json::Value ToJSON(void);
+
+    private:
+    bool Enabled = false;
+    std::mutex Mutex;
+    // The seconds spent in each check, by file
+    llvm::StringMap<llvm::StringMap<double>> Times;
+    // The seconds spent in each check on the files past MAX_PROFILED_FILES
+    llvm::StringMap<double> OtherTimes;
+};
+
+extern CheckProfiler GlobalCheckProfiler;
+
+// Adds the time between its construction and destruction (or Stop) to a
+// check on a file, if profiling is turned on, and to the current thread's
+// time trace as a span, if one is being recorded. The names given must
+// outlive it.
+class ProfileScope {
+    public:
+    ProfileScope(llvm::StringRef Check, llvm::StringRef FilePath = "")
+        : Check(Check), FilePath(FilePath),
+          Active(GlobalCheckProfiler.IsEnabled()),
+          Traced(llvm::timeTraceProfilerEnabled()) {
+        if (Active) {
+            Start = std::chrono::steady_clock::now();
+        }
+        if (Traced) {
+            llvm::timeTraceProfilerBegin(Check, FilePath);
+        }
+    }
+
+    ~ProfileScope() {
+        Stop();
+    }
+
+    // Stops timing before the scope ends.
+    void Stop(void) {
+        if (Active) {
+            std::chrono::duration<double> Elapsed =
+                    std::chrono::steady_clock::now() - Start;
+            GlobalCheckProfiler.AddTime(Check, FilePath, Elapsed.count());
+            Active = false;
+        }
+        if (Traced) {
+            llvm::timeTraceProfilerEnd();
+            Traced = false;
+        }
+    }
+
+    private:
+    llvm::StringRef Check;
+    llvm::StringRef FilePath;
+    bool Active;
+    bool Traced;
+    std::chrono::steady_clock::time_point Start;
+};
+
+}  // namespace stats
+}  // namespace nett
+
+#endif
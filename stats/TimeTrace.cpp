@@ -0,0 +1,62 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#include "TimeTrace.hpp"
+
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/TimeProfiler.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <string>
+
+namespace nett {
+namespace stats {
+
+static bool Enabled = false;
+static unsigned TraceGranularity = 0;
+static std::string TraceProcessName;
+
+void EnableTimeTrace(unsigned Granularity, llvm::StringRef ProcessName) {
+
+    Enabled = true;
+    TraceGranularity = Granularity;
+    TraceProcessName = ProcessName.str();
+    llvm::timeTraceProfilerInitialize(TraceGranularity, TraceProcessName);
+}
+
+bool IsTimeTraceEnabled(void) {
+    return Enabled;
+}
+
+bool WriteTimeTrace(llvm::StringRef FilePath) {
+
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(FilePath, EC, llvm::sys::fs::OF_Text);
+    if (EC) {
+        return false;
+    }
+
+    llvm::timeTraceProfilerWrite(OS);
+    return true;
+}
+
+TimeTraceThread::TimeTraceThread() {
+
+    if (Enabled && !llvm::getTimeTraceProfilerInstance()) {
+        llvm::timeTraceProfilerInitialize(TraceGranularity, TraceProcessName);
+        Started = true;
+    }
+}
+
+TimeTraceThread::~TimeTraceThread() {
+
+    // The pool's threads outlive the run, so each thread's spans are handed
+    // over as soon as it is done with them. A thread which records again
+    // later gets a new profiler, whose spans go under the same thread.
+    if (Started) {
+        llvm::timeTraceProfilerFinishThread();
+    }
+}
+
+}  // namespace stats
+}  // namespace nett
@@ -0,0 +1,42 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#ifndef LLVM_CLANG_TOOLS_EXTRA_NETT_STATS_TIMETRACE_HPP
+#define LLVM_CLANG_TOOLS_EXTRA_NETT_STATS_TIMETRACE_HPP
+
+#include "llvm/ADT/StringRef.h"
+
+namespace nett {
+namespace stats {
+
+// Starts recording a trace of the time spent in each phase of checking
+// (e.g. parsing a file or rendering the output) on the current thread, and
+// on any thread which records a TimeTraceThread from then on. Spans shorter
+// than the given number of microseconds are left out.
+void EnableTimeTrace(unsigned Granularity, llvm::StringRef ProcessName);
+
+bool IsTimeTraceEnabled(void);
+
+// Writes the spans recorded by every thread to the given file, in the
+// Chrome trace event format. Returns false if the file can't be written.
+bool WriteTimeTrace(llvm::StringRef FilePath);
+
+// Records the spans of a worker thread while it is in scope, after which
+// they are handed over to be written. Threads which are already recording
+// (e.g. the main thread) are left alone.
+class TimeTraceThread {
+    public:
+    TimeTraceThread();
+    ~TimeTraceThread();
+
+    TimeTraceThread(const TimeTraceThread&) = delete;
+    TimeTraceThread& operator=(const TimeTraceThread&) = delete;
+
+    private:
+    bool Started = false;
+};
+
+}  // namespace stats
+}  // namespace nett
+
+#endif
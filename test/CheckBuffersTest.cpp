@@ -0,0 +1,106 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+// Drives the in-process interface (see api/NettCore.hpp) the way an editor
+// or grader would: checks buffers that aren't on disk, first one at a time
+// and then from two threads at once, which have to get the same results.
+// Run by testOptionsCheck.py.
+#include "../api/NettCore.hpp"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdlib>
+#include <functional>
+#include <thread>
+
+using namespace nett;
+
+#define CONCURRENT_REPETITIONS 10
+
+// Each buffer has a violation the other doesn't
+static const SourceBuffer FIRST_BUFFER = {"checkBuffersFirst.c",
+        "int BadVariable = 0;\n"
+        "\n"
+        "int main(void) {\n"
+        "    return BadVariable;\n"
+        "}\n"};
+static const SourceBuffer SECOND_BUFFER = {"checkBuffersSecond.c",
+        "void Bad_Function(void) {\n"
+        "}\n"
+        "\n"
+        "int main(void) {\n"
+        "    Bad_Function();\n"
+        "    return 0;\n"
+        "}\n"};
+
+// Reports a failed expectation, returning false.
+static bool Fail(llvm::StringRef Buffer, llvm::StringRef Reason) {
+    llvm::errs() << Buffer << ": " << Reason << "\n";
+    return false;
+}
+
+// Checks that the results are those of the given buffer alone: it is the
+// only file, and its own violation is found but not the other buffer's.
+static bool CheckResults(const CheckBufferResults& Results,
+        const SourceBuffer& Buffer, llvm::StringRef Expected,
+        llvm::StringRef Unexpected) {
+
+    if (Results.Files.size() != 1) {
+        return Fail(Buffer.FilePath, "expected the results of one file");
+    }
+    const auto& File = Results.Files[0];
+    if (!llvm::StringRef(File.FilePath).endswith(Buffer.FilePath)) {
+        return Fail(Buffer.FilePath, "results are for " + File.FilePath);
+    }
+
+    bool Found = false;
+    for (const auto& Viol : File.Violations) {
+        if (llvm::StringRef(Viol.Message).contains(Unexpected)) {
+            return Fail(Buffer.FilePath, "found '" + Viol.Message + "'");
+        }
+        Found |= (Viol.Category == "NAMING" &&
+                  llvm::StringRef(Viol.Message).contains(Expected));
+    }
+    if (!Found) {
+        return Fail(Buffer.FilePath, "missing " + Expected.str());
+    }
+    if (!llvm::StringRef(Results.Output).contains(Expected)) {
+        return Fail(Buffer.FilePath, "output is missing " + Expected.str());
+    }
+    return true;
+}
+
+int main(void) {
+
+    auto FirstResults = CheckBuffers({FIRST_BUFFER});
+    auto SecondResults = CheckBuffers({SECOND_BUFFER});
+    if (!CheckResults(FirstResults, FIRST_BUFFER, "'BadVariable' misnamed",
+                "Bad_Function") ||
+            !CheckResults(SecondResults, SECOND_BUFFER,
+                    "'Bad_Function' misnamed", "BadVariable")) {
+        return EXIT_FAILURE;
+    }
+
+    // Concurrent calls keep their state to themselves, so each thread gets
+    // the same output as checking its buffer on its own
+    bool FirstMatches = true;
+    bool SecondMatches = true;
+    auto Repeat = [](const SourceBuffer& Buffer,
+                          const CheckBufferResults& Expected, bool& Matches) {
+        for (int i = 0; i < CONCURRENT_REPETITIONS && Matches; i++) {
+            if (CheckBuffers({Buffer}).Output != Expected.Output) {
+                Matches = Fail(Buffer.FilePath,
+                        "concurrent results differ from sequential ones");
+            }
+        }
+    };
+    std::thread First(Repeat, std::cref(FIRST_BUFFER), std::cref(FirstResults),
+            std::ref(FirstMatches));
+    std::thread Second(Repeat, std::cref(SECOND_BUFFER),
+            std::cref(SecondResults), std::ref(SecondMatches));
+    First.join();
+    Second.join();
+
+    return (FirstMatches && SecondMatches) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -4,6 +4,7 @@ import os
 
 TEST_PATH = os.path.dirname(os.path.realpath(__file__))
 NETT_PATH = TEST_PATH.split("llvm-project/", 1)[0] + "llvm-project/build/bin/nett"
+NETT_API_TEST_PATH = NETT_PATH + "-api-test"
 
 # Import the test modules
 import testNamingCheck
@@ -15,6 +16,7 @@ import testLineLengthCheck
 import testOverallCheck
 import testWarningCheck
 import testPatchesCheck
+import testOptionsCheck
 
 # Initialize the test suite
 loader = unittest.TestLoader()
@@ -30,6 +32,7 @@ suite.addTests(loader.loadTestsFromModule(testLineLengthCheck))
 suite.addTests(loader.loadTestsFromModule(testOverallCheck))
 suite.addTests(loader.loadTestsFromModule(testWarningCheck))
 suite.addTests(loader.loadTestsFromModule(testPatchesCheck))
+suite.addTests(loader.loadTestsFromModule(testOptionsCheck))
 
 # Initialize a runner, pass it the test suite and run it
 runner = unittest.TextTestRunner(verbosity=3)
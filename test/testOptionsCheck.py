@@ -0,0 +1,361 @@
+""" Copyright (C) 2020  Matthys Grobbelaar 
+    Full license notice can be found in Nett.cpp
+"""
+import glob
+import json
+import os
+import re
+import shutil
+import tempfile
+import time
+import unittest
+import urllib.parse
+import subprocess
+from runner import NETT_API_TEST_PATH
+from runner import NETT_PATH
+from runner import TEST_PATH
+
+class TestOptionsChecks(unittest.TestCase):
+
+    def setUp(self):
+        self.maxDiff = None
+        self.test_files = sorted(
+            glob.glob(TEST_PATH + "/test_files/naming/*.c") +
+            glob.glob(TEST_PATH + "/test_files/comments/*.[ch]") +
+            glob.glob(TEST_PATH + "/test_files/whitespace/*.c"))
+
+    def test_parallel_jobs_check(self):
+        sequential = subprocess.check_output([NETT_PATH] + self.test_files)
+        parallel = subprocess.check_output(
+            [NETT_PATH, "--jobs", "4"] + self.test_files)
+
+        self.assertEqual(sequential.decode("utf-8"), parallel.decode("utf-8"))
+
+    def test_corpus_check(self):
+        submissions = [
+            [TEST_PATH + "/test_files/naming/varNameCheckTest.c",
+                TEST_PATH + "/test_files/naming/funcNameCheckTest.c"],
+            [TEST_PATH + "/test_files/comments/functionCommentCheckTest.c",
+                TEST_PATH + "/test_files/comments/functionCommentCheckTest.h"],
+        ]
+
+        with tempfile.TemporaryDirectory() as corpus:
+            with open(os.path.join(corpus, "manifest.txt"), "w") as manifest:
+                for index, files in enumerate(submissions):
+                    submission = os.path.join(corpus, "s" + str(index))
+                    os.mkdir(submission)
+                    for file in files:
+                        shutil.copy(file, submission)
+                    manifest.write("s" + str(index) + "\n")
+
+            subprocess.check_output(
+                [NETT_PATH, "--corpus", os.path.join(corpus, "manifest.txt")])
+
+            # Each submission's report matches checking it on its own
+            for index in range(len(submissions)):
+                submission = os.path.join(corpus, "s" + str(index))
+                files = sorted(glob.glob(submission + "/*.[ch]"))
+                expected = subprocess.check_output([NETT_PATH] + files)
+
+                with open(os.path.join(submission, "nett.out"), "rb") as report:
+                    self.assertEqual(expected.decode("utf-8"),
+                        report.read().decode("utf-8"))
+
+            # Structured output goes to each submission rather than stdout
+            output = subprocess.check_output([NETT_PATH, "--format=jsonl",
+                "--corpus", os.path.join(corpus, "manifest.txt")])
+            self.assertEqual(b"", output)
+
+            def by_file(jsonl):
+                entries = [json.loads(line) for line in jsonl.splitlines()]
+                return {os.path.realpath(entry["file"]): entry["violations"]
+                    for entry in entries}
+
+            for index in range(len(submissions)):
+                submission = os.path.join(corpus, "s" + str(index))
+                files = sorted(glob.glob(submission + "/*.[ch]"))
+                expected = subprocess.check_output(
+                    [NETT_PATH, "--format=jsonl"] + files)
+
+                with open(os.path.join(submission, "nett.jsonl"), "rb") as report:
+                    self.assertEqual(by_file(expected.decode("utf-8")),
+                        by_file(report.read().decode("utf-8")))
+
+    def test_server_check(self):
+        with tempfile.TemporaryDirectory() as directory:
+            socket_path = os.path.join(directory, "nett.sock")
+            server = subprocess.Popen([NETT_PATH, "--serve", socket_path],
+                stderr=subprocess.DEVNULL)
+
+            try:
+                for _ in range(100):
+                    if os.path.exists(socket_path):
+                        break
+                    time.sleep(0.05)
+
+                expected = subprocess.check_output([NETT_PATH] + self.test_files)
+
+                # Repeated requests shouldn't see each other's state
+                for _ in range(2):
+                    served = subprocess.check_output(
+                        [NETT_PATH, "--connect", socket_path] + self.test_files)
+                    self.assertEqual(expected.decode("utf-8"),
+                        served.decode("utf-8"))
+
+                # A file's content can be sent on stdin instead of from disk
+                test_file = (TEST_PATH +
+                    "/test_files/whitespace/forLoopWhitespaceCheckTest.c")
+                unsaved_file = os.path.join(directory, "unsaved.c")
+                expected = subprocess.check_output([NETT_PATH, test_file])
+                with open(test_file, "rb") as content:
+                    served = subprocess.check_output(
+                        [NETT_PATH, "--connect", socket_path,
+                            "--assume-filename", unsaved_file],
+                        stdin=content)
+                self.assertEqual(
+                    expected.decode("utf-8").replace(test_file, unsaved_file),
+                    served.decode("utf-8"))
+            finally:
+                server.terminate()
+                server.wait()
+
+    def test_check_buffers_api(self):
+        # The driver reports what went wrong on stderr
+        result = subprocess.run([NETT_API_TEST_PATH],
+            stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+        self.assertEqual(result.returncode, 0, result.stderr.decode("utf-8"))
+
+    def test_preamble_check(self):
+        with_preamble = subprocess.check_output([NETT_PATH] + self.test_files)
+        without_preamble = subprocess.check_output(
+            [NETT_PATH, "--preamble=false"] + self.test_files)
+
+        self.assertEqual(without_preamble.decode("utf-8"),
+            with_preamble.decode("utf-8"))
+
+    def test_skip_header_bodies_check(self):
+        expected = subprocess.check_output([NETT_PATH] + self.test_files)
+        skipped = subprocess.check_output(
+            [NETT_PATH, "--skip-header-bodies"] + self.test_files)
+
+        self.assertEqual(expected.decode("utf-8"), skipped.decode("utf-8"))
+
+    def test_cache_check(self):
+        expected = subprocess.check_output([NETT_PATH] + self.test_files)
+
+        with tempfile.TemporaryDirectory() as directory:
+            # The first run fills the cache and the second reads from it
+            for _ in range(2):
+                cached = subprocess.check_output(
+                    [NETT_PATH, "--cache", "--cache-dir", directory] +
+                    self.test_files)
+                self.assertEqual(expected.decode("utf-8"),
+                    cached.decode("utf-8"))
+
+    def test_lines_check(self):
+        test_file = (TEST_PATH +
+            "/test_files/whitespace/binaryOperatorWhitespaceCheckTest.c")
+        full = subprocess.check_output([NETT_PATH, test_file])
+        ranged = subprocess.check_output(
+            [NETT_PATH, "--lines=" + test_file + ":10-30"])
+
+        def violations(output):
+            return [line for line in output.decode("utf-8").splitlines()
+                if re.match(r"Line \d+:", line)]
+
+        # Only violations on the given lines are reported, and those are
+        # the same violations found when checking the whole file
+        expected = [line for line in violations(full)
+            if 10 <= int(re.match(r"Line (\d+):", line).group(1)) <= 30]
+        self.assertEqual(expected, violations(ranged))
+
+    def test_diff_check(self):
+        test_file = (TEST_PATH +
+            "/test_files/whitespace/binaryOperatorWhitespaceCheckTest.c")
+        full = subprocess.check_output([NETT_PATH, test_file])
+        with open(test_file) as source:
+            lines = source.read().splitlines()
+
+        # Line 9 is changed, and a line is removed after line 22, which
+        # counts as a change to line 23
+        diff = "\n".join([
+            "diff --git a/src/check.c b/src/check.c",
+            "--- a/src/check.c",
+            "+++ b/src/check.c",
+            "@@ -8,3 +8,3 @@",
+            " " + lines[7],
+            "-    int removed;",
+            "+" + lines[8],
+            " " + lines[9],
+            "@@ -24,1 +22,0 @@",
+            "-    int removed;",
+            ""])
+
+        with tempfile.TemporaryDirectory() as directory:
+            os.mkdir(os.path.join(directory, "src"))
+            shutil.copy(test_file, os.path.join(directory, "src", "check.c"))
+            ranged = subprocess.run([NETT_PATH, "--diff"], cwd=directory,
+                input=diff.encode("utf-8"), stdout=subprocess.PIPE,
+                check=True).stdout
+
+        def violations(output):
+            return [line for line in output.decode("utf-8").splitlines()
+                if re.match(r"Line \d+:", line)]
+
+        # The files are named by the diff, without the "b/" prefix
+        expected = [line for line in violations(full)
+            if int(re.match(r"Line (\d+):", line).group(1)) in (9, 23)]
+        self.assertTrue(expected)
+        self.assertEqual(expected, violations(ranged))
+
+    def test_structured_output_check(self):
+        text = subprocess.check_output([NETT_PATH] + self.test_files)
+        jsonl = subprocess.check_output(
+            [NETT_PATH, "--format=jsonl"] + self.test_files)
+        sarif = subprocess.check_output(
+            [NETT_PATH, "--format=sarif"] + self.test_files)
+
+        # The terminal output has a line per file, with its path shortened
+        # from the left, followed by the file's violations
+        expected = {}
+        violations = None
+        for line in text.decode("utf-8").splitlines():
+            if line.startswith("Line "):
+                violations.append(line)
+            elif line:
+                path = re.sub(r"\x1b\[[0-9;]*m", "", line).split()[0]
+                path = path[3:] if path.startswith("...") else path
+                matches = [file for file in self.test_files
+                    if os.path.realpath(file).endswith(path)]
+                self.assertEqual(len(matches), 1)
+                violations = expected.setdefault(
+                    os.path.realpath(matches[0]), [])
+
+        # Violations without a category aren't printed in the terminal
+        # output. Each JSON Lines entry is a file and its violations.
+        from_jsonl = {}
+        for line in jsonl.decode("utf-8").splitlines():
+            entry = json.loads(line)
+            from_jsonl[os.path.realpath(entry["file"])] = [
+                "Line %d: [%s] %s" % (violation["line"],
+                    violation["category"], violation["message"])
+                for violation in entry["violations"] if violation["category"]]
+        self.assertEqual(expected, from_jsonl)
+
+        # The SARIF log has a single run, with a result per violation
+        log = json.loads(sarif.decode("utf-8"))
+        self.assertEqual(log["version"], "2.1.0")
+        from_sarif = {file: [] for file in expected}
+        for result in log["runs"][0]["results"]:
+            if not result["ruleId"]:
+                continue
+            location = result["locations"][0]["physicalLocation"]
+            uri = location["artifactLocation"]["uri"]
+            self.assertTrue(uri.startswith("file://"))
+            file = os.path.realpath(urllib.parse.unquote(uri[len("file://"):]))
+            line_no = location.get("region", {}).get("startLine", 0)
+            from_sarif[file].append("Line %d: [%s] %s" % (
+                line_no, result["ruleId"], result["message"]["text"]))
+        self.assertEqual(expected, from_sarif)
+
+    def test_profile_checks(self):
+        expected = subprocess.check_output([NETT_PATH] + self.test_files)
+
+        with tempfile.TemporaryDirectory() as directory:
+            profile_path = os.path.join(directory, "profile.json")
+            result = subprocess.run(
+                [NETT_PATH, "--profile-checks",
+                    "--profile-output=" + profile_path] + self.test_files,
+                stdout=subprocess.PIPE, stderr=subprocess.PIPE, check=True)
+
+            # Profiling doesn't change the violations found
+            self.assertEqual(expected.decode("utf-8"),
+                result.stdout.decode("utf-8"))
+            self.assertIn("Time spent in each check",
+                result.stderr.decode("utf-8"))
+
+            with open(profile_path) as profile_file:
+                profile = json.load(profile_file)
+
+        # Every input file has its own entry, with the checks run on it
+        files = {entry["file"]: entry["checks"]
+            for entry in profile["files"] if "file" in entry}
+        for test_file in self.test_files:
+            self.assertIn(os.path.abspath(test_file), files)
+        self.assertTrue(any("naming/VarName" in checks
+            for checks in files.values()))
+
+    def test_time_trace(self):
+        with tempfile.TemporaryDirectory() as directory:
+            trace_path = os.path.join(directory, "trace.json")
+            subprocess.check_output(
+                [NETT_PATH, "--jobs", "2", "--time-trace", trace_path,
+                    "--time-trace-granularity=0"] + self.test_files)
+
+            with open(trace_path) as trace_file:
+                trace = json.load(trace_file)
+
+        spans = [event for event in trace["traceEvents"]
+            if event["ph"] == "X"]
+        names = set(event["name"] for event in spans)
+        for name in ["input/Sanitize", "CheckFile", "Parse", "Match",
+                "deferred/FunctionComments", "output/Terminal"]:
+            self.assertIn(name, names)
+
+        # The files are checked on the worker threads, not the main thread
+        main_threads = set(event["tid"] for event in spans
+            if event["name"] == "input/Sanitize")
+        worker_threads = set(event["tid"] for event in spans
+            if event["name"] == "Match")
+        self.assertFalse(main_threads & worker_threads)
+
+    def test_max_memory_check(self):
+        test_file = TEST_PATH + "/test_files/naming/varNameCheckTest.c"
+        expected = subprocess.check_output([NETT_PATH, test_file])
+
+        with tempfile.TemporaryDirectory() as directory:
+            # The table alone is over the budget once it has been read
+            large_file = os.path.join(directory, "largeTable.c")
+            with open(large_file, "w") as source:
+                source.write("int table[] = {\n")
+                for _ in range(60000):
+                    source.write("    0, 0, 0, 0, 0, 0, 0, 0,\n")
+                source.write("};\n")
+
+            result = subprocess.run(
+                [NETT_PATH, "--stats", "--max-memory=1", large_file,
+                    test_file],
+                stdout=subprocess.PIPE, stderr=subprocess.PIPE, check=True)
+
+        output = result.stdout.decode("utf-8")
+        self.assertIn("[RESOURCE]", output)
+        self.assertIn("(over budget)", result.stderr.decode("utf-8"))
+
+        # The other file is still checked in full
+        for line in expected.decode("utf-8").splitlines():
+            if line.startswith("Line "):
+                self.assertIn(line, output)
+
+    def test_max_memory_within_declaration(self):
+        with tempfile.TemporaryDirectory() as directory:
+            # The source fits in the budget, but the table's AST doesn't
+            large_file = os.path.join(directory, "largeTable.c")
+            with open(large_file, "w") as source:
+                source.write("int table[] = {\n")
+                for _ in range(60000):
+                    source.write("    0, 0, 0, 0, 0, 0, 0, 0,\n")
+                source.write("};\n")
+                source.write("int BadName;\n")
+
+            result = subprocess.run(
+                [NETT_PATH, "--max-memory=8", large_file],
+                stdout=subprocess.PIPE, stderr=subprocess.PIPE, check=True)
+
+        # Parsing stops inside the table, before the misnamed variable
+        lines = result.stdout.decode("utf-8").splitlines()
+        resource = [line for line in lines if "[RESOURCE]" in line]
+        self.assertEqual(len(resource), 1)
+        line_no = int(resource[0].split(":")[0][len("Line "):])
+        self.assertGreater(line_no, 1)
+        self.assertLess(line_no, 60002)
+        self.assertFalse(any("BadName" in line for line in lines))
@@ -380,6 +380,7 @@ class TestWhitespaceChecks(unittest.TestCase):
             "Line 21: [WHITESPACE] '*' at position 16, expected 1 space, found 2",
             "Line 21: [WHITESPACE] 'm' at position 18, expected 0 spaces, found 1",
             "Line 21: [WHITESPACE] Pointers should be a* b or a *b, not a*b.",
+            "Line 22: [WHITESPACE] Pointers should be a* b or a *b, not a * b.",
             ""
         ])
 
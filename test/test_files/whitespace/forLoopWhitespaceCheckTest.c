@@ -46,5 +46,9 @@ int main(int argc, char** argv) {
             ) {
     }
 
+    // Semicolons within literals
+    for (argc = ';'; argc > 0; argc--) {
+    }
+
     return 0;
 }
\ No newline at end of file
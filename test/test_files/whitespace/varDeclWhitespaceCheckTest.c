@@ -19,6 +19,7 @@ int main(int argc, char** argv) {
     char **j;
     char *k;
     float*l ,  * m;
+    int (*n)(int[2], int * p, int[3]);
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,95 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#include "StringPool.hpp"
+
+#include "llvm/ADT/Hashing.h"
+#include "llvm/Support/MathExtras.h"
+
+namespace nett {
+
+thread_local StringPool* GlobalStringPool = nullptr;
+
+// Finds the block holding the given id, and the id's place within it.
+static void GetBlockIndex(uint32_t ID, unsigned& Block, uint32_t& Offset) {
+
+    // Block B starts at id FIRST_BLOCK * (2^B - 1)
+    uint64_t Position = static_cast<uint64_t>(ID) + STRING_POOL_FIRST_BLOCK;
+    Block = llvm::Log2_64(Position / STRING_POOL_FIRST_BLOCK);
+    Offset = Position - (static_cast<uint64_t>(STRING_POOL_FIRST_BLOCK)
+                                << Block);
+}
+
+StringPool::StringPool() : NextID(0) {
+    for (auto& Block : StringPool::Blocks) {
+        Block.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+StringPool::~StringPool() {
+    Clear();
+}
+
+llvm::StringRef& StringPool::GetSlot(uint32_t ID) {
+
+    unsigned Block;
+    uint32_t Offset;
+    GetBlockIndex(ID, Block, Offset);
+
+    // Two threads may need a new block at once, in which case only the
+    // first one's is kept.
+    auto* Strings = StringPool::Blocks[Block].load(std::memory_order_acquire);
+    if (!Strings) {
+        auto* NewStrings = new llvm::StringRef[STRING_POOL_FIRST_BLOCK
+                                               << Block];
+        if (StringPool::Blocks[Block].compare_exchange_strong(
+                    Strings, NewStrings, std::memory_order_acq_rel)) {
+            Strings = NewStrings;
+        } else {
+            delete[] NewStrings;
+        }
+    }
+    return Strings[Offset];
+}
+
+uint32_t StringPool::Intern(llvm::StringRef String) {
+
+    auto& Part = StringPool::Shards[llvm::hash_value(String) %
+                                    STRING_POOL_SHARDS];
+    std::lock_guard<std::mutex> Lock(Part.Mutex);
+
+    auto Found = Part.IDs.find(String);
+    if (Found != Part.IDs.end()) {
+        return Found->second;
+    }
+
+    // The map owns the string, so the slot refers to its key. Anyone given
+    // the id gets it through this lock (or from a thread which did), so
+    // they see the slot filled in.
+    auto ID = StringPool::NextID.fetch_add(1, std::memory_order_relaxed);
+    auto Inserted = Part.IDs.insert({String, ID});
+    GetSlot(ID) = Inserted.first->getKey();
+    return ID;
+}
+
+llvm::StringRef StringPool::Get(uint32_t ID) const {
+
+    unsigned Block;
+    uint32_t Offset;
+    GetBlockIndex(ID, Block, Offset);
+    return StringPool::Blocks[Block].load(std::memory_order_acquire)[Offset];
+}
+
+void StringPool::Clear(void) {
+
+    for (auto& Part : StringPool::Shards) {
+        std::lock_guard<std::mutex> Lock(Part.Mutex);
+        Part.IDs.clear();
+    }
+    for (auto& Block : StringPool::Blocks) {
+        delete[] Block.exchange(nullptr, std::memory_order_acq_rel);
+    }
+    StringPool::NextID.store(0, std::memory_order_relaxed);
+}
+
+}  // namespace nett
@@ -0,0 +1,70 @@
+/* Copyright (C) 2020  Matthys Grobbelaar
+ *  Full license notice can be found in Nett.cpp
+ */
+#ifndef LLVM_CLANG_TOOLS_EXTRA_NETT_VIOLATIONS_STRINGPOOL_HPP
+#define LLVM_CLANG_TOOLS_EXTRA_NETT_VIOLATIONS_STRINGPOOL_HPP
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace nett {
+
+// The number of parts the pool's strings are split into by their hash. Each
+// part has its own lock, so threads adding different strings rarely wait.
+#define STRING_POOL_SHARDS 16
+
+// The number of strings in the first block of the pool. Each block after it
+// holds twice as many as the one before, and blocks never move, so looking
+// up a string needs no lock.
+#define STRING_POOL_FIRST_BLOCK 1024
+#define STRING_POOL_BLOCKS 22
+
+// Keeps a single copy of each string given to it, so that violations can
+// refer to their file and message with a small id. The files of a session
+// are checked on several threads at once, so the pool is shared between
+// them. Getting a string never waits on other threads.
+class StringPool {
+    public:
+    StringPool();
+    ~StringPool();
+
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    // Returns the id of the given string, adding it to the pool if needed.
+    uint32_t Intern(llvm::StringRef String);
+
+    // Returns the string with the given id. The string stays valid until
+    // the pool is cleared.
+    llvm::StringRef Get(uint32_t ID) const;
+
+    // Frees every string in the pool. Ids handed out before this are no
+    // longer valid, so nothing (on any thread) may be holding on to them.
+    void Clear(void);
+
+    private:
+    struct Shard {
+        std::mutex Mutex;
+        llvm::StringMap<uint32_t> IDs;
+    };
+
+    // Returns the slot holding the string with the given id, creating its
+    // block if it doesn't exist yet.
+    llvm::StringRef& GetSlot(uint32_t ID);
+
+    Shard Shards[STRING_POOL_SHARDS];
+    std::atomic<llvm::StringRef*> Blocks[STRING_POOL_BLOCKS];
+    std::atomic<uint32_t> NextID;
+};
+
+// The string pool of the session checking files on the current thread. Each
+// session installs its own (see runner/Session.hpp).
+extern thread_local StringPool* GlobalStringPool;
+
+}  // namespace nett
+
+#endif
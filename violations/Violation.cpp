@@ -3,303 +3,313 @@
  */
 #include "Violation.hpp"
 
-#include "clang/Frontend/FrontendActions.h"
-
-#include <functional>
-#include <sstream>
+#include "StringPool.hpp"
 
 namespace nett {
 
-// Violation ------------------------------------------------------------------
-
-Violation::Violation(
-        std::string SourceFilePath, uint LineNo, std::string Message) {
-    this->SourceFilePath = std::move(SourceFilePath);
+// The label each type of violation is printed with, by ViolationType
+static const char* const VIOLATION_TAGS[] = {"NAMING", "COMMENTS", "BRACES",
+        "WHITESPACE", "INDENTATION", "LINE-LENGTH", "OVERALL", "WARNING",
+        "RESOURCE", "NOTE", ""};
+
+// What each naming rule asks for, by NamingRule
+static const char* const NAMING_EXPLANATIONS[] = {
+        "#defines should be NAMED_LIKE_THIS.",
+        "Enum constants should be NAMED_LIKE_THIS.",
+        "Enums should be NamedLikeThis.",
+        "Functions should be named_like_this.",
+        "Hungarian notation is not to be used.",
+        "Struct/Union fields should be namedLikeThis.",
+        "Types should be NamedLikeThis.", "Variables should be namedLikeThis.",
+        "Files should be namedLikeThis.c"};
+
+llvm::StringRef GetViolationTypeName(ViolationType Type) {
+    return VIOLATION_TAGS[Type];
+}
+
+Violation::Violation(ViolationType Type, llvm::StringRef SourceFilePath,
+        uint LineNo, llvm::StringRef Message) {
+    this->FileID = GlobalStringPool->Intern(SourceFilePath);
     this->LineNo = LineNo;
-    this->Message = std::move(Message);
-}
-
-std::string Violation::GetSourceFile(void) const {
-    return Violation::SourceFilePath;
-}
-
-std::string Violation::GetMessage(void) const {
-    return Violation::Message;
-}
-
-uint Violation::GetLineNumber(void) const {
-    return Violation::LineNo;
-}
-
-std::string Violation::ToTerminalString(void) {
-    return std::string("");
-}
-
-std::string Violation::ToFileString(void) {
-    return std::string("");
-}
-
-ViolationType Violation::Type(void) {
-    return ViolationType::UNSPEC;
-}
-
-bool Violation::operator==(const Violation& Other) const {
-    // Two violations are equal if they have the same type,
-    // are on the same line in the same file, and have the
-    // same message
-    if (Violation::LineNo != Other.LineNo) {
-        return false;
-    }
-    if (Violation::SourceFilePath.compare(Other.SourceFilePath) != 0) {
-        return false;
-    }
-    if (Violation::Message.compare(Other.Message) != 0) {
-        return false;
-    }
-    return true;
-}
-
-// NamingViolation ------------------------------------------------------------
-NamingViolation::NamingViolation(
-        std::string SourceFilePath, uint LineNo, std::string Message)
-    : Violation(SourceFilePath, LineNo, Message) {
-}
-
-std::string NamingViolation::ToTerminalString(void) {
-
-    std::ostringstream Message;
-    Message << "Line " << Violation::LineNo << ": [NAMING] "
-            << Violation::Message;
-
-    return Message.str();
-}
-
-std::string NamingViolation::ToFileString(void) {
-
-    std::ostringstream Message;
-    Message << "[NAMING] " << Violation::Message;
-
-    return Message.str();
+    this->ColumnNo = 0;
+    this->TextID = GlobalStringPool->Intern(Message);
+    this->Args[0] = 0;
+    this->Args[1] = 0;
+    this->ViolType = Type;
+    this->ViolRule = RULE_MESSAGE;
+}
+
+Violation::Violation(ViolationType Type, ViolationRule Rule,
+        llvm::StringRef SourceFilePath, uint LineNo, uint ColumnNo,
+        llvm::StringRef Text, uint Arg0, uint Arg1) {
+    this->FileID = GlobalStringPool->Intern(SourceFilePath);
+    this->LineNo = LineNo;
+    this->ColumnNo = ColumnNo;
+    this->TextID = GlobalStringPool->Intern(Text);
+    this->Args[0] = Arg0;
+    this->Args[1] = Arg1;
+    this->ViolType = Type;
+    this->ViolRule = Rule;
 }
 
-ViolationType NamingViolation::Type(void) {
-    return ViolationType::NAMING;
+Violation Violation::TokenSpacing(llvm::StringRef SourceFilePath,
+        uint LineNo, uint ColumnNo, llvm::StringRef Token,
+        uint ExpectedSpaces, uint ActualSpaces) {
+    return Violation(ViolationType::WHITESPACE, RULE_TOKEN_SPACING,
+            SourceFilePath, LineNo, ColumnNo, Token, ExpectedSpaces,
+            ActualSpaces);
 }
 
-// CommentsViolation ----------------------------------------------------------
-CommentsViolation::CommentsViolation(
-        std::string SourceFilePath, uint LineNo, std::string Message)
-    : Violation(SourceFilePath, LineNo, Message) {
+Violation Violation::Misnamed(llvm::StringRef SourceFilePath, uint LineNo,
+        llvm::StringRef Name, NamingRule BrokenRule) {
+    return Violation(ViolationType::NAMING, RULE_MISNAMED, SourceFilePath,
+            LineNo, 0, Name, BrokenRule, 0);
 }
 
-std::string CommentsViolation::ToTerminalString(void) {
-
-    std::ostringstream Message;
-    Message << "Line " << Violation::LineNo << ": [COMMENTS] "
-            << Violation::Message;
-
-    return Message.str();
+Violation Violation::AlreadyInfracted(llvm::StringRef SourceFilePath,
+        uint LineNo, llvm::StringRef Name, bool IsMisnamed) {
+    return Violation(ViolationType::NOTE, RULE_ALREADY_INFRACTED,
+            SourceFilePath, LineNo, 0, Name, IsMisnamed, 0);
 }
 
-std::string CommentsViolation::ToFileString(void) {
-
-    std::ostringstream Message;
-    Message << "[COMMENTS] " << Violation::Message;
-
-    return Message.str();
+Violation Violation::Indent(llvm::StringRef SourceFilePath, uint LineNo,
+        llvm::StringRef Token, uint ExpectedIndent, uint ActualIndent) {
+    return Violation(ViolationType::INDENTATION, RULE_INDENT, SourceFilePath,
+            LineNo, 0, Token, ExpectedIndent, ActualIndent);
 }
 
-ViolationType CommentsViolation::Type(void) {
-    return ViolationType::COMMENTS;
+Violation Violation::LineLength(llvm::StringRef SourceFilePath,
+        uint LineNo, uint Length, uint MaxLength) {
+    return Violation(ViolationType::LINE_LENGTH, RULE_LINE_LENGTH,
+            SourceFilePath, LineNo, 0, "", Length, MaxLength);
 }
 
-// BracesViolation ------------------------------------------------------------
-BracesViolation::BracesViolation(
-        std::string SourceFilePath, uint LineNo, std::string Message)
-    : Violation(SourceFilePath, LineNo, Message) {
+Violation Violation::FunctionLength(llvm::StringRef SourceFilePath,
+        uint LineNo, uint Length, uint MaxLength) {
+    return Violation(ViolationType::OVERALL, RULE_FUNCTION_LENGTH,
+            SourceFilePath, LineNo, 0, "", Length, MaxLength);
 }
 
-std::string BracesViolation::ToTerminalString(void) {
-
-    std::ostringstream Message;
-    Message << "Line " << Violation::LineNo << ": [BRACES] "
-            << Violation::Message;
-
-    return Message.str();
+Violation Violation::UnaryOperator(llvm::StringRef SourceFilePath,
+        uint LineNo, llvm::StringRef Operator, bool IsPostfix) {
+    return Violation(ViolationType::WHITESPACE, RULE_UNARY_OPERATOR,
+            SourceFilePath, LineNo, 0, Operator, IsPostfix, 0);
 }
 
-std::string BracesViolation::ToFileString(void) {
-
-    std::ostringstream Message;
-    Message << "[BRACES] " << Violation::Message;
-
-    return Message.str();
+Violation Violation::MemberAccess(llvm::StringRef SourceFilePath,
+        uint LineNo, llvm::StringRef Operator) {
+    return Violation(ViolationType::WHITESPACE, RULE_MEMBER_ACCESS,
+            SourceFilePath, LineNo, 0, Operator, 0, 0);
 }
 
-ViolationType BracesViolation::Type(void) {
-    return ViolationType::BRACES;
+llvm::StringRef Violation::GetSourceFile(void) const {
+    return GlobalStringPool->Get(Violation::FileID);
 }
 
-// WhitespaceViolation --------------------------------------------------------
-WhitespaceViolation::WhitespaceViolation(
-        std::string SourceFilePath, uint LineNo, std::string Message)
-    : Violation(SourceFilePath, LineNo, Message) {
-}
-
-std::string WhitespaceViolation::ToTerminalString(void) {
-
-    std::ostringstream Message;
-    Message << "Line " << Violation::LineNo << ": [WHITESPACE] "
-            << Violation::Message;
+std::string Violation::GetMessage(void) const {
 
-    return Message.str();
+    auto Text = GlobalStringPool->Get(Violation::TextID);
+
+    switch (Violation::ViolRule) {
+    case RULE_TOKEN_SPACING: {
+        auto Expected = Violation::Args[0];
+        std::string Message;
+        Message += "'";
+        Message += Text;
+        Message += "' at position " + std::to_string(Violation::ColumnNo);
+        Message += ", expected " + std::to_string(Expected);
+        Message += (Expected == 1) ? " space" : " spaces";
+        Message += ", found " + std::to_string(Violation::Args[1]);
+        return Message;
+    }
+    case RULE_MISNAMED:
+        return "'" + Text.str() + "' misnamed. " +
+               NAMING_EXPLANATIONS[Violation::Args[0]];
+    case RULE_ALREADY_INFRACTED:
+        if (Violation::Args[0]) {
+            return "'" + Text.str() +
+                   "' misnamed but has already been infracted.";
+        }
+        return "'" + Text.str() + "' has already been infracted.";
+    case RULE_INDENT: {
+        std::string Message;
+        if (!Text.empty()) {
+            Message += "'" + Text.str() + "' ";
+        }
+        Message += "Expected indent of " + std::to_string(Violation::Args[0]) +
+                   " spaces, found " + std::to_string(Violation::Args[1]) +
+                   ".";
+        return Message;
+    }
+    case RULE_FUNCTION_LENGTH:
+        return "Function length of " + std::to_string(Violation::Args[0]) +
+               " is over the maximum of " +
+               std::to_string(Violation::Args[1]) + ".";
+    case RULE_LINE_LENGTH:
+        return "Line length of " + std::to_string(Violation::Args[0]) +
+               " is over the maximum of " +
+               std::to_string(Violation::Args[1]) + ".";
+    case RULE_UNARY_OPERATOR:
+        if (Violation::Args[0]) {
+            return "Unary operators should look like: X" + Text.str();
+        }
+        return "Unary operators should look like: " + Text.str() + "X";
+    case RULE_MEMBER_ACCESS:
+        return "Member accesses should look like: X" + Text.str() + "a";
+    case RULE_MESSAGE:
+        break;
+    }
+    return Text.str();
 }
 
-std::string WhitespaceViolation::ToFileString(void) {
-
-    std::ostringstream Message;
-    Message << "[WHITESPACE] " << Violation::Message;
+llvm::StringRef Violation::GetMessageText(void) const {
 
-    return Message.str();
+    if (Violation::ViolRule != RULE_MESSAGE) {
+        return llvm::StringRef();
+    }
+    return GlobalStringPool->Get(Violation::TextID);
 }
 
-ViolationType WhitespaceViolation::Type(void) {
-    return ViolationType::WHITESPACE;
-}
+std::string Violation::ToTerminalString(void) const {
 
-// IndentationViolation -------------------------------------------------------
-IndentationViolation::IndentationViolation(
-        std::string SourceFilePath, uint LineNo, std::string Message)
-    : Violation(SourceFilePath, LineNo, Message) {
+    if (Violation::ViolType == ViolationType::UNSPEC) {
+        return std::string("");
+    }
+    return "Line " + std::to_string(Violation::LineNo) + ": " +
+           ToFileString();
 }
 
-std::string IndentationViolation::ToTerminalString(void) {
-
-    std::ostringstream Message;
-    Message << "Line " << Violation::LineNo << ": [INDENTATION] "
-            << Violation::Message;
+std::string Violation::ToFileString(void) const {
 
-    return Message.str();
+    if (Violation::ViolType == ViolationType::UNSPEC) {
+        return std::string("");
+    }
+    return "[" + GetViolationTypeName(Violation::ViolType).str() + "] " +
+           GetMessage();
 }
 
-std::string IndentationViolation::ToFileString(void) {
-
-    std::ostringstream Message;
-    Message << "[INDENTATION] " << Violation::Message;
-
-    return Message.str();
+bool Violation::operator==(const Violation& Other) const {
+    // The message is made from the rule, text, column and arguments, so
+    // comparing those compares the messages.
+    return Violation::LineNo == Other.LineNo &&
+           Violation::FileID == Other.FileID &&
+           Violation::ViolRule == Other.ViolRule &&
+           Violation::TextID == Other.TextID &&
+           Violation::ColumnNo == Other.ColumnNo &&
+           Violation::Args[0] == Other.Args[0] &&
+           Violation::Args[1] == Other.Args[1];
 }
 
-ViolationType IndentationViolation::Type(void) {
-    return ViolationType::INDENTATION;
-}
+size_t Violation::Hash(void) const {
 
-// LineLengthViolation -------------------------------------------------------
-LineLengthViolation::LineLengthViolation(
-        std::string SourceFilePath, uint LineNo, std::string Message)
-    : Violation(SourceFilePath, LineNo, Message) {
+    size_t Result = Violation::FileID;
+    Result = Result * 31 + Violation::LineNo;
+    Result = Result * 31 + Violation::TextID;
+    Result = Result * 31 + Violation::ColumnNo;
+    return Result;
 }
 
-std::string LineLengthViolation::ToTerminalString(void) {
-
-    std::ostringstream Message;
-    Message << "Line " << Violation::LineNo << ": [LINE-LENGTH] "
-            << Violation::Message;
+llvm::json::Value Violation::ToJSON(void) const {
 
-    return Message.str();
+    return llvm::json::Array{static_cast<int>(Violation::ViolType),
+            static_cast<int>(Violation::ViolRule), GetSourceFile(),
+            Violation::LineNo, Violation::ColumnNo,
+            GlobalStringPool->Get(Violation::TextID), Violation::Args[0],
+            Violation::Args[1]};
 }
 
-std::string LineLengthViolation::ToFileString(void) {
+llvm::Optional<Violation> Violation::FromJSON(const llvm::json::Value& Value) {
 
-    std::ostringstream Message;
-    Message << "[LINE-LENGTH] " << Violation::Message;
-
-    return Message.str();
-}
+    const auto* Fields = Value.getAsArray();
+    if (!Fields || Fields->size() != 8) {
+        return llvm::None;
+    }
 
-ViolationType LineLengthViolation::Type(void) {
-    return ViolationType::LINE_LENGTH;
-}
+    uint32_t Numbers[8];
+    for (unsigned i = 0; i < 8; i++) {
+        if (i == 2 || i == 5) {
+            // The file and text are the only strings
+            continue;
+        }
+        auto Number = (*Fields)[i].getAsInteger();
+        if (!Number || *Number < 0 || *Number > UINT32_MAX) {
+            return llvm::None;
+        }
+        Numbers[i] = *Number;
+    }
+    auto File = (*Fields)[2].getAsString();
+    auto Text = (*Fields)[5].getAsString();
+    if (!File || !Text || Numbers[0] > ViolationType::UNSPEC ||
+            Numbers[1] > RULE_LINE_LENGTH) {
+        return llvm::None;
+    }
+    if (Numbers[1] == RULE_MISNAMED && Numbers[6] > NAMING_FILE) {
+        return llvm::None;
+    }
 
-// OverallViolation -----------------------------------------------------------
-OverallViolation::OverallViolation(
-        std::string SourceFilePath, uint LineNo, std::string Message)
-    : Violation(SourceFilePath, LineNo, Message) {
+    Violation Result;
+    Result.ViolType = static_cast<ViolationType>(Numbers[0]);
+    Result.ViolRule = static_cast<ViolationRule>(Numbers[1]);
+    Result.FileID = GlobalStringPool->Intern(*File);
+    Result.LineNo = Numbers[3];
+    Result.ColumnNo = Numbers[4];
+    Result.TextID = GlobalStringPool->Intern(*Text);
+    Result.Args[0] = Numbers[6];
+    Result.Args[1] = Numbers[7];
+    return Result;
 }
 
-std::string OverallViolation::ToTerminalString(void) {
-
-    std::ostringstream Message;
-    Message << "Line " << Violation::LineNo << ": [OVERALL] "
-            << Violation::Message;
-
-    return Message.str();
+Violation NamingViolation(
+        llvm::StringRef SourceFilePath, uint LineNo, llvm::StringRef Message) {
+    return Violation(ViolationType::NAMING, SourceFilePath, LineNo, Message);
 }
 
-std::string OverallViolation::ToFileString(void) {
-
-    std::ostringstream Message;
-    Message << "[OVERALL] " << Violation::Message;
-
-    return Message.str();
+Violation CommentsViolation(
+        llvm::StringRef SourceFilePath, uint LineNo, llvm::StringRef Message) {
+    return Violation(ViolationType::COMMENTS, SourceFilePath, LineNo, Message);
 }
 
-ViolationType OverallViolation::Type(void) {
-    return ViolationType::OVERALL;
+Violation BracesViolation(
+        llvm::StringRef SourceFilePath, uint LineNo, llvm::StringRef Message) {
+    return Violation(ViolationType::BRACES, SourceFilePath, LineNo, Message);
 }
 
-// WarningViolation -----------------------------------------------------------
-WarningViolation::WarningViolation(
-        std::string SourceFilePath, uint LineNo, std::string Message)
-    : Violation(SourceFilePath, LineNo, Message) {
+Violation WhitespaceViolation(
+        llvm::StringRef SourceFilePath, uint LineNo, llvm::StringRef Message) {
+    return Violation(
+            ViolationType::WHITESPACE, SourceFilePath, LineNo, Message);
 }
 
-std::string WarningViolation::ToTerminalString(void) {
-
-    std::ostringstream Message;
-    Message << "Line " << Violation::LineNo << ": [WARNING] "
-            << Violation::Message;
-
-    return Message.str();
+Violation IndentationViolation(
+        llvm::StringRef SourceFilePath, uint LineNo, llvm::StringRef Message) {
+    return Violation(
+            ViolationType::INDENTATION, SourceFilePath, LineNo, Message);
 }
 
-std::string WarningViolation::ToFileString(void) {
-
-    std::ostringstream Message;
-    Message << "[WARNING] " << Violation::Message;
-
-    return Message.str();
+Violation LineLengthViolation(
+        llvm::StringRef SourceFilePath, uint LineNo, llvm::StringRef Message) {
+    return Violation(
+            ViolationType::LINE_LENGTH, SourceFilePath, LineNo, Message);
 }
 
-ViolationType WarningViolation::Type(void) {
-    return ViolationType::WARNING;
+Violation OverallViolation(
+        llvm::StringRef SourceFilePath, uint LineNo, llvm::StringRef Message) {
+    return Violation(ViolationType::OVERALL, SourceFilePath, LineNo, Message);
 }
 
-// NoteViolation -----------------------------------------------------------
-NoteViolation::NoteViolation(
-        std::string SourceFilePath, uint LineNo, std::string Message)
-    : Violation(SourceFilePath, LineNo, Message) {
+Violation WarningViolation(
+        llvm::StringRef SourceFilePath, uint LineNo, llvm::StringRef Message) {
+    return Violation(ViolationType::WARNING, SourceFilePath, LineNo, Message);
 }
 
-std::string NoteViolation::ToTerminalString(void) {
-
-    std::ostringstream Message;
-    Message << "Line " << Violation::LineNo << ": [NOTE] "
-            << Violation::Message;
-
-    return Message.str();
-}
-
-std::string NoteViolation::ToFileString(void) {
-
-    std::ostringstream Message;
-    Message << "[NOTE] " << Violation::Message;
-
-    return Message.str();
+Violation ResourceViolation(
+        llvm::StringRef SourceFilePath, uint LineNo, llvm::StringRef Message) {
+    return Violation(ViolationType::RESOURCE, SourceFilePath, LineNo, Message);
 }
 
-ViolationType NoteViolation::Type(void) {
-    return ViolationType::NOTE;
+Violation NoteViolation(
+        llvm::StringRef SourceFilePath, uint LineNo, llvm::StringRef Message) {
+    return Violation(ViolationType::NOTE, SourceFilePath, LineNo, Message);
 }
 
-}  // namespace nett
\ No newline at end of file
+}  // namespace nett
@@ -4,12 +4,19 @@
 #ifndef LLVM_CLANG_TOOLS_EXTRA_NETT_VIOLATIONS_VIOLATION_HPP
 #define LLVM_CLANG_TOOLS_EXTRA_NETT_VIOLATIONS_VIOLATION_HPP
 
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/JSON.h"
+
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <sys/types.h>
 
 namespace nett {
 
 // A category of style violation
-enum ViolationType {
+enum ViolationType : uint8_t {
     NAMING,
     COMMENTS,
     BRACES,
@@ -18,126 +25,201 @@ enum ViolationType {
     LINE_LENGTH,
     OVERALL,
     WARNING,
+    RESOURCE,
     NOTE,
     UNSPEC
 };
 
-// Represents a style violation within a source file.
+// Returns the label a type of violation is printed with (e.g. "NAMING").
+llvm::StringRef GetViolationTypeName(ViolationType Type);
+
+// What a violation's message is made from. Messages with a fixed wording
+// are stored as is. Messages that mention a name, token or number keep
+// those as arguments instead, and are only formatted when printed.
+enum ViolationRule : uint8_t {
+    // The text is the message
+    RULE_MESSAGE,
+    // The text is the token, and the arguments are the expected and found
+    // number of spaces before it. The column is the token's.
+    RULE_TOKEN_SPACING,
+    // The text is the name, and the first argument is the NamingRule it
+    // breaks.
+    RULE_MISNAMED,
+    // The text is a name that breaks a naming rule it has already been
+    // infracted for. The first argument is nonzero if the note says it is
+    // misnamed.
+    RULE_ALREADY_INFRACTED,
+    // The text is the token, which may be empty, and the arguments are the
+    // expected and found indent.
+    RULE_INDENT,
+    // The arguments are the function's length and the maximum length.
+    RULE_FUNCTION_LENGTH,
+    // The text is the operator, and the first argument is nonzero if it is
+    // a postfix operator.
+    RULE_UNARY_OPERATOR,
+    // The text is the member access operator.
+    RULE_MEMBER_ACCESS,
+    // The arguments are the line's length and the maximum length.
+    RULE_LINE_LENGTH
+};
+
+// The naming rules a RULE_MISNAMED violation can break
+enum NamingRule : uint8_t {
+    NAMING_DEFINE,
+    NAMING_ENUM_CONSTANT,
+    NAMING_ENUM,
+    NAMING_FUNCTION,
+    NAMING_HUNGARIAN,
+    NAMING_FIELD,
+    NAMING_TYPE,
+    NAMING_VARIABLE,
+    NAMING_FILE
+};
+
+// Represents a style violation within a source file. Violations are small
+// records: the file and text are kept in the GlobalStringPool, so copying,
+// comparing and hashing a violation only deals with integers.
 class Violation {
     public:
-    Violation(std::string SourceFilePath, uint LineNo, std::string Message);
+    Violation(ViolationType Type, llvm::StringRef SourceFilePath, uint LineNo,
+            llvm::StringRef Message);
+
+    // Makes a whitespace violation for the wrong number of spaces before
+    // the given token.
+    static Violation TokenSpacing(llvm::StringRef SourceFilePath, uint LineNo,
+            uint ColumnNo, llvm::StringRef Token, uint ExpectedSpaces,
+            uint ActualSpaces);
+
+    // Makes a naming violation for a name that breaks the given rule.
+    static Violation Misnamed(llvm::StringRef SourceFilePath, uint LineNo,
+            llvm::StringRef Name, NamingRule BrokenRule);
+
+    // Makes a note for a name that has already been infracted, which says
+    // it is misnamed if IsMisnamed is set.
+    static Violation AlreadyInfracted(llvm::StringRef SourceFilePath,
+            uint LineNo, llvm::StringRef Name, bool IsMisnamed);
+
+    // Makes an indentation violation for the given token, which may be
+    // empty if there is none.
+    static Violation Indent(llvm::StringRef SourceFilePath, uint LineNo,
+            llvm::StringRef Token, uint ExpectedIndent, uint ActualIndent);
+
+    // Makes a line length violation for a line that is too long.
+    static Violation LineLength(llvm::StringRef SourceFilePath, uint LineNo,
+            uint Length, uint MaxLength);
+
+    // Makes an overall violation for a function that is too long.
+    static Violation FunctionLength(llvm::StringRef SourceFilePath,
+            uint LineNo, uint Length, uint MaxLength);
+
+    // Makes a whitespace violation for a unary operator that isn't on the
+    // same line as its operand.
+    static Violation UnaryOperator(llvm::StringRef SourceFilePath,
+            uint LineNo, llvm::StringRef Operator, bool IsPostfix);
+
+    // Makes a whitespace violation for a member access operator that isn't
+    // on the same line as the accessed struct or union.
+    static Violation MemberAccess(llvm::StringRef SourceFilePath,
+            uint LineNo, llvm::StringRef Operator);
+
+    // Returns the id of the file in which this violation has occurred.
+    uint32_t GetFileID(void) const {
+        return FileID;
+    }
 
     // Returns the full file path of the file in which
     // this violation has occurred.
-    std::string GetSourceFile(void) const;
+    llvm::StringRef GetSourceFile(void) const;
 
     // Returns the line number in the file on which this
     // violation occured.
-    uint GetLineNumber(void) const;
+    uint GetLineNumber(void) const {
+        return LineNo;
+    }
+
+    // Returns the column the violation refers to, or 0 if it doesn't
+    // refer to one.
+    uint GetColumnNumber(void) const {
+        return ColumnNo;
+    }
 
     // Returns the message string for this violation
     std::string GetMessage(void) const;
 
+    // Returns the message of a RULE_MESSAGE violation without formatting
+    // it, or an empty string for other rules.
+    llvm::StringRef GetMessageText(void) const;
+
     // Returns a string representation of this violation
     // for terminal output purposes.
-    virtual std::string ToTerminalString(void);
+    std::string ToTerminalString(void) const;
 
     // Returns a string representation of this violation
     // for file output purposes.
-    virtual std::string ToFileString(void);
+    std::string ToFileString(void) const;
 
     // Returns the type of this violation (NAMING, COMMENTS etc.)
-    virtual ViolationType Type(void);
+    ViolationType Type(void) const {
+        return ViolType;
+    }
 
-    // We need to override the equals method
-    bool operator==(const Violation& Other) const;
+    ViolationRule Rule(void) const {
+        return ViolRule;
+    }
 
-    protected:
-    std::string SourceFilePath;
-    uint LineNo;
-    std::string Message;
-};
-
-class NamingViolation : public Violation {
-    public:
-    NamingViolation(
-            std::string SourceFilePath, uint LineNo, std::string Message);
-    std::string ToTerminalString(void) override;
-    std::string ToFileString(void) override;
-    ViolationType Type(void) override;
-};
-
-class CommentsViolation : public Violation {
-    public:
-    CommentsViolation(
-            std::string SourceFilePath, uint LineNo, std::string Message);
-    std::string ToTerminalString(void) override;
-    std::string ToFileString(void) override;
-    ViolationType Type(void) override;
-};
+    // Two violations are equal if they are on the same line in the same
+    // file and have the same message.
+    bool operator==(const Violation& Other) const;
 
-class BracesViolation : public Violation {
-    public:
-    BracesViolation(
-            std::string SourceFilePath, uint LineNo, std::string Message);
-    std::string ToTerminalString(void) override;
-    std::string ToFileString(void) override;
-    ViolationType Type(void) override;
-};
+    size_t Hash(void) const;
 
-class WhitespaceViolation : public Violation {
-    public:
-    WhitespaceViolation(
-            std::string SourceFilePath, uint LineNo, std::string Message);
-    std::string ToTerminalString(void) override;
-    std::string ToFileString(void) override;
-    ViolationType Type(void) override;
-};
+    // Returns the violation as a JSON array, for the result cache.
+    llvm::json::Value ToJSON(void) const;
 
-class IndentationViolation : public Violation {
-    public:
-    IndentationViolation(
-            std::string SourceFilePath, uint LineNo, std::string Message);
-    std::string ToTerminalString(void) override;
-    std::string ToFileString(void) override;
-    ViolationType Type(void) override;
-};
+    // Rebuilds a violation from the array made by ToJSON. Returns None if
+    // the value isn't one.
+    static llvm::Optional<Violation> FromJSON(const llvm::json::Value& Value);
 
-class LineLengthViolation : public Violation {
-    public:
-    LineLengthViolation(
-            std::string SourceFilePath, uint LineNo, std::string Message);
-    std::string ToTerminalString(void) override;
-    std::string ToFileString(void) override;
-    ViolationType Type(void) override;
-};
+    private:
+    Violation() = default;
 
-class OverallViolation : public Violation {
-    public:
-    OverallViolation(
-            std::string SourceFilePath, uint LineNo, std::string Message);
-    std::string ToTerminalString(void) override;
-    std::string ToFileString(void) override;
-    ViolationType Type(void) override;
-};
+    // Makes a violation of the given rule, which is formatted from the
+    // text and arguments when printed.
+    Violation(ViolationType Type, ViolationRule Rule,
+            llvm::StringRef SourceFilePath, uint LineNo, uint ColumnNo,
+            llvm::StringRef Text, uint Arg0, uint Arg1);
 
-class WarningViolation : public Violation {
-    public:
-    WarningViolation(
-            std::string SourceFilePath, uint LineNo, std::string Message);
-    std::string ToTerminalString(void) override;
-    std::string ToFileString(void) override;
-    ViolationType Type(void) override;
+    uint32_t FileID;
+    uint32_t LineNo;
+    uint32_t ColumnNo;
+    uint32_t TextID;
+    uint32_t Args[2];
+    ViolationType ViolType;
+    ViolationRule ViolRule;
 };
 
-class NoteViolation : public Violation {
-    public:
-    NoteViolation(std::string SourceFilePath, uint LineNo, std::string Message);
-    std::string ToTerminalString(void) override;
-    std::string ToFileString(void) override;
-    ViolationType Type(void) override;
-};
+// Each of these makes a violation of its type with the given message.
+Violation NamingViolation(
+        llvm::StringRef SourceFilePath, uint LineNo, llvm::StringRef Message);
+Violation CommentsViolation(
+        llvm::StringRef SourceFilePath, uint LineNo, llvm::StringRef Message);
+Violation BracesViolation(
+        llvm::StringRef SourceFilePath, uint LineNo, llvm::StringRef Message);
+Violation WhitespaceViolation(
+        llvm::StringRef SourceFilePath, uint LineNo, llvm::StringRef Message);
+Violation IndentationViolation(
+        llvm::StringRef SourceFilePath, uint LineNo, llvm::StringRef Message);
+Violation LineLengthViolation(
+        llvm::StringRef SourceFilePath, uint LineNo, llvm::StringRef Message);
+Violation OverallViolation(
+        llvm::StringRef SourceFilePath, uint LineNo, llvm::StringRef Message);
+Violation WarningViolation(
+        llvm::StringRef SourceFilePath, uint LineNo, llvm::StringRef Message);
+Violation ResourceViolation(
+        llvm::StringRef SourceFilePath, uint LineNo, llvm::StringRef Message);
+Violation NoteViolation(
+        llvm::StringRef SourceFilePath, uint LineNo, llvm::StringRef Message);
 
 }  // namespace nett
 
-#endif
\ No newline at end of file
+#endif
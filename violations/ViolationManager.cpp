@@ -3,35 +3,59 @@
  */
 #include "ViolationManager.hpp"
 
-#include "clang/Frontend/FrontendActions.h"
+#include "StringPool.hpp"
 
-#include <algorithm>
-#include <sstream>
+#include "../input/LineFilter.hpp"
 
-namespace std {
-template <> struct hash<nett::Violation> {
-    std::size_t operator()(const nett::Violation& Viol) const {
-        std::hash<std::string> StringHasher;
-        auto MessageHash = StringHasher(Viol.GetMessage());
-        auto FileHash = StringHasher(Viol.GetSourceFile());
-        return 93 * MessageHash ^ FileHash ^ Viol.GetLineNumber();
-    }
-};
-}  // namespace std
+#include <algorithm>
+#include <utility>
 
 namespace nett {
 
 // Since clang and libtooling use callbacks to perform all
 // of the checking operations, we use a global violation
 // manager variable since trying to inject one into
-// the methods will be painful and bug-prone.
-ViolationManager GlobalViolationManager;
+// the methods will be painful and bug-prone. Each thread
+// that checks files gets its own manager, and the results
+// are merged afterwards.
+thread_local ViolationManager GlobalViolationManager;
+
+ViolationManager::ViolationManager(ViolationManager&& Other) {
+    *this = std::move(Other);
+}
+
+ViolationManager& ViolationManager::operator=(ViolationManager&& Other) {
+    // Swapping hands our current violations to the other manager,
+    // which drops them once it is destroyed.
+    std::swap(FoundViolations, Other.FoundViolations);
+    std::swap(FrozenViolations, Other.FrozenViolations);
+    std::swap(InfractedNames, Other.InfractedNames);
+    std::swap(NameInfractions, Other.NameInfractions);
+    std::swap(ViolationCounts, Other.ViolationCounts);
+    std::swap(OutputToFile, Other.OutputToFile);
+    return *this;
+}
+
+void ViolationManager::AddViolation(const Violation& Viol) {
+
+    // Only the lines being checked are reported on
+    if (input::GlobalLineFilter->IsActive() &&
+            !input::GlobalLineFilter->Contains(
+                    Viol.GetSourceFile(), Viol.GetLineNumber())) {
+        return;
+    }
 
-void ViolationManager::AddViolation(Violation* Viol) {
-    ViolationManager::FoundViolations[Viol->GetSourceFile()].insert(Viol);
-    ViolationManager::ViolationLineMapping[Viol->GetSourceFile()].insert(
-            Viol->GetLineNumber());
-    ViolationManager::ViolationCounts[Viol->Type()]++;
+    auto Inserted =
+            ViolationManager::FoundViolations[Viol.GetFileID()].insert(Viol);
+    if (!Inserted.second) {
+        return;
+    }
+
+    // The file's index no longer holds all of its violations
+    if (!ViolationManager::FrozenViolations.empty()) {
+        ViolationManager::FrozenViolations.erase(Viol.GetFileID());
+    }
+    ViolationManager::ViolationCounts[Viol.Type()]++;
 }
 
 void ViolationManager::AddInfractedName(std::string IdentifierName) {
@@ -42,6 +66,161 @@ bool ViolationManager::NameHasBeenInfracted(std::string IdentifierName) {
     return ViolationManager::InfractedNames.count(IdentifierName) != 0;
 }
 
+void ViolationManager::AddNameInfraction(std::string IdentifierName,
+        const Violation& Infraction, llvm::Optional<Violation> Note) {
+
+    if (!ViolationManager::NameHasBeenInfracted(IdentifierName)) {
+        ViolationManager::AddInfractedName(IdentifierName);
+        ViolationManager::AddViolation(Infraction);
+
+        // We hold on to the note in case this infraction needs to be
+        // downgraded when merging with another manager.
+        if (!ViolationManager::OutputToFile) {
+            Note = llvm::None;
+        }
+        ViolationManager::NameInfractions.push_back(
+                {IdentifierName, Infraction, Note});
+        return;
+    }
+
+    if (Note && ViolationManager::OutputToFile) {
+        ViolationManager::AddViolation(*Note);
+    }
+}
+
+void ViolationManager::MergeFrom(ViolationManager& Other) {
+
+    // Names that the other manager infracted first may have already been
+    // infracted by us. If so, the other manager's infraction is replaced
+    // with its note, just as if the files had been checked together.
+    for (auto& Entry : Other.NameInfractions) {
+        if (!ViolationManager::NameHasBeenInfracted(Entry.IdentifierName)) {
+            ViolationManager::NameInfractions.push_back(Entry);
+            continue;
+        }
+
+        Other.FoundViolations[Entry.Infraction.GetFileID()].erase(
+                Entry.Infraction);
+        if (Entry.Note) {
+            Other.AddViolation(*Entry.Note);
+        }
+    }
+
+    // The other manager's violations now belong to us
+    for (const auto& FileViolations : Other.FoundViolations) {
+        for (const auto& Viol : FileViolations.second) {
+            ViolationManager::AddViolation(Viol);
+        }
+    }
+    for (const auto& Name : Other.InfractedNames) {
+        ViolationManager::AddInfractedName(Name);
+    }
+
+    Other.Clear();
+}
+
+size_t ViolationManager::GetMemoryUsage(llvm::StringRef FilePath) const {
+
+    auto Found = ViolationManager::FoundViolations.find(
+            GlobalStringPool->Intern(FilePath));
+    if (Found == ViolationManager::FoundViolations.end()) {
+        return 0;
+    }
+
+    // Each violation is a node of the file's hash set (the violation, the
+    // next pointer and the cached hash). Messages are counted once per
+    // violation, even though the pool shares identical ones.
+    const auto& Violations = Found->second;
+    size_t Bytes = Violations.bucket_count() * sizeof(void*);
+    for (const auto& Viol : Violations) {
+        Bytes += sizeof(Violation) + sizeof(void*) + sizeof(size_t);
+        Bytes += Viol.GetMessageText().size();
+    }
+    return Bytes;
+}
+
+llvm::json::Value ViolationManager::ToJSON(void) const {
+
+    llvm::json::Array Violations;
+    for (const auto& FileViolations : ViolationManager::FoundViolations) {
+        for (const auto& Viol : FileViolations.second) {
+            Violations.push_back(Viol.ToJSON());
+        }
+    }
+
+    llvm::json::Array Infractions;
+    for (const auto& Entry : ViolationManager::NameInfractions) {
+        Infractions.push_back(llvm::json::Array{Entry.IdentifierName,
+                Entry.Infraction.ToJSON(),
+                Entry.Note ? Entry.Note->ToJSON() : nullptr});
+    }
+
+    return llvm::json::Object{{"violations", std::move(Violations)},
+            {"names", llvm::json::Array(ViolationManager::InfractedNames)},
+            {"infractions", std::move(Infractions)}};
+}
+
+bool ViolationManager::FromJSON(const llvm::json::Value& Value) {
+
+    const auto* Fields = Value.getAsObject();
+    if (!Fields) {
+        return false;
+    }
+    const auto* Violations = Fields->getArray("violations");
+    const auto* Names = Fields->getArray("names");
+    const auto* Infractions = Fields->getArray("infractions");
+    if (!Violations || !Names || !Infractions) {
+        return false;
+    }
+
+    for (const auto& Item : *Violations) {
+        auto Viol = Violation::FromJSON(Item);
+        if (!Viol) {
+            return false;
+        }
+        ViolationManager::AddViolation(*Viol);
+    }
+
+    for (const auto& Item : *Names) {
+        auto Name = Item.getAsString();
+        if (!Name) {
+            return false;
+        }
+        ViolationManager::AddInfractedName(Name->str());
+    }
+
+    for (const auto& Item : *Infractions) {
+        const auto* Entry = Item.getAsArray();
+        if (!Entry || Entry->size() != 3) {
+            return false;
+        }
+        auto Name = (*Entry)[0].getAsString();
+        auto Infraction = Violation::FromJSON((*Entry)[1]);
+        llvm::Optional<Violation> Note;
+        if (!(*Entry)[2].getAsNull()) {
+            Note = Violation::FromJSON((*Entry)[2]);
+            if (!Note) {
+                return false;
+            }
+        }
+        if (!Name || !Infraction) {
+            return false;
+        }
+        ViolationManager::NameInfractions.push_back(
+                {Name->str(), *Infraction, Note});
+    }
+    return true;
+}
+
+void ViolationManager::Clear(void) {
+
+    ViolationManager::FoundViolations.clear();
+    ViolationManager::FrozenViolations.clear();
+    ViolationManager::InfractedNames.clear();
+    ViolationManager::NameInfractions.clear();
+    ViolationManager::ViolationCounts.clear();
+}
+
 void ViolationManager::SetOutputToFile(void) {
     ViolationManager::OutputToFile = true;
 }
@@ -50,106 +229,120 @@ bool ViolationManager::WillOutputToFile(void) {
     return ViolationManager::OutputToFile;
 }
 
+// The parts of a violation which decide the order it is output in. These
+// are worked out once for each violation, rather than on every comparison
+// while sorting.
+struct ViolationSortKey {
+    uint LineNo;
+    ViolationType Type;
+    uint ColumnNo;
+    llvm::StringRef Message;
+    const Violation* Viol;
+};
+
 // When we output violations, we want them in a particular order.
-// They are ordered by their filepath, then by line number and
-// then by violation type. For whitespace violations with column
-// indices, we order them in ascending order. For other violations,
-// if they are the same type, we order them by their error message.
-bool ViolationComparator(Violation* V1, Violation* V2) {
-
-    int FilePathComparison = V1->GetSourceFile().compare(V2->GetSourceFile());
-
-    if (FilePathComparison == 0) {
-        if (V1->GetLineNumber() != V2->GetLineNumber()) {
-            // If they are on different lines, we only use that for sorting
-            return V1->GetLineNumber() < V2->GetLineNumber();
-        }
-        if (V1->Type() != V2->Type()) {
-            // If they are on the same line, and have different types, we use
-            // that instead
-            return V1->Type() < V2->Type();
-        }
+// They are ordered by line number and then by violation type.
+// For violations with column indices, we order them in ascending
+// order. For other violations, if they are the same type, we order
+// them by their error message.
+static bool ViolationComparator(
+        const ViolationSortKey& K1, const ViolationSortKey& K2) {
 
-        // If they are on the same line, are whitespace violations,
-        // and both violations reference columns, we order them by the column
-        // number
-        if (V1->Type() == ViolationType::WHITESPACE) {
-            auto V1Msg = V1->GetMessage();
-            auto V2Msg = V2->GetMessage();
-            auto SearchString = std::string("at position ");
-            auto V1ColPos = V1Msg.find(SearchString);
-            auto V2ColPos = V2Msg.find(SearchString);
-
-            if (V1ColPos != std::string::npos &&
-                    V2ColPos != std::string::npos) {
-                auto V1EndPos =
-                        V1Msg.substr(V1ColPos + SearchString.size()).find(",");
-                auto V2EndPos =
-                        V2Msg.substr(V2ColPos + SearchString.size()).find(",");
-                auto V1ColString =
-                        V1Msg.substr(V1ColPos + SearchString.size(), V1EndPos);
-                auto V2ColString =
-                        V2Msg.substr(V2ColPos + SearchString.size(), V2EndPos);
-
-                auto V1ColNo = std::stoi(V1ColString);
-                auto V2ColNo = std::stoi(V2ColString);
-                return V1ColNo < V2ColNo;
-            }
-        }
+    if (K1.LineNo != K2.LineNo) {
+        // If they are on different lines, we only use that for sorting
+        return K1.LineNo < K2.LineNo;
+    }
+    if (K1.Type != K2.Type) {
+        // If they are on the same line, and have different types, we use
+        // that instead
+        return K1.Type < K2.Type;
+    }
 
-        // Otherwise, we order them by their messages
-        return V1->GetMessage().compare(V2->GetMessage()) < 0;
+    // If they are on the same line and both violations reference columns,
+    // we order them by the column number
+    if (K1.ColumnNo && K2.ColumnNo && K1.ColumnNo != K2.ColumnNo) {
+        return K1.ColumnNo < K2.ColumnNo;
     }
 
-    // Otherwise compare them by filepath
-    return FilePathComparison < 0;
+    // Otherwise, we order them by their messages
+    return K1.Message.compare(K2.Message) < 0;
 }
 
-std::vector<Violation*> ViolationManager::GetViolationsInFile(
-        std::string FilePath) {
+FileViolationIndex::FileViolationIndex(
+        std::vector<const Violation*> Violations) {
+
+    std::vector<ViolationSortKey> Keys;
+    Keys.reserve(Violations.size());
 
-    auto Violations = ViolationManager::FoundViolations.find(FilePath);
+    // Most messages are kept as they are in the string pool, so only
+    // violations with arguments need formatting. The formatted messages
+    // can't move once the keys refer to them.
+    std::vector<std::string> FormattedMessages;
+    FormattedMessages.reserve(Violations.size());
 
-    if (Violations == ViolationManager::FoundViolations.end()) {
-        // If there aren't any violations for the file, we return an empty list
-        return std::vector<Violation*>();
+    for (const auto* Viol : Violations) {
+        auto Message = Viol->GetMessageText();
+        if (Viol->Rule() != RULE_MESSAGE) {
+            FormattedMessages.push_back(Viol->GetMessage());
+            Message = FormattedMessages.back();
+        }
+        Keys.push_back({Viol->GetLineNumber(), Viol->Type(),
+                Viol->GetColumnNumber(), Message, Viol});
+        FileViolationIndex::TypeCounts[Viol->Type()]++;
     }
+    std::sort(Keys.begin(), Keys.end(), ViolationComparator);
 
-    auto ResultList = std::vector<Violation*>();
-    for (auto* Viol : Violations->second) {
-        ResultList.push_back(Viol);
+    FileViolationIndex::Sorted.reserve(Keys.size());
+    for (const auto& Key : Keys) {
+        FileViolationIndex::Sorted.push_back(Key.Viol);
     }
-    std::sort(ResultList.begin(), ResultList.end(), ViolationComparator);
 
-    return ResultList;
+    // Each line's violations start where the previous line's end
+    uint LastLineNo = Keys.empty() ? 0 : Keys.back().LineNo;
+    FileViolationIndex::LineStarts.assign(LastLineNo + 2, 0);
+    for (const auto& Key : Keys) {
+        FileViolationIndex::LineStarts[Key.LineNo + 1]++;
+    }
+    for (uint i = 1; i < FileViolationIndex::LineStarts.size(); i++) {
+        FileViolationIndex::LineStarts[i] +=
+                FileViolationIndex::LineStarts[i - 1];
+    }
 }
 
-std::vector<Violation*> ViolationManager::GetViolationsOnLine(
-        std::string FilePath, uint LineNo) {
+llvm::ArrayRef<const Violation*> FileViolationIndex::GetViolationsOnLine(
+        uint LineNo) const {
 
-    // First we need to consult the line mapping to see whether we have
-    // any infractions to report for the given line
-    auto LineMapping = ViolationManager::ViolationLineMapping.find(FilePath);
-
-    if (LineMapping == ViolationManager::ViolationLineMapping.end()) {
-        // This file contains no style violations
-        return std::vector<Violation*>();
-    } else if (LineMapping->second.count(LineNo) == 0) {
-        // There are no style violations on this line
-        return std::vector<Violation*>();
+    if (LineNo + 1 >= FileViolationIndex::LineStarts.size()) {
+        // There are no style violations on or after this line
+        return llvm::ArrayRef<const Violation*>();
     }
 
-    // If we do have style violations, we filter them out by line number
-    auto ViolList = ViolationManager::GetViolationsInFile(FilePath);
-    std::vector<Violation*> FilteredList;
+    auto Start = FileViolationIndex::LineStarts[LineNo];
+    auto End = FileViolationIndex::LineStarts[LineNo + 1];
+    return llvm::makeArrayRef(FileViolationIndex::Sorted).slice(
+            Start, End - Start);
+}
+
+const FileViolationIndex& ViolationManager::GetFileViolations(
+        const std::string& FilePath) {
+
+    auto FileID = GlobalStringPool->Intern(FilePath);
+    auto Frozen = ViolationManager::FrozenViolations.find(FileID);
+    if (Frozen != ViolationManager::FrozenViolations.end()) {
+        return Frozen->second;
+    }
 
-    for (auto* Violation : ViolList) {
-        if (Violation->GetLineNumber() == LineNo) {
-            FilteredList.push_back(Violation);
+    std::vector<const Violation*> Violations;
+    auto Found = ViolationManager::FoundViolations.find(FileID);
+    if (Found != ViolationManager::FoundViolations.end()) {
+        for (const auto& Viol : Found->second) {
+            Violations.push_back(&Viol);
         }
     }
 
-    return FilteredList;
+    auto& Index = ViolationManager::FrozenViolations[FileID];
+    Index = FileViolationIndex(std::move(Violations));
+    return Index;
 }
 
-}  // namespace nett
\ No newline at end of file
+}  // namespace nett
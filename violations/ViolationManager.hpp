@@ -6,33 +6,72 @@
 
 #include "Violation.hpp"
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/Optional.h"
+
+#include <cstdint>
 #include <map>
 #include <unordered_set>
 #include <vector>
 
 namespace nett {
 
-struct ViolationEqualityChecker {
+struct ViolationHasher {
     public:
-    bool operator()(const Violation* V1, const Violation* V2) const {
-        return *V1 == *V2;
+    size_t operator()(const Violation& Viol) const {
+        return Viol.Hash();
     }
 };
 
-struct ViolationHasher {
+// The violations of a single file, sorted in the order that they are
+// output and grouped by line number. The index is built once the file has
+// been checked, so that the output can walk it in a single pass.
+class FileViolationIndex {
     public:
-    size_t operator()(const Violation* Viol) const {
-        std::hash<std::string> StringHasher;
-        auto MessageHash = StringHasher(Viol->GetMessage());
-        auto FileHash = StringHasher(Viol->GetSourceFile());
-        return 93 * MessageHash ^ FileHash ^ Viol->GetLineNumber();
+    FileViolationIndex() = default;
+
+    // Sorts the given violations, which must all belong to the same file.
+    explicit FileViolationIndex(std::vector<const Violation*> Violations);
+
+    // Returns every violation in the file, sorted by line number.
+    llvm::ArrayRef<const Violation*> GetViolations(void) const {
+        return Sorted;
+    }
+
+    // Returns the violations on the given line, in output order.
+    llvm::ArrayRef<const Violation*> GetViolationsOnLine(uint LineNo) const;
+
+    // Returns the number of violations of the given type in the file.
+    uint GetTypeCount(ViolationType Type) const {
+        return TypeCounts[Type];
     }
+
+    bool empty(void) const {
+        return Sorted.empty();
+    }
+
+    private:
+    std::vector<const Violation*> Sorted;
+    // The violations on line L are Sorted[LineStarts[L]:LineStarts[L + 1]]
+    std::vector<uint32_t> LineStarts;
+    uint TypeCounts[UNSPEC + 1] = {};
 };
 
 class ViolationManager {
     public:
-    // Adds a new violation into the violation manager
-    void AddViolation(Violation* Violation);
+    ViolationManager() = default;
+
+    // The manager can hold a lot of violations, so it can be moved
+    // between threads but never copied.
+    ViolationManager(ViolationManager&& Other);
+    ViolationManager& operator=(ViolationManager&& Other);
+    ViolationManager(const ViolationManager&) = delete;
+    ViolationManager& operator=(const ViolationManager&) = delete;
+
+    // Adds a new violation into the violation manager. Violations which
+    // are identical to one that has already been added, or which are on
+    // lines outside the GlobalLineFilter, are dropped.
+    void AddViolation(const Violation& Viol);
 
     // Adds the given identifier name into the violation manager's
     // list of known naming infractions. This allows us to depict
@@ -44,15 +83,40 @@ class ViolationManager {
     // Returns true if it has, else returns false.
     bool NameHasBeenInfracted(std::string IdentiferName);
 
-    // Returns a sorted list of violations that have been generated for
-    // the given file. The violations in this list are sorted
-    // in ascending order by line number for simpler printing.
-    std::vector<Violation*> GetViolationsInFile(std::string FilePath);
-
-    // Returns a list of violations that have been generated on
-    // the given line of the given file.
-    std::vector<Violation*> GetViolationsOnLine(
-            std::string FilePath, uint LineNo);
+    // Adds the given NAMING violation for the identifier name if the name
+    // hasn't been infracted yet. Otherwise the given NOTE violation (if any)
+    // is added when the violations will be output to a file.
+    void AddNameInfraction(std::string IdentifierName,
+            const Violation& Infraction,
+            llvm::Optional<Violation> Note = llvm::None);
+
+    // Moves the violations and infracted names found by another manager
+    // into this one. The other manager should hold the results of files
+    // checked after those in this manager, so that names it infracted
+    // first are downgraded to notes if we've already infracted them.
+    void MergeFrom(ViolationManager& Other);
+
+    // Returns the violations that have been generated for the given file,
+    // sorted and grouped by line. The index is built on first use, and
+    // rebuilt only if violations are added to the file afterwards.
+    const FileViolationIndex& GetFileViolations(const std::string& FilePath);
+
+    // Returns roughly how many bytes the violations of the given file take
+    // up, counting their messages.
+    size_t GetMemoryUsage(llvm::StringRef FilePath) const;
+
+    // Returns the violations and infracted names held by the manager as
+    // JSON, for the result cache.
+    llvm::json::Value ToJSON(void) const;
+
+    // Adds the violations and infracted names stored by ToJSON to the
+    // manager. Returns false if the value isn't in that form, in which case
+    // the manager may have been partly filled.
+    bool FromJSON(const llvm::json::Value& Value);
+
+    // Removes all of the violations and infracted names held by the manager.
+    // The output setting is kept.
+    void Clear(void);
 
     // Sets that the violations will be output to a file.
     // This allows us to turn off certain messages when sending
@@ -64,16 +128,26 @@ class ViolationManager {
     bool WillOutputToFile(void);
 
     private:
-    std::map<std::string, std::unordered_set<Violation*, ViolationHasher,
-                                  ViolationEqualityChecker>>
+    // The first infraction of a name, along with the note that replaces it
+    // if the name turns out to have been infracted elsewhere.
+    struct NameInfraction {
+        std::string IdentifierName;
+        Violation Infraction;
+        llvm::Optional<Violation> Note;
+    };
+
+    // The violations and indexes of each file, by the file's id in the
+    // GlobalStringPool
+    std::map<uint32_t, std::unordered_set<Violation, ViolationHasher>>
             FoundViolations;
-    std::map<std::string, std::unordered_set<int>> ViolationLineMapping;
+    std::map<uint32_t, FileViolationIndex> FrozenViolations;
     std::unordered_set<std::string> InfractedNames;
+    std::vector<NameInfraction> NameInfractions;
     std::map<ViolationType, uint> ViolationCounts;
     bool OutputToFile = false;
 };
 
-extern ViolationManager GlobalViolationManager;
+extern thread_local ViolationManager GlobalViolationManager;
 
 }  // namespace nett
 